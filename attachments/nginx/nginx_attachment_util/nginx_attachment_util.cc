@@ -15,6 +15,7 @@
 #include "nginx_attachment_util.h"
 
 #include <arpa/inet.h>
+#include <algorithm>
 
 #include "http_configuration.h"
 
@@ -22,10 +23,14 @@ using namespace std;
 
 static HttpAttachmentConfiguration conf_data;
 
+static void compileExcludeSources();
+
 int
 initAttachmentConfig(c_str conf_file)
 {
-    return conf_data.init(conf_file);
+    int res = conf_data.init(conf_file);
+    compileExcludeSources();
+    return res;
 }
 
 ngx_http_inspection_mode_e
@@ -232,33 +237,51 @@ createIPAddress(c_str ip_str)
     return res;
 }
 
-static bool
-isIPInRange(const IpAddress &ip, const IpAddress &start, const IpAddress &end)
-{
-    if (ip.is_ipv4 != start.is_ipv4 || ip.is_ipv4 != end.is_ipv4) return false;
-    return start <= ip && ip <= end;
-}
+using IpRange = pair<IpAddress, IpAddress>;
+
+// The exclude sources, parsed when the configuration is loaded. The ranges are sorted and merged, so a source is
+// looked up with a binary search.
+static vector<IpRange> exclude_ranges;
 
 static bool
-isIPInRange(const IpAddress &ip, const string &range)
+createIPRange(const string &range, IpRange &ip_range)
 {
     auto delimiter = range.find('-');
-
-    if (delimiter == string::npos) {
-        if (!isIPAddress(range.c_str())) return false;
-        auto address = createIPAddress(range.c_str());
-        return isIPInRange(ip, address, address);
-    }
-
     auto start_str = range.substr(0, delimiter);
-    if (!isIPAddress(start_str.c_str())) return false;
-    auto start_addr = createIPAddress(start_str.c_str());
+    auto end_str = delimiter == string::npos ? start_str : range.substr(delimiter + 1);
+    if (!isIPAddress(start_str.c_str()) || !isIPAddress(end_str.c_str())) return false;
 
-    auto end_str = range.substr(delimiter + 1);
-    if (!isIPAddress(end_str.c_str())) return false;
-    auto end_addr = createIPAddress(end_str.c_str());
+    ip_range.first = createIPAddress(start_str.c_str());
+    ip_range.second = createIPAddress(end_str.c_str());
+    return ip_range.first.is_ipv4 == ip_range.second.is_ipv4 && ip_range.first <= ip_range.second;
+}
 
-    return isIPInRange(ip, start_addr, end_addr);
+static void
+compileExcludeSources()
+{
+    exclude_ranges.clear();
+    for (auto &range : conf_data.getExcludeSources()) {
+        IpRange ip_range;
+        if (createIPRange(range, ip_range)) exclude_ranges.push_back(ip_range);
+    }
+    if (exclude_ranges.empty()) return;
+
+    sort(
+        exclude_ranges.begin(),
+        exclude_ranges.end(),
+        [] (const IpRange &first, const IpRange &second) { return first.first < second.first; }
+    );
+
+    size_t merged_index = 0;
+    for (size_t i = 1; i < exclude_ranges.size(); ++i) {
+        auto &merged = exclude_ranges[merged_index];
+        if (merged.first.is_ipv4 == exclude_ranges[i].first.is_ipv4 && exclude_ranges[i].first <= merged.second) {
+            if (merged.second < exclude_ranges[i].second) merged.second = exclude_ranges[i].second;
+        } else {
+            exclude_ranges[++merged_index] = exclude_ranges[i];
+        }
+    }
+    exclude_ranges.resize(merged_index + 1);
 }
 
 int
@@ -267,9 +290,14 @@ isSkipSource(c_str ip_str)
     if (!isIPAddress(ip_str)) return 0;
     auto ip = createIPAddress(ip_str);
 
-    for (auto &range : conf_data.getExcludeSources()) {
-        if (isIPInRange(ip, range)) return 1;
-    }
+    auto next_range = upper_bound(
+        exclude_ranges.begin(),
+        exclude_ranges.end(),
+        ip,
+        [] (const IpAddress &ip, const IpRange &range) { return ip < range.first; }
+    );
+    if (next_range == exclude_ranges.begin()) return 0;
 
-    return 0;
+    auto &range = *prev(next_range);
+    return range.first.is_ipv4 == ip.is_ipv4 && ip <= range.second ? 1 : 0;
 }
@@ -0,0 +1,346 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Drives a running HTTP Transaction Handler through its shared memory queues with synthetic transactions, and
+// reports the verdict latency and the chunk rate it sustained. Running it with different "--ipc-elements" and
+// "--chunks-per-signal" values (and the same "nginxAttachment.numOfNginxIpcElements" setting in the service)
+// shows how many queue elements a given traffic mix needs.
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "synthetic_nginx_attachment.h"
+
+using namespace std;
+using namespace chrono;
+
+struct BenchOptions
+{
+    string instance_id;
+    string signal_path = SHARED_VERDICT_SIGNAL_PATH;
+    uint16_t ipc_elements = NUM_OF_NGINX_IPC_ELEMENTS;
+    uint sessions = 10000;
+    uint concurrency = 1;
+    uint headers = 10;
+    uint body_size = 0;
+    uint chunk_size = 4096;
+    uint chunks_per_signal = 1;
+    bool response = false;
+    uint timeout_ms = 5000;
+};
+
+struct Chunk
+{
+    ngx_http_chunk_type_e type;
+    string data;
+};
+
+// The chunks the attachment pushes to the queue before it signals the service and waits for the verdicts.
+using Burst = vector<Chunk>;
+
+struct Session
+{
+    uint32_t id;
+    size_t next_burst = 0;
+    steady_clock::time_point start;
+};
+
+struct BenchResults
+{
+    uint64_t chunks = 0;
+    uint64_t bytes = 0;
+    uint64_t round_trips = 0;
+    uint64_t queue_full = 0;
+    uint64_t sessions = 0;
+    vector<uint64_t> round_trip_latency;
+    vector<uint64_t> session_latency;
+    map<ngx_http_cp_verdict_e, uint64_t> verdicts;
+};
+
+static void
+printUsage(const char *name)
+{
+    cerr
+        << "Usage: " << name << " --instance-id=<id> [options]\n"
+        << "  --instance-id=<id>         Unique ID of the service instance (<family>_<id> when it has a family)\n"
+        << "  --signal-path=<path>       Registration socket path, without the instance ID suffix\n"
+        << "  --ipc-elements=<n>         Number of elements of the shared memory queues (default: 200)\n"
+        << "  --sessions=<n>             Number of transactions to send (default: 10000)\n"
+        << "  --concurrency=<n>          Number of transactions open at the same time (default: 1)\n"
+        << "  --headers=<n>              Number of request headers (default: 10)\n"
+        << "  --body-size=<bytes>        Size of the request body, and of the response body (default: 0)\n"
+        << "  --chunk-size=<bytes>       Size of the body chunks (default: 4096)\n"
+        << "  --chunks-per-signal=<n>    Body chunks pushed to the queue before signaling the service (default: 1)\n"
+        << "  --response                 Send the response phases as well\n"
+        << "  --timeout-ms=<ms>          Time to wait for a verdict (default: 5000)\n";
+}
+
+static bool
+parseOptions(int argc, char **argv, BenchOptions &options)
+{
+    static const struct option long_options[] = {
+        { "instance-id", required_argument, nullptr, 'i' },
+        { "signal-path", required_argument, nullptr, 'p' },
+        { "ipc-elements", required_argument, nullptr, 'e' },
+        { "sessions", required_argument, nullptr, 's' },
+        { "concurrency", required_argument, nullptr, 'c' },
+        { "headers", required_argument, nullptr, 'H' },
+        { "body-size", required_argument, nullptr, 'b' },
+        { "chunk-size", required_argument, nullptr, 'k' },
+        { "chunks-per-signal", required_argument, nullptr, 'n' },
+        { "response", no_argument, nullptr, 'r' },
+        { "timeout-ms", required_argument, nullptr, 't' },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    try {
+        int opt;
+        while ((opt = getopt_long(argc, argv, "", long_options, nullptr)) != -1) {
+            switch (opt) {
+                case 'i': options.instance_id = optarg; break;
+                case 'p': options.signal_path = optarg; break;
+                case 'e': options.ipc_elements = stoul(optarg); break;
+                case 's': options.sessions = stoul(optarg); break;
+                case 'c': options.concurrency = max(1ul, stoul(optarg)); break;
+                case 'H': options.headers = stoul(optarg); break;
+                case 'b': options.body_size = stoul(optarg); break;
+                case 'k': options.chunk_size = max(1ul, stoul(optarg)); break;
+                case 'n': options.chunks_per_signal = max(1ul, stoul(optarg)); break;
+                case 'r': options.response = true; break;
+                case 't': options.timeout_ms = stoul(optarg); break;
+                default: return false;
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Invalid option value: " << e.what() << endl;
+        return false;
+    }
+
+    return !options.instance_id.empty();
+}
+
+static void
+addBodyBursts(vector<Burst> &bursts, ngx_http_chunk_type_e type, const BenchOptions &options)
+{
+    if (options.body_size == 0) return;
+
+    string body(options.body_size, 'a');
+    uint8_t part = 0;
+    for (size_t offset = 0; offset < body.size(); offset += options.chunk_size, part++) {
+        if (part % options.chunks_per_signal == 0) bursts.emplace_back();
+        bool is_last = offset + options.chunk_size >= body.size();
+        bursts.back().push_back({ type, SyntheticNginxAttachment::genBody(
+            body.substr(offset, options.chunk_size),
+            is_last,
+            part
+        ) });
+    }
+}
+
+// All the transactions are the same, the phases differ in their size and in the number of chunks they take.
+static vector<Burst>
+genTransaction(const BenchOptions &options)
+{
+    vector<pair<string, string>> request_headers = {
+        { "Host", "www.example.com" },
+        { "User-Agent", "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko)" },
+        { "Accept", "text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8" }
+    };
+    while (request_headers.size() < options.headers) {
+        string index = to_string(request_headers.size());
+        request_headers.emplace_back("X-Synthetic-Header-" + index, "synthetic header value number " + index);
+    }
+    request_headers.resize(options.headers);
+
+    vector<Burst> bursts;
+    bursts.push_back({ { ngx_http_chunk_type_e::REQUEST_START, SyntheticNginxAttachment::genRequestStart(
+        options.body_size > 0 ? "POST" : "GET",
+        "www.example.com",
+        "/api/v1/items?page=1&sort=name",
+        "10.0.0.1",
+        45000
+    ) } });
+    bursts.push_back({ { ngx_http_chunk_type_e::REQUEST_HEADER, SyntheticNginxAttachment::genHeaders(
+        request_headers,
+        true,
+        0
+    ) } });
+    addBodyBursts(bursts, ngx_http_chunk_type_e::REQUEST_BODY, options);
+    bursts.push_back({ { ngx_http_chunk_type_e::REQUEST_END, "" } });
+
+    if (!options.response) return bursts;
+
+    bursts.push_back({ { ngx_http_chunk_type_e::RESPONSE_CODE, SyntheticNginxAttachment::genResponseCode(200) } });
+    bursts.push_back({ { ngx_http_chunk_type_e::CONTENT_LENGTH,
+        SyntheticNginxAttachment::genContentLength(options.body_size)
+    } });
+    bursts.push_back({ { ngx_http_chunk_type_e::RESPONSE_HEADER, SyntheticNginxAttachment::genHeaders(
+        { { "Content-Type", "application/json" }, { "Cache-Control", "no-cache" } },
+        true,
+        0
+    ) } });
+    addBodyBursts(bursts, ngx_http_chunk_type_e::RESPONSE_BODY, options);
+    bursts.push_back({ { ngx_http_chunk_type_e::RESPONSE_END, "" } });
+    return bursts;
+}
+
+static bool
+isFinalVerdict(ngx_http_cp_verdict_e verdict)
+{
+    return
+        verdict == ngx_http_cp_verdict_e::TRAFFIC_VERDICT_ACCEPT ||
+        verdict == ngx_http_cp_verdict_e::TRAFFIC_VERDICT_DROP ||
+        verdict == ngx_http_cp_verdict_e::TRAFFIC_VERDICT_IRRELEVANT;
+}
+
+static const char *
+verdictToString(ngx_http_cp_verdict_e verdict)
+{
+    switch (verdict) {
+        case ngx_http_cp_verdict_e::TRAFFIC_VERDICT_INSPECT: return "inspect";
+        case ngx_http_cp_verdict_e::TRAFFIC_VERDICT_ACCEPT: return "accept";
+        case ngx_http_cp_verdict_e::TRAFFIC_VERDICT_DROP: return "drop";
+        case ngx_http_cp_verdict_e::TRAFFIC_VERDICT_INJECT: return "inject";
+        case ngx_http_cp_verdict_e::TRAFFIC_VERDICT_IRRELEVANT: return "irrelevant";
+        case ngx_http_cp_verdict_e::TRAFFIC_VERDICT_RECONF: return "reconf";
+        case ngx_http_cp_verdict_e::TRAFFIC_VERDICT_WAIT: return "wait";
+    }
+    return "unknown";
+}
+
+static uint64_t
+percentile(vector<uint64_t> &samples, double fraction)
+{
+    if (samples.empty()) return 0;
+    size_t index = min(samples.size() - 1, static_cast<size_t>(samples.size() * fraction));
+    nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+static void
+printLatency(const string &title, vector<uint64_t> &samples)
+{
+    cout
+        << left << setw(24) << title
+        << " p50: " << setw(8) << percentile(samples, 0.5)
+        << " p90: " << setw(8) << percentile(samples, 0.9)
+        << " p99: " << setw(8) << percentile(samples, 0.99)
+        << " max: " << percentile(samples, 1.0)
+        << " (usec)" << endl;
+}
+
+// Pushes the burst of the session, when the queue fills up the service is signaled to drain it first.
+static bool
+sendBurst(SyntheticNginxAttachment &attachment, const Session &session, const Burst &burst, BenchResults &results)
+{
+    for (const Chunk &chunk : burst) {
+        while (!attachment.pushChunk(session.id, chunk.type, chunk.data)) {
+            results.queue_full++;
+            if (!attachment.signalAndWait(session.id)) return false;
+            for (const auto &verdict : attachment.readVerdicts()) results.verdicts[verdict.second]++;
+        }
+        results.chunks++;
+        results.bytes += chunk.data.size();
+    }
+    return true;
+}
+
+static bool
+runBench(SyntheticNginxAttachment &attachment, const BenchOptions &options, BenchResults &results)
+{
+    const vector<Burst> bursts = genTransaction(options);
+    uint32_t next_session_id = 1;
+    deque<Session> open_sessions;
+
+    while (results.sessions < options.sessions) {
+        while (open_sessions.size() < options.concurrency && next_session_id <= options.sessions) {
+            open_sessions.push_back({ next_session_id++, 0, steady_clock::now() });
+        }
+
+        Session session = open_sessions.front();
+        open_sessions.pop_front();
+
+        auto round_trip_start = steady_clock::now();
+        if (!sendBurst(attachment, session, bursts[session.next_burst++], results)) return false;
+        if (!attachment.signalAndWait(session.id)) return false;
+
+        bool is_finished = session.next_burst == bursts.size();
+        for (const auto &verdict : attachment.readVerdicts()) {
+            results.verdicts[verdict.second]++;
+            if (verdict.first == session.id && isFinalVerdict(verdict.second)) is_finished = true;
+        }
+
+        auto now = steady_clock::now();
+        results.round_trips++;
+        results.round_trip_latency.push_back(duration_cast<microseconds>(now - round_trip_start).count());
+
+        if (is_finished) {
+            results.sessions++;
+            results.session_latency.push_back(duration_cast<microseconds>(now - session.start).count());
+        } else {
+            open_sessions.push_back(session);
+        }
+    }
+
+    return true;
+}
+
+int
+main(int argc, char **argv)
+{
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    SyntheticNginxAttachment attachment(options.instance_id, options.ipc_elements, milliseconds(options.timeout_ms));
+    if (!attachment.registerToService(options.signal_path)) {
+        cerr << "Failed to register to the service: " << attachment.getError() << endl;
+        return 1;
+    }
+
+    BenchResults results;
+    auto start = steady_clock::now();
+    bool is_completed = runBench(attachment, options, results);
+    double elapsed = duration_cast<duration<double>>(steady_clock::now() - start).count();
+    if (!is_completed) cerr << "The benchmark stopped early: " << attachment.getError() << endl;
+
+    cout
+        << "Sessions: " << results.sessions
+        << ", chunks: " << results.chunks
+        << ", bytes: " << results.bytes
+        << ", elapsed: " << fixed << setprecision(3) << elapsed << " sec" << endl
+        << "Throughput: " << setprecision(0) << results.chunks / elapsed << " chunks/sec, "
+        << results.sessions / elapsed << " sessions/sec, "
+        << setprecision(2) << results.bytes / elapsed / (1024 * 1024) << " MB/sec" << endl
+        << "Round trips: " << results.round_trips
+        << ", queue full: " << results.queue_full << endl;
+    printLatency("Round trip latency", results.round_trip_latency);
+    printLatency("Transaction latency", results.session_latency);
+
+    cout << "Verdicts:";
+    for (const auto &verdict : results.verdicts) cout << " " << verdictToString(verdict.first) << "=" << verdict.second;
+    cout << endl;
+
+    return is_completed ? 0 : 1;
+}
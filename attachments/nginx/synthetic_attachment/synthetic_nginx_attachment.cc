@@ -0,0 +1,250 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "synthetic_nginx_attachment.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+static void
+ignoreIpcDebug(int, const char *, const char *, int, const char *, ...)
+{
+}
+
+template <typename T>
+static void
+appendValue(string &data, T value)
+{
+    data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static void
+appendStrParam(string &data, const string &param)
+{
+    appendValue<uint16_t>(data, param.size());
+    data.append(param);
+}
+
+SyntheticNginxAttachment::SyntheticNginxAttachment(
+    const string &_instance_id,
+    uint16_t _num_of_ipc_elements,
+    chrono::milliseconds _timeout)
+        :
+    instance_id(_instance_id),
+    num_of_ipc_elements(_num_of_ipc_elements),
+    timeout(_timeout)
+{
+}
+
+SyntheticNginxAttachment::~SyntheticNginxAttachment()
+{
+    if (ipc != nullptr) destroyIpc(ipc, 0);
+    if (sock >= 0) close(sock);
+}
+
+bool
+SyntheticNginxAttachment::registerToService(const string &signal_path)
+{
+    if (instance_id.size() > MAX_NGINX_UID_LEN) return setError("Instance ID is too long: " + instance_id);
+
+    string socket_path = signal_path + "-" + instance_id;
+    struct sockaddr_un server;
+    if (socket_path.size() >= sizeof(server.sun_path)) return setError("Socket path is too long: " + socket_path);
+
+    sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0) return setError(string("Failed to open a socket: ") + strerror(errno));
+
+    memset(&server, 0, sizeof(server));
+    server.sun_family = AF_UNIX;
+    strncpy(server.sun_path, socket_path.c_str(), sizeof(server.sun_path) - 1);
+    if (connect(sock, reinterpret_cast<struct sockaddr *>(&server), sizeof(server)) < 0) {
+        return setError("Failed to connect to " + socket_path + ": " + strerror(errno));
+    }
+
+    uint8_t uid_size = instance_id.size();
+    uint32_t user_id = getuid();
+    uint32_t group_id = getgid();
+    if (
+        !writeToSocket(&uid_size, sizeof(uid_size)) ||
+        !writeToSocket(instance_id.data(), instance_id.size()) ||
+        !writeToSocket(&user_id, sizeof(user_id)) ||
+        !writeToSocket(&group_id, sizeof(group_id))
+    ) {
+        return false;
+    }
+
+    uint8_t registration_success = 0;
+    if (!readFromSocket(&registration_success, sizeof(registration_success))) return false;
+    if (registration_success != 1) return setError("The service refused the registration");
+
+    ipc = initIpc(instance_id.c_str(), user_id, group_id, 0, num_of_ipc_elements, ignoreIpcDebug);
+    if (ipc == nullptr) return setError("Failed to open the shared memory queues of " + instance_id);
+
+    return true;
+}
+
+bool
+SyntheticNginxAttachment::pushChunk(uint32_t session_id, ngx_http_chunk_type_e chunk_type, const string &data)
+{
+    ngx_http_cp_request_data_t request_data;
+    request_data.data_type = static_cast<uint16_t>(chunk_type);
+    request_data.session_id = session_id;
+
+    const char *fragments[] = { reinterpret_cast<const char *>(&request_data), data.data() };
+    const uint16_t fragments_sizes[] = { sizeof(request_data), static_cast<uint16_t>(data.size()) };
+    return sendChunkedData(ipc, fragments_sizes, fragments, 2) == 0;
+}
+
+bool
+SyntheticNginxAttachment::signalAndWait(uint32_t session_id)
+{
+    if (!writeToSocket(&session_id, sizeof(session_id))) return false;
+
+    // Signals of earlier sessions may still be waiting on the socket, just like the attachment we skip them.
+    uint32_t signaled_session_id = 0;
+    while (signaled_session_id != session_id) {
+        if (!readFromSocket(&signaled_session_id, sizeof(signaled_session_id))) return false;
+    }
+    return true;
+}
+
+vector<pair<uint32_t, ngx_http_cp_verdict_e>>
+SyntheticNginxAttachment::readVerdicts()
+{
+    vector<pair<uint32_t, ngx_http_cp_verdict_e>> verdicts;
+    while (isDataAvailable(ipc)) {
+        const char *reply_data = nullptr;
+        uint16_t reply_size = 0;
+        if (receiveData(ipc, &reply_size, &reply_data) < 0) break;
+
+        if (reply_data != nullptr && reply_size >= sizeof(ngx_http_cp_reply_from_service_t)) {
+            auto reply = reinterpret_cast<const ngx_http_cp_reply_from_service_t *>(reply_data);
+            verdicts.emplace_back(reply->session_id, static_cast<ngx_http_cp_verdict_e>(reply->verdict));
+        }
+        popData(ipc);
+    }
+    return verdicts;
+}
+
+string
+SyntheticNginxAttachment::genRequestStart(
+    const string &method,
+    const string &host,
+    const string &uri,
+    const string &client_addr,
+    uint16_t client_port)
+{
+    string data;
+    appendStrParam(data, "HTTP/1.1");
+    appendStrParam(data, method);
+    appendStrParam(data, host);
+    appendStrParam(data, "127.0.0.1");
+    appendValue<uint16_t>(data, 80);
+    appendStrParam(data, uri);
+    appendStrParam(data, client_addr);
+    appendValue<uint16_t>(data, client_port);
+    appendStrParam(data, host);
+    appendStrParam(data, uri);
+    return data;
+}
+
+string
+SyntheticNginxAttachment::genHeaders(
+    const vector<pair<string, string>> &headers,
+    bool is_last_part,
+    uint8_t part_index)
+{
+    string data;
+    appendValue<uint8_t>(data, is_last_part ? 1 : 0);
+    appendValue<uint8_t>(data, part_index);
+    for (const auto &header : headers) {
+        appendStrParam(data, header.first);
+        appendStrParam(data, header.second);
+    }
+    return data;
+}
+
+string
+SyntheticNginxAttachment::genBody(const string &body, bool is_last_part, uint8_t part_index)
+{
+    string data;
+    appendValue<uint8_t>(data, is_last_part ? 1 : 0);
+    appendValue<uint8_t>(data, part_index);
+    data.append(body);
+    return data;
+}
+
+string
+SyntheticNginxAttachment::genResponseCode(uint16_t response_code)
+{
+    string data;
+    appendValue<uint16_t>(data, response_code);
+    return data;
+}
+
+string
+SyntheticNginxAttachment::genContentLength(uint64_t content_length)
+{
+    string data;
+    appendValue<uint64_t>(data, content_length);
+    return data;
+}
+
+bool
+SyntheticNginxAttachment::setError(const string &err)
+{
+    error = err;
+    return false;
+}
+
+bool
+SyntheticNginxAttachment::writeToSocket(const void *data, size_t size)
+{
+    const char *pos = static_cast<const char *>(data);
+    while (size > 0) {
+        ssize_t written = send(sock, pos, size, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return setError(string("Failed to write to the service socket: ") + strerror(errno));
+        pos += written;
+        size -= written;
+    }
+    return true;
+}
+
+bool
+SyntheticNginxAttachment::readFromSocket(void *data, size_t size)
+{
+    char *pos = static_cast<char *>(data);
+    while (size > 0) {
+        struct pollfd poll_fd = { sock, POLLIN, 0 };
+        int res = poll(&poll_fd, 1, timeout.count());
+        if (res < 0 && errno == EINTR) continue;
+        if (res == 0) return setError("Timed out waiting for the service");
+        if (res < 0) return setError(string("Failed to poll the service socket: ") + strerror(errno));
+
+        ssize_t received = recv(sock, pos, size, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received == 0) return setError("The service closed the socket");
+        if (received < 0) return setError(string("Failed to read from the service socket: ") + strerror(errno));
+        pos += received;
+        size -= received;
+    }
+    return true;
+}
@@ -0,0 +1,86 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __SYNTHETIC_NGINX_ATTACHMENT_H__
+#define __SYNTHETIC_NGINX_ATTACHMENT_H__
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "nginx_attachment_common.h"
+#include "shmem_ipc.h"
+
+// Plays the part of an nginx worker in front of a running HTTP Transaction Handler: it registers the way the
+// attachment does and passes transactions to the service over the same shared memory queues, chunk by chunk.
+// Used to measure the throughput and latency of the IPC without an nginx in the loop.
+class SyntheticNginxAttachment
+{
+public:
+    // The number of queue elements must match the "nginxAttachment.numOfNginxIpcElements" setting of the service.
+    SyntheticNginxAttachment(
+        const std::string &instance_id,
+        uint16_t num_of_ipc_elements,
+        std::chrono::milliseconds timeout
+    );
+    ~SyntheticNginxAttachment();
+
+    SyntheticNginxAttachment(const SyntheticNginxAttachment &) = delete;
+    SyntheticNginxAttachment & operator=(const SyntheticNginxAttachment &) = delete;
+
+    bool registerToService(const std::string &signal_path = SHARED_VERDICT_SIGNAL_PATH);
+
+    // Fails when the queue is full - the chunk should be pushed again after the service drained the queue.
+    bool pushChunk(uint32_t session_id, ngx_http_chunk_type_e chunk_type, const std::string &data);
+
+    // Signals the service that chunks of the session are waiting, and waits until the service signals back.
+    bool signalAndWait(uint32_t session_id);
+
+    // Reads (and removes from the queue) the verdicts that the service wrote since the last read.
+    std::vector<std::pair<uint32_t, ngx_http_cp_verdict_e>> readVerdicts();
+
+    const std::string & getError() const { return error; }
+
+    // The chunks, serialized the way the attachment sends them.
+    static std::string genRequestStart(
+        const std::string &method,
+        const std::string &host,
+        const std::string &uri,
+        const std::string &client_addr,
+        uint16_t client_port
+    );
+    static std::string genHeaders(
+        const std::vector<std::pair<std::string, std::string>> &headers,
+        bool is_last_part,
+        uint8_t part_index
+    );
+    static std::string genBody(const std::string &data, bool is_last_part, uint8_t part_index);
+    static std::string genResponseCode(uint16_t response_code);
+    static std::string genContentLength(uint64_t content_length);
+
+private:
+    bool setError(const std::string &err);
+    bool writeToSocket(const void *data, size_t size);
+    bool readFromSocket(void *data, size_t size);
+
+    std::string instance_id;
+    uint16_t num_of_ipc_elements;
+    std::chrono::milliseconds timeout;
+    int sock = -1;
+    SharedMemoryIPC *ipc = nullptr;
+    std::string error;
+};
+
+#endif // __SYNTHETIC_NGINX_ATTACHMENT_H__
@@ -0,0 +1,14 @@
+find_library(BENCHMARK_LIBRARY benchmark)
+
+# The benchmarks are not part of the default build, use "make benchmarks" to build all of them.
+add_custom_target(benchmarks)
+
+function(add_benchmark bench_name bench_sources use_libs)
+    if(NOT BENCHMARK_LIBRARY)
+        return()
+    endif()
+
+    add_executable(${bench_name} EXCLUDE_FROM_ALL ${bench_sources})
+    target_link_libraries(${bench_name} -Wl,--start-group ${use_libs} debug_is report cptest pthread packet singleton environment metric event_is buffers rest config compression_utils z ${BENCHMARK_LIBRARY} ${GTEST_BOTH_LIBRARIES} gmock boost_regex pthread dl -Wl,--end-group)
+    add_dependencies(benchmarks ${bench_name})
+endfunction(add_benchmark)
@@ -0,0 +1,88 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "early_verdict.h"
+
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "debug.h"
+#include "ip_utilities.h"
+#include "generic_rulebase/rulebase_config.h"
+#include "generic_rulebase/generic_rulebase_utils.h"
+
+using namespace std;
+
+USE_DEBUG_FLAG(D_NGINX_ATTACHMENT);
+
+// The sources whose transactions are not inspected. The ranges are compiled when the policy is loaded, so checking a
+// transaction is a binary search.
+class InspectionBypassSources
+{
+public:
+    void
+    load(cereal::JSONInputArchive &ar)
+    {
+        vector<string> sources;
+        parseJSONKey<vector<string>>("sources", sources, ar);
+
+        vector<IPRange> ranges;
+        for (const string &source : sources) {
+            auto range = IPUtilities::createRangeFromString<IPRange, IpAddress>(source, "ip address");
+            if (!range.ok()) {
+                dbgWarning(D_NGINX_ATTACHMENT)
+                    << "Failed to parse inspection bypass source: "
+                    << source
+                    << ", Error: "
+                    << range.getErr();
+                continue;
+            }
+            ranges.push_back(range.unpack());
+        }
+        bypass_ranges = IPUtilities::IpRangeSet(ranges);
+    }
+
+    bool contains(const IPAddr &source) const { return bypass_ranges.contains(source); }
+
+private:
+    IPUtilities::IpRangeSet bypass_ranges;
+};
+
+void
+EarlyVerdict::preload()
+{
+    registerExpectedConfiguration<InspectionBypassSources>("HTTP manager", "Inspection bypass sources");
+}
+
+Maybe<ngx_http_cp_verdict_e>
+EarlyVerdict::get(const IPAddr &source_ip)
+{
+    auto &bypass_sources = getConfiguration<InspectionBypassSources>("HTTP manager", "Inspection bypass sources");
+    if (bypass_sources.ok() && bypass_sources.unpack().contains(source_ip)) {
+        dbgDebug(D_NGINX_ATTACHMENT) << "Source " << source_ip << " is configured to bypass inspection";
+        return ngx_http_cp_verdict_e::TRAFFIC_VERDICT_ACCEPT;
+    }
+
+    if (!getProfileAgentSettingWithDefault<bool>(false, "nginxAttachment.irrelevantWithoutPractices")) {
+        return genError("Transaction should be inspected");
+    }
+
+    auto &rule_by_ctx = getConfiguration<BasicRuleConfig>("rulebase", "rulesConfig");
+    if (rule_by_ctx.ok() && rule_by_ctx.unpack().getPractices().empty()) {
+        dbgDebug(D_NGINX_ATTACHMENT) << "No practice is active for asset " << rule_by_ctx.unpack().getAssetName();
+        return ngx_http_cp_verdict_e::TRAFFIC_VERDICT_IRRELEVANT;
+    }
+
+    return genError("Transaction should be inspected");
+}
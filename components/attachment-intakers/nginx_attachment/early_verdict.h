@@ -0,0 +1,34 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __EARLY_VERDICT_H__
+#define __EARLY_VERDICT_H__
+
+#include "connkey.h"
+#include "maybe_res.h"
+#include "nginx_attachment_common.h"
+
+// Decides, when a transaction starts and before any security app sees it, whether it needs to be inspected at all.
+// A final verdict is sent back to nginx, which then stops passing the rest of the transaction to the agent:
+// - Accept, for sources listed in the "HTTP manager" / "Inspection bypass sources" configuration.
+// - Irrelevant, for assets whose rule has no practices. Security configurations that are not practices (such as
+//   "rulebase" / "httpGeoFilter") are not consulted, so this is only done when the
+//   "nginxAttachment.irrelevantWithoutPractices" agent setting is enabled.
+class EarlyVerdict
+{
+public:
+    static void preload();
+    static Maybe<ngx_http_cp_verdict_e> get(const IPAddr &source_ip);
+};
+
+#endif // __EARLY_VERDICT_H__
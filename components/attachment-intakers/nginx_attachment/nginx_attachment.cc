@@ -55,6 +55,8 @@
 #include "report/report_enums.h"
 #include "user_identifiers_config.h"
 #include "agent_core_utilities.h"
+#include "inspection_stage_metric.h"
+#include "early_verdict.h"
 
 #ifdef FAILURE_TEST
 #include "intentional_failure.h"
@@ -77,6 +79,7 @@ using ChunkType = ngx_http_chunk_type_e;
 
 static const uint32_t corrupted_session_id = CORRUPTED_SESSION_ID;
 static const AlertInfo alert(AlertTeam::CORE, "nginx attachment");
+static const uint default_max_decompression_ratio = 1000;
 
 class FailopenModeListener : public Listener<FailopenModeEvent>
 {
@@ -242,6 +245,8 @@ public:
         createStaticResourcesFolder();
 
         setCompressionDebugFunctions();
+        setDecompressionRatioLimit();
+        registerConfigLoadCb([this]() { setDecompressionRatioLimit(); });
 
         setMetricHandlers();
 
@@ -668,6 +673,17 @@ private:
         );
     }
 
+    void
+    setDecompressionRatioLimit()
+    {
+        setMaxDecompressionRatio(
+            getProfileAgentSettingWithDefault<uint>(
+                default_max_decompression_ratio,
+                "nginxAttachment.maxDecompressionRatio"
+            )
+        );
+    }
+
     void
     deleteStaticResourcesFolder()
     {
@@ -1002,7 +1018,7 @@ private:
         CompressionStream *compression_stream = content_encoding == CompressionType::NO_COMPRESSION ?
             nullptr :
             opaque.getResponseCompressionStream();
-        auto http_response_body_maybe = NginxParser::parseResponseBody(data, compression_stream);
+        auto http_response_body_maybe = NginxParser::parseResponseBody(data, compression_stream, content_encoding);
 
         return handleModifiableChunk(http_response_body_maybe, "response body", false);
     }
@@ -1010,6 +1026,7 @@ private:
     FilterVerdict
     handleChunkedData(ChunkType chunk_type, const Buffer &data, NginxAttachmentOpaque &opaque)
     {
+        InspectionStageTimer timer("nginxAttachment.chunk");
         ScopedContext event_type;
         event_type.registerValue<ngx_http_chunk_type_e>("HTTP Chunk type", chunk_type);
 
@@ -1030,6 +1047,16 @@ private:
             return FilterVerdict(verdict_action);
         }
 
+        if (chunk_type == ChunkType::REQUEST_START) {
+            auto early_verdict = EarlyVerdict::get(opaque.getTransactionData().getSourceIP());
+            if (early_verdict.ok()) {
+                dbgDebug(D_NGINX_ATTACHMENT)
+                    << "Transaction needs no inspection. Setting verdict to "
+                    << verdictToString(early_verdict.unpack());
+                return FilterVerdict(early_verdict.unpack());
+            }
+        }
+
         switch (chunk_type) {
             case ChunkType::REQUEST_START:
                 return handleStartTransaction(data, opaque);
@@ -1878,6 +1905,7 @@ NginxAttachment::preload()
     registerExpectedConfiguration<uint>("HTTP manager", "NGINX response header thread timeout msec");
     registerExpectedConfiguration<uint>("HTTP manager", "NGINX response body thread timeout msec");
     registerExpectedConfiguration<uint>("HTTP manager", "NGINX inspection mode");
+    EarlyVerdict::preload();
     registerExpectedConfiguration<uint>("Nginx Attachment", "metric reporting interval");
     registerExpectedSetting<bool>("allowOnlyDefinedApplications");
     registerExpectedConfigFile("activeContextConfig", Config::ConfigFileType::Policy);
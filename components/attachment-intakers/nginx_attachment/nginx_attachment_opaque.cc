@@ -87,6 +87,7 @@ NginxAttachmentOpaque::setSessionTenantAndProfile(const string &tenant, const st
 {
     session_tenant = tenant;
     session_profile = profile;
+    config_snapshots.clear();
     Singleton::Consume<I_Environment>::by<NginxAttachmentOpaque>()->setActiveTenantAndProfile(
         session_tenant,
         session_profile
@@ -107,10 +108,15 @@ NginxAttachmentOpaque::getSourceIdentifiersType() const
 }
 
 void
-NginxAttachmentOpaque::addToSavedData(const string &name, const string &data)
+NginxAttachmentOpaque::addToSavedData(const string &name, const Buffer &data)
 {
-    saved_data[name] += data;
-    ctx.registerValue(name, saved_data[name]);
+    auto saved_buffer = saved_buffers.find(name);
+    if (saved_buffer == saved_buffers.end()) {
+        saved_buffer = saved_buffers.emplace(name, Buffer()).first;
+        Buffer &buffer = saved_buffer->second;
+        ctx.registerFunc<string>(name, [&buffer] () { return static_cast<string>(buffer); });
+    }
+    saved_buffer->second += data;
 }
 
 void
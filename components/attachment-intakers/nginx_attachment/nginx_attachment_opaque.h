@@ -17,8 +17,10 @@
 #include <string>
 #include <set>
 #include <map>
+#include <typeindex>
 
 #include "compression_utils.h"
+#include "config.h"
 #include "generic_rulebase/generic_rulebase_context.h"
 #include "http_transaction_data.h"
 #include "table_opaque.h"
@@ -78,7 +80,9 @@ public:
 
     const std::string & getSessionUUID() const { return uuid; }
 
-    void addToSavedData(const std::string &name, const std::string &data);
+    // Keeps the buffer's segments rather than a copy of their data. The saved data is only turned into a string
+    // when the environment is asked for it.
+    void addToSavedData(const std::string &name, const Buffer &data);
     void setSavedData(
         const std::string &name,
         const std::string &data,
@@ -86,6 +90,27 @@ public:
     );
     void setApplicationState(const ApplicationState &app_state) { application_state = app_state; }
 
+    // The configuration as it was when the transaction first asked for it, so handling every header or chunk does not
+    // look it up again. The snapshot shares the ownership of the loaded value, so a reload in the middle of the
+    // transaction does not invalidate it. There is one snapshot per configuration type, and it is dropped when the
+    // transaction's tenant changes.
+    template <typename ConfigurationType, typename ... Strings>
+    const ConfigurationType &
+    getConfigurationSnapshot(const ConfigurationType &default_val, const Strings & ... tags)
+    {
+        auto snapshot = config_snapshots.find(typeid(ConfigurationType));
+        if (snapshot == config_snapshots.end()) {
+            if (!Singleton::exists<Config::I_Config>()) return default_val;
+            auto i_config = Singleton::Consume<Config::I_Config>::from<Config::MockConfigProvider>();
+            snapshot = config_snapshots.emplace(
+                typeid(ConfigurationType),
+                i_config->getConfiguration(Config::getVector(tags ...))
+            ).first;
+        }
+        auto &value = snapshot->second.template getValue<ConfigurationType>();
+        return value.ok() ? value.unpack() : default_val;
+    }
+
 private:
     CompressionStream       *response_compression_stream;
     HttpTransactionData     transaction_data;
@@ -97,6 +122,8 @@ private:
     std::string             source_identifier;
     std::string             identifier_type;
     std::map<std::string, std::string> saved_data;
+    std::map<std::string, Buffer> saved_buffers;
+    std::map<std::type_index, TypeWrapper> config_snapshots;
     ApplicationState application_state = ApplicationState::UNKOWN;
 };
 
@@ -0,0 +1,127 @@
+#include "early_verdict.h"
+
+#include <sstream>
+
+#include "cptest.h"
+#include "config.h"
+#include "config_component.h"
+#include "environment.h"
+#include "generic_rulebase/rulebase_config.h"
+
+using namespace std;
+using namespace testing;
+
+ostream &
+operator<<(ostream &os, const ngx_http_cp_verdict_e &verdict)
+{
+    return os << static_cast<int>(verdict);
+}
+
+class EarlyVerdictTest : public Test
+{
+public:
+    EarlyVerdictTest()
+    {
+        env.preload();
+        env.init();
+        config.preload();
+        BasicRuleConfig::preload();
+        EarlyVerdict::preload();
+    }
+
+    void
+    loadPolicy(const string &practices, const string &irrelevant_without_practices = "false")
+    {
+        string policy =
+            "{"
+            "    \"agentSettings\": ["
+            "        {"
+            "            \"id\": \"1\","
+            "            \"key\": \"nginxAttachment.irrelevantWithoutPractices\","
+            "            \"value\": \"" + irrelevant_without_practices + "\""
+            "        }"
+            "    ],"
+            "    \"HTTP manager\": {"
+            "        \"Inspection bypass sources\": ["
+            "            {"
+            "                \"sources\": [ \"10.0.0.0-10.0.0.255\", \"2001:db8::1\", \"not an address\" ]"
+            "            }"
+            "        ]"
+            "    },"
+            "    \"rulebase\": {"
+            "        \"rulesConfig\": ["
+            "            {"
+            "                \"assetId\": \"1-1-1\","
+            "                \"assetName\": \"asset\","
+            "                \"ruleId\": \"2-2-2\","
+            "                \"ruleName\": \"rule\","
+            "                \"priority\": 1,"
+            "                \"practices\": [" + practices + "],"
+            "                \"triggers\": [],"
+            "                \"parameters\": [],"
+            "                \"zoneId\": \"\","
+            "                \"zoneName\": \"\""
+            "            }"
+            "        ]"
+            "    }"
+            "}";
+        istringstream ss(policy);
+        ASSERT_TRUE(Singleton::Consume<Config::I_Config>::from(config)->loadConfiguration(ss));
+    }
+
+    Maybe<ngx_http_cp_verdict_e>
+    getVerdict(const string &source)
+    {
+        return EarlyVerdict::get(IPAddr::createIPAddr(source).unpack());
+    }
+
+    const string web_practice =
+        "{"
+        "    \"practiceId\": \"3-3-3\","
+        "    \"practiceName\": \"practice\","
+        "    \"practiceType\": \"WebApplication\""
+        "}";
+
+    ::Environment env;
+    ConfigComponent config;
+};
+
+TEST_F(EarlyVerdictTest, inspect_without_configuration)
+{
+    EXPECT_THAT(getVerdict("10.0.0.1"), IsError("Transaction should be inspected"));
+}
+
+TEST_F(EarlyVerdictTest, accept_bypass_source)
+{
+    loadPolicy(web_practice);
+
+    EXPECT_THAT(getVerdict("10.0.0.1"), IsValue(ngx_http_cp_verdict_e::TRAFFIC_VERDICT_ACCEPT));
+    EXPECT_THAT(getVerdict("10.0.0.255"), IsValue(ngx_http_cp_verdict_e::TRAFFIC_VERDICT_ACCEPT));
+    EXPECT_THAT(getVerdict("2001:db8::1"), IsValue(ngx_http_cp_verdict_e::TRAFFIC_VERDICT_ACCEPT));
+    EXPECT_THAT(getVerdict("10.0.1.0"), IsError("Transaction should be inspected"));
+    EXPECT_THAT(getVerdict("2001:db8::2"), IsError("Transaction should be inspected"));
+}
+
+TEST_F(EarlyVerdictTest, inspect_rule_without_practices_by_default)
+{
+    // Security configurations that are not practices may still apply to the asset
+    loadPolicy("");
+
+    EXPECT_THAT(getVerdict("192.168.0.1"), IsError("Transaction should be inspected"));
+}
+
+TEST_F(EarlyVerdictTest, irrelevant_rule_without_practices_when_enabled)
+{
+    loadPolicy("", "true");
+
+    EXPECT_THAT(getVerdict("192.168.0.1"), IsValue(ngx_http_cp_verdict_e::TRAFFIC_VERDICT_IRRELEVANT));
+    // Bypass sources are still accepted
+    EXPECT_THAT(getVerdict("10.0.0.1"), IsValue(ngx_http_cp_verdict_e::TRAFFIC_VERDICT_ACCEPT));
+}
+
+TEST_F(EarlyVerdictTest, inspect_rule_with_practices)
+{
+    loadPolicy(web_practice, "true");
+
+    EXPECT_THAT(getVerdict("192.168.0.1"), IsError("Transaction should be inspected"));
+}
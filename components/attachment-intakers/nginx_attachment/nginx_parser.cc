@@ -29,11 +29,15 @@ USE_DEBUG_FLAG(D_NGINX_ATTACHMENT_PARSER);
 Buffer NginxParser::tenant_header_key = Buffer();
 static const Buffer proxy_ip_header_key("X-Forwarded-For", 15, Buffer::MemoryType::STATIC);
 static const Buffer source_ip("sourceip", 8, Buffer::MemoryType::STATIC);
+static const Buffer header_separator(": ", 2, Buffer::MemoryType::STATIC);
+static const Buffer header_line_end("\r\n", 2, Buffer::MemoryType::STATIC);
 
 map<Buffer, CompressionType> NginxParser::content_encodings = {
     {Buffer("identity"), CompressionType::NO_COMPRESSION},
     {Buffer("gzip"), CompressionType::GZIP},
-    {Buffer("deflate"), CompressionType::ZLIB}
+    {Buffer("deflate"), CompressionType::ZLIB},
+    {Buffer("br"), CompressionType::BROTLI},
+    {Buffer("zstd"), CompressionType::ZSTD}
 };
 
 Maybe<HttpTransactionData>
@@ -183,20 +187,21 @@ NginxParser::parseRequestHeaders(const Buffer &data)
     if (!parsed_headers.ok()) return parsed_headers.passErr();
 
     auto i_transaction_table = Singleton::Consume<I_TableSpecific<SessionID>>::by<NginxAttachment>();
+    NginxAttachmentOpaque &opaque = i_transaction_table->getState<NginxAttachmentOpaque>();
+    static const UsersAllIdentifiersConfig default_identifiers;
 
     for (const HttpHeader &header : *parsed_headers) {
-        auto source_identifiers = getConfigurationWithDefault<UsersAllIdentifiersConfig>(
-            UsersAllIdentifiersConfig(),
+        const UsersAllIdentifiersConfig &source_identifiers = opaque.getConfigurationSnapshot(
+            default_identifiers,
             "rulebase",
             "usersIdentifiers"
         );
         source_identifiers.parseRequestHeaders(header);
 
-        NginxAttachmentOpaque &opaque = i_transaction_table->getState<NginxAttachmentOpaque>();
-        opaque.addToSavedData(
-            HttpTransactionData::req_headers,
-            static_cast<string>(header.getKey()) + ": " + static_cast<string>(header.getValue()) + "\r\n"
-        );
+        opaque.addToSavedData(HttpTransactionData::req_headers, header.getKey());
+        opaque.addToSavedData(HttpTransactionData::req_headers, header_separator);
+        opaque.addToSavedData(HttpTransactionData::req_headers, header.getValue());
+        opaque.addToSavedData(HttpTransactionData::req_headers, header_line_end);
 
         if (NginxParser::tenant_header_key == header.getKey()) {
             dbgDebug(D_NGINX_ATTACHMENT_PARSER)
@@ -222,11 +227,20 @@ NginxParser::parseResponseHeaders(const Buffer &data)
 }
 
 Maybe<Buffer>
-decompressBuffer(CompressionStream *compression_stream, const Buffer &compressed_buffer)
+decompressBuffer(
+    CompressionStream *compression_stream,
+    CompressionType content_encoding,
+    const Buffer &compressed_buffer
+)
 {
     if (compressed_buffer.size() == 0) return Buffer();
 
-    auto compression_result = decompressData(compression_stream, compressed_buffer.size(), compressed_buffer.data());
+    auto compression_result = decompressDataByType(
+        compression_stream,
+        content_encoding,
+        compressed_buffer.size(),
+        compressed_buffer.data()
+    );
     if (!compression_result.ok) return genError("Failed to decompress data");
 
     if (compression_result.output == nullptr) return Buffer();;
@@ -242,11 +256,15 @@ decompressBuffer(CompressionStream *compression_stream, const Buffer &compressed
 }
 
 Maybe<Buffer>
-parseCompressedHttpBodyData(CompressionStream *compression_stream, const Buffer &body_raw_data)
+parseCompressedHttpBodyData(
+    CompressionStream *compression_stream,
+    CompressionType content_encoding,
+    const Buffer &body_raw_data
+)
 {
     if (compression_stream == nullptr) return genError("Cannot decompress body without compression stream");
 
-    Maybe<Buffer> decompressed_buffer_maybe = decompressBuffer(compression_stream, body_raw_data);
+    Maybe<Buffer> decompressed_buffer_maybe = decompressBuffer(compression_stream, content_encoding, body_raw_data);
     if (!decompressed_buffer_maybe.ok()) {
         return genError("Failed to decompress buffer. Error: " + decompressed_buffer_maybe.getErr());
     }
@@ -255,7 +273,11 @@ parseCompressedHttpBodyData(CompressionStream *compression_stream, const Buffer
 }
 
 Maybe<HttpBody>
-genBody(const Buffer &raw_response_body, CompressionStream *compression_stream = nullptr)
+genBody(
+    const Buffer &raw_response_body,
+    CompressionStream *compression_stream = nullptr,
+    CompressionType content_encoding = CompressionType::NO_COMPRESSION
+)
 {
     uint offset = 0;
     auto is_last_part_maybe = raw_response_body.getTypePtr<uint8_t>(offset);
@@ -283,7 +305,7 @@ genBody(const Buffer &raw_response_body, CompressionStream *compression_stream =
         return HttpBody(body_raw_data, is_last_part, body_chunk_index);
     }
 
-    Maybe<Buffer> body_data_maybe = parseCompressedHttpBodyData(compression_stream, body_raw_data);
+    Maybe<Buffer> body_data_maybe = parseCompressedHttpBodyData(compression_stream, content_encoding, body_raw_data);
     if (!body_data_maybe.ok()) {
         dbgWarning(D_NGINX_ATTACHMENT_PARSER)
             << "Failed to decompress body chunk. Chunk index: "
@@ -324,9 +346,13 @@ NginxParser::parseRequestBody(const Buffer &data)
 }
 
 Maybe<HttpBody>
-NginxParser::parseResponseBody(const Buffer &raw_response_body, CompressionStream *compression_stream)
+NginxParser::parseResponseBody(
+    const Buffer &raw_response_body,
+    CompressionStream *compression_stream,
+    CompressionType content_encoding
+)
 {
-    Maybe<HttpBody> body = genBody(raw_response_body, compression_stream);
+    Maybe<HttpBody> body = genBody(raw_response_body, compression_stream, content_encoding);
     if (!body.ok()) return genError("Failed to generate body from buffer: " + body.getErr());
 
     dbgTrace(D_NGINX_ATTACHMENT_PARSER)
@@ -31,6 +31,8 @@
 #include "log_generator.h"
 #include "http_inspection_events.h"
 #include "agent_core_utilities.h"
+#include "inspection_stage_metric.h"
+#include "generic_rulebase/generic_rulebase_utils.h"
 
 USE_DEBUG_FLAG(D_HTTP_MANAGER);
 
@@ -56,6 +58,58 @@ operator<<(ostream &os, const EventVerdict &event)
     return os;
 }
 
+// Decides how much of a response body is inspected, based on the response's content type. Bodies of the "skip"
+// types are not inspected at all and bodies of the "partial" types only up to the partial inspection size - in both
+// cases the transaction is accepted once that point is reached, so nginx stops passing the rest of the body.
+// Nothing is listed unless configured, and a listed prefix (e.g. "image/") never covers a type that may carry
+// script, which is only skipped if it is listed by its full name.
+class ResponseBodyInspectionPlan
+{
+public:
+    void
+    load(cereal::JSONInputArchive &ar)
+    {
+        parseJSONKey<vector<string>>("skipContentTypes", skip_content_types, ar);
+        parseJSONKey<vector<string>>("partialContentTypes", partial_content_types, ar);
+        parseJSONKey<uint>("partialInspectionSize", partial_inspection_size, ar);
+        for (auto &content_type : skip_content_types) boost::algorithm::to_lower(content_type);
+        for (auto &content_type : partial_content_types) boost::algorithm::to_lower(content_type);
+    }
+
+    // Returns the number of body bytes to inspect, or an error if the whole body should be inspected.
+    Maybe<uint>
+    getInspectionLimit(const string &content_type_header) const
+    {
+        string content_type = content_type_header.substr(0, content_type_header.find(';'));
+        boost::algorithm::trim(content_type);
+        boost::algorithm::to_lower(content_type);
+
+        if (isListed(skip_content_types, content_type)) return 0;
+        if (isListed(partial_content_types, content_type)) return partial_inspection_size;
+        return genError("Content type '" + content_type + "' is fully inspected");
+    }
+
+private:
+    static bool
+    isListed(const vector<string> &content_types, const string &content_type)
+    {
+        bool may_carry_script = script_content_types.count(content_type) > 0;
+        for (const auto &listed_type : content_types) {
+            if (content_type == listed_type) return true;
+            if (!may_carry_script && boost::algorithm::starts_with(content_type, listed_type)) return true;
+        }
+        return false;
+    }
+
+    static const unordered_set<string> script_content_types;
+
+    vector<string> skip_content_types;
+    vector<string> partial_content_types;
+    uint partial_inspection_size = 64 * 1024;
+};
+
+const unordered_set<string> ResponseBodyInspectionPlan::script_content_types = { "image/svg+xml" };
+
 class HttpManager::Impl
         :
     Singleton::Provide<I_HttpManager>::From<HttpManager>
@@ -85,6 +139,32 @@ public:
                 for (const string &header : ignored_headers_vec) ignored_headers.insert(header);
             }
         }
+
+        chrono::seconds metric_report_interval(
+            getConfigurationWithDefault<uint>(METRIC_PERIODIC_TIMEOUT, "HTTP manager", "metric reporting interval")
+        );
+        inspection_stage_metric.init(
+            "Inspection stages latency",
+            ReportIS::AudienceTeam::AGENT_CORE,
+            ReportIS::IssuingEngine::AGENT_CORE,
+            metric_report_interval,
+            true
+        );
+        inspection_stage_metric.registerListener();
+        Singleton::Consume<I_MainLoop>::by<HttpManager>()->addRecurringRoutine(
+            I_MainLoop::RoutineType::System,
+            metric_report_interval,
+            [this] () { inspection_stage_metric.flushStages(); },
+            "Inspection stages latency aggregation"
+        );
+    }
+
+    void
+    loadInspectionStagesSettings()
+    {
+        InspectionStageTimer::setEnabled(
+            getProfileAgentSettingWithDefault<bool>(false, "httpManager.inspectionStagesMetric")
+        );
     }
 
     FilterVerdict
@@ -98,6 +178,7 @@ public:
         ScopedContext ctx;
         ctx.registerValue(app_sec_marker_key, i_transaction_table->keyToString(), EnvKeyAttr::LogSection::MARKER);
 
+        InspectionStageTimer timer("httpManager.newTransaction");
         return handleEvent(NewHttpTransactionEvent(event).performNamedQuery());
     }
 
@@ -137,6 +218,11 @@ public:
             ctx.registerValue("UserDefined", state.getUserDefinedValue().unpack(), EnvKeyAttr::LogSection::DATA);
         }
 
+        if (!is_request && boost::algorithm::iequals(event_key, content_type_header_key)) {
+            planResponseBodyInspection(state, static_cast<string>(event.getValue()));
+        }
+
+        InspectionStageTimer timer(is_request ? "httpManager.requestHeader" : "httpManager.responseHeader");
         auto event_responds =
             is_request ?
             HttpRequestHeaderEvent(event).performNamedQuery() :
@@ -145,6 +231,15 @@ public:
         if (verdict.getVerdict() == ngx_http_cp_verdict_e::TRAFFIC_VERDICT_INJECT) {
             applyInjectionModifications(verdict, event_responds, event.getHeaderIndex());
         }
+
+        if (
+            !is_request &&
+            event.isLastHeader() &&
+            verdict.getVerdict() == ngx_http_cp_verdict_e::TRAFFIC_VERDICT_INSPECT &&
+            isResponseBodyInspectionDone(state)
+        ) {
+            return acceptPlannedResponseBody(state);
+        }
         return verdict;
     }
 
@@ -156,13 +251,16 @@ public:
             return FilterVerdict(default_verdict);
         }
 
+        HttpManagerOpaque &state = i_transaction_table->getState<HttpManagerOpaque>();
+        if (!is_request && isResponseBodyInspectionDone(state)) {
+            return acceptPlannedResponseBody(state);
+        }
+
         ngx_http_cp_verdict_e body_size_limit_verdict = handleBodySizeLimit(is_request, event);
         if (body_size_limit_verdict != ngx_http_cp_verdict_e::TRAFFIC_VERDICT_INSPECT) {
             return FilterVerdict(body_size_limit_verdict);
         }
 
-        HttpManagerOpaque &state = i_transaction_table->getState<HttpManagerOpaque>();
-
         ScopedContext ctx;
         ctx.registerValue(app_sec_marker_key, i_transaction_table->keyToString(), EnvKeyAttr::LogSection::MARKER);
         if (state.getUserDefinedValue().ok()) {
@@ -175,6 +273,7 @@ public:
             return verdict;
         }
 
+        InspectionStageTimer timer(is_request ? "httpManager.requestBody" : "httpManager.responseBody");
         auto event_responds =
             is_request ?
             HttpRequestBodyEvent(event, state.getPreviousDataCache()).performNamedQuery() :
@@ -184,6 +283,14 @@ public:
         if (verdict.getVerdict() == ngx_http_cp_verdict_e::TRAFFIC_VERDICT_INJECT) {
             applyInjectionModifications(verdict, event_responds, event.getBodyChunkIndex());
         }
+
+        if (
+            !is_request &&
+            verdict.getVerdict() == ngx_http_cp_verdict_e::TRAFFIC_VERDICT_INSPECT &&
+            isResponseBodyInspectionDone(state)
+        ) {
+            return acceptPlannedResponseBody(state);
+        }
         return verdict;
     }
 
@@ -203,6 +310,7 @@ public:
             ctx.registerValue("UserDefined", state.getUserDefinedValue().unpack(), EnvKeyAttr::LogSection::DATA);
         }
 
+        InspectionStageTimer timer("httpManager.responseCode");
         return handleEvent(ResponseCodeEvent(event).performNamedQuery());
     }
 
@@ -223,6 +331,7 @@ public:
             ctx.registerValue("UserDefined", state.getUserDefinedValue().unpack(), EnvKeyAttr::LogSection::DATA);
         }
 
+        InspectionStageTimer timer("httpManager.endRequest");
         return handleEvent(EndRequestEvent().performNamedQuery());
     }
 
@@ -243,6 +352,7 @@ public:
             ctx.registerValue("UserDefined", state.getUserDefinedValue().unpack(), EnvKeyAttr::LogSection::DATA);
         }
 
+        InspectionStageTimer timer("httpManager.endTransaction");
         return handleEvent(EndTransactionEvent().performNamedQuery());
     }
 
@@ -262,6 +372,7 @@ public:
             ctx.registerValue("UserDefined", state.getUserDefinedValue().unpack(), EnvKeyAttr::LogSection::DATA);
         }
 
+        InspectionStageTimer timer("httpManager.delayedVerdict");
         return handleEvent(WaitTransactionEvent().performNamedQuery());
     }
 
@@ -278,6 +389,45 @@ public:
     }
 
 private:
+    void
+    planResponseBodyInspection(HttpManagerOpaque &state, const string &content_type)
+    {
+        auto &plan = getConfigurationWithDefault<ResponseBodyInspectionPlan>(
+            default_response_body_inspection_plan,
+            "HTTP manager",
+            "Response body inspection plan"
+        );
+
+        auto inspection_limit = plan.getInspectionLimit(content_type);
+        if (!inspection_limit.ok()) return;
+
+        dbgTrace(D_HTTP_MANAGER)
+            << "Response body of content type '"
+            << content_type
+            << "' will be inspected up to "
+            << inspection_limit.unpack()
+            << " bytes";
+        state.setResponseBodyInspectionLimit(inspection_limit.unpack());
+    }
+
+    static bool
+    isResponseBodyInspectionDone(const HttpManagerOpaque &state)
+    {
+        auto &inspection_limit = state.getResponseBodyInspectionLimit();
+        return inspection_limit.ok() && state.getAggeregatedPayloadSize() >= inspection_limit.unpack();
+    }
+
+    static FilterVerdict
+    acceptPlannedResponseBody(HttpManagerOpaque &state)
+    {
+        dbgDebug(D_HTTP_MANAGER)
+            << "Inspected the planned part of the response body ("
+            << state.getAggeregatedPayloadSize()
+            << " bytes). Returning Accept";
+        state.setManagerVerdict(ngx_http_cp_verdict_e::TRAFFIC_VERDICT_ACCEPT);
+        return FilterVerdict(ngx_http_cp_verdict_e::TRAFFIC_VERDICT_ACCEPT);
+    }
+
     ngx_http_cp_verdict_e
     handleBodySizeLimit(bool is_request_body_type, const HttpBody &event)
     {
@@ -421,11 +571,16 @@ private:
     I_Table *i_transaction_table;
     static const ngx_http_cp_verdict_e default_verdict;
     static const string app_sec_marker_key;
+    static const string content_type_header_key;
+    static const ResponseBodyInspectionPlan default_response_body_inspection_plan;
     unordered_set<string> ignored_headers;
+    InspectionStageMetric inspection_stage_metric;
 };
 
 const ngx_http_cp_verdict_e HttpManager::Impl::default_verdict(ngx_http_cp_verdict_e::TRAFFIC_VERDICT_DROP);
 const string HttpManager::Impl::app_sec_marker_key = "app_sec_marker";
+const string HttpManager::Impl::content_type_header_key = "Content-Type";
+const ResponseBodyInspectionPlan HttpManager::Impl::default_response_body_inspection_plan;
 
 HttpManager::HttpManager() : Component("HttpManager"), pimpl(make_unique<Impl>()) {}
 HttpManager::~HttpManager() {}
@@ -438,7 +593,10 @@ HttpManager::preload()
     registerExpectedConfiguration<uint>("HTTP manager", "Previous Buffer Cache size");
     registerExpectedConfiguration<uint>("HTTP manager", "Max Request Body Size");
     registerExpectedConfiguration<uint>("HTTP manager", "Max Response Body Size");
+    registerExpectedConfiguration<uint>("HTTP manager", "metric reporting interval");
     registerExpectedConfiguration<string>("HTTP manager", "Request Size Limit Verdict");
     registerExpectedConfiguration<string>("HTTP manager", "Response Size Limit Verdict");
+    registerExpectedConfiguration<ResponseBodyInspectionPlan>("HTTP manager", "Response body inspection plan");
     registerConfigLoadCb([this] () { pimpl->sendPolicyLog(); });
+    registerConfigLoadCb([this] () { pimpl->loadInspectionStagesSettings(); });
 }
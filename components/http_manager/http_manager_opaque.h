@@ -40,6 +40,8 @@ public:
     uint getAggeregatedPayloadSize() const { return aggregated_payload_size; }
     void updatePayloadSize(const uint curr_payload);
     void resetPayloadSize() { aggregated_payload_size = 0; }
+    void setResponseBodyInspectionLimit(uint limit) { response_body_inspection_limit = limit; }
+    const Maybe<uint> & getResponseBodyInspectionLimit() const { return response_body_inspection_limit; }
 
 // LCOV_EXCL_START - sync functions, can only be tested once the sync module exists
     template <typename T> void serialize(T &ar, uint) { ar(applications_verdicts, prev_data_cache); }
@@ -56,6 +58,7 @@ private:
     Buffer prev_data_cache;
     uint aggregated_payload_size = 0;
     Maybe<std::string> user_defined_value = genError("uninitialized");
+    Maybe<uint> response_body_inspection_limit = genError("Response body is fully inspected");
 };
 
 #endif // __HTTP_MANAGER_OPAQUE_H__
@@ -0,0 +1,218 @@
+#include "http_manager.h"
+
+#include <sstream>
+
+#include "cptest.h"
+#include "config.h"
+#include "config_component.h"
+#include "environment.h"
+#include "http_manager_opaque.h"
+#include "http_inspection_events.h"
+#include "inspection_stage_metric.h"
+#include "metric/all_metric_event.h"
+#include "mock/mock_table.h"
+#include "mock/mock_mainloop.h"
+#include "mock/mock_time_get.h"
+#include "mock/mock_logging.h"
+#include "mock/mock_messaging.h"
+#include "mock/mock_rest_api.h"
+#include "mock/mock_agent_details.h"
+
+using namespace std;
+using namespace testing;
+
+USE_DEBUG_FLAG(D_HTTP_MANAGER);
+
+// A security app that keeps inspecting the response, so only the HTTP manager decides when inspection ends
+class InspectingApp
+        :
+    public Listener<HttpResponseHeaderEvent>,
+    public Listener<HttpResponseBodyEvent>
+{
+public:
+    EventVerdict respond(const HttpResponseHeaderEvent &) override { return inspect_verdict; }
+    EventVerdict respond(const HttpResponseBodyEvent &) override { return inspect_verdict; }
+    string getListenerName() const override { return "inspecting app"; }
+
+private:
+    const EventVerdict inspect_verdict = ngx_http_cp_verdict_e::TRAFFIC_VERDICT_INSPECT;
+};
+
+class StagesListener : public Listener<InspectionStageEvent>
+{
+public:
+    void upon(const InspectionStageEvent &event) override { stages.push_back(event.getStage()); }
+
+    vector<string> stages;
+};
+
+class HttpManagerTest : public Test
+{
+public:
+    HttpManagerTest()
+    {
+        Debug::setUnitTestFlag(D_HTTP_MANAGER, Debug::DebugLevel::TRACE);
+        Debug::setNewDefaultStdout(&capture_debug);
+
+        EXPECT_CALL(mock_table, hasState(_)).WillRepeatedly(Return(true));
+        EXPECT_CALL(mock_table, getState(_)).WillRepeatedly(Return(&state));
+        EXPECT_CALL(mock_mainloop, addRecurringRoutine(_, _, _, _, _)).WillRepeatedly(Return(0));
+        EXPECT_CALL(mock_mainloop, addRecurringRoutine(_, _, _, "Inspection stages latency aggregation", _))
+            .WillOnce(DoAll(SaveArg<2>(&flush_stages_routine), Return(0)));
+
+        env.preload();
+        env.init();
+        config.preload();
+        http_manager.preload();
+        http_manager.init();
+        app.registerListener();
+        stages_listener.registerListener();
+        i_http_manager = Singleton::Consume<I_HttpManager>::from(http_manager);
+    }
+
+    ~HttpManagerTest()
+    {
+        stages_listener.unregisterListener();
+        app.unregisterListener();
+        InspectionStageTimer::setEnabled(false);
+        Debug::setNewDefaultStdout(&cout);
+    }
+
+    void
+    loadInspectionPlan(const string &plan)
+    {
+        string config_json =
+            "{"
+            "    \"HTTP manager\": {"
+            "        \"Response body inspection plan\": [" + plan + "]"
+            "    }"
+            "}";
+        istringstream ss(config_json);
+        Singleton::Consume<Config::I_Config>::from(config)->loadConfiguration(ss);
+    }
+
+    void
+    loadInspectionStagesSetting(bool is_enabled)
+    {
+        string config_json =
+            "{"
+            "    \"agentSettings\": ["
+            "        {"
+            "            \"id\": \"1\","
+            "            \"key\": \"httpManager.inspectionStagesMetric\","
+            "            \"value\": \"" + string(is_enabled ? "true" : "false") + "\""
+            "        }"
+            "    ]"
+            "}";
+        istringstream ss(config_json);
+        Singleton::Consume<Config::I_Config>::from(config)->loadConfiguration(ss);
+    }
+
+    ngx_http_cp_verdict_e
+    inspectResponseHeader(const string &key, const string &value, bool is_last_header)
+    {
+        HttpHeader header(Buffer(key), Buffer(value), 0, is_last_header);
+        return i_http_manager->inspect(header, false).getVerdict();
+    }
+
+    ngx_http_cp_verdict_e
+    inspectResponseBody(const string &data, uint8_t index)
+    {
+        HttpBody body(Buffer(data), false, index);
+        return i_http_manager->inspect(body, false).getVerdict();
+    }
+
+    const ngx_http_cp_verdict_e inspect = ngx_http_cp_verdict_e::TRAFFIC_VERDICT_INSPECT;
+    const ngx_http_cp_verdict_e accept = ngx_http_cp_verdict_e::TRAFFIC_VERDICT_ACCEPT;
+    HttpManagerOpaque state;
+    InspectingApp app;
+    StagesListener stages_listener;
+    I_MainLoop::Routine flush_stages_routine;
+    NiceMock<MockTable> mock_table;
+    NiceMock<MockMainLoop> mock_mainloop;
+    NiceMock<MockTimeGet> mock_time;
+    NiceMock<MockLogging> mock_logging;
+    NiceMock<MockMessaging> mock_messaging;
+    NiceMock<MockRestApi> mock_rest;
+    NiceMock<MockAgentDetails> mock_agent_details;
+    ::Environment env;
+    ConfigComponent config;
+    HttpManager http_manager;
+    I_HttpManager *i_http_manager;
+    ostringstream capture_debug;
+};
+
+TEST_F(HttpManagerTest, response_body_is_inspected_without_plan)
+{
+    EXPECT_EQ(inspectResponseHeader("Content-Type", "image/png", true), inspect);
+    EXPECT_EQ(inspectResponseBody(string(1000, 'a'), 0), inspect);
+    EXPECT_EQ(inspectResponseBody(string(1000, 'a'), 1), inspect);
+}
+
+TEST_F(HttpManagerTest, skipped_content_type_is_accepted_on_last_header)
+{
+    loadInspectionPlan("{ \"skipContentTypes\": [ \"Image/\" ] }");
+
+    EXPECT_EQ(inspectResponseHeader("content-type", "image/PNG; q=1", false), inspect);
+    EXPECT_EQ(inspectResponseHeader("Server", "test", true), accept);
+}
+
+TEST_F(HttpManagerTest, svg_is_not_skipped_by_prefix)
+{
+    loadInspectionPlan("{ \"skipContentTypes\": [ \"image/\" ] }");
+
+    EXPECT_EQ(inspectResponseHeader("Content-Type", "image/svg+xml", true), inspect);
+    EXPECT_EQ(inspectResponseBody("<svg><script>", 0), inspect);
+}
+
+TEST_F(HttpManagerTest, svg_is_skipped_by_full_name)
+{
+    loadInspectionPlan("{ \"skipContentTypes\": [ \"image/svg+xml\" ] }");
+
+    EXPECT_EQ(inspectResponseHeader("Content-Type", "image/svg+xml", true), accept);
+}
+
+TEST_F(HttpManagerTest, unlisted_content_type_is_fully_inspected)
+{
+    loadInspectionPlan("{ \"skipContentTypes\": [ \"image/\" ], \"partialContentTypes\": [ \"text/\" ] }");
+
+    EXPECT_EQ(inspectResponseHeader("Content-Type", "application/json", true), inspect);
+    EXPECT_EQ(inspectResponseBody(string(100000, 'a'), 0), inspect);
+}
+
+TEST_F(HttpManagerTest, partial_content_type_is_accepted_after_limit)
+{
+    loadInspectionPlan("{ \"partialContentTypes\": [ \"text/html\" ], \"partialInspectionSize\": 1500 }");
+
+    EXPECT_EQ(inspectResponseHeader("Content-Type", "text/html", true), inspect);
+    EXPECT_EQ(inspectResponseBody(string(1000, 'a'), 0), inspect);
+    // The chunk that reaches the limit is still inspected, and the transaction is accepted right after it
+    EXPECT_EQ(inspectResponseBody(string(1000, 'a'), 1), accept);
+    EXPECT_EQ(inspectResponseBody(string(1000, 'a'), 2), accept);
+    EXPECT_EQ(state.getManagerVerdict(), accept);
+}
+
+TEST_F(HttpManagerTest, inspection_stages_are_not_timed_by_default)
+{
+    EXPECT_EQ(inspectResponseHeader("Content-Type", "text/html", true), inspect);
+
+    EXPECT_THAT(stages_listener.stages, IsEmpty());
+}
+
+TEST_F(HttpManagerTest, inspection_stages_are_timed_when_enabled)
+{
+    loadInspectionStagesSetting(true);
+    EXPECT_EQ(inspectResponseHeader("Content-Type", "text/html", true), inspect);
+    EXPECT_THAT(stages_listener.stages, ElementsAre("httpManager.responseHeader"));
+
+    // The samples only reach the reported metric once they are flushed
+    AllMetricEvent all_mt_event;
+    all_mt_event.setReset(false);
+    EXPECT_THAT(all_mt_event.query(), Not(Contains(HasSubstr("httpManager.responseHeader"))));
+    flush_stages_routine();
+    EXPECT_THAT(all_mt_event.query(), Contains(HasSubstr("\"httpManager.responseHeader\"")));
+
+    loadInspectionStagesSetting(false);
+    EXPECT_EQ(inspectResponseHeader("Content-Type", "text/html", true), inspect);
+    EXPECT_EQ(stages_listener.stages.size(), 1u);
+}
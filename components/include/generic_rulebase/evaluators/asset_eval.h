@@ -24,8 +24,11 @@ public:
     AssetMatcher(const std::vector<std::string> &params);
 
     static std::string getName() { return "assetId"; }
+    static std::string getIndexName() { return "asset id"; }
+    static Maybe<std::set<std::string>> lookupIndexValues();
 
     Maybe<bool, Context::Error> evalVariable() const override;
+    Maybe<std::set<std::string>> getIndexValues(const std::string &index) const override;
 
     static std::string ctx_key;
 
@@ -25,8 +25,11 @@ public:
     EqualHost(const std::vector<std::string> &params);
 
     static std::string getName() { return "EqualHost"; }
+    static std::string getIndexName() { return "host"; }
+    static Maybe<std::set<std::string>> lookupIndexValues();
 
     Maybe<bool, Context::Error> evalVariable() const override;
+    Maybe<std::set<std::string>> getIndexValues(const std::string &index) const override;
 
 private:
     std::string host;
@@ -40,6 +43,8 @@ public:
     static std::string getName() { return "WildcardHost"; }
 
     Maybe<bool, Context::Error> evalVariable() const override;
+    // Indexed by the host index of `EqualHost`, whose lookup also returns the wildcard of the host.
+    Maybe<std::set<std::string>> getIndexValues(const std::string &index) const override;
 
 private:
     std::string host;
@@ -64,8 +69,11 @@ public:
     EqualListeningPort(const std::vector<std::string> &params);
 
     static std::string getName() { return "EqualListeningPort"; }
+    static std::string getIndexName() { return "listening port"; }
+    static Maybe<std::set<std::string>> lookupIndexValues();
 
     Maybe<bool, Context::Error> evalVariable() const override;
+    Maybe<std::set<std::string>> getIndexValues(const std::string &index) const override;
 
 private:
     PortNumber listening_port;
@@ -24,8 +24,11 @@ public:
     PracticeMatcher(const std::vector<std::string> &params);
 
     static std::string getName() { return "practiceId"; }
+    static std::string getIndexName() { return "practice id"; }
+    static Maybe<std::set<std::string>> lookupIndexValues();
 
     Maybe<bool, Context::Error> evalVariable() const override;
+    Maybe<std::set<std::string>> getIndexValues(const std::string &index) const override;
 
     static std::string ctx_key;
 
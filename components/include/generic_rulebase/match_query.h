@@ -28,6 +28,7 @@
 #include <boost/regex.hpp>
 
 #include "c_common/ip_common.h"
+#include "ip_utilities.h"
 
 class MatchQuery
 {
@@ -103,6 +104,7 @@ private:
     std::set<std::string> value;
     std::set<boost::regex> regex_values;
     std::vector<IPRange> ip_addr_value;
+    IPUtilities::IpRangeSet ip_addr_set;
     std::vector<PortsRange> port_value;
     std::vector<IpProtoRange> ip_proto_value;
     std::vector<MatchQuery> items;
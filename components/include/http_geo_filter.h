@@ -5,6 +5,7 @@
 
 #include "singleton.h"
 #include "i_mainloop.h"
+#include "i_time_get.h"
 #include "component.h"
 #include "http_inspection_events.h"
 #include "i_geo_location.h"
@@ -14,6 +15,7 @@ class HttpGeoFilter
         :
     public Component,
     Singleton::Consume<I_MainLoop>,
+    Singleton::Consume<I_TimeGet>,
     Singleton::Consume<I_GeoLocation>,
     Singleton::Consume<I_GenericRulebase>,
     Singleton::Consume<I_Environment>
@@ -0,0 +1,122 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __INSPECTION_STAGE_METRIC_H__
+#define __INSPECTION_STAGE_METRIC_H__
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+
+#include "generic_metric.h"
+#include "i_time_get.h"
+#include "profiling_labels.h"
+#include "singleton.h"
+
+// Time spent in one stage of the HTTP inspection (e.g. the WAAP handling of the request headers).
+class InspectionStageEvent : public Event<InspectionStageEvent>
+{
+public:
+    InspectionStageEvent(const char *_stage, std::chrono::microseconds _time) : stage(_stage), time(_time) {}
+
+    const char * getStage() const { return stage; }
+    std::chrono::microseconds getTime() const { return time; }
+
+private:
+    const char *stage;
+    std::chrono::microseconds time;
+};
+
+// Measures the time spent in its scope, and reports it as an `InspectionStageEvent`. The samples of the sampling
+// profiler taken in the scope are attributed to the stage as well.
+// Timing a stage reads the clock twice and notifies an event, so it is only done once it is enabled. The stage name
+// is kept by pointer, and also identifies the stage, so it should be a string literal.
+class InspectionStageTimer : Singleton::Consume<I_TimeGet>
+{
+public:
+    explicit InspectionStageTimer(const char *_stage)
+            :
+        stage(_stage),
+        profiling_stage(_stage),
+        is_timed(isEnabled())
+    {
+        if (is_timed) start = Singleton::Consume<I_TimeGet>::by<InspectionStageTimer>()->getMonotonicTime();
+    }
+
+    ~InspectionStageTimer()
+    {
+        if (!is_timed) return;
+        auto end = Singleton::Consume<I_TimeGet>::by<InspectionStageTimer>()->getMonotonicTime();
+        InspectionStageEvent(stage, end - start).notify();
+    }
+
+    InspectionStageTimer(const InspectionStageTimer &) = delete;
+    InspectionStageTimer & operator=(const InspectionStageTimer &) = delete;
+
+    static void setEnabled(bool is_enabled) { getEnabledFlag() = is_enabled; }
+    static bool isEnabled() { return getEnabledFlag(); }
+
+private:
+    static bool &
+    getEnabledFlag()
+    {
+        static bool is_enabled = false;
+        return is_enabled;
+    }
+
+    const char *stage;
+    ProfilingStage profiling_stage;
+    bool is_timed;
+    std::chrono::microseconds start = std::chrono::microseconds::zero();
+};
+
+// Latency distribution of every inspection stage, reported with the stage as a label.
+// The samples are aggregated by the address of the stage name, and are only moved to the labeled metric by
+// `flushStages`, so recording a sample does not format or compare the stage name.
+class InspectionStageMetric
+        :
+    public GenericMetric,
+    public Listener<InspectionStageEvent>
+{
+public:
+    void
+    upon(const InspectionStageEvent &event) override
+    {
+        auto stage = stages.find(event.getStage());
+        if (stage == stages.end()) {
+            stage = stages.emplace(event.getStage(), MetricCalculations::Histogram<uint64_t>{nullptr, ""}).first;
+        }
+        stage->second.report(event.getTime().count());
+    }
+
+    void
+    flushStages()
+    {
+        for (auto &stage : stages) {
+            if (stage.second.getCount() == 0) continue;
+            stage_latency.merge(stage.first, stage.second);
+            stage.second.reset();
+        }
+    }
+
+private:
+    std::unordered_map<const char *, MetricCalculations::Histogram<uint64_t>> stages;
+    MetricCalculations::MetricMap<std::string, MetricCalculations::Histogram<uint64_t>> stage_latency{
+        MetricCalculations::Histogram<uint64_t>{nullptr, ""},
+        this,
+        "stage",
+        "inspectionStageLatencyMicroSec"
+    };
+};
+
+#endif // __INSPECTION_STAGE_METRIC_H__
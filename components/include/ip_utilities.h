@@ -23,6 +23,7 @@
 
 #include "c_common/ip_common.h"
 #include "common.h"
+#include "connkey.h"
 #include "maybe_res.h"
 #include "debug.h"
 
@@ -59,6 +60,40 @@ Maybe<Range> createRangeFromString(const std::string &range, const std::string &
 using IpProto = uint8_t;
 using Port = uint16_t;
 
+// The "IpRangeSet" class holds a set of IP ranges in a form that allows fast lookups - the ranges are sorted, and the
+// overlapping or adjacent ones are merged, when the set is built (typically when the policy is loaded), and a lookup
+// is a binary search over them. IPv4 and IPv6 ranges are kept apart, and a range whose start and end are not of the
+// same type is ignored.
+class IpRangeSet
+{
+public:
+    IpRangeSet() {}
+    IpRangeSet(const std::vector<IPRange> &ranges);
+
+    bool contains(const IPAddr &ip) const;
+    bool contains(const IpAddress &ip) const;
+
+    bool empty() const { return v4_ranges.empty() && v6_ranges.empty(); }
+    size_t size() const { return v4_ranges.size() + v6_ranges.size(); }
+
+private:
+    // IPv6 addresses are compared as a pair of host order 64 bit integers (the high part first).
+    using V6Value = std::pair<uint64_t, uint64_t>;
+
+    template <typename Value>
+    static void sortAndMerge(std::vector<std::pair<Value, Value>> &ranges);
+    template <typename Value>
+    static bool isInRanges(const std::vector<std::pair<Value, Value>> &ranges, const Value &value);
+
+    static bool isNext(uint32_t value, uint32_t next);
+    static bool isNext(const V6Value &value, const V6Value &next);
+    static uint32_t toValue(const struct in_addr &ip);
+    static V6Value toValue(const struct in6_addr &ip);
+
+    std::vector<std::pair<uint32_t, uint32_t>> v4_ranges;
+    std::vector<std::pair<V6Value, V6Value>> v6_ranges;
+};
+
 class IpAttrFromString
 {
 public:
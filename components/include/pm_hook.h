@@ -17,6 +17,7 @@
 #include <memory>
 #include <string>
 #include <map>
+#include <vector>
 #include <unordered_set>
 #include <sys/types.h>
 #include "i_pm_scan.h"
@@ -26,6 +27,21 @@ class KissThinNFA;
 class PMHook final : public I_PMScan
 {
 public:
+    // The automaton state reached at the end of the data scanned so far in a stream.
+    // Allows scanning a stream one buffer at a time, while still finding patterns that span buffers.
+    class StreamState
+    {
+    public:
+        uint getScannedBytes() const { return scanned_so_far; }
+
+    private:
+        friend class PMHook;
+
+        std::weak_ptr<KissThinNFA> nfa;
+        int bnfa_offset = 0;
+        uint scanned_so_far = 0;
+    };
+
     explicit PMHook();
     ~PMHook();
 
@@ -33,6 +49,10 @@ public:
     std::set<PMPattern> scanBuf(const Buffer &buf) const override;
     std::set<std::pair<uint, uint>> scanBufWithOffset(const Buffer &buf) const override;
     void scanBufWithOffsetLambda(const Buffer &buf, I_PMScan::CBFunction cb) const override;
+    // Scans buf as the continuation of the stream, returning each match with the stream offset of its last byte.
+    // A pattern anchored with ^ matches only at the beginning of the stream, and one anchored with $ matches at the
+    // end of each buffer. A state created by a different compilation of the patterns is restarted.
+    std::vector<std::pair<PMPattern, uint>> scanStream(StreamState &state, const Buffer &buf) const;
 
     // Line may begin with ^ or $ sign to mark LSS is at begin/end of buffer.
     static Maybe<PMPattern> lineToPattern(const std::string &line);
@@ -199,4 +199,25 @@ private:
     MetricCalculations::LastReportedValue<int> all_assets{this, "numberOfProtectedAssetsSample"};
 };
 
+class InspectionBudgetEvent : public Event<InspectionBudgetEvent>
+{
+public:
+    InspectionBudgetEvent(bool by_time, uint64_t scanned_bytes) : exhausted_by_time(by_time), bytes(scanned_bytes) {};
+    bool isExhaustedByTime() const { return exhausted_by_time; }
+    uint64_t getScannedBytes() const { return bytes; }
+private:
+    bool exhausted_by_time;
+    uint64_t bytes;
+};
+
+class InspectionBudgetMetric : public GenericMetric, Listener<InspectionBudgetEvent>
+{
+public:
+    void upon(const InspectionBudgetEvent &event) override;
+private:
+    MetricCalculations::Counter exhausted_by_time{this, "inspectionBudgetExhaustedByTimeSum"};
+    MetricCalculations::Counter exhausted_by_bytes{this, "inspectionBudgetExhaustedByBytesSum"};
+    MetricCalculations::Max<uint64_t> max_scanned_bytes{this, "inspectionBudgetScannedBytesMaxSample", 0};
+};
+
 #endif // __TELEMETRY_H__
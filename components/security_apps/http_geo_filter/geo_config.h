@@ -2,6 +2,7 @@
 #define __GEO_CONFIG_H__
 
 #include <string>
+#include <unordered_set>
 
 #include "cereal/archives/json.hpp"
 #include "debug.h"
@@ -46,6 +47,13 @@ public:
         } catch (const cereal::Exception &e) {
             dbgDebug(D_GEO_FILTER) << "Failed to load http geo config, error: " << e.what();
         }
+
+        for (const GeoFilterCountry &country : allowed_countries) {
+            allowed_country_codes.insert(country.getCountryCode());
+        }
+        for (const GeoFilterCountry &country : blocked_countries) {
+            blocked_country_codes.insert(country.getCountryCode());
+        }
     }
 
     const std::string & getId() const { return id; }
@@ -55,11 +63,9 @@ public:
     isAllowedCountry(const std::string &_country_code) const
     {
         dbgTrace(D_GEO_FILTER) << "Check if country code: " << _country_code << " is allowed";
-        for (const GeoFilterCountry &country : allowed_countries) {
-            if (country.getCountryCode() == _country_code) {
-                dbgTrace(D_GEO_FILTER) << "County code: " << _country_code << " is allowed";
-                return true;
-            }
+        if (allowed_country_codes.count(_country_code) > 0) {
+            dbgTrace(D_GEO_FILTER) << "County code: " << _country_code << " is allowed";
+            return true;
         }
         dbgTrace(D_GEO_FILTER) << "County code: " << _country_code << " not in allowed countries list";
         return false;
@@ -69,11 +75,9 @@ public:
     isBlockedCountry(const std::string &_country_code) const
     {
         dbgTrace(D_GEO_FILTER) << "Check if country code: " << _country_code << " is blocked";
-        for (const GeoFilterCountry &country : blocked_countries) {
-            if (country.getCountryCode() == _country_code) {
-                dbgTrace(D_GEO_FILTER) << "County code: " << _country_code << " is blocked";
-                return true;
-            }
+        if (blocked_country_codes.count(_country_code) > 0) {
+            dbgTrace(D_GEO_FILTER) << "County code: " << _country_code << " is blocked";
+            return true;
         }
         dbgTrace(D_GEO_FILTER) << "County code: " << _country_code << " not in blocked countries list";
         return false;
@@ -85,6 +89,9 @@ private:
     std::string id;
     std::vector<GeoFilterCountry> allowed_countries;
     std::vector<GeoFilterCountry> blocked_countries;
+    // The country codes are indexed when the policy is loaded, so checking a country does not scan the lists.
+    std::unordered_set<std::string> allowed_country_codes;
+    std::unordered_set<std::string> blocked_country_codes;
 };
 
 #endif //__GEO_CONFIG_H__
@@ -6,9 +6,11 @@
 #include <algorithm>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <boost/algorithm/string.hpp>
 
+#include "cache.h"
 #include "cidrs_data.h"
 #include "generic_rulebase/generic_rulebase.h"
 #include "generic_rulebase/parameters_config.h"
@@ -26,6 +28,8 @@ using namespace std;
 USE_DEBUG_FLAG(D_GEO_FILTER);
 
 static const LogTriggerConf default_triger;
+static const uint default_geo_cache_size = 10000;
+static const uint default_geo_cache_expiration = 3600;
 
 class HttpGeoFilter::Impl : public Listener<HttpRequestHeaderEvent>
 {
@@ -36,12 +40,18 @@ public:
     {
         dbgTrace(D_GEO_FILTER) << "Init Http Geo filter component";
         registerListener();
+        geo_location_cache.startExpiration(
+            getGeoCacheExpiration(),
+            Singleton::Consume<I_MainLoop>::by<HttpGeoFilter>(),
+            Singleton::Consume<I_TimeGet>::by<HttpGeoFilter>()
+        );
     }
 
     void
     fini()
     {
         unregisterListener();
+        geo_location_cache.endExpiration();
     }
 
     string getListenerName() const override { return "HTTP geo filter"; }
@@ -61,6 +71,20 @@ public:
         }
     }
 
+    void
+    loadCacheSettings()
+    {
+        // The geo location DB and the trusted sources may have been reloaded with the configuration, so the lookups
+        // that were done against the previous ones are dropped.
+        geo_location_cache.clear();
+        trusted_cidrs.clear();
+
+        geo_location_cache.capacity(
+            getProfileAgentSettingWithDefault<uint>(default_geo_cache_size, "httpGeoFilter.cacheSize")
+        );
+        geo_location_cache.startExpiration(getGeoCacheExpiration());
+    }
+
     EventVerdict
     respond(const HttpRequestHeaderEvent &event) override
     {
@@ -113,6 +137,14 @@ public:
     }
 
 private:
+    chrono::seconds
+    getGeoCacheExpiration() const
+    {
+        return chrono::seconds(
+            getProfileAgentSettingWithDefault<uint>(default_geo_cache_expiration, "httpGeoFilter.cacheExpiration")
+        );
+    }
+
     std::set<std::string>
     split(const std::string& s, char delim) {
         std::set<std::string> elems;
@@ -145,7 +177,7 @@ private:
     void
     removeTrustedIpsFromXff(std::set<std::string> &xff_set)
     {
-        auto identify_config = getConfiguration<UsersAllIdentifiersConfig>(
+        const auto &identify_config = getConfiguration<UsersAllIdentifiersConfig>(
             "rulebase",
             "usersIdentifiers"
         );
@@ -169,17 +201,33 @@ private:
     isIpTrusted(const string &ip, const vector<string> &trusted_ips)
     {
         for (const auto &trusted_ip : trusted_ips) {
-            CIDRSData cidr_data(trusted_ip);
-            if (
-                ip == trusted_ip ||
-                (cidr_data.contains(ip))
-            ) {
-                return true;
+            if (ip == trusted_ip) return true;
+
+            auto cidr_data = trusted_cidrs.find(trusted_ip);
+            if (cidr_data == trusted_cidrs.end()) {
+                cidr_data = trusted_cidrs.emplace(trusted_ip, CIDRSData(trusted_ip)).first;
             }
+            if (cidr_data->second.contains(ip)) return true;
         }
         return false;
     }
 
+    Maybe<EnumArray<I_GeoLocation::GeoLocationField, std::string>>
+    lookupLocation(const IPAddr &ip)
+    {
+        const auto &cache = geo_location_cache;
+        auto cached_location = cache.getEntry(ip);
+        if (cached_location.ok()) {
+            dbgTrace(D_GEO_FILTER) << "Geo location of " << ip << " was found in cache";
+            return cached_location.unpack();
+        }
+
+        I_GeoLocation *i_geo_location = Singleton::Consume<I_GeoLocation>::by<HttpGeoFilter>();
+        auto location = i_geo_location->lookupLocation(ip);
+        geo_location_cache.emplaceEntry(ip, location);
+        return location;
+    }
+
     string
     convertIpAddrToString(const IPAddr &ip_to_convert)
     {
@@ -211,14 +259,13 @@ private:
     ngx_http_cp_verdict_e
     getGeoLookupVerdict(const std::set<std::string> &sources)
     {
-        auto maybe_geo_config = getConfiguration<GeoConfig>("rulebase", "httpGeoFilter");
+        const auto &maybe_geo_config = getConfiguration<GeoConfig>("rulebase", "httpGeoFilter");
         if (!maybe_geo_config.ok()) {
             dbgTrace(D_GEO_FILTER) << "Failed to load HTTP Geo Filter config. Error:" << maybe_geo_config.getErr();
             return ngx_http_cp_verdict_e::TRAFFIC_VERDICT_IRRELEVANT;
         }
-        GeoConfig geo_config = maybe_geo_config.unpack();
+        const GeoConfig &geo_config = maybe_geo_config.unpack();
         EnumArray<I_GeoLocation::GeoLocationField, std::string> geo_location_data;
-        I_GeoLocation *i_geo_location = Singleton::Consume<I_GeoLocation>::by<HttpGeoFilter>();
 
         for (const std::string& source : sources) {
             Maybe<IPAddr> maybe_source_ip = IPAddr::createIPAddr(source);
@@ -230,7 +277,7 @@ private:
                 maybe_source_ip.getErr();
                 continue;
             }
-            auto asset_location = i_geo_location->lookupLocation(maybe_source_ip.unpack());
+            auto asset_location = lookupLocation(maybe_source_ip.unpack());
             if (!asset_location.ok()) {
                 dbgWarning(D_GEO_FILTER) <<
                 "Lookup location failed for source: " <<
@@ -333,7 +380,6 @@ private:
 
         pair<ngx_http_cp_verdict_e, string> curr_matched_behavior;
         ngx_http_cp_verdict_e verdict = ngx_http_cp_verdict_e::TRAFFIC_VERDICT_IRRELEVANT;
-        I_GeoLocation *i_geo_location = Singleton::Consume<I_GeoLocation>::by<HttpGeoFilter>();
         EnumArray<I_GeoLocation::GeoLocationField, std::string> geo_location_data;
 
         for (const std::string& source : sources) {
@@ -349,7 +395,7 @@ private:
             }
 
 
-            auto asset_location = i_geo_location->lookupLocation(maybe_source_ip.unpack());
+            auto asset_location = lookupLocation(maybe_source_ip.unpack());
             if (!asset_location.ok()) {
                 dbgDebug(D_GEO_FILTER) << "Lookup location failed for source: " <<
                 source <<
@@ -456,6 +502,9 @@ private:
     }
 
     ngx_http_cp_verdict_e default_action = ngx_http_cp_verdict_e::TRAFFIC_VERDICT_IRRELEVANT;
+    // Clients are usually seen again shortly, so their geo location (or the failure to find it) is kept per IP.
+    TemporaryCache<IPAddr, Maybe<EnumArray<I_GeoLocation::GeoLocationField, std::string>>> geo_location_cache;
+    unordered_map<string, CIDRSData> trusted_cidrs;
 };
 
 HttpGeoFilter::HttpGeoFilter() : Component("HttpGeoFilter"), pimpl(make_unique<HttpGeoFilter::Impl>()) {}
@@ -478,5 +527,11 @@ HttpGeoFilter::preload()
 {
     registerExpectedConfiguration<GeoConfig>("rulebase", "httpGeoFilter");
     registerExpectedConfiguration<UsersAllIdentifiersConfig>("rulebase", "usersIdentifiers");
-    registerConfigLoadCb([this]() { pimpl->loadDefaultAction(); });
+    registerConfigLoadCb(
+        [this]()
+        {
+            pimpl->loadDefaultAction();
+            pimpl->loadCacheSettings();
+        }
+    );
 }
@@ -0,0 +1,190 @@
+#include "http_geo_filter.h"
+
+#include <sstream>
+
+#include "cptest.h"
+#include "config.h"
+#include "config_component.h"
+#include "environment.h"
+#include "http_transaction_data.h"
+#include "mock/mock_mainloop.h"
+#include "mock/mock_time_get.h"
+#include "mock/mock_logging.h"
+#include "mock/mock_agent_details.h"
+
+using namespace std;
+using namespace testing;
+
+USE_DEBUG_FLAG(D_GEO_FILTER);
+
+using GeoLocationData = EnumArray<I_GeoLocation::GeoLocationField, string>;
+
+ostream &
+operator<<(ostream &os, const GeoLocationData &location)
+{
+    return os << location[I_GeoLocation::GeoLocationField::COUNTRY_CODE];
+}
+
+ostream &
+operator<<(ostream &os, const Zone &)
+{
+    return os;
+}
+
+class MockGeoLocation : public Singleton::Provide<I_GeoLocation>::From<MockProvider<I_GeoLocation>>
+{
+public:
+    MOCK_METHOD1(lookupLocation, Maybe<GeoLocationData>(const string &));
+    MOCK_METHOD1(lookupLocation, Maybe<GeoLocationData>(const IPAddr &));
+};
+
+class MockGenericRulebase : public Singleton::Provide<I_GenericRulebase>::From<MockProvider<I_GenericRulebase>>
+{
+public:
+    MOCK_CONST_METHOD0(getLocalZone, Maybe<Zone, Config::Errors>());
+    MOCK_CONST_METHOD0(getOtherZone, Maybe<Zone, Config::Errors>());
+    MOCK_CONST_METHOD1(getLogTriggerConf, LogTriggerConf(const string &));
+    MOCK_CONST_METHOD1(getParameterException, ParameterException(const string &));
+    MOCK_CONST_METHOD1(getBehavior, set<ParameterBehavior>(const ParameterKeyValues &));
+};
+
+static const string geo_policy =
+    "{"
+    "    \"rulebase\": {"
+    "        \"httpGeoFilter\": ["
+    "            {"
+    "                \"name\": \"geo\","
+    "                \"defaultAction\": \"inspect\","
+    "                \"practiceId\": \"geo-practice\","
+    "                \"allowedCountries\": ["
+    "                    { \"countryName\": \"United States\", \"countryCode\": \"US\", \"id\": \"1\" },"
+    "                    { \"countryName\": \"Canada\", \"countryCode\": \"CA\", \"id\": \"2\" }"
+    "                ],"
+    "                \"blockedCountries\": ["
+    "                    { \"countryName\": \"Bhutan\", \"countryCode\": \"BT\", \"id\": \"3\" }"
+    "                ]"
+    "            }"
+    "        ]"
+    "    }"
+    "}";
+
+class HttpGeoFilterTest : public Test
+{
+public:
+    HttpGeoFilterTest()
+    {
+        Debug::setUnitTestFlag(D_GEO_FILTER, Debug::DebugLevel::TRACE);
+        EXPECT_CALL(mock_rulebase, getBehavior(_)).WillRepeatedly(Return(set<ParameterBehavior>()));
+        env.preload();
+        env.init();
+        config.preload();
+        geo_filter.preload();
+        geo_filter.init();
+        loadPolicy();
+        ctx.activate();
+    }
+
+    ~HttpGeoFilterTest()
+    {
+        ctx.deactivate();
+        geo_filter.fini();
+    }
+
+    void
+    loadPolicy()
+    {
+        istringstream policy(geo_policy);
+        ASSERT_TRUE(Singleton::Consume<Config::I_Config>::from(config)->loadConfiguration(policy));
+    }
+
+    EventVerdict
+    inspect(const string &source_ip, const string &xff = "")
+    {
+        ctx.registerValue<IPAddr>(HttpTransactionData::client_ip_ctx, IPAddr::createIPAddr(source_ip).unpack());
+        if (!xff.empty()) ctx.registerValue<string>(HttpTransactionData::xff_vals_ctx, xff);
+
+        const HttpHeader last_header{ Buffer("Host"), Buffer("www.example.com"), 0, true };
+        auto verdicts = HttpRequestHeaderEvent(last_header).query();
+        EXPECT_EQ(verdicts.size(), 1u);
+        return verdicts.empty() ? EventVerdict(ngx_http_cp_verdict_e::TRAFFIC_VERDICT_IRRELEVANT) : verdicts[0];
+    }
+
+    static GeoLocationData
+    location(const string &country_code, const string &country_name)
+    {
+        GeoLocationData res;
+        res[I_GeoLocation::GeoLocationField::COUNTRY_CODE] = country_code;
+        res[I_GeoLocation::GeoLocationField::COUNTRY_NAME] = country_name;
+        return res;
+    }
+
+    static Matcher<const IPAddr &>
+    ip(const string &ip_text)
+    {
+        return Eq(IPAddr::createIPAddr(ip_text).unpack());
+    }
+
+    const ngx_http_cp_verdict_e accept = ngx_http_cp_verdict_e::TRAFFIC_VERDICT_ACCEPT;
+    const ngx_http_cp_verdict_e drop = ngx_http_cp_verdict_e::TRAFFIC_VERDICT_DROP;
+    const ngx_http_cp_verdict_e inspect_verdict = ngx_http_cp_verdict_e::TRAFFIC_VERDICT_INSPECT;
+
+    NiceMock<MockMainLoop> mock_mainloop;
+    NiceMock<MockTimeGet> mock_time;
+    NiceMock<MockLogging> mock_logging;
+    NiceMock<MockAgentDetails> mock_agent_details;
+    StrictMock<MockGeoLocation> mock_geo_location;
+    NiceMock<MockGenericRulebase> mock_rulebase;
+    ::Environment env;
+    ConfigComponent config;
+    HttpGeoFilter geo_filter;
+    Context ctx;
+};
+
+TEST_F(HttpGeoFilterTest, verdict_by_allowed_and_blocked_countries)
+{
+    EXPECT_CALL(mock_geo_location, lookupLocation(ip("1.1.1.1"))).WillOnce(Return(location("US", "United States")));
+    EXPECT_CALL(mock_geo_location, lookupLocation(ip("2.2.2.2"))).WillOnce(Return(location("CA", "Canada")));
+    EXPECT_CALL(mock_geo_location, lookupLocation(ip("3.3.3.3"))).WillOnce(Return(location("BT", "Bhutan")));
+    EXPECT_CALL(mock_geo_location, lookupLocation(ip("4.4.4.4"))).WillOnce(Return(location("FR", "France")));
+
+    EXPECT_EQ(inspect("1.1.1.1").getVerdict(), accept);
+    EXPECT_EQ(inspect("2.2.2.2").getVerdict(), accept);
+    EXPECT_EQ(inspect("3.3.3.3").getVerdict(), drop);
+    EXPECT_EQ(inspect("4.4.4.4").getVerdict(), inspect_verdict);
+}
+
+TEST_F(HttpGeoFilterTest, blocked_xff_source)
+{
+    EXPECT_CALL(mock_geo_location, lookupLocation(ip("4.4.4.4"))).WillOnce(Return(location("FR", "France")));
+    EXPECT_CALL(mock_geo_location, lookupLocation(ip("3.3.3.3"))).WillOnce(Return(location("BT", "Bhutan")));
+
+    EXPECT_EQ(inspect("4.4.4.4", "3.3.3.3").getVerdict(), drop);
+}
+
+TEST_F(HttpGeoFilterTest, lookup_is_cached_between_checks_and_requests)
+{
+    // The exceptions and the geo practice are both checked, on two requests, with a single DB lookup
+    EXPECT_CALL(mock_geo_location, lookupLocation(ip("3.3.3.3"))).WillOnce(Return(location("BT", "Bhutan")));
+
+    EXPECT_EQ(inspect("3.3.3.3").getVerdict(), drop);
+    EXPECT_EQ(inspect("3.3.3.3").getVerdict(), drop);
+}
+
+TEST_F(HttpGeoFilterTest, failed_lookup_is_cached)
+{
+    EXPECT_CALL(mock_geo_location, lookupLocation(ip("5.5.5.5"))).WillOnce(Return(genError("Not in the DB")));
+
+    EXPECT_EQ(inspect("5.5.5.5").getVerdict(), inspect_verdict);
+    EXPECT_EQ(inspect("5.5.5.5").getVerdict(), inspect_verdict);
+}
+
+TEST_F(HttpGeoFilterTest, cache_is_cleared_on_configuration_load)
+{
+    EXPECT_CALL(mock_geo_location, lookupLocation(ip("1.1.1.1")))
+        .WillOnce(Return(location("US", "United States")))
+        .WillOnce(Return(location("BT", "Bhutan")));
+
+    EXPECT_EQ(inspect("1.1.1.1").getVerdict(), accept);
+    loadPolicy();
+    EXPECT_EQ(inspect("1.1.1.1").getVerdict(), drop);
+}
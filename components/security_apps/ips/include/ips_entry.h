@@ -3,11 +3,13 @@
 
 #include <map>
 #include <set>
+#include <memory>
 
 #include "table_opaque.h"
 #include "parsed_context.h"
 #include "buffer.h"
 #include "context.h"
+#include "pm_hook.h"
 
 class IPSEntry : public TableOpaqueSerialize<IPSEntry>, public Listener<ParsedContext>
 {
@@ -40,15 +42,42 @@ public:
     const std::vector<std::pair<std::string, Buffer>> getPendingContexts() const { return pending_contexts; }
     void clearPendingContexts() { pending_contexts.clear(); }
 
+    // A streamed buffer is the kept history of the context being inspected followed by its new chunk, so only the
+    // new chunk is scanned.
+    std::set<PMPattern> getFirstTierMatches(
+        const std::shared_ptr<PMHook> &hook,
+        const Buffer &buffer,
+        bool is_streamed
+    );
+
     void setDrop() { is_drop = true; }
     bool isDrop() const { return is_drop; }
 
 private:
+    // First tier scanning state of a history context. Every chunk is scanned once, continuing the automaton state
+    // of the previous chunks, and the patterns matched in the kept history are remembered instead of rescanned.
+    class FirstTierStream
+    {
+    public:
+        PMHook::StreamState state;
+        uint base = 0; // Context offset at which the stream was started
+        std::map<PMPattern, uint> last_match_start; // Context offset of the latest match of each pattern
+    };
+
+    std::set<PMPattern> scanFirstTierStream(const std::shared_ptr<PMHook> &hook, const Buffer &buffer);
+
     std::map<std::string, Buffer> past_contexts;
     std::set<std::string> flags;
     Context ctx;
     std::map<Buffer, Buffer> transaction_data;
     std::vector<std::pair<std::string, Buffer>> pending_contexts;
+    std::map<std::string, std::map<std::shared_ptr<PMHook>, FirstTierStream>> first_tier_streams;
+    std::map<std::string, uint> history_context_sizes;
+    // First tier results of the context being inspected, shared by all signature sets that use the same hook
+    std::map<std::shared_ptr<PMHook>, std::set<PMPattern>> first_tier_results;
+    std::string streamed_context;
+    uint streamed_history_size = 0;
+    uint streamed_chunk_size = 0;
 
     bool is_drop = false;
 };
@@ -419,7 +419,8 @@ public:
 
     /// \brief Check if the context is matched for prevention.
     /// \param context_buffer The context buffer.
-    bool isMatchedPrevent(const Buffer &context_buffer) const;
+    /// \param is_streamed Whether the buffer is the kept history of the context followed by its new chunk.
+    bool isMatchedPrevent(const Buffer &context_buffer, bool is_streamed = false) const;
 
     /// \brief Calculate the first tier for the given context name.
     /// \param ctx_name The context name.
@@ -428,7 +429,8 @@ public:
 private:
     /// \brief Get the first tier matches for the buffer.
     /// \param buffer The buffer to match.
-    std::set<PMPattern> getFirstTierMatches(const Buffer &buffer) const;
+    /// \param is_streamed Whether the buffer is the kept history of the context followed by its new chunk.
+    std::set<PMPattern> getFirstTierMatches(const Buffer &buffer, bool is_streamed) const;
 
     std::map<PMPattern, std::vector<IPSSignatureSubTypes::SignatureAndAction>> signatures_per_lss;
     std::vector<IPSSignatureSubTypes::SignatureAndAction> signatures_without_lss;
@@ -527,7 +529,12 @@ public:
     /// \brief Check if the context is matched for prevention.
     /// \param context_name The name of the context.
     /// \param context_buffer The context buffer.
-    bool isMatchedPrevent(const std::string &context_name, const Buffer &context_buffer) const;
+    /// \param is_streamed Whether the buffer is the kept history of the context followed by its new chunk.
+    bool isMatchedPrevent(
+        const std::string &context_name,
+        const Buffer &context_buffer,
+        bool is_streamed = false
+    ) const;
 
     /// \brief Check if the IPS signatures are empty.
     /// \return True if the signatures are empty, otherwise false.
@@ -605,7 +612,12 @@ public:
     /// \brief Check if the context is matched for prevention.
     /// \param context_name The name of the context.
     /// \param context_buffer The context buffer.
-    bool isMatchedPrevent(const std::string &context_name, const Buffer &context_buffer) const;
+    /// \param is_streamed Whether the buffer is the kept history of the context followed by its new chunk.
+    bool isMatchedPrevent(
+        const std::string &context_name,
+        const Buffer &context_buffer,
+        bool is_streamed = false
+    ) const;
 
     /// \brief Check if the Snort signatures are empty.
     /// \return True if the signatures are empty, otherwise false.
@@ -14,6 +14,7 @@
 #include "helper.h"
 #include "ips_common_types.h"
 #include "nginx_attachment_common.h"
+#include "inspection_stage_metric.h"
 
 using namespace std;
 
@@ -164,6 +165,8 @@ public:
     EventVerdict
     respond(const HttpRequestHeaderEvent &event) override
     {
+        InspectionStageTimer timer("ips.requestHeader");
+
         if (!table->hasState<IPSEntry>()) return ACCEPT;
 
         auto &ips_state = table->getState<IPSEntry>();
@@ -204,6 +207,8 @@ public:
     EventVerdict
     respond(const HttpRequestBodyEvent &event) override
     {
+        InspectionStageTimer timer("ips.requestBody");
+
         if (!table->hasState<IPSEntry>()) return ACCEPT;
 
         auto &ips_state = table->getState<IPSEntry>();
@@ -235,6 +240,8 @@ public:
     EventVerdict
     respond(const EndRequestEvent &) override
     {
+        InspectionStageTimer timer("ips.endRequest");
+
         if (!table->hasState<IPSEntry>()) return ACCEPT;
 
         auto &ips_state = table->getState<IPSEntry>();
@@ -280,6 +287,8 @@ public:
     EventVerdict
     respond(const HttpResponseHeaderEvent &event) override
     {
+        InspectionStageTimer timer("ips.responseHeader");
+
         if (!table->hasState<IPSEntry>()) return ACCEPT;
 
         auto &ips_state = table->getState<IPSEntry>();
@@ -294,6 +303,8 @@ public:
     EventVerdict
     respond(const HttpResponseBodyEvent &event) override
     {
+        InspectionStageTimer timer("ips.responseBody");
+
         if (!table->hasState<IPSEntry>()) return ACCEPT;
 
         auto &ips_state = table->getState<IPSEntry>();
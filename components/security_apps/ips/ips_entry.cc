@@ -46,18 +46,28 @@ IPSEntry::respond(const ParsedContext &parsed)
     dbgTrace(D_IPS) << "Context Content " << dumpHex(buf);
 
     auto config = getConfigurationWithDefault(default_conf, "IPS", "IpsConfigurations").getContext(name);
+    first_tier_results.clear();
     if (config.getType() == IPSConfiguration::ContextType::HISTORY) {
+        streamed_context = name;
+        streamed_history_size = past_contexts[name].size();
+        streamed_chunk_size = buf.size();
         buf = past_contexts[name] + buf;
     }
     ctx.registerValue(I_KeywordsRule::getKeywordsRuleTag(), name);
     ctx.registerValue(name, buf);
 
     ctx.activate();
+    bool is_streamed = !streamed_context.empty();
     auto &signatures = getConfigurationWithDefault(default_ips_sigs, "IPS", "IpsProtections");
-    bool should_drop = signatures.isMatchedPrevent(parsed.getName(), buf);
+    bool should_drop = signatures.isMatchedPrevent(parsed.getName(), buf, is_streamed);
     auto &snort_signatures = getConfigurationWithDefault(default_snort_sigs, "IPSSnortSigs", "SnortProtections");
-    should_drop |= snort_signatures.isMatchedPrevent(parsed.getName(), buf);
+    should_drop |= snort_signatures.isMatchedPrevent(parsed.getName(), buf, is_streamed);
     ctx.deactivate();
+    first_tier_results.clear();
+    if (!streamed_context.empty()) {
+        history_context_sizes[name] += streamed_chunk_size;
+        streamed_context.clear();
+    }
 
     switch(config.getType()) {
         case IPSConfiguration::ContextType::NORMAL: {
@@ -95,6 +105,56 @@ IPSEntry::getBuffer(const string &name) const
     return Buffer();
 }
 
+set<PMPattern>
+IPSEntry::getFirstTierMatches(const shared_ptr<PMHook> &hook, const Buffer &buffer, bool is_streamed)
+{
+    auto cached = first_tier_results.find(hook);
+    if (cached != first_tier_results.end()) return cached->second;
+
+    auto res = is_streamed && !streamed_context.empty() ? scanFirstTierStream(hook, buffer) : hook->scanBuf(buffer);
+    first_tier_results.emplace(hook, res);
+    return res;
+}
+
+set<PMPattern>
+IPSEntry::scanFirstTierStream(const shared_ptr<PMHook> &hook, const Buffer &buffer)
+{
+    uint chunk_start = history_context_sizes[streamed_context];
+    uint window_start = chunk_start - streamed_history_size;
+    auto &stream = first_tier_streams[streamed_context][hook];
+
+    Buffer to_scan = buffer.getSubBuffer(streamed_history_size, buffer.size());
+    auto matches = hook->scanStream(stream.state, to_scan);
+    if (stream.base + stream.state.getScannedBytes() != chunk_start + to_scan.size()) {
+        // The stream missed some of the context or the hook was recompiled - restart it at the history start
+        dbgTrace(D_IPS) << "Restarting first tier stream of " << streamed_context;
+        stream = FirstTierStream();
+        stream.base = window_start;
+        matches = hook->scanStream(stream.state, buffer);
+    }
+
+    set<PMPattern> res;
+    for (auto &match : matches) {
+        auto &pattern = match.first;
+        uint start = stream.base + match.second + 1 - pattern.size();
+        if (start < window_start) continue;
+        res.insert(pattern);
+        // A pattern that must end the buffer will not match again in the next chunk's buffer
+        if (!pattern.isEndMatch()) stream.last_match_start[pattern] = start;
+    }
+
+    for (auto iter = stream.last_match_start.begin(); iter != stream.last_match_start.end();) {
+        if (iter->second < window_start) {
+            iter = stream.last_match_start.erase(iter);
+        } else {
+            res.insert(iter->first);
+            iter++;
+        }
+    }
+
+    return res;
+}
+
 void
 IPSEntry::setTransactionData(const Buffer &key, const Buffer &value)
 {
@@ -674,15 +674,19 @@ IPSSignaturesPerContext::calcFirstTier(const string &ctx_name)
 }
 
 set<PMPattern>
-IPSSignaturesPerContext::getFirstTierMatches(const Buffer &buffer) const
+IPSSignaturesPerContext::getFirstTierMatches(const Buffer &buffer, bool is_streamed) const
 {
-    return first_tier->ok() ? first_tier->scanBuf(buffer) : set<PMPattern>();
+    if (!first_tier->ok()) return set<PMPattern>();
+
+    auto table = Singleton::Consume<I_Table>::by<IPSComp>();
+    if (!table->hasState<IPSEntry>()) return first_tier->scanBuf(buffer);
+    return table->getState<IPSEntry>().getFirstTierMatches(first_tier, buffer, is_streamed);
 }
 
 bool
-IPSSignaturesPerContext::isMatchedPrevent(const Buffer &context_buffer) const
+IPSSignaturesPerContext::isMatchedPrevent(const Buffer &context_buffer, bool is_streamed) const
 {
-    auto first_tier_res = getFirstTierMatches(context_buffer);
+    auto first_tier_res = getFirstTierMatches(context_buffer, is_streamed);
 
     for (auto &pat : first_tier_res) {
         auto find = signatures_per_lss.find(pat);
@@ -753,7 +757,7 @@ IPSSignatures::load(cereal::JSONInputArchive &ar)
 }
 
 bool
-IPSSignatures::isMatchedPrevent(const string &context_name, const Buffer &context_buffer) const
+IPSSignatures::isMatchedPrevent(const string &context_name, const Buffer &context_buffer, bool is_streamed) const
 {
     auto curr_sig = signatures_per_context.find(context_name);
 
@@ -770,7 +774,7 @@ IPSSignatures::isMatchedPrevent(const string &context_name, const Buffer &contex
         ctx.registerValue<string>("practiceId", (*config).getPracticeId(), SOURCE);
     }
     ctx.registerValue<string>("practiceSubType", "Web IPS", SOURCE);
-    auto is_matched = curr_sig->second.isMatchedPrevent(context_buffer);
+    auto is_matched = curr_sig->second.isMatchedPrevent(context_buffer, is_streamed);
 
     return is_matched;
 }
@@ -835,7 +839,7 @@ SnortSignatures::load(cereal::JSONInputArchive &ar)
 }
 
 bool
-SnortSignatures::isMatchedPrevent(const string &context_name, const Buffer &context_buffer) const
+SnortSignatures::isMatchedPrevent(const string &context_name, const Buffer &context_buffer, bool is_streamed) const
 {
     auto curr_sig = signatures_per_context.find(context_name);
 
@@ -854,7 +858,7 @@ SnortSignatures::isMatchedPrevent(const string &context_name, const Buffer &cont
         ctx.registerValue<string>("practiceId", (*config).getPracticeId(), SOURCE);
     }
     ctx.registerValue<string>("practiceSubType", "Web Snort", SOURCE);
-    auto is_matched = curr_sig->second.isMatchedPrevent(context_buffer);
+    auto is_matched = curr_sig->second.isMatchedPrevent(context_buffer, is_streamed);
 
     return is_matched;
 }
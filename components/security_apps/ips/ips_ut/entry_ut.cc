@@ -41,6 +41,7 @@ public:
     EntryTest()
     {
         ON_CALL(table, getState(_)).WillByDefault(Return(ptr));
+        ON_CALL(table, hasState(type_index(typeid(IPSEntry)))).WillByDefault(Return(true));
     }
 
     void
@@ -240,6 +241,35 @@ TEST_F(EntryTest, check_snort_signature_invoking)
     EXPECT_EQ(repondToContext("ddd", "HTTP_RESPONSE_BODY"), ParsedContextReply::ACCEPT);
 }
 
+TEST_F(EntryTest, first_tier_match_across_chunks)
+{
+    string signature =
+        "{"
+            "\"protectionMetadata\": {"
+                "\"protectionName\": \"Test1\","
+                "\"maintrainId\": \"101\","
+                "\"severity\": \"Medium High\","
+                "\"confidenceLevel\": \"Low\","
+                "\"performanceImpact\": \"Medium High\","
+                "\"lastUpdate\": \"20210420\","
+                "\"tags\": [],"
+                "\"cveList\": []"
+            "},"
+            "\"detectionRules\": {"
+                "\"type\": \"simple\","
+                "\"SSM\": \"abcd\","
+                "\"keywords\": \"data: \\\"abcd\\\";\","
+                "\"context\": [\"HTTP_REQUEST_BODY\"]"
+            "}"
+        "}";
+    loadSignatures(signature);
+
+    EXPECT_EQ(repondToContext("xxab", "HTTP_REQUEST_BODY"), ParsedContextReply::ACCEPT);
+    EXPECT_EQ(repondToContext("cdyy", "HTTP_REQUEST_BODY"), ParsedContextReply::DROP);
+    // The match is still in the kept history, so it is found without rescanning it
+    EXPECT_EQ(repondToContext("zz", "HTTP_REQUEST_BODY"), ParsedContextReply::DROP);
+}
+
 TEST_F(EntryTest, flags_test)
 {
     EXPECT_FALSE(entry.isFlagSet("CONTEXT_A"));
@@ -15,6 +15,7 @@
 #include "generic_rulebase/evaluators/asset_eval.h"
 #include "generic_rulebase/parameters_config.h"
 #include "WaapConfigApi.h"
+#include "inspection_stage_metric.h"
 #include "WaapConfigApplication.h"
 #include "PatternMatcher.h"
 #include "i_waapConfig.h"
@@ -272,6 +273,7 @@ public:
     {
         if (!event.isLastHeader()) return INSPECT;
 
+        InspectionStageTimer timer("rateLimit.requestHeader");
         auto env = Singleton::Consume<I_Environment>::by<RateLimit>();
         auto uri_ctx = env->get<string>(HttpTransactionData::uri_ctx);
         if (!uri_ctx.ok()) {
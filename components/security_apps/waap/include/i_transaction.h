@@ -20,6 +20,7 @@
 #include "../waap_clib/WaapOpenRedirect.h"
 #include "../waap_clib/FpMitigation.h"
 #include "../waap_clib/DeepParser.h"
+#include "../waap_clib/InspectionBudget.h"
 #include "../waap_clib/OASchemaUpdaterConfConstant.h"
 #include "http_inspection_events.h"
 
@@ -91,6 +92,8 @@ public:
     virtual ngx_http_cp_verdict_e getUserLimitVerdict() = 0;
     virtual const std::string getUserLimitVerdictStr() const = 0;
     virtual const std::string getViolatedUserLimitTypeStr() const = 0;
+    virtual Waap::InspectionBudget::State& getInspectionBudget() = 0;
+    virtual ngx_http_cp_verdict_e getInspectionBudgetVerdict() = 0;
     virtual void checkShouldInject() = 0;
     virtual void completeInjectionResponseBody(std::string& strInjection) = 0;
     virtual void sendLog() = 0;
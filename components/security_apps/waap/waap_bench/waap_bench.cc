@@ -0,0 +1,309 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "cptest/cptest_bench_inputs.h"
+#include "Waf2Regex.h"
+#include "WaapRegexPreconditions.h"
+#include "Waf2Util.h"
+#include "ParserBase.h"
+#include "ParserJson.h"
+#include "ParserXML.h"
+#include "ParserMultipartForm.h"
+#include "ParserUrlEncode.h"
+
+using namespace std;
+
+// A few signatures shaped like the ones of the WAAP engine, each with the keyword that enables it.
+static const vector<pair<string, string>> signatures = {
+    { "union", "(?i)\\bunion\\b[\\s\\S]{0,100}?\\bselect\\b" },
+    { "select", "(?i)\\bselect\\b[\\s\\S]{0,100}?\\bfrom\\b" },
+    { "sleep", "(?i)\\b(?:sleep|benchmark)\\s*\\(" },
+    { "waitfor", "(?i)\\bwaitfor\\s+delay\\b" },
+    { "drop", "(?i)\\bdrop\\s+(?:table|database)\\b" },
+    { "' or '", "(?i)'\\s*or\\s*'[^']*'\\s*=\\s*'" },
+    { "extractvalue", "(?i)\\b(?:extractvalue|updatexml)\\s*\\(" },
+    { "<script", "(?i)<script[^>]*>" },
+    { "onerror", "(?i)\\bon(?:error|load|mouseover)\\s*=" },
+    { "javascript:", "(?i)javascript\\s*:" },
+    { "document.cookie", "(?i)\\bdocument\\s*\\.\\s*cookie\\b" },
+    { "<iframe", "(?i)<iframe\\b[^>]*\\bsrc\\s*=" },
+    { "../", "(?:\\.\\./){2,}" }
+};
+
+// Parameter values of a typical request: mostly benign, with some attacks among them.
+static const vector<string> &
+getValues()
+{
+    static vector<string> values;
+    if (values.empty()) {
+        for (uint index = 0; index < 64; index++) values.push_back("benign value number " + to_string(index));
+        for (const string &payload : cptestSqliPayloads()) values.push_back(payload);
+        for (const string &payload : cptestXssPayloads()) values.push_back(payload);
+    }
+    return values;
+}
+
+static size_t
+getValuesSize()
+{
+    size_t size = 0;
+    for (const string &value : getValues()) size += value.size();
+    return size;
+}
+
+static shared_ptr<Waap::RegexPreconditions>
+getPreconditions()
+{
+    static shared_ptr<Waap::RegexPreconditions> preconditions;
+    if (preconditions == nullptr) {
+        picojson::value::object preconditions_json;
+        picojson::value::array keys;
+        for (const auto &signature : signatures) {
+            picojson::value::array action = {
+                picojson::value("regex"),
+                picojson::value(signature.second),
+                picojson::value("")
+            };
+            preconditions_json[signature.first] = picojson::value(picojson::value::array{ picojson::value(action) });
+            keys.emplace_back(signature.first);
+        }
+        picojson::value::object data = {
+            { "preconditions", picojson::value(preconditions_json) },
+            { "precondition_keys", picojson::value(keys) }
+        };
+        bool error = false;
+        preconditions = make_shared<Waap::RegexPreconditions>(data, error);
+    }
+    return preconditions;
+}
+
+static vector<string>
+getPatterns()
+{
+    vector<string> patterns;
+    for (const auto &signature : signatures) patterns.push_back(signature.second);
+    return patterns;
+}
+
+static void
+BM_SingleRegexFindAllMatches(benchmark::State &state)
+{
+    bool error = false;
+    SingleRegex regex(signatures.front().second, error, "union_select");
+    vector<RegexMatch> matches;
+
+    for (auto _ : state) {
+        for (const string &value : getValues()) regex.findAllMatches(value, matches);
+    }
+    state.SetItemsProcessed(state.iterations() * getValues().size());
+    state.SetBytesProcessed(state.iterations() * getValuesSize());
+}
+BENCHMARK(BM_SingleRegexFindAllMatches);
+
+static void
+BM_RegexFindAllMatches(benchmark::State &state)
+{
+    bool error = false;
+    Regex regex(getPatterns(), error, "signatures", nullptr);
+    vector<RegexMatch> matches;
+
+    for (auto _ : state) {
+        for (const string &value : getValues()) regex.findAllMatches(value, matches);
+    }
+    state.SetItemsProcessed(state.iterations() * getValues().size());
+    state.SetBytesProcessed(state.iterations() * getValuesSize());
+}
+BENCHMARK(BM_RegexFindAllMatches);
+
+static void
+BM_RegexFindAllMatchesWithPreconditions(benchmark::State &state)
+{
+    bool error = false;
+    auto preconditions = getPreconditions();
+    Regex regex(getPatterns(), error, "signatures", preconditions);
+    vector<RegexMatch> matches;
+
+    for (auto _ : state) {
+        for (const string &value : getValues()) {
+            Waap::RegexPreconditions::PmWordSet words;
+            preconditions->pmScan(Buffer(value), words);
+            regex.findAllMatches(value, matches, &words);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * getValues().size());
+    state.SetBytesProcessed(state.iterations() * getValuesSize());
+}
+BENCHMARK(BM_RegexFindAllMatchesWithPreconditions);
+
+static void
+BM_RegexPreconditionsPmScan(benchmark::State &state)
+{
+    auto preconditions = getPreconditions();
+    string input = cptestBenignJson(state.range(0));
+
+    for (auto _ : state) {
+        Waap::RegexPreconditions::PmWordSet words;
+        preconditions->pmScan(Buffer(input), words);
+        benchmark::DoNotOptimize(words.size());
+    }
+    state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_RegexPreconditionsPmScan)->Range(1 << 10, 1 << 20);
+
+// The decoders run on every parameter value, so they are measured on the values of a typical request.
+template <typename Decoder>
+static void
+runDecoder(benchmark::State &state, Decoder decoder)
+{
+    for (auto _ : state) {
+        for (const string &value : getValues()) {
+            string decoded = value;
+            decoder(decoded);
+            benchmark::DoNotOptimize(decoded.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * getValues().size());
+    state.SetBytesProcessed(state.iterations() * getValuesSize());
+}
+
+static void
+BM_UnquotePlus(benchmark::State &state)
+{
+    runDecoder(state, [] (string &text) { text.erase(unquote_plus(text.begin(), text.end()), text.end()); });
+}
+BENCHMARK(BM_UnquotePlus);
+
+static void
+BM_EscapeHtml(benchmark::State &state)
+{
+    runDecoder(state, [] (string &text) { text.erase(escape_html(text.begin(), text.end()), text.end()); });
+}
+BENCHMARK(BM_EscapeHtml);
+
+static void
+BM_EscapeBackslashes(benchmark::State &state)
+{
+    runDecoder(state, [] (string &text) { text.erase(escape_backslashes(text.begin(), text.end()), text.end()); });
+}
+BENCHMARK(BM_EscapeBackslashes);
+
+static void
+BM_UnescapeUnicode(benchmark::State &state)
+{
+    runDecoder(state, [] (string &text) { unescapeUnicode(text); });
+}
+BENCHMARK(BM_UnescapeUnicode);
+
+static void
+BM_DecodePercentEncoding(benchmark::State &state)
+{
+    runDecoder(state, [] (string &text) { Waap::Util::decodePercentEncoding(text, true); });
+}
+BENCHMARK(BM_DecodePercentEncoding);
+
+static void
+BM_FindEscapeChars(benchmark::State &state)
+{
+    runDecoder(state, [] (string &text) { benchmark::DoNotOptimize(findEscapeChars(text)); });
+}
+BENCHMARK(BM_FindEscapeChars);
+
+static void
+BM_Base64Decode(benchmark::State &state)
+{
+    string encoded = Waap::Util::base64Encode(cptestBinaryData(state.range(0)));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Waap::Util::base64Decode(encoded));
+    }
+    state.SetBytesProcessed(state.iterations() * encoded.size());
+}
+BENCHMARK(BM_Base64Decode)->Range(1 << 10, 1 << 20);
+
+// Counts the key/value pairs the parsers emit, like the deep parser receives them.
+class CountingReceiver : public IParserReceiver
+{
+public:
+    int
+    onKv(const char *, size_t, const char *, size_t v_len, int, size_t) override
+    {
+        pairs++;
+        bytes += v_len;
+        return 0;
+    }
+
+    size_t pairs = 0;
+    size_t bytes = 0;
+};
+
+static void
+BM_ParserJson(benchmark::State &state)
+{
+    string input = cptestBenignJson(state.range(0));
+
+    for (auto _ : state) {
+        CountingReceiver receiver;
+        ParserJson parser(receiver);
+        parser.push(input.data(), input.size());
+        parser.finish();
+        benchmark::DoNotOptimize(receiver.pairs);
+    }
+    state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_ParserJson)->Range(1 << 10, 1 << 20);
+
+static void
+BM_ParserXML(benchmark::State &state)
+{
+    string input = cptestBenignXml(state.range(0));
+
+    for (auto _ : state) {
+        CountingReceiver receiver;
+        BufferedReceiver buffered_receiver(receiver);
+        ParserXML parser(buffered_receiver, 0);
+        parser.push(input.data(), input.size());
+        parser.finish();
+        benchmark::DoNotOptimize(receiver.pairs);
+    }
+    state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_ParserXML)->Range(1 << 10, 1 << 20);
+
+static void
+BM_ParserUrlEncode(benchmark::State &state)
+{
+    string input = cptestUrlEncodedForm(state.range(0));
+
+    for (auto _ : state) {
+        CountingReceiver receiver;
+        BufferedReceiver buffered_receiver(receiver);
+        ParserUrlEncode parser(buffered_receiver, 0);
+        parser.push(input.data(), input.size());
+        parser.finish();
+        benchmark::DoNotOptimize(receiver.pairs);
+    }
+    state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_ParserUrlEncode)->Range(1 << 10, 1 << 20);
+
+static void
+BM_ParserMultipartForm(benchmark::State &state)
+{
+    static const string boundary = "----WebKitFormBoundary7MA4YWxkTrZu0gW";
+    string input = cptestMultipartBody(boundary, state.range(0));
+
+    for (auto _ : state) {
+        CountingReceiver receiver;
+        BufferedReceiver buffered_receiver(receiver);
+        ParserMultipartForm parser(buffered_receiver, 0, boundary.data(), boundary.size());
+        parser.push(input.data(), input.size());
+        parser.finish();
+        benchmark::DoNotOptimize(receiver.pairs);
+    }
+    state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_ParserMultipartForm)->Range(1 << 10, 1 << 20);
+
+BENCHMARK_MAIN();
@@ -20,6 +20,7 @@
 #include "ErrorLimitingDecision.h"
 #include "RateLimitingDecision.h"
 #include "UserLimitsDecision.h"
+#include "InspectionBudgetDecision.h"
 
 USE_DEBUG_FLAG(D_WAAP);
 
@@ -70,6 +71,11 @@ void DecisionFactory::initDecision(DecisionType type)
             initUserLimitsDecision();
             break;
         }
+        case INSPECTION_BUDGET_DECISION:
+        {
+            initInspectionBudgetDecision();
+            break;
+        }
         default:
             static_assert(true, "Illegal DecisionType ENUM value");
             dbgError(D_WAAP) << "Illegal DecisionType ENUM value " << type;
@@ -141,6 +147,15 @@ void DecisionFactory::initUserLimitsDecision()
     }
 }
 
+void DecisionFactory::initInspectionBudgetDecision()
+{
+    DecisionType type = DecisionType::INSPECTION_BUDGET_DECISION;
+    if (!m_decisions[type])
+    {
+        m_decisions[type] = std::make_shared<InspectionBudgetDecision>(type);
+    }
+}
+
 std::shared_ptr<SingleDecision>
 DecisionFactory::getDecision(DecisionType type) const
 {
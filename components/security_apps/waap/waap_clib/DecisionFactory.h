@@ -40,6 +40,7 @@ private:
     void initErrorLimitingDecision();
     void initRateLimitingDecision();
     void initUserLimitsDecision();
+    void initInspectionBudgetDecision();
     DecisionsArr m_decisions;
 };
 #endif
@@ -25,6 +25,7 @@ enum DecisionType
     ERROR_LIMITING_DECISION,
     USER_LIMITS_DECISION,
     RATE_LIMITING_DECISION,
+    INSPECTION_BUDGET_DECISION,
     // Must be kept last
     NO_WAAP_DECISION
 };
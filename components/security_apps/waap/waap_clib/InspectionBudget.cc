@@ -0,0 +1,124 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "InspectionBudget.h"
+#include "i_transaction.h"
+#include "telemetry.h"
+#include "waap.h"
+#include "config.h"
+#include "debug.h"
+
+USE_DEBUG_FLAG(D_WAAP);
+
+namespace Waap {
+namespace InspectionBudget {
+
+static ExhaustedVerdict
+parseExhaustedVerdict(const std::string &verdict)
+{
+    if (verdict == "accept") return ExhaustedVerdict::ACCEPT;
+    if (verdict == "drop") return ExhaustedVerdict::DROP;
+    if (verdict != "inspect") {
+        dbgWarning(D_WAAP) << "Unknown inspection budget verdict '" << verdict << "', using 'inspect'";
+    }
+    return ExhaustedVerdict::INSPECT;
+}
+
+State::State()
+    :
+    m_maxTime(0),
+    m_maxScannedBytes(0),
+    m_verdict(ExhaustedVerdict::INSPECT),
+    m_inspectionTime(0),
+    m_scannedBytes(0),
+    m_skippedBytes(0),
+    m_reason(ExhaustedReason::NONE)
+{
+}
+
+void
+State::reset()
+{
+    m_maxTime = std::chrono::milliseconds(
+        getProfileAgentSettingWithDefault<uint>(0, "agent.waap.inspectionBudget.maxTimeMs")
+    );
+    m_maxScannedBytes = getProfileAgentSettingWithDefault<uint>(0, "agent.waap.inspectionBudget.maxScannedBytes");
+    m_verdict = parseExhaustedVerdict(
+        getProfileAgentSettingWithDefault<std::string>("inspect", "agent.waap.inspectionBudget.exhaustedVerdict")
+    );
+    m_inspectionTime = std::chrono::microseconds(0);
+    m_scannedBytes = 0;
+    m_skippedBytes = 0;
+    m_reason = ExhaustedReason::NONE;
+}
+
+bool
+State::consume(size_t bytes, std::chrono::microseconds elapsed)
+{
+    m_inspectionTime += elapsed;
+    m_scannedBytes += bytes;
+
+    if (isExhausted()) return false;
+
+    if (m_maxTime.count() != 0 && m_inspectionTime >= m_maxTime) {
+        m_reason = ExhaustedReason::TIME;
+    } else if (m_maxScannedBytes != 0 && m_scannedBytes >= m_maxScannedBytes) {
+        m_reason = ExhaustedReason::BYTES;
+    } else {
+        return false;
+    }
+
+    dbgInfo(D_WAAP)
+        << "Inspection budget exhausted ("
+        << reasonToString(m_reason)
+        << "): scanned "
+        << m_scannedBytes
+        << " bytes in "
+        << m_inspectionTime.count()
+        << " microseconds";
+    return true;
+}
+
+const char *
+State::reasonToString(ExhaustedReason reason)
+{
+    switch (reason) {
+        case ExhaustedReason::NONE: return "none";
+        case ExhaustedReason::TIME: return "time";
+        case ExhaustedReason::BYTES: return "bytes";
+    }
+    return "unknown";
+}
+
+Scope::Scope(IWaf2Transaction &transaction, size_t bytes)
+    :
+    m_transaction(transaction),
+    m_bytes(bytes),
+    m_start(Singleton::Consume<I_TimeGet>::by<WaapComponent>()->getMonotonicTime())
+{
+}
+
+Scope::~Scope()
+{
+    std::chrono::microseconds end = Singleton::Consume<I_TimeGet>::by<WaapComponent>()->getMonotonicTime();
+    State &state = m_transaction.getInspectionBudget();
+    if (!state.consume(m_bytes, end - m_start)) return;
+
+    m_transaction.addNote(
+        std::string("inspection_budget_exhausted:") + State::reasonToString(state.getExhaustedReason())
+    );
+    InspectionBudgetEvent(state.getExhaustedReason() == ExhaustedReason::TIME, state.getScannedBytes()).notify();
+}
+
+}
+}
@@ -0,0 +1,95 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __INSPECTION_BUDGET_H__5b1c07e2
+#define __INSPECTION_BUDGET_H__5b1c07e2
+
+#include <stddef.h>
+#include <stdint.h>
+#include <chrono>
+#include <string>
+
+class IWaf2Transaction;
+
+namespace Waap {
+namespace InspectionBudget {
+
+// What to do with a request once its inspection budget is exhausted.
+// INSPECT keeps the transaction going but skips the signature scanning of the remaining parameters,
+// ACCEPT and DROP end the transaction with the respective verdict (DROP only applies in prevent mode).
+enum class ExhaustedVerdict {
+    INSPECT,
+    ACCEPT,
+    DROP
+};
+
+enum class ExhaustedReason {
+    NONE,
+    TIME,
+    BYTES
+};
+
+// Per-transaction quota on the work the scanner may spend on a single request.
+// Both the accumulated scanning time and the number of scanned bytes are tracked; a limit of 0 disables
+// that part of the budget. Limits are read from the agent settings when the transaction starts:
+//   agent.waap.inspectionBudget.maxTimeMs         - accumulated scanning time per request
+//   agent.waap.inspectionBudget.maxScannedBytes   - accumulated size of scanned parameter values
+//   agent.waap.inspectionBudget.exhaustedVerdict  - "inspect" (default), "accept" or "drop"
+// Scanning never yields to the mainloop: the transaction table context is only valid for the current routine run,
+// so large requests are bounded by exhausting the budget rather than by pausing in the middle of inspection.
+class State {
+public:
+    State();
+
+    void reset();
+    bool isEnabled() const { return m_maxTime.count() != 0 || m_maxScannedBytes != 0; }
+    bool isExhausted() const { return m_reason != ExhaustedReason::NONE; }
+    ExhaustedReason getExhaustedReason() const { return m_reason; }
+    ExhaustedVerdict getExhaustedVerdict() const { return m_verdict; }
+    // Accounts for one scanning step. Returns true only on the step that exhausted the budget.
+    bool consume(size_t bytes, std::chrono::microseconds elapsed);
+    size_t getScannedBytes() const { return m_scannedBytes; }
+    // Accounts for request data that was left unparsed because the budget was already exhausted
+    void skip(size_t bytes) { m_skippedBytes += bytes; }
+    size_t getSkippedBytes() const { return m_skippedBytes; }
+    std::chrono::microseconds getInspectionTime() const { return m_inspectionTime; }
+
+    static const char *reasonToString(ExhaustedReason reason);
+
+private:
+    std::chrono::microseconds m_maxTime;
+    size_t m_maxScannedBytes;
+    ExhaustedVerdict m_verdict;
+    std::chrono::microseconds m_inspectionTime;
+    size_t m_scannedBytes;
+    size_t m_skippedBytes;
+    ExhaustedReason m_reason;
+};
+
+// Measures the scanning step it lives in and charges it to the transaction's budget when it goes out of scope.
+// The first step that exhausts the budget is noted on the transaction and reported to telemetry.
+class Scope {
+public:
+    Scope(IWaf2Transaction &transaction, size_t bytes);
+    ~Scope();
+
+private:
+    IWaf2Transaction &m_transaction;
+    size_t m_bytes;
+    std::chrono::microseconds m_start;
+};
+
+}
+}
+
+#endif // __INSPECTION_BUDGET_H__5b1c07e2
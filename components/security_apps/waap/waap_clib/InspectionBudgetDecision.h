@@ -1,4 +1,4 @@
-// Copyright (C) 2023 Check Point Software Technologies Ltd. All rights reserved.
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
 
 // Licensed under the Apache License, Version 2.0 (the "License");
 // You may obtain a copy of the License at
@@ -11,25 +11,17 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#ifndef __JSON_STREAM_H__
-#define __JSON_STREAM_H__
+#ifndef __INSPECTION_BUDGET_DECISION_H__
+#define __INSPECTION_BUDGET_DECISION_H__
 
-#include <ostream>
+#include "SingleDecision.h"
+#include "DecisionType.h"
+#include <string>
 
-class JsonStream : public std::streambuf, public std::ostream
+class InspectionBudgetDecision: public SingleDecision
 {
 public:
-    JsonStream(std::ostream *os, bool is_pretty);
-
-private:
-    int overflow(int c) override;
-    void emplace(char c);
-    void add(char c);
-
-    std::ostream *os;
-    bool is_prev_single_backslash = false;
-    bool is_pretty;
-    bool in_string = false;
+    explicit InspectionBudgetDecision(DecisionType type);
+    std::string getTypeStr() const override;
 };
-
-#endif // __JSON_STREAM_H__
+#endif
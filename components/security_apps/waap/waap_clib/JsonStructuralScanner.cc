@@ -0,0 +1,822 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "JsonStructuralScanner.h"
+
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static const size_t JSON_BLOCK_SIZE = 64;
+// The structural index takes 4 bytes per byte of input, so it (and the buffer of decoded strings) is only kept between
+// calls while it is small.
+static const size_t MAX_KEPT_INDEX_SIZE = 64 * 1024;
+static const uint64_t EVEN_BITS = 0x5555555555555555ULL;
+
+// Bitmaps of interesting characters within one 64 bytes block (bit i represents byte i of the block)
+struct JsonBlockMasks {
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t op;
+    uint64_t space;
+    uint64_t ctrl;
+};
+
+// Whitespace as accepted by yajl lexer (note that it also accepts '\v' and '\f')
+static inline bool
+isJsonSpace(unsigned char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Anything that is not whitespace, operator or quote. Such characters following each other outside of strings
+// form a single run in stage 1 and only the first one of them is indexed.
+static inline bool
+isScalarChar(unsigned char c)
+{
+    switch (c) {
+        case '{': case '}': case '[': case ']': case ':': case ',': case '/': case '"':
+            return false;
+        default:
+            return !isJsonSpace(c);
+    }
+}
+
+static inline bool
+isHexChar(unsigned char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+static inline bool
+isEscapableChar(unsigned char c)
+{
+    return c == '"' || c == '\\' || c == '/' || c == 'b' || c == 'f' || c == 'n' || c == 'r' || c == 't';
+}
+
+#if defined(__SSE2__)
+static inline uint64_t
+toBits(__m128i cmp_result, int shift)
+{
+    return static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(cmp_result))) << shift;
+}
+
+static inline void
+classifyBlock(const unsigned char *block, JsonBlockMasks &masks)
+{
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    // '{' and '[' (as well as '}' and ']') only differ by 0x20 bit
+    const __m128i lower_bit = _mm_set1_epi8(0x20);
+    const __m128i open_bracket = _mm_set1_epi8('{');
+    const __m128i close_bracket = _mm_set1_epi8('}');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i slash = _mm_set1_epi8('/');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i space_range = _mm_set1_epi8('\r' - '\t');
+    const __m128i last_ctrl = _mm_set1_epi8(0x1f);
+
+    masks = JsonBlockMasks{0, 0, 0, 0, 0};
+    for (int i = 0; i < 4; i++) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16 * i));
+        __m128i lowered = _mm_or_si128(v, lower_bit);
+        __m128i op = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(lowered, open_bracket), _mm_cmpeq_epi8(lowered, close_bracket)),
+            _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma)),
+                _mm_cmpeq_epi8(v, slash)
+            )
+        );
+        __m128i from_tab = _mm_sub_epi8(v, tab);
+        __m128i ws = _mm_or_si128(
+            _mm_cmpeq_epi8(v, space),
+            _mm_cmpeq_epi8(_mm_min_epu8(from_tab, space_range), from_tab)
+        );
+
+        masks.quote |= toBits(_mm_cmpeq_epi8(v, quote), 16 * i);
+        masks.backslash |= toBits(_mm_cmpeq_epi8(v, backslash), 16 * i);
+        masks.op |= toBits(op, 16 * i);
+        masks.space |= toBits(ws, 16 * i);
+        masks.ctrl |= toBits(_mm_cmpeq_epi8(_mm_max_epu8(v, last_ctrl), last_ctrl), 16 * i);
+    }
+}
+#else
+static inline void
+classifyBlock(const unsigned char *block, JsonBlockMasks &masks)
+{
+    masks = JsonBlockMasks{0, 0, 0, 0, 0};
+    for (size_t i = 0; i < JSON_BLOCK_SIZE; i++) {
+        unsigned char c = block[i];
+        uint64_t bit = 1ULL << i;
+        switch (c) {
+            case '"': masks.quote |= bit; break;
+            case '\\': masks.backslash |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',': case '/': masks.op |= bit; break;
+            default: break;
+        }
+        if (isJsonSpace(c)) masks.space |= bit;
+        if (c < 0x20) masks.ctrl |= bit;
+    }
+}
+#endif
+
+// Bit i of result is set when odd number of bits are set in positions 0..i of the input
+static inline uint64_t
+prefixXor(uint64_t bits)
+{
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+// Returns characters that are escaped by preceding odd sequence of backslashes.
+// prev_escaped carries the escape state of the last character across blocks.
+static inline uint64_t
+findEscaped(uint64_t backslash, uint64_t &prev_escaped)
+{
+    backslash &= ~prev_escaped;
+    uint64_t follows_escape = (backslash << 1) | prev_escaped;
+    uint64_t odd_sequence_starts = backslash & ~EVEN_BITS & ~follows_escape;
+    unsigned long long sequences_starting_on_even_bits;
+    prev_escaped = __builtin_uaddll_overflow(odd_sequence_starts, backslash, &sequences_starting_on_even_bits);
+    uint64_t invert_mask = sequences_starting_on_even_bits << 1;
+    return (EVEN_BITS ^ invert_mask) & follows_escape;
+}
+
+static inline void
+hexToDigit(unsigned int &val, const char *hex)
+{
+    for (int i = 0; i < 4; i++) {
+        unsigned char c = hex[i];
+        if (c >= 'A') c = (c & ~0x20) - 7;
+        c -= '0';
+        val = (val << 4) | c;
+    }
+}
+
+static void
+appendUtf8(unsigned int codepoint, std::string &out)
+{
+    if (codepoint < 0x80) {
+        out.push_back(static_cast<char>(codepoint));
+    } else if (codepoint < 0x0800) {
+        out.push_back(static_cast<char>((codepoint >> 6) | 0xC0));
+        out.push_back(static_cast<char>((codepoint & 0x3F) | 0x80));
+    } else if (codepoint < 0x10000) {
+        out.push_back(static_cast<char>((codepoint >> 12) | 0xE0));
+        out.push_back(static_cast<char>(((codepoint >> 6) & 0x3F) | 0x80));
+        out.push_back(static_cast<char>((codepoint & 0x3F) | 0x80));
+    } else if (codepoint < 0x200000) {
+        out.push_back(static_cast<char>((codepoint >> 18) | 0xF0));
+        out.push_back(static_cast<char>(((codepoint >> 12) & 0x3F) | 0x80));
+        out.push_back(static_cast<char>(((codepoint >> 6) & 0x3F) | 0x80));
+        out.push_back(static_cast<char>((codepoint & 0x3F) | 0x80));
+    } else {
+        out.push_back('?');
+    }
+}
+
+// Decode escapes of an already validated string, exactly as yajl_string_decode() does (including its handling
+// of unpaired high surrogates). The string must be followed by its closing quote in memory.
+static void
+decodeString(const char *str, size_t len, std::string &out)
+{
+    size_t beg = 0;
+    size_t end = 0;
+
+    out.clear();
+    while (end < len) {
+        if (str[end] != '\\') {
+            end++;
+            continue;
+        }
+        out.append(str + beg, end - beg);
+        switch (str[++end]) {
+            case 'r': out.push_back('\r'); break;
+            case 'n': out.push_back('\n'); break;
+            case '\\': out.push_back('\\'); break;
+            case '/': out.push_back('/'); break;
+            case '"': out.push_back('"'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'b': out.push_back('\b'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u': {
+                unsigned int codepoint = 0;
+                if (len - end <= 4) {
+                    // Only possible after skipping a character following an unpaired surrogate
+                    out.push_back('?');
+                    return;
+                }
+                hexToDigit(codepoint, str + ++end);
+                end += 3;
+                if ((codepoint & 0xFC00) == 0xD800) {
+                    end++;
+                    if (end + 5 < len && str[end] == '\\' && str[end + 1] == 'u') {
+                        unsigned int surrogate = 0;
+                        hexToDigit(surrogate, str + end + 2);
+                        codepoint =
+                            (((codepoint & 0x3F) << 10) |
+                            ((((codepoint >> 6) & 0xF) + 1) << 16) |
+                            (surrogate & 0x3FF));
+                        end += 5;
+                    } else {
+                        out.push_back('?');
+                        break;
+                    }
+                }
+                appendUtf8(codepoint, out);
+                break;
+            }
+            default:
+                out.push_back('?');
+                break;
+        }
+        beg = ++end;
+    }
+    if (beg < len) out.append(str + beg, len - beg);
+}
+
+static inline int
+peekChar(const char *buf, size_t len, size_t pos, bool final)
+{
+    if (pos < len) return static_cast<unsigned char>(buf[pos]);
+    // At end of stream yajl terminates pending tokens with a single space
+    return final ? ' ' : -1;
+}
+
+// Lex a number token the same way yajl_lex_number() does. On success, end points right after the number.
+JsonStructuralScanner::lex_result
+JsonStructuralScanner::lexNumber(const char *buf, size_t len, size_t start, bool final, size_t &end)
+{
+    size_t pos = start;
+    int c = peekChar(buf, len, pos++, final);
+
+    if (c == '-') {
+        c = peekChar(buf, len, pos++, final);
+        if (c < 0) return lex_eof;
+    }
+
+    if (c == '0') {
+        c = peekChar(buf, len, pos++, final);
+        if (c < 0) return lex_eof;
+    } else if (c >= '1' && c <= '9') {
+        do {
+            c = peekChar(buf, len, pos++, final);
+            if (c < 0) return lex_eof;
+        } while (c >= '0' && c <= '9');
+    } else {
+        return lex_error;
+    }
+
+    if (c == '.') {
+        int digits = 0;
+        c = peekChar(buf, len, pos++, final);
+        if (c < 0) return lex_eof;
+        while (c >= '0' && c <= '9') {
+            digits++;
+            c = peekChar(buf, len, pos++, final);
+            if (c < 0) return lex_eof;
+        }
+        if (!digits) return lex_error;
+    }
+
+    if (c == 'e' || c == 'E') {
+        c = peekChar(buf, len, pos++, final);
+        if (c < 0) return lex_eof;
+        if (c == '+' || c == '-') {
+            c = peekChar(buf, len, pos++, final);
+            if (c < 0) return lex_eof;
+        }
+        if (c < '0' || c > '9') return lex_error;
+        do {
+            c = peekChar(buf, len, pos++, final);
+            if (c < 0) return lex_eof;
+        } while (c >= '0' && c <= '9');
+    }
+
+    // The number ends one character before the last one read
+    end = pos - 1;
+    return lex_ok;
+}
+
+JsonStructuralScanner::JsonStructuralScanner(const yajl_callbacks *callbacks, void *ctx)
+        :
+    m_callbacks(callbacks),
+    m_ctx(ctx),
+    m_stateStack(1, ps_start),
+    m_indexLen(0),
+    m_pendingType(pt_none),
+    m_stringEscape(0),
+    m_consumed(0)
+{
+}
+
+JsonStructuralScanner::status
+JsonStructuralScanner::parse(const char *buf, size_t len)
+{
+    size_t pos = 0;
+
+    m_consumed = 0;
+    if (m_stateStack.back() == ps_error) return st_error;
+
+    if (m_pendingType != pt_none) {
+        size_t end = 0;
+        lex_result result = findPendingEnd(buf, len, end);
+        if (result == lex_error) {
+            setError();
+            return st_error;
+        }
+        if (result == lex_eof) {
+            m_pending.append(buf, len);
+            m_consumed = len;
+            return st_ok;
+        }
+        m_pending.append(buf, end);
+
+        // The carried over token is now complete and is the only thing in the buffer
+        std::string token;
+        token.swap(m_pending);
+        m_pendingType = pt_none;
+        size_t consumed = 0;
+        status token_result = parseBuffer(token.data(), token.size(), true, consumed);
+        releaseLargeBuffers();
+        if (token_result != st_ok) return st_error;
+        pos = end;
+    }
+
+    // Structural index holds 32 bit offsets
+    if (len - pos > UINT32_MAX) {
+        m_consumed = pos;
+        return st_unsupported;
+    }
+
+    size_t consumed = 0;
+    status result = parseBuffer(buf + pos, len - pos, false, consumed);
+    releaseLargeBuffers();
+    m_consumed = pos + consumed;
+    return result;
+}
+
+JsonStructuralScanner::status
+JsonStructuralScanner::completeParse()
+{
+    if (m_stateStack.back() == ps_error) return st_error;
+
+    if (m_pendingType != pt_none) {
+        std::string token;
+        token.swap(m_pending);
+        bool is_string = m_pendingType == pt_string;
+        m_pendingType = pt_none;
+        size_t consumed = 0;
+        // Numbers and literals are terminated by the end of stream. Unterminated string is simply dropped,
+        // which is only fine if it follows a complete top level value (checked below) and it does not end
+        // in the middle of escape sequence.
+        if (is_string && m_stringEscape != 0) {
+            setError();
+            return st_error;
+        }
+        status token_result = is_string ? st_ok : parseBuffer(token.data(), token.size(), true, consumed);
+        releaseLargeBuffers();
+        if (token_result != st_ok) return st_error;
+    }
+
+    if (m_stateStack.size() != 1 || m_stateStack.back() != ps_got_value) {
+        setError();
+        return st_error;
+    }
+    return st_ok;
+}
+
+std::string
+JsonStructuralScanner::getYajlPrefix() const
+{
+    std::string prefix;
+    size_t top = m_stateStack.size() - 1;
+
+    for (size_t i = 0; i < m_stateStack.size(); i++) {
+        // Levels below the top one are always in "got value" state, their value being the nested container.
+        bool is_top = (i == top);
+        switch (m_stateStack[i]) {
+            case ps_got_value: if (is_top) prefix += "null"; break;
+            case ps_map_start: prefix += "{"; break;
+            case ps_map_need_key: prefix += "{\"\":null,"; break;
+            case ps_map_sep: prefix += "{\"\""; break;
+            case ps_map_need_val: prefix += "{\"\":"; break;
+            case ps_map_got_val: prefix += is_top ? "{\"\":null" : "{\"\":"; break;
+            case ps_array_start: prefix += "["; break;
+            case ps_array_need_val: prefix += "[null,"; break;
+            case ps_array_got_val: prefix += is_top ? "[null" : "["; break;
+            default: break;
+        }
+    }
+    return prefix;
+}
+
+void
+JsonStructuralScanner::releaseLargeBuffers()
+{
+    if (m_index.size() > MAX_KEPT_INDEX_SIZE) std::vector<uint32_t>().swap(m_index);
+    if (m_decodeBuf.capacity() > MAX_KEPT_INDEX_SIZE) std::string().swap(m_decodeBuf);
+}
+
+void
+JsonStructuralScanner::setError()
+{
+    m_stateStack.assign(1, ps_error);
+    m_pending.clear();
+    m_pendingType = pt_none;
+}
+
+// Find where the carried over token ends in the new chunk.
+JsonStructuralScanner::lex_result
+JsonStructuralScanner::findPendingEnd(const char *buf, size_t len, size_t &end)
+{
+    switch (m_pendingType) {
+        case pt_string:
+            return scanStringPart(buf, len, end);
+        case pt_number:
+            for (end = 0; end < len; end++) {
+                char c = buf[end];
+                if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) {
+                    return lex_ok;
+                }
+            }
+            return lex_eof;
+        case pt_literal:
+            for (end = 0; end < len; end++) {
+                if (buf[end] < 'a' || buf[end] > 'z') return lex_ok;
+            }
+            return lex_eof;
+        default:
+            end = 0;
+            return lex_ok;
+    }
+}
+
+// Validate part of a string that is cut by chunk boundaries and look for its closing quote.
+// Escape sequence state is kept in m_stringEscape between calls: 0 - none, 1 - after backslash,
+// 2..5 - expecting the hex digits of "\u" escape.
+JsonStructuralScanner::lex_result
+JsonStructuralScanner::scanStringPart(const char *buf, size_t len, size_t &end)
+{
+    for (end = 0; end < len; end++) {
+        unsigned char c = buf[end];
+        if (m_stringEscape == 0) {
+            if (c == '"') {
+                end++;
+                return lex_ok;
+            }
+            if (c == '\\') {
+                m_stringEscape = 1;
+            } else if (c < 0x20) {
+                return lex_error;
+            }
+        } else if (m_stringEscape == 1) {
+            if (c == 'u') {
+                m_stringEscape = 2;
+            } else if (isEscapableChar(c)) {
+                m_stringEscape = 0;
+            } else {
+                return lex_error;
+            }
+        } else {
+            if (!isHexChar(c)) return lex_error;
+            m_stringEscape = (m_stringEscape == 5) ? 0 : m_stringEscape + 1;
+        }
+    }
+    return lex_eof;
+}
+
+// Stage 1: index of unescaped quotes, operators outside of strings, escape sequences and control characters
+// inside of strings, and first characters of everything else outside of strings (numbers, literals or garbage).
+// The buffer always starts outside of a string.
+void
+JsonStructuralScanner::buildIndex(const char *buf, size_t len)
+{
+    if (m_index.size() < len) m_index.resize(len);
+
+    uint32_t *out = m_index.data();
+    uint64_t prev_escaped = 0;
+    uint64_t prev_in_string = 0;
+    uint64_t prev_scalar = 0;
+    unsigned char tail[JSON_BLOCK_SIZE];
+
+    for (size_t base = 0; base < len; base += JSON_BLOCK_SIZE) {
+        const unsigned char *block = reinterpret_cast<const unsigned char *>(buf) + base;
+        uint64_t valid = ~0ULL;
+        if (len - base < JSON_BLOCK_SIZE) {
+            memset(tail, ' ', sizeof(tail));
+            memcpy(tail, block, len - base);
+            block = tail;
+            valid = (1ULL << (len - base)) - 1;
+        }
+
+        JsonBlockMasks masks;
+        classifyBlock(block, masks);
+
+        uint64_t escaped = findEscaped(masks.backslash, prev_escaped);
+        uint64_t quote = masks.quote & ~escaped;
+        uint64_t in_string = prefixXor(quote) ^ prev_in_string;
+        prev_in_string = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+
+        uint64_t string_body = in_string & ~quote;
+        uint64_t outside = ~(in_string | quote);
+        uint64_t scalar = outside & ~(masks.op | masks.space);
+        uint64_t scalar_start = scalar & ~((scalar << 1) | prev_scalar);
+        prev_scalar = scalar >> 63;
+
+        uint64_t structurals =
+            quote |
+            (masks.op & outside) |
+            scalar_start |
+            (string_body & ((masks.backslash & ~escaped) | masks.ctrl));
+        structurals &= valid;
+
+        while (structurals) {
+            *out++ = static_cast<uint32_t>(base + __builtin_ctzll(structurals));
+            structurals &= structurals - 1;
+        }
+    }
+
+    m_indexLen = out - m_index.data();
+}
+
+// Stage 2: walk the structural index and emit tokens.
+// When final is false, token that is cut by the end of buffer is saved in m_pending.
+JsonStructuralScanner::status
+JsonStructuralScanner::parseBuffer(const char *buf, size_t len, bool final, size_t &consumed)
+{
+    buildIndex(buf, len);
+
+    const uint32_t *index = m_index.data();
+    size_t index_len = m_indexLen;
+    size_t k = 0;
+    // Number or literal can be immediately followed by another token that is not indexed (e.g. "0123" is lexed
+    // by yajl as two numbers), in which case it is processed next.
+    size_t glued = std::string::npos;
+
+    consumed = len;
+    for (;;) {
+        size_t start;
+        if (glued != std::string::npos) {
+            start = glued;
+            glued = std::string::npos;
+        } else if (k < index_len) {
+            start = index[k++];
+        } else {
+            return st_ok;
+        }
+
+        bool ok = true;
+        switch (buf[start]) {
+            case '{':
+                ok = onToken(tok_left_bracket, nullptr, 0);
+                break;
+            case '}':
+                ok = onToken(tok_right_bracket, nullptr, 0);
+                break;
+            case '[':
+                ok = onToken(tok_left_brace, nullptr, 0);
+                break;
+            case ']':
+                ok = onToken(tok_right_brace, nullptr, 0);
+                break;
+            case ',':
+                ok = onToken(tok_comma, nullptr, 0);
+                break;
+            case ':':
+                ok = onToken(tok_colon, nullptr, 0);
+                break;
+            case '"': {
+                // Only escapes, control characters and the closing quote are indexed inside of string
+                bool has_escapes = false;
+                bool complete = false;
+                size_t end = 0;
+                for (; k < index_len; k++) {
+                    size_t special = index[k];
+                    unsigned char c = buf[special];
+                    if (c == '"') {
+                        end = special;
+                        complete = true;
+                        k++;
+                        break;
+                    }
+                    if (c != '\\') {
+                        // control character inside of string
+                        setError();
+                        return st_error;
+                    }
+                    has_escapes = true;
+                    if (special + 1 >= len) break;
+                    if (buf[special + 1] == 'u') {
+                        size_t hex = special + 2;
+                        for (; hex < special + 6 && hex < len; hex++) {
+                            if (!isHexChar(buf[hex])) {
+                                setError();
+                                return st_error;
+                            }
+                        }
+                        if (hex < special + 6) break;
+                    } else if (!isEscapableChar(buf[special + 1])) {
+                        setError();
+                        return st_error;
+                    }
+                }
+
+                if (!complete) {
+                    size_t end;
+                    m_stringEscape = 0;
+                    // The part we have was validated up to its last (possibly incomplete) escape sequence.
+                    // Rescan it to know where that escape sequence stands.
+                    if (final || scanStringPart(buf + start + 1, len - start - 1, end) != lex_eof) {
+                        setError();
+                        return st_error;
+                    }
+                    m_pending.assign(buf + start, len - start);
+                    m_pendingType = pt_string;
+                    return st_ok;
+                }
+
+                ok = onToken(tok_string, buf + start + 1, end - start - 1, has_escapes);
+                break;
+            }
+            case 't':
+            case 'f':
+            case 'n': {
+                const char *literal = buf[start] == 't' ? "true" : (buf[start] == 'f' ? "false" : "null");
+                size_t literal_len = buf[start] == 'f' ? 5 : 4;
+                size_t i = 1;
+                for (; i < literal_len && start + i < len; i++) {
+                    if (buf[start + i] != literal[i]) {
+                        setError();
+                        return st_error;
+                    }
+                }
+                if (i < literal_len) {
+                    if (final) {
+                        setError();
+                        return st_error;
+                    }
+                    m_pending.assign(buf + start, len - start);
+                    m_pendingType = pt_literal;
+                    return st_ok;
+                }
+                ok = onToken(buf[start] == 'n' ? tok_null : tok_bool, buf + start, literal_len);
+                if (start + literal_len < len && isScalarChar(buf[start + literal_len])) glued = start + literal_len;
+                break;
+            }
+            case '-':
+            case '0': case '1': case '2': case '3': case '4':
+            case '5': case '6': case '7': case '8': case '9': {
+                size_t end = 0;
+                lex_result result = lexNumber(buf, len, start, final, end);
+                if (result == lex_error) {
+                    setError();
+                    return st_error;
+                }
+                if (result == lex_eof) {
+                    m_pending.assign(buf + start, len - start);
+                    m_pendingType = pt_number;
+                    return st_ok;
+                }
+                ok = onToken(tok_number, buf + start, end - start);
+                if (end < len && isScalarChar(buf[end])) glued = end;
+                break;
+            }
+            case '/':
+                // Comment - let yajl continue from here
+                consumed = start;
+                return st_unsupported;
+            default:
+                setError();
+                return st_error;
+        }
+
+        if (!ok) {
+            setError();
+            return st_error;
+        }
+    }
+}
+
+bool
+JsonStructuralScanner::onString(const char *s, size_t slen, bool has_escapes, bool is_key)
+{
+    auto callback = is_key ? m_callbacks->yajl_map_key : m_callbacks->yajl_string;
+    if (callback == nullptr) return true;
+
+    if (has_escapes) {
+        decodeString(s, slen, m_decodeBuf);
+        s = m_decodeBuf.data();
+        slen = m_decodeBuf.size();
+    }
+    return callback(m_ctx, reinterpret_cast<const unsigned char *>(s), slen) != 0;
+}
+
+// Parser state machine, transitions are the same as in yajl_do_parse()
+bool
+JsonStructuralScanner::onToken(token tok, const char *s, size_t slen, bool has_escapes)
+{
+    uint8_t state = m_stateStack.back();
+
+    switch (state) {
+        case ps_start:
+        case ps_got_value:
+        case ps_map_need_val:
+        case ps_array_need_val:
+        case ps_array_start: {
+            parse_state state_to_push = ps_start;
+            switch (tok) {
+                case tok_string:
+                    if (!onString(s, slen, has_escapes, false)) return false;
+                    break;
+                case tok_number:
+                    if (m_callbacks->yajl_number && !m_callbacks->yajl_number(m_ctx, s, slen)) return false;
+                    break;
+                case tok_bool:
+                    if (m_callbacks->yajl_boolean && !m_callbacks->yajl_boolean(m_ctx, *s == 't')) return false;
+                    break;
+                case tok_null:
+                    if (m_callbacks->yajl_null && !m_callbacks->yajl_null(m_ctx)) return false;
+                    break;
+                case tok_left_bracket:
+                    if (m_callbacks->yajl_start_map && !m_callbacks->yajl_start_map(m_ctx)) return false;
+                    state_to_push = ps_map_start;
+                    break;
+                case tok_left_brace:
+                    if (m_callbacks->yajl_start_array && !m_callbacks->yajl_start_array(m_ctx)) return false;
+                    state_to_push = ps_array_start;
+                    break;
+                case tok_right_brace:
+                    if (state != ps_array_start) return false;
+                    if (m_callbacks->yajl_end_array && !m_callbacks->yajl_end_array(m_ctx)) return false;
+                    m_stateStack.pop_back();
+                    return true;
+                default:
+                    return false;
+            }
+
+            if (state == ps_start || state == ps_got_value) {
+                m_stateStack.back() = ps_got_value;
+            } else if (state == ps_map_need_val) {
+                m_stateStack.back() = ps_map_got_val;
+            } else {
+                m_stateStack.back() = ps_array_got_val;
+            }
+            if (state_to_push != ps_start) m_stateStack.push_back(state_to_push);
+            return true;
+        }
+        case ps_map_start:
+        case ps_map_need_key:
+            if (tok == tok_string) {
+                if (!onString(s, slen, has_escapes, true)) return false;
+                m_stateStack.back() = ps_map_sep;
+                return true;
+            }
+            if (tok != tok_right_bracket || state != ps_map_start) return false;
+            if (m_callbacks->yajl_end_map && !m_callbacks->yajl_end_map(m_ctx)) return false;
+            m_stateStack.pop_back();
+            return true;
+        case ps_map_sep:
+            if (tok != tok_colon) return false;
+            m_stateStack.back() = ps_map_need_val;
+            return true;
+        case ps_map_got_val:
+            if (tok == tok_comma) {
+                m_stateStack.back() = ps_map_need_key;
+                return true;
+            }
+            if (tok != tok_right_bracket) return false;
+            if (m_callbacks->yajl_end_map && !m_callbacks->yajl_end_map(m_ctx)) return false;
+            m_stateStack.pop_back();
+            return true;
+        case ps_array_got_val:
+            if (tok == tok_comma) {
+                m_stateStack.back() = ps_array_need_val;
+                return true;
+            }
+            if (tok != tok_right_brace) return false;
+            if (m_callbacks->yajl_end_array && !m_callbacks->yajl_end_array(m_ctx)) return false;
+            m_stateStack.pop_back();
+            return true;
+        default:
+            return false;
+    }
+}
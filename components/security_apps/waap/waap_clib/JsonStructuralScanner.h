@@ -0,0 +1,113 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __JSON_STRUCTURAL_SCANNER_H__3d7e90c4
+#define __JSON_STRUCTURAL_SCANNER_H__3d7e90c4
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "yajl/yajl_parse.h"
+
+// Streaming JSON tokenizer that drives the same yajl_callbacks, in the same order, as yajl configured with
+// yajl_allow_comments, yajl_allow_multiple_values and yajl_dont_validate_strings does.
+// It works in two stages (the simdjson approach): stage 1 classifies the input 64 bytes at a time (using SSE2
+// when available) and builds an index of structural positions - unescaped quotes, operators outside of strings,
+// escapes and control characters inside strings and the first byte of every number/literal.
+// Stage 2 walks that index, so string contents and whitespace are never looked at byte by byte.
+// A token that is cut by the end of a chunk is carried over and completed by the next parse() call.
+// Comments are not handled: parse() returns st_unsupported and the caller is expected to continue the stream
+// with yajl, after priming it with getYajlPrefix().
+class JsonStructuralScanner {
+public:
+    enum status {
+        st_ok,
+        st_error,
+        st_unsupported
+    };
+
+    JsonStructuralScanner(const yajl_callbacks *callbacks, void *ctx);
+    status parse(const char *buf, size_t len);
+    status completeParse();
+    // On st_unsupported: number of bytes of the last parse() buffer that were consumed.
+    size_t bytesConsumed() const { return m_consumed; }
+    // JSON text that brings a fresh yajl handle to the scanner's current parsing state.
+    std::string getYajlPrefix() const;
+
+private:
+    enum parse_state {
+        ps_start,
+        ps_got_value,
+        ps_map_start,
+        ps_map_need_key,
+        ps_map_sep,
+        ps_map_need_val,
+        ps_map_got_val,
+        ps_array_start,
+        ps_array_need_val,
+        ps_array_got_val,
+        ps_error
+    };
+
+    enum token {
+        tok_left_bracket,
+        tok_right_bracket,
+        tok_left_brace,
+        tok_right_brace,
+        tok_comma,
+        tok_colon,
+        tok_string,
+        tok_number,
+        tok_bool,
+        tok_null
+    };
+
+    enum lex_result {
+        lex_ok,
+        lex_eof,
+        lex_error
+    };
+
+    enum pending_token {
+        pt_none,
+        pt_string,
+        pt_number,
+        pt_literal
+    };
+
+    static lex_result lexNumber(const char *buf, size_t len, size_t start, bool final, size_t &end);
+    status parseBuffer(const char *buf, size_t len, bool final, size_t &consumed);
+    void buildIndex(const char *buf, size_t len);
+    bool onToken(token tok, const char *s, size_t slen, bool has_escapes = false);
+    bool onString(const char *s, size_t slen, bool has_escapes, bool is_key);
+    lex_result findPendingEnd(const char *buf, size_t len, size_t &end);
+    lex_result scanStringPart(const char *buf, size_t len, size_t &end);
+    void setError();
+    void releaseLargeBuffers();
+
+    const yajl_callbacks *m_callbacks;
+    void *m_ctx;
+    std::vector<uint8_t> m_stateStack;
+    // Offsets of the structural characters of the buffer being parsed, released after large buffers.
+    std::vector<uint32_t> m_index;
+    size_t m_indexLen;
+    std::string m_pending;
+    pending_token m_pendingType;
+    uint8_t m_stringEscape;
+    std::string m_decodeBuf;
+    size_t m_consumed;
+};
+
+#endif // __JSON_STRUCTURAL_SCANNER_H__3d7e90c4
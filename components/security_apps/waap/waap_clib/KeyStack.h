@@ -30,7 +30,12 @@ public:
     void clear() { m_key.clear(); m_stack.clear(); }
     size_t depth() const { return m_nameDepth; }
     size_t size() const {
-        return str().size();
+        // Same as str().size(), without building the string
+        if (m_stack.size() <= 1 || m_stack[1] + 1 >= m_key.size()) {
+            return 0;
+        }
+
+        return m_key.size() - m_stack[1] - 1;
     }
     const char *c_str() const {
         // If pushed none - return empty string.
@@ -193,6 +193,20 @@ ParserJson::cb_end_array()
     return 1;
 }
 
+const yajl_callbacks ParserJson::m_callbacks = {
+    p_null,
+    p_boolean,
+    NULL,
+    NULL,
+    p_number,
+    p_string,
+    p_start_map,
+    p_map_key,
+    p_end_map,
+    p_start_array,
+    p_end_array
+};
+
 // Static functions to be called from C and forward the calls to respective class cb_* methods
 int
 ParserJson::p_null(void *ctx)
@@ -260,6 +274,7 @@ ParserJson::ParserJson(
     m_state(s_start),
     m_bufLen(0),
     m_key("json_parser"),
+    m_scanner(&m_callbacks, this),
     m_jsonHandler(NULL),
     is_map_empty(false),
     m_pTransaction(pTransaction),
@@ -272,32 +287,7 @@ ParserJson::ParserJson(
     // TODO:: do we really want to clear this?
     memset(m_buf, 0, sizeof(m_buf));
 
-    static const yajl_callbacks callbacks = {
-        p_null,
-        p_boolean,
-        NULL,
-        NULL,
-        p_number,
-        p_string,
-        p_start_map,
-        p_map_key,
-        p_end_map,
-        p_start_array,
-        p_end_array
-    };
-
-    m_jsonHandler = yajl_alloc(&callbacks, NULL, this);
-    
-    if (m_jsonHandler == NULL) {
-        dbgTrace(D_WAAP_PARSER_JSON) << "ParserJson::ParserJson(): yajl_alloc() failed. Switching to s_error state.";
-        m_state = s_error;
-        return;
-    }
-
-    // Configure yajl parser
-    yajl_config(m_jsonHandler, yajl_allow_comments, 1);
-    yajl_config(m_jsonHandler, yajl_dont_validate_strings, 1); // disable utf8 checking
-    yajl_config(m_jsonHandler, yajl_allow_multiple_values, 1);
+    memset(&m_yajlCallbacks, 0, sizeof(m_yajlCallbacks));
 
     // Ugly: push first element into key (it will be ignored since we will never call the "first()"
     // method of this key within Json parser object.
@@ -324,8 +314,12 @@ ParserJson::push(const char *buf, size_t len)
     if (len == 0) {
         dbgTrace(D_WAAP_PARSER_JSON) << "ParserJson::push(): end of data signal! m_state=" << m_state;
         // TODO:: think - should I send existing data in buffer to yajl_parse() here?
-        // Tell yajl that there's end of stream here
-        if (yajl_complete_parse(m_jsonHandler) != yajl_status_ok) {
+        // Tell the tokenizer that there's end of stream here
+        if (m_jsonHandler) {
+            if (yajl_complete_parse(m_jsonHandler) != yajl_status_ok) {
+                m_state = s_error;
+            }
+        } else if (m_scanner.completeParse() != JsonStructuralScanner::st_ok) {
             m_state = s_error;
         }
 
@@ -381,13 +375,13 @@ ParserJson::push(const char *buf, size_t len)
                     << "'";
             if (m_bufLen > 0) {
                 // Send accumulated bytes (if any)
-                if (yajl_parse(m_jsonHandler, (unsigned char*)m_buf, m_bufLen) != yajl_status_ok) {
+                if (!parseChunk(m_buf, m_bufLen)) {
                     m_state = s_error;
                 }
                 // And reset buffer (so it's only get sent once)
                 m_bufLen = 0;
             }
-            if (yajl_parse(m_jsonHandler, (unsigned char*)(buf + i), len - i) != yajl_status_ok) {
+            if (!parseChunk(buf + i, len - i)) {
                 m_state = s_error;
             }
             // success (whole buffer consumed)
@@ -405,6 +399,57 @@ ParserJson::push(const char *buf, size_t len)
     return len;
 }
 
+bool
+ParserJson::parseChunk(const char *buf, size_t len)
+{
+    if (m_jsonHandler) {
+        return yajl_parse(m_jsonHandler, (const unsigned char *)buf, len) == yajl_status_ok;
+    }
+
+    switch (m_scanner.parse(buf, len)) {
+        case JsonStructuralScanner::st_ok:
+            return true;
+        case JsonStructuralScanner::st_error:
+            return false;
+        case JsonStructuralScanner::st_unsupported:
+            break;
+    }
+
+    size_t consumed = m_scanner.bytesConsumed();
+    dbgTrace(D_WAAP_PARSER_JSON) << "ParserJson::parseChunk(): continuing with yajl at offset " << consumed;
+    if (!switchToYajl()) {
+        return false;
+    }
+    return yajl_parse(m_jsonHandler, (const unsigned char *)(buf + consumed), len - consumed) == yajl_status_ok;
+}
+
+// Allocate yajl parser and bring it to the state of the structural scanner.
+// The scanner state is replayed as JSON text while callbacks are still disabled (m_yajlCallbacks is zeroed).
+bool
+ParserJson::switchToYajl()
+{
+    m_jsonHandler = yajl_alloc(&m_yajlCallbacks, NULL, this);
+
+    if (m_jsonHandler == NULL) {
+        dbgTrace(D_WAAP_PARSER_JSON) << "ParserJson::switchToYajl(): yajl_alloc() failed";
+        return false;
+    }
+
+    // Configure yajl parser
+    yajl_config(m_jsonHandler, yajl_allow_comments, 1);
+    yajl_config(m_jsonHandler, yajl_dont_validate_strings, 1); // disable utf8 checking
+    yajl_config(m_jsonHandler, yajl_allow_multiple_values, 1);
+
+    std::string prefix = m_scanner.getYajlPrefix();
+    if (yajl_parse(m_jsonHandler, (const unsigned char *)prefix.data(), prefix.size()) != yajl_status_ok) {
+        dbgTrace(D_WAAP_PARSER_JSON) << "ParserJson::switchToYajl(): failed to replay parser state: " << prefix;
+        return false;
+    }
+
+    m_yajlCallbacks = m_callbacks;
+    return true;
+}
+
 void
 ParserJson::finish()
 {
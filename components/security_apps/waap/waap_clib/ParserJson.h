@@ -19,6 +19,7 @@
 
 #include "ParserBase.h"
 #include "KeyStack.h"
+#include "JsonStructuralScanner.h"
 #include "yajl/yajl_parse.h"
 #include "singleton.h"
 #include "i_oa_schema_updater.h"
@@ -45,6 +46,9 @@ public:
     bool error() const;
     virtual size_t depth() { return (m_key.depth() > 0) ? m_key.depth()-1 : m_key.depth(); }
 private:
+    bool parseChunk(const char *data, size_t data_len);
+    bool switchToYajl();
+
     int cb_null();
     int cb_boolean(int boolean);
     int cb_number(const char *s, yajl_size_t slen);
@@ -66,6 +70,8 @@ private:
     static int p_start_array(void *ctx);
     static int p_end_array(void *ctx);
 
+    static const yajl_callbacks m_callbacks;
+
     enum state {
         s_start,
         s_accumulate_first_bytes,
@@ -89,6 +95,10 @@ private:
     // Key and structure depth stacks
     KeyStack m_key;
     std::vector<enum js_state> m_depthStack;
+    // JSON text is tokenized by m_scanner, unless it stumbles on input it does not support (comments),
+    // in which case the rest of the stream is handed over to yajl (m_jsonHandler is allocated only then).
+    JsonStructuralScanner m_scanner;
+    yajl_callbacks m_yajlCallbacks;
     yajl_handle m_jsonHandler;
     bool is_map_empty;
     bool should_collect_for_oa_schema_updater;
@@ -319,3 +319,14 @@ AssetsMetric::upon(const AssetCountEvent &event)
         }
     }
 }
+
+void
+InspectionBudgetMetric::upon(const InspectionBudgetEvent &event)
+{
+    if (event.isExhaustedByTime()) {
+        exhausted_by_time.report(1);
+    } else {
+        exhausted_by_bytes.report(1);
+    }
+    max_scanned_bytes.report(event.getScannedBytes());
+}
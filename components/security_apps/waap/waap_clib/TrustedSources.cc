@@ -75,22 +75,43 @@ std::set<Waap::TrustedSources::TrustedSourceType> Waap::TrustedSources::TrustedS
 
 bool SourcesIdentifers::isCidrMatch(const std::string &source, const TrustedSourceType &trustedSourceType) const
 {
-    auto found = m_identifiersMap.find(trustedSourceType);
-    if (found == m_identifiersMap.end())
+    auto found = m_cidrSets.find(trustedSourceType);
+    if (found == m_cidrSets.end())
+    {
+        return false;
+    }
+    Maybe<IPAddr> sourceIp = IPAddr::createIPAddr(source);
+    if (!sourceIp.ok() || !found->second.contains(sourceIp.unpack()))
     {
         return false;
     }
-    const std::vector<std::string>& cidrs = found->second;
-    for (auto cidr : cidrs)
+    dbgTrace(D_WAAP) << "source: " << source << " is trusted for type: " << trustedSourceType;
+    return true;
+}
+
+void SourcesIdentifers::compileCidrs()
+{
+    m_cidrSets.clear();
+    for (TrustedSourceType type : { SOURCE_IP, X_FORWARDED_FOR })
     {
-        if (Waap::Util::cidrMatch(source, cidr))
+        auto found = m_identifiersMap.find(type);
+        if (found == m_identifiersMap.end())
         {
-            dbgTrace(D_WAAP) << "source: " << source << " is trusted for type: " << trustedSourceType <<
-                ", cidr: " << cidr;
-            return true;
+            continue;
+        }
+        std::vector<IPRange> ranges;
+        for (const std::string &cidr : found->second)
+        {
+            auto range = IPUtilities::createRangeFromString<IPRange, IpAddress>(cidr, "ip address");
+            if (!range.ok())
+            {
+                dbgDebug(D_WAAP) << "failed to parse trusted source: " << cidr << ", error: " << range.getErr();
+                continue;
+            }
+            ranges.push_back(range.unpack());
         }
+        m_cidrSets[type] = IPUtilities::IpRangeSet(ranges);
     }
-    return false;
 }
 
 bool SourcesIdentifers::isRegexMatch(const std::string &source, const TrustedSourceType& type) const
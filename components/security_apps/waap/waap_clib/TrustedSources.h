@@ -17,6 +17,7 @@
 #include <cereal/types/vector.hpp>
 #include <cereal/types/map.hpp>
 #include "debug.h"
+#include "ip_utilities.h"
 
 USE_DEBUG_FLAG(D_WAAP);
 
@@ -71,6 +72,7 @@ namespace Waap {
                         m_trustedTypes.insert(identifier.identitySource);
                     }
                 }
+                compileCidrs();
             }
 
             bool isCidrMatch(const std::string &source, const TrustedSourceType &type) const;
@@ -80,7 +82,11 @@ namespace Waap {
 
             inline bool operator!=(const SourcesIdentifers& other) const;
         private:
+            void compileCidrs();
+
             std::map<TrustedSourceType, std::vector<std::string>> m_identifiersMap;
+            // The CIDRs of the IP based identifiers, parsed once when the policy is loaded.
+            std::map<TrustedSourceType, IPUtilities::IpRangeSet> m_cidrSets;
             std::set<TrustedSourceType> m_trustedTypes;
             size_t m_minSources;
         };
@@ -21,7 +21,7 @@
 #include "agent_core_utilities.h"
 #include <algorithm>
 #include <fstream>
-#include <boost/regex.hpp>
+#include <unordered_set>
 
 #define MAX_CACHE_VALUE_SIZE 1024
 
@@ -85,7 +85,7 @@ static const SingleRegex evasion_hex_regex(
     err_hex,
     "evasion_hex_regex");
 static const std::string bad_hex_regex_helper = "(%[cC]1%(([19][cC])|([pP][cC])|(8[sS])))";
-static const boost::regex bad_hex_regex(bad_hex_regex_helper);
+static const Regex bad_hex_regex(bad_hex_regex_helper, err_hex, "bad_hex");
 static const SingleRegex evasion_bad_hex_regex(
     bad_hex_regex_helper + path_traversal_chars_regex +
     "|" + path_traversal_chars_regex + bad_hex_regex_helper,
@@ -98,14 +98,15 @@ static const SingleRegex utf_evasion_for_dot(
     "|" + path_traversal_chars_regex + utf_evasion_for_dot_helper,
     err_hex,
     "utf_evasion_for_dot");
-static const boost::regex utf_evasion_for_dot_regex(utf_evasion_for_dot_helper);
+static const Regex utf_evasion_for_dot_regex(utf_evasion_for_dot_helper, err_hex, "utf_evasion_for_dot_sub");
 static const std::string sqli_comma_evasion_regex_helper = "\"\\s*,\\s*\"";
-static const boost::regex sqli_comma_evasion_regex(sqli_comma_evasion_regex_helper);
+static const Regex sqli_comma_evasion_regex(sqli_comma_evasion_regex_helper, err_hex, "sqli_comma_evasion");
 
 WaapAssetState::WaapAssetState(const std::shared_ptr<WaapAssetState>& pWaapAssetState,
     const std::string& waapDataFileName,
     const std::string& id) :
     WaapAssetState(pWaapAssetState->m_Signatures,
+        pWaapAssetState->m_typeValidator,
         waapDataFileName,
         pWaapAssetState->m_cleanValuesCache.capacity(),
         pWaapAssetState->m_suspiciousValuesCache.capacity(),
@@ -114,7 +115,6 @@ WaapAssetState::WaapAssetState(const std::shared_ptr<WaapAssetState>& pWaapAsset
 {
     scoreBuilder.mergeScores(pWaapAssetState->scoreBuilder);
     updateScores();
-    m_typeValidator = pWaapAssetState->m_typeValidator;
 
     registerConfigLoadCb(
     [this]()
@@ -127,6 +127,23 @@ WaapAssetState::WaapAssetState(const std::shared_ptr<WaapAssetState>& pWaapAsset
 }
 
 WaapAssetState::WaapAssetState(std::shared_ptr<Signatures> signatures,
+    const std::string& waapDataFileName,
+    size_t cleanValuesCacheCapacity,
+    size_t suspiciousValuesCacheCapacity,
+    size_t sampleTypeCacheCapacity,
+    const std::string& assetId) :
+    WaapAssetState(signatures,
+        nullptr,
+        waapDataFileName,
+        cleanValuesCacheCapacity,
+        suspiciousValuesCacheCapacity,
+        sampleTypeCacheCapacity,
+        assetId)
+{
+}
+
+WaapAssetState::WaapAssetState(std::shared_ptr<Signatures> signatures,
+    std::shared_ptr<const KeywordTypeValidator> typeValidator,
     const std::string& waapDataFileName,
     size_t cleanValuesCacheCapacity,
     size_t suspiciousValuesCacheCapacity,
@@ -142,11 +159,15 @@ WaapAssetState::WaapAssetState(std::shared_ptr<Signatures> signatures,
 
 
     m_filtersMngr(nullptr),
-    m_typeValidator(getWaapDataDir() + "/waap.data"),
+    m_typeValidator(typeValidator),
     m_cleanValuesCache(cleanValuesCacheCapacity),
     m_suspiciousValuesCache(suspiciousValuesCacheCapacity),
     m_sampleTypeCache(sampleTypeCacheCapacity)
     {
+        if (!m_typeValidator)
+        {
+            m_typeValidator = std::make_shared<const KeywordTypeValidator>(getWaapDataDir() + "/waap.data");
+        }
         if (assetId != "" && Singleton::exists<I_AgentDetails>())
         {
             I_AgentDetails* agentDetails = Singleton::Consume<I_AgentDetails>::by<WaapComponent>();
@@ -421,59 +442,94 @@ WaapAssetState::WaapAssetState(std::shared_ptr<Signatures> signatures,
         std::string text = s;
         dbgTrace(D_WAAP_SAMPLE_PREPROCESS) << "unescape: (0) '" << text << "'";
 
-        fixBreakingSpace(text);
-        // 1. remove all unicode characters from string. Basically,
-        // remove all characters whose ASCII code is >=128.
-        // Python equivalent: text.encode('ascii',errors='ignore')
-        filterUnicode(text);
+        // Each pass below only runs when characters it decodes are present in the text (for clean ASCII text
+        // none of them runs). The escapes mask is refreshed after every pass that ran, since decoded
+        // characters may start new escape sequences.
+        unsigned int escapes = findEscapeChars(text);
+
+        if (escapes & ESCAPE_CHARS_NON_ASCII) {
+            fixBreakingSpace(text);
+            // 1. remove all unicode characters from string. Basically,
+            // remove all characters whose ASCII code is >=128.
+            // Python equivalent: text.encode('ascii',errors='ignore')
+            filterUnicode(text);
+            escapes = findEscapeChars(text);
+        }
         dbgTrace(D_WAAP_SAMPLE_PREPROCESS) << "unescape: (1) '" << text << "'";
 
-        text = filterUTF7(text);
+        if (escapes & ESCAPE_CHARS_PLUS) {
+            text = filterUTF7(text);
+            escapes = findEscapeChars(text);
+        }
         dbgTrace(D_WAAP_SAMPLE_PREPROCESS) << "unescape: (1) (after filterUTF7) '" << text << "'";
 
         // 2. Replace %xx sequences by their single-character equivalents.
         // Also replaces '+' symbol by space character.
         // Python equivalent: text = urllib.unquote_plus(text)
-        text.erase(unquote_plus(text.begin(), text.end()), text.end());
+        if (escapes & (ESCAPE_CHARS_PERCENT | ESCAPE_CHARS_PLUS)) {
+            text.erase(unquote_plus(text.begin(), text.end()), text.end());
+            escapes = findEscapeChars(text);
+        }
         dbgTrace(D_WAAP_SAMPLE_PREPROCESS) << "unescape: (2) '" << text << "'";
 
-        fixBreakingSpace(text);
+        if (escapes & ESCAPE_CHARS_NON_ASCII) {
+            fixBreakingSpace(text);
 
-        // 3. remove all unicode characters from string. Basically,
-        // remove all characters whose ASCII code is >=128.
-        // Python equivalent: text.encode('ascii',errors='ignore')
-        filterUnicode(text);
+            // 3. remove all unicode characters from string. Basically,
+            // remove all characters whose ASCII code is >=128.
+            // Python equivalent: text.encode('ascii',errors='ignore')
+            filterUnicode(text);
+            escapes = findEscapeChars(text);
+        }
         dbgTrace(D_WAAP_SAMPLE_PREPROCESS) << "unescape: (3) '" << text << "'";
 
         // 4. oh shi?... should I handle unicode html entities (python's htmlentitydefs module)???
         // Python equivalent: text = HTMLParser.HTMLParser().unescape(text)
-        text.erase(escape_html(text.begin(), text.end()), text.end());
+        if (escapes & ESCAPE_CHARS_AMPERSAND) {
+            text.erase(escape_html(text.begin(), text.end()), text.end());
+            escapes = findEscapeChars(text);
+        }
         dbgTrace(D_WAAP_SAMPLE_PREPROCESS) << "unescape: (4) '" << text << "'";
 
         // 5. Apply backslash escaping (like in C)
         // Python equivalent: text = text.decode('string_escape')
-        text.erase(escape_backslashes(text.begin(), text.end()), text.end());
+        if (escapes & ESCAPE_CHARS_BACKSLASH) {
+            text.erase(escape_backslashes(text.begin(), text.end()), text.end());
+            escapes = findEscapeChars(text);
+        }
         dbgTrace(D_WAAP_SAMPLE_PREPROCESS) << "unescape: (5) '" << text << "'";
 
         // 6. remove all unicode characters from string. Basically,
         // remove all characters whose ASCII code is >=128.
         // Python equivalent: text.encode('ascii',errors='ignore')
-        filterUnicode(text);
+        if (escapes & ESCAPE_CHARS_NON_ASCII) {
+            filterUnicode(text);
+            escapes = findEscapeChars(text);
+        }
         dbgTrace(D_WAAP_SAMPLE_PREPROCESS) << "unescape: (6) '" << text << "'";
 
         // 7. Replace %xx sequences by their single-character equivalents.
         // Also replaces '+' symbol by space character.
         // Python equivalent: text = urllib.unquote_plus(text)
-        text.erase(unquote_plus(text.begin(), text.end()), text.end());
+        if (escapes & (ESCAPE_CHARS_PERCENT | ESCAPE_CHARS_PLUS)) {
+            text.erase(unquote_plus(text.begin(), text.end()), text.end());
+            escapes = findEscapeChars(text);
+        }
         dbgTrace(D_WAAP_SAMPLE_PREPROCESS) << "unescape: (7) '" << text << "'";
 
-        unescapeUnicode(text);
+        if (escapes & ESCAPE_CHARS_BACKSLASH) {
+            unescapeUnicode(text);
+            escapes = findEscapeChars(text);
+        }
         dbgTrace(D_WAAP_SAMPLE_PREPROCESS) << "after unescapeUnicode '" << text << "'";
 
         // 8. remove all unicode characters from string. Basically,
         // remove all characters whose ASCII code is >=128.
         // Python equivalent: text.encode('ascii',errors='ignore')
-        filterUnicode(text);
+        if (escapes & ESCAPE_CHARS_NON_ASCII) {
+            filterUnicode(text);
+            escapes = findEscapeChars(text);
+        }
         dbgTrace(D_WAAP_SAMPLE_PREPROCESS) << "unescape: (8) '" << text << "'";
 
         // 9. ???
@@ -487,7 +543,9 @@ WaapAssetState::WaapAssetState(std::shared_ptr<Signatures> signatures,
         // Python equivalent: text = re.sub(r'[^\x00-\x7F]+',' ', text)
         // TODO:: actually, in python Pavel do this:
         // text = re.sub(r'[^\x00-\x7F]+',' ', text).encode("ascii","ignore")
-        replaceUnicodeSequence(text, ' ');
+        if (escapes & ESCAPE_CHARS_NON_ASCII) {
+            replaceUnicodeSequence(text, ' ');
+        }
 
 #if 0 // Removed Aug 25 2018. Reason for removal - breaks input containing ASCII zeros.
         // 11. remove all unicode characters from string.
@@ -1057,8 +1115,14 @@ WaapAssetState::apply(
         }
     }
 
+    // Escape characters present in the raw line - evasion checks below that look for encoded sequences
+    // are skipped when none of the relevant characters are found.
+    unsigned int lineEscapes = findEscapeChars(line);
+
     std::string unquote_line = line;
-    unquote_line.erase(unquote_plus(unquote_line.begin(), unquote_line.end()), unquote_line.end());
+    if (lineEscapes & (ESCAPE_CHARS_PERCENT | ESCAPE_CHARS_PLUS)) {
+        unquote_line.erase(unquote_plus(unquote_line.begin(), unquote_line.end()), unquote_line.end());
+    }
 
     // If binary data type is detected outside the scanner - enable filtering specific matches/keywords
     bool binaryDataFound =
@@ -1159,6 +1223,25 @@ WaapAssetState::apply(
         }
     }
 
+    // Evasion handling below scans transformed variants of the sample. Different transformations often produce
+    // the same string, so each distinct variant is scanned only once. Matches are accumulated without duplicates,
+    // so scanning the same variant again could not add anything.
+    std::unordered_set<std::string> scannedVariants[2]; // indexed by the longTextFound flag of the scan
+    auto checkVariant = [&](const std::string &variant, bool variantLongTextFound) {
+        if (!scannedVariants[variantLongTextFound].insert(variant).second) {
+            dbgTrace(D_WAAP_EVASIONS) << "variant '" << variant << "' was already scanned";
+            return;
+        }
+
+        SampleValue variantSample(variant, m_Signatures->m_regexPreconditions);
+        checkRegex(variantSample, m_Signatures->specific_acuracy_keywords_regex, res.keyword_matches,
+            res.found_patterns, variantLongTextFound, binaryDataFound);
+        checkRegex(variantSample, m_Signatures->words_regex, res.keyword_matches, res.found_patterns,
+            variantLongTextFound, binaryDataFound);
+        checkRegex(variantSample, m_Signatures->pattern_regex, res.regex_matches, res.found_patterns,
+            variantLongTextFound, binaryDataFound);
+    };
+
     bool os_cmd_ev = Waap::Util::find_in_map_of_stringlists_keys("os_cmd_ev", res.found_patterns);
     dbgTrace(D_WAAP_SAMPLE_SCAN) << "before evasion checking " << nicePrint(res);
     if (os_cmd_ev) {
@@ -1191,13 +1274,7 @@ WaapAssetState::apply(
         unescaped += res.unescaped_line.substr(pos); // add tail
 
         if (res.unescaped_line != unescaped) {
-            SampleValue unescapedSample(unescaped, m_Signatures->m_regexPreconditions);
-            checkRegex(unescapedSample, m_Signatures->specific_acuracy_keywords_regex, res.keyword_matches,
-                res.found_patterns, longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->words_regex, res.keyword_matches, res.found_patterns,
-                longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->pattern_regex, res.regex_matches, res.found_patterns,
-                longTextFound, binaryDataFound);
+            checkVariant(unescaped, longTextFound);
         }
 
         if (kwCount == res.keyword_matches.size()) {
@@ -1227,13 +1304,7 @@ WaapAssetState::apply(
         size_t kwCount = res.keyword_matches.size();
 
         if (res.unescaped_line != unescaped) {
-            SampleValue unescapedSample(unescaped, m_Signatures->m_regexPreconditions);
-            checkRegex(unescapedSample, m_Signatures->specific_acuracy_keywords_regex, res.keyword_matches,
-                res.found_patterns, longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->words_regex, res.keyword_matches, res.found_patterns,
-                longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->pattern_regex, res.regex_matches, res.found_patterns,
-                longTextFound, binaryDataFound);
+            checkVariant(unescaped, longTextFound);
         }
 
         if (kwCount == res.keyword_matches.size()) {
@@ -1251,7 +1322,7 @@ WaapAssetState::apply(
         }
     }
 
-    if (Waap::Util::containsInvalidUtf8(line)) {
+    if ((lineEscapes & ESCAPE_CHARS_PERCENT) && Waap::Util::containsInvalidUtf8(line)) {
         dbgTrace(D_WAAP_EVASIONS) << "invalid utf-8 evasion found";
 
         // Possible quotes evasion detected: - clean up and scan with regexes again.
@@ -1262,13 +1333,7 @@ WaapAssetState::apply(
         unescaped = unescape(unescaped);
 
         if (res.unescaped_line != unescaped) {
-            SampleValue unescapedSample(unescaped, m_Signatures->m_regexPreconditions);
-            checkRegex(unescapedSample, m_Signatures->specific_acuracy_keywords_regex, res.keyword_matches,
-                res.found_patterns, longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->words_regex, res.keyword_matches, res.found_patterns,
-                longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->pattern_regex, res.regex_matches, res.found_patterns,
-                longTextFound, binaryDataFound);
+            checkVariant(unescaped, longTextFound);
         }
 
         if (kwCount != res.keyword_matches.size() && !binaryDataFound) {
@@ -1281,7 +1346,11 @@ WaapAssetState::apply(
         }
     }
 
-    Maybe<std::string> broken_utf8_line = Waap::Util::containsBrokenUtf8(line, unquote_line);
+    // Both line and its unquoted version can only contain '%' if the line does
+    Maybe<std::string> broken_utf8_line = genError("does not contain broken-down UTF8");
+    if (lineEscapes & ESCAPE_CHARS_PERCENT) {
+        broken_utf8_line = Waap::Util::containsBrokenUtf8(line, unquote_line);
+    }
 
     if (broken_utf8_line.ok()) {
         dbgTrace(D_WAAP_EVASIONS) << "broken-down utf-8 evasion found";
@@ -1291,13 +1360,7 @@ WaapAssetState::apply(
         unescaped = unescape(unescaped);
 
         if (res.unescaped_line != unescaped) {
-            SampleValue unescapedSample(unescaped, m_Signatures->m_regexPreconditions);
-            checkRegex(unescapedSample, m_Signatures->specific_acuracy_keywords_regex, res.keyword_matches,
-                res.found_patterns, longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->words_regex, res.keyword_matches, res.found_patterns,
-                longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->pattern_regex, res.regex_matches, res.found_patterns,
-                longTextFound, binaryDataFound);
+            checkVariant(unescaped, longTextFound);
         }
 
         if (kwCount != res.keyword_matches.size() && !binaryDataFound) {
@@ -1320,13 +1383,7 @@ WaapAssetState::apply(
         size_t kwCount = res.keyword_matches.size();
 
         if (res.unescaped_line != unescaped) {
-            SampleValue unescapedSample(unescaped, m_Signatures->m_regexPreconditions);
-            checkRegex(unescapedSample, m_Signatures->specific_acuracy_keywords_regex, res.keyword_matches,
-                res.found_patterns, longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->words_regex, res.keyword_matches, res.found_patterns,
-                longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->pattern_regex, res.regex_matches, res.found_patterns,
-                longTextFound, binaryDataFound);
+            checkVariant(unescaped, longTextFound);
         }
 
         if (kwCount == res.keyword_matches.size()) {
@@ -1359,13 +1416,7 @@ WaapAssetState::apply(
         size_t kwCount = res.keyword_matches.size();
 
         if (res.unescaped_line != unescaped) {
-            SampleValue unescapedSample(unescaped, m_Signatures->m_regexPreconditions);
-            checkRegex(unescapedSample, m_Signatures->specific_acuracy_keywords_regex, res.keyword_matches,
-                res.found_patterns, longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->words_regex, res.keyword_matches, res.found_patterns,
-                longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->pattern_regex, res.regex_matches, res.found_patterns,
-                longTextFound, binaryDataFound);
+            checkVariant(unescaped, longTextFound);
         }
 
         if (kwCount == res.keyword_matches.size()) {
@@ -1397,13 +1448,7 @@ WaapAssetState::apply(
         size_t kwCount = res.keyword_matches.size();
 
         if (res.unescaped_line != unescaped) {
-            SampleValue unescapedSample(unescaped, m_Signatures->m_regexPreconditions);
-            checkRegex(unescapedSample, m_Signatures->specific_acuracy_keywords_regex, res.keyword_matches,
-                res.found_patterns, longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->words_regex, res.keyword_matches, res.found_patterns,
-                longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->pattern_regex, res.regex_matches, res.found_patterns,
-                longTextFound, binaryDataFound);
+            checkVariant(unescaped, longTextFound);
         }
 
         if (kwCount == res.keyword_matches.size()) {
@@ -1421,7 +1466,7 @@ WaapAssetState::apply(
         }
     }
 
-    if (Waap::Util::testUrlBareUtf8Evasion(line)) {
+    if ((lineEscapes & ESCAPE_CHARS_PERCENT) && Waap::Util::testUrlBareUtf8Evasion(line)) {
         // Possible quotes evasion detected: - clean up and scan with regexes again.
         dbgTrace(D_WAAP_EVASIONS) << "url_bare_utf8 evasion found";
 
@@ -1436,13 +1481,7 @@ WaapAssetState::apply(
         size_t kwCount = res.keyword_matches.size();
 
         if (res.unescaped_line != unescaped) {
-            SampleValue unescapedSample(unescaped, m_Signatures->m_regexPreconditions);
-            checkRegex(unescapedSample, m_Signatures->specific_acuracy_keywords_regex, res.keyword_matches,
-                res.found_patterns, longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->words_regex, res.keyword_matches, res.found_patterns,
-                longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->pattern_regex, res.regex_matches, res.found_patterns,
-                longTextFound, binaryDataFound);
+            checkVariant(unescaped, longTextFound);
         }
 
         if (kwCount != res.keyword_matches.size() && !binaryDataFound) {
@@ -1455,23 +1494,16 @@ WaapAssetState::apply(
         }
     }
 
-    boost::cmatch what;
-    if (boost::regex_search(res.unescaped_line.c_str(), what, sqli_comma_evasion_regex)) {
+    if (sqli_comma_evasion_regex.hasMatch(res.unescaped_line)) {
         // Possible SQLi evasion detected (","): - clean up and scan with regexes again.
         dbgTrace(D_WAAP_EVASIONS) << "Possible SQLi evasion detected (\",\"): - clean up and scan with regexes again.";
 
         std::string unescaped = res.unescaped_line;
-        unescaped = boost::regex_replace(unescaped, sqli_comma_evasion_regex, "");
+        unescaped = sqli_comma_evasion_regex.sub(unescaped);
         unescaped = unescape(unescaped);
 
         if (res.unescaped_line != unescaped) {
-            SampleValue unescapedSample(unescaped, m_Signatures->m_regexPreconditions);
-            checkRegex(unescapedSample, m_Signatures->specific_acuracy_keywords_regex, res.keyword_matches,
-                    res.found_patterns, longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->words_regex, res.keyword_matches, res.found_patterns,
-                    longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->pattern_regex, res.regex_matches, res.found_patterns,
-                    longTextFound, binaryDataFound);
+            checkVariant(unescaped, longTextFound);
         }
 
 
@@ -1495,13 +1527,7 @@ WaapAssetState::apply(
         size_t kwCount = res.keyword_matches.size();
 
         if (res.unescaped_line != unescaped) {
-            SampleValue unescapedSample(unescaped, m_Signatures->m_regexPreconditions);
-            checkRegex(unescapedSample, m_Signatures->specific_acuracy_keywords_regex, res.keyword_matches,
-                res.found_patterns, false, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->words_regex, res.keyword_matches, res.found_patterns,
-                false, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->pattern_regex, res.regex_matches, res.found_patterns,
-                false, binaryDataFound);
+            checkVariant(unescaped, false);
         }
 
         if (kwCount != res.keyword_matches.size() && !binaryDataFound) {
@@ -1536,13 +1562,7 @@ WaapAssetState::apply(
         size_t kwCount = res.keyword_matches.size();
 
         if (line != unescaped) {
-            SampleValue unescapedSample(unescaped, m_Signatures->m_regexPreconditions);
-            checkRegex(unescapedSample, m_Signatures->specific_acuracy_keywords_regex, res.keyword_matches,
-                res.found_patterns, false, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->words_regex, res.keyword_matches, res.found_patterns,
-                false, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->pattern_regex, res.regex_matches, res.found_patterns,
-                false, binaryDataFound);
+            checkVariant(unescaped, false);
         }
 
         if (kwCount != res.keyword_matches.size() && !binaryDataFound) {
@@ -1571,20 +1591,14 @@ WaapAssetState::apply(
 
         std::string unescaped = res.unescaped_line;
 
-        unescaped = boost::regex_replace(unescaped, bad_hex_regex, "/");
+        unescaped = bad_hex_regex.sub(unescaped, "/");
         unescaped = unescape(unescaped);
         dbgTrace(D_WAAP_EVASIONS) << "unescaped =='" << unescaped << "'";
 
         size_t kwCount = res.keyword_matches.size();
 
         if (res.unescaped_line != unescaped) {
-            SampleValue unescapedSample(unescaped, m_Signatures->m_regexPreconditions);
-            checkRegex(unescapedSample, m_Signatures->specific_acuracy_keywords_regex, res.keyword_matches,
-                    res.found_patterns, longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->words_regex, res.keyword_matches, res.found_patterns,
-                    longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->pattern_regex, res.regex_matches, res.found_patterns,
-                    longTextFound, binaryDataFound);
+            checkVariant(unescaped, longTextFound);
         }
 
         if (kwCount != res.keyword_matches.size() && !binaryDataFound) {
@@ -1598,24 +1612,18 @@ WaapAssetState::apply(
 
     }
 
-    if ((line.find("%") != std::string::npos) && evasion_bad_hex_regex.hasMatch(line)) {
+    if ((lineEscapes & ESCAPE_CHARS_PERCENT) && evasion_bad_hex_regex.hasMatch(line)) {
         dbgTrace(D_WAAP_EVASIONS) << "Bad hex evasion found (%c1%1c or  %c1%9c in raw line)";
         std::string unescaped = line;
 
-        unescaped = boost::regex_replace(unescaped, bad_hex_regex, "/");
+        unescaped = bad_hex_regex.sub(unescaped, "/");
         unescaped = unescape(unescaped);
         dbgTrace(D_WAAP_EVASIONS) << "unescaped == '" << unescaped << "'";
 
         size_t kwCount = res.keyword_matches.size();
 
         if (line != unescaped) {
-            SampleValue unescapedSample(unescaped, m_Signatures->m_regexPreconditions);
-            checkRegex(unescapedSample, m_Signatures->specific_acuracy_keywords_regex, res.keyword_matches,
-                    res.found_patterns, longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->words_regex, res.keyword_matches, res.found_patterns,
-                    longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->pattern_regex, res.regex_matches, res.found_patterns,
-                    longTextFound, binaryDataFound);
+            checkVariant(unescaped, longTextFound);
         }
 
         if (kwCount != res.keyword_matches.size() && !binaryDataFound) {
@@ -1633,20 +1641,14 @@ WaapAssetState::apply(
             "UTF evasion for dot found (%c0%*e) in unescaped line";
         std::string unescaped = res.unescaped_line;
 
-        unescaped = boost::regex_replace(unescaped, utf_evasion_for_dot_regex, ".");
+        unescaped = utf_evasion_for_dot_regex.sub(unescaped, ".");
         unescaped = unescape(unescaped);
         dbgTrace(D_WAAP_EVASIONS) << "unescaped == '" << unescaped << "'";
 
         size_t kwCount = res.keyword_matches.size();
 
         if (res.unescaped_line != unescaped) {
-            SampleValue unescapedSample(unescaped, m_Signatures->m_regexPreconditions);
-            checkRegex(unescapedSample, m_Signatures->specific_acuracy_keywords_regex, res.keyword_matches,
-                    res.found_patterns, longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->words_regex, res.keyword_matches, res.found_patterns,
-                    longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->pattern_regex, res.regex_matches, res.found_patterns,
-                    longTextFound, binaryDataFound);
+            checkVariant(unescaped, longTextFound);
         }
 
         if (kwCount != res.keyword_matches.size() && !binaryDataFound) {
@@ -1660,24 +1662,18 @@ WaapAssetState::apply(
     }
 
 
-    if ((line.find("%") != std::string::npos) && utf_evasion_for_dot.hasMatch(line)) {
+    if ((lineEscapes & ESCAPE_CHARS_PERCENT) && utf_evasion_for_dot.hasMatch(line)) {
         dbgTrace(D_WAAP_EVASIONS) << "UTF evasion for dot found (%c0%*e) in raw line";
         std::string unescaped = line;
 
-        unescaped = boost::regex_replace(unescaped, utf_evasion_for_dot_regex, ".");
+        unescaped = utf_evasion_for_dot_regex.sub(unescaped, ".");
         unescaped = unescape(unescaped);
         dbgTrace(D_WAAP_EVASIONS) << "unescaped == '" << unescaped << "'";
 
         size_t kwCount = res.keyword_matches.size();
 
         if (line != unescaped) {
-            SampleValue unescapedSample(unescaped, m_Signatures->m_regexPreconditions);
-            checkRegex(unescapedSample, m_Signatures->specific_acuracy_keywords_regex, res.keyword_matches,
-                    res.found_patterns, longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->words_regex, res.keyword_matches, res.found_patterns,
-                    longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->pattern_regex, res.regex_matches, res.found_patterns,
-                    longTextFound, binaryDataFound);
+            checkVariant(unescaped, longTextFound);
         }
 
         if (kwCount != res.keyword_matches.size() && !binaryDataFound) {
@@ -1717,13 +1713,7 @@ WaapAssetState::apply(
         size_t kwCount = res.keyword_matches.size();
 
         if (res.unescaped_line != unescaped) {
-            SampleValue unescapedSample(unescaped, m_Signatures->m_regexPreconditions);
-            checkRegex(unescapedSample, m_Signatures->specific_acuracy_keywords_regex, res.keyword_matches,
-                res.found_patterns, longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->words_regex, res.keyword_matches, res.found_patterns,
-                longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->pattern_regex, res.regex_matches, res.found_patterns,
-                longTextFound, binaryDataFound);
+            checkVariant(unescaped, longTextFound);
         }
 
         if (kwCount == res.keyword_matches.size()) {
@@ -1793,13 +1783,7 @@ WaapAssetState::apply(
         size_t kwCount = res.keyword_matches.size();
 
         if (res.unescaped_line != unescaped) {
-            SampleValue unescapedSample(unescaped, m_Signatures->m_regexPreconditions);
-            checkRegex(unescapedSample, m_Signatures->specific_acuracy_keywords_regex, res.keyword_matches,
-                res.found_patterns, longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->words_regex, res.keyword_matches, res.found_patterns,
-                longTextFound, binaryDataFound);
-            checkRegex(unescapedSample, m_Signatures->pattern_regex, res.regex_matches, res.found_patterns,
-                longTextFound, binaryDataFound);
+            checkVariant(unescaped, longTextFound);
         }
 
         if (kwCount == res.keyword_matches.size()) {
@@ -1980,7 +1964,7 @@ void WaapAssetState::updateFilterManagerPolicy(IWaapConfig* pConfig)
 
 bool WaapAssetState::isKeywordOfType(const std::string& keyword, ParamType type) const
 {
-    return m_typeValidator.isKeywordOfType(keyword, type);
+    return m_typeValidator->isKeywordOfType(keyword, type);
 }
 
 bool WaapAssetState::isBinarySampleType(const std::string & sample) const
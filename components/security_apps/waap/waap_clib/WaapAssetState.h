@@ -51,6 +51,12 @@ private: //ugly but needed for build
     void filterKeywordsDueToLongText(Waf2ScanResult &res) const;
     std::string nicePrint(Waf2ScanResult &res) const;
 
+    // The keyword types are read from the global waap data file once, and shared read-only by all the assets' states.
+    explicit WaapAssetState(std::shared_ptr<Signatures> signatures,
+        std::shared_ptr<const KeywordTypeValidator> typeValidator, const std::string& waapDataFileName,
+        size_t cleanCacheCapacity, size_t suspiciousCacheCapacity, size_t sampleTypeCacheCapacity,
+        const std::string& assetId);
+
 public:
     // Load and compile signatures from file
     explicit WaapAssetState(std::shared_ptr<Signatures> signatures, const std::string& waapDataFileName,
@@ -72,7 +78,7 @@ public:
     std::shared_ptr<Waap::RateLimiting::State> m_errorLimitingState;
     std::shared_ptr<Waap::SecurityHeaders::State> m_securityHeadersState;
     std::shared_ptr<IndicatorsFiltersManager> m_filtersMngr;
-    KeywordTypeValidator m_typeValidator;
+    std::shared_ptr<const KeywordTypeValidator> m_typeValidator;
 
     bool apply(const std::string &v, Waf2ScanResult &res, const std::string &scanStage, bool isBinaryData=false,
         const Maybe<std::string> splitType=genError("not splitted")) const;
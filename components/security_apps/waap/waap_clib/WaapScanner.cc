@@ -281,6 +281,14 @@ int Waap::Scanner::onKv(const char* k, size_t k_len, const char* v, size_t v_len
         v_len -= 2;
         value = std::string(v, v_len);
     }
+
+    // Signature scanning is the expensive part - it stops once the request used up its inspection budget
+    if (m_transaction->getInspectionBudget().isExhausted()) {
+        dbgTrace(D_WAAP_SCANNER) << "Waap::Scanner::onKv: inspection budget exhausted, skip scanning";
+        return 0;
+    }
+    Waap::InspectionBudget::Scope budgetScope(*m_transaction, k_len + v_len);
+
     res.location = dp.m_key.first();
     res.param_name = dp.m_key.str();
     res.unescaped_line = unescape(value);
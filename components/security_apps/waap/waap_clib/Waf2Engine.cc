@@ -303,6 +303,7 @@ Waf2Transaction::Waf2Transaction() :
     m_local_port(0),
     m_csrfState(),
     m_userLimitsState(nullptr),
+    m_inspectionBudget(),
     m_siteConfig(NULL),
     m_contentType(Waap::Util::CONTENT_TYPE_UNKNOWN),
     m_requestBodyParser(NULL),
@@ -342,6 +343,7 @@ Waf2Transaction::Waf2Transaction(std::shared_ptr<WaapAssetState> pWaapAssetState
     m_local_port(0),
     m_csrfState(),
     m_userLimitsState(nullptr),
+    m_inspectionBudget(),
     m_siteConfig(NULL),
     m_contentType(Waap::Util::CONTENT_TYPE_UNKNOWN),
     m_requestBodyParser(NULL),
@@ -568,6 +570,7 @@ void Waf2Transaction::start() {
     m_cookieStr.clear();
     m_notes.clear();
     m_source_identifier.clear();
+    m_inspectionBudget.reset();
     // TODO:: remove this! refactor extraction of kv_pairs!
     m_deepParser.clear();
     hdrs_map.clear();
@@ -1191,7 +1194,11 @@ void Waf2Transaction::add_request_body_chunk(const char* data, int data_len) {
         }
     }
 
-    if (m_isScanningRequired && m_request_body_bytes_received <= maxSizeToScan)
+    // Once the inspection budget is exhausted the rest of the body is not parsed (nor scanned)
+    if (m_inspectionBudget.isExhausted()) {
+        m_inspectionBudget.skip(data_len);
+    }
+    else if (m_isScanningRequired && m_request_body_bytes_received <= maxSizeToScan)
     {
         if (m_requestBodyParser != NULL) {
             m_requestBodyParser->push(data, data_len);
@@ -1589,6 +1596,8 @@ Waf2Transaction::decideFinal(
         }
         // User limits
         shouldBlock |= (getUserLimitVerdict() == ngx_http_cp_verdict_e::TRAFFIC_VERDICT_DROP);
+        // Inspection budget
+        shouldBlock |= (getInspectionBudgetVerdict() == ngx_http_cp_verdict_e::TRAFFIC_VERDICT_DROP);
     }
 
     if (mode == 2) {
@@ -1817,7 +1826,8 @@ Waf2Transaction::sendLog()
     else if (m_overrideState.bForceException) {
         telemetryData.blockType = FORCE_EXCEPTION;
     }
-    else if (m_waapDecision.getDecision(USER_LIMITS_DECISION)->shouldBlock()) {
+    else if (m_waapDecision.getDecision(USER_LIMITS_DECISION)->shouldBlock() ||
+        m_waapDecision.getDecision(INSPECTION_BUDGET_DECISION)->shouldBlock()) {
         telemetryData.blockType = LIMIT_BLOCK;
     }
     else if (autonomousSecurityDecision->shouldBlock()) {
@@ -1952,6 +1962,33 @@ Waf2Transaction::sendLog()
         waap_log << LogField("eventConfidence", "High");
         break;
     }
+    case INSPECTION_BUDGET_DECISION: {
+        std::string incidentDetails = "Http request inspection stopped after ";
+        incidentDetails += std::to_string(m_inspectionBudget.getScannedBytes());
+        incidentDetails += " bytes (";
+        incidentDetails += Waap::InspectionBudget::State::reasonToString(m_inspectionBudget.getExhaustedReason());
+        incidentDetails += " limit)";
+        if (m_inspectionBudget.getSkippedBytes() != 0) {
+            incidentDetails += ", ";
+            incidentDetails += std::to_string(m_inspectionBudget.getSkippedBytes());
+            incidentDetails += " body bytes were not parsed";
+        }
+
+        LogGenWrapper logGenWrapper(
+                                maybeLogTriggerConf,
+                                "Web Request",
+                                ReportIS::Audience::SECURITY,
+                                LogTriggerConf::SecurityType::ThreatPrevention,
+                                Severity::HIGH,
+                                Priority::HIGH,
+                                shouldBlock);
+
+        LogGen& waap_log = logGenWrapper.getLogGen();
+        appendCommonLogFields(waap_log, triggerLog, shouldBlock, logOverride, "Inspection budget exhausted");
+        waap_log << LogField("waapIncidentDetails", incidentDetails);
+        waap_log << LogField("eventConfidence", "High");
+        break;
+    }
     case OPEN_REDIRECT_DECISION:
     case ERROR_LIMITING_DECISION:
     case RATE_LIMITING_DECISION:
@@ -27,6 +27,7 @@
 #include "WaapConfigApi.h"
 #include "WaapDecision.h"
 #include "DeepAnalyzer.h"
+#include "InspectionBudget.h"
 #include <vector>
 #include <map>
 #include <string>
@@ -131,6 +132,8 @@ public:
     ngx_http_cp_verdict_e getUserLimitVerdict();
     const std::string getUserLimitVerdictStr() const;
     const std::string getViolatedUserLimitTypeStr() const;
+    Waap::InspectionBudget::State& getInspectionBudget() { return m_inspectionBudget; }
+    ngx_http_cp_verdict_e getInspectionBudgetVerdict();
 
     virtual HeaderType detectHeaderType(const char* name, int name_len);
     HeaderType checkCleanHeader(const char* name, int name_len, const char* value, int value_len) const;
@@ -307,6 +310,8 @@ private:
     Waap::CSRF::State m_csrfState;
     // UserLimits state
     std::shared_ptr<Waap::UserLimits::State> m_userLimitsState;
+    // Inspection budget state
+    Waap::InspectionBudget::State m_inspectionBudget;
 
     WaapConfigAPI m_ngenAPIConfig;
     WaapConfigApplication m_ngenSiteConfig;
@@ -492,6 +492,54 @@ Waf2Transaction::getUserLimitVerdict()
     return verdict;
 }
 
+ngx_http_cp_verdict_e
+Waf2Transaction::getInspectionBudgetVerdict()
+{
+    if (!m_inspectionBudget.isExhausted() || m_siteConfig == nullptr) {
+        return ngx_http_cp_verdict_e::TRAFFIC_VERDICT_INSPECT;
+    }
+
+    std::string msg;
+    msg = "[INSPECTION BUDGET][" +
+        std::string(WaapConfigBase::get_WebAttackMitigationModeStr(*m_siteConfig)) +
+        " mode] " + "Verdict is ";
+    std::string reason;
+    reason = "  reason: " + std::string(
+        Waap::InspectionBudget::State::reasonToString(m_inspectionBudget.getExhaustedReason())
+    );
+
+    // The rest of the request is not parsed, so whatever the verdict is the exhausted budget is logged
+    auto decision = m_waapDecision.getDecision(INSPECTION_BUDGET_DECISION);
+    decision->setLog(true);
+    decision->setBlock(false);
+
+    ngx_http_cp_verdict_e verdict = ngx_http_cp_verdict_e::TRAFFIC_VERDICT_INSPECT;
+    switch (m_inspectionBudget.getExhaustedVerdict()) {
+        case Waap::InspectionBudget::ExhaustedVerdict::INSPECT:
+            dbgTrace(D_WAAP) << msg << "INSPECT" << reason;
+            verdict = ngx_http_cp_verdict_e::TRAFFIC_VERDICT_INSPECT;
+            break;
+        case Waap::InspectionBudget::ExhaustedVerdict::ACCEPT:
+            dbgInfo(D_WAAP) << msg << "PASS" << reason;
+            verdict = ngx_http_cp_verdict_e::TRAFFIC_VERDICT_ACCEPT;
+            break;
+        case Waap::InspectionBudget::ExhaustedVerdict::DROP:
+            // Same as user limits: only block in prevent mode and unless an exception applies
+            if (WaapConfigBase::get_WebAttackMitigationMode(*m_siteConfig) == AttackMitigationMode::PREVENT &&
+                !m_overrideState.bForceException) {
+                decision->setBlock(true);
+                dbgInfo(D_WAAP) << msg << "BLOCK" << reason;
+                verdict = ngx_http_cp_verdict_e::TRAFFIC_VERDICT_DROP;
+            } else {
+                dbgInfo(D_WAAP) << msg << "PASS" << reason;
+                verdict = ngx_http_cp_verdict_e::TRAFFIC_VERDICT_ACCEPT;
+            }
+            break;
+    }
+
+    return verdict;
+}
+
 const std::string Waf2Transaction::getUserLimitVerdictStr() const
 {
     std::stringstream verdict;
@@ -645,6 +693,7 @@ ReportIS::Severity Waf2Transaction::computeEventSeverityFromDecision() const
     switch (type)
     {
         case DecisionType::USER_LIMITS_DECISION:
+        case DecisionType::INSPECTION_BUDGET_DECISION:
         {
             return ReportIS::Severity::HIGH;
             break;
@@ -27,6 +27,9 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "CidrMatch.h"
 #include "debug.h"
@@ -624,6 +627,11 @@ normalize_param(const string& param)
 }
 
 void unescapeUnicode(string& text) {
+    // All escape sequences handled here start with backslash
+    if (text.find('\\') == string::npos) {
+        return;
+    }
+
     string::iterator it = text.begin();
     string::iterator result = it;
     char acc[16];   // accumulates characters we are parsing and do not want to copy directly.
@@ -952,6 +960,60 @@ string filterUTF7(const string& text) {
     return result;
 }
 
+static inline unsigned int
+escapeCharKind(unsigned char ch)
+{
+    switch (ch) {
+        case '%': return ESCAPE_CHARS_PERCENT;
+        case '+': return ESCAPE_CHARS_PLUS;
+        case '&': return ESCAPE_CHARS_AMPERSAND;
+        case '\\': return ESCAPE_CHARS_BACKSLASH;
+        default: return ch >= 0x80 ? ESCAPE_CHARS_NON_ASCII : ESCAPE_CHARS_NONE;
+    }
+}
+
+unsigned int
+findEscapeChars(const char *text, size_t len)
+{
+    static const unsigned int all_kinds =
+        ESCAPE_CHARS_PERCENT |
+        ESCAPE_CHARS_PLUS |
+        ESCAPE_CHARS_AMPERSAND |
+        ESCAPE_CHARS_BACKSLASH |
+        ESCAPE_CHARS_NON_ASCII;
+    unsigned int found = ESCAPE_CHARS_NONE;
+    size_t pos = 0;
+
+#if defined(__SSE2__)
+    const __m128i percent = _mm_set1_epi8('%');
+    const __m128i plus = _mm_set1_epi8('+');
+    const __m128i ampersand = _mm_set1_epi8('&');
+    const __m128i backslash = _mm_set1_epi8('\\');
+
+    for (; pos + 16 <= len; pos += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + pos));
+        // Non-ASCII bytes are negative as signed chars, so they are reported by movemask of the data itself
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, percent), _mm_cmpeq_epi8(v, plus)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, ampersand), _mm_cmpeq_epi8(v, backslash))
+        );
+        if (_mm_movemask_epi8(_mm_or_si128(special, v)) == 0) continue;
+
+        // Rare: classify this block byte by byte
+        for (size_t i = pos; i < pos + 16; i++) {
+            found |= escapeCharKind(text[i]);
+        }
+        if (found == all_kinds) return found;
+    }
+#endif
+
+    for (; pos < len; pos++) {
+        found |= escapeCharKind(text[pos]);
+    }
+
+    return found;
+}
+
 // Attempts to validate and decode base64-encoded chunk.
 // Value is the full value inside which potential base64-encoded chunk was found,
 // it and end point to start and end of that chunk.
@@ -1929,6 +1991,10 @@ string computeConfidenceFromThreatLevel(ThreatLevel threatLevel)
 
 void decodePercentEncoding(string &text, bool decodePlus)
 {
+    if (!(findEscapeChars(text) & (ESCAPE_CHARS_PERCENT | (decodePlus ? ESCAPE_CHARS_PLUS : 0)))) {
+        return;
+    }
+
     // Replace %xx sequences by their single-character equivalents.
     // Do not replace the '+' symbol by space character because this would corrupt some base64 source strings
     // (base64 alphabet includes the '+' character).
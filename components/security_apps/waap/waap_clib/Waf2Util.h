@@ -865,6 +865,26 @@ void unescapeUnicode(std::string &text);
 // Try to find and decode UTF7 chunks
 std::string filterUTF7(const std::string &text);
 
+// Kinds of characters that start an encoded sequence. Each decoding pass is only useful when its kind is present.
+enum escape_chars {
+    ESCAPE_CHARS_NONE = 0,
+    ESCAPE_CHARS_PERCENT = 1 << 0,    // '%xx' url encoding
+    ESCAPE_CHARS_PLUS = 1 << 1,       // '+' url encoded space, start of utf7 chunk
+    ESCAPE_CHARS_AMPERSAND = 1 << 2,  // '&' html entities
+    ESCAPE_CHARS_BACKSLASH = 1 << 3,  // '\' C and unicode escapes
+    ESCAPE_CHARS_NON_ASCII = 1 << 4   // bytes >= 0x80 (utf8 sequences, non-breaking space)
+};
+
+// Returns bitmask of escape_chars found in text. The text is scanned 16 bytes at a time (SSE2) and scan stops as
+// soon as all kinds are found, so for clean ASCII text (the common case) this is much cheaper than any decoding pass.
+unsigned int findEscapeChars(const char *text, size_t len);
+
+inline unsigned int
+findEscapeChars(const std::string &text)
+{
+    return findEscapeChars(text.data(), text.size());
+}
+
 base64_decode_status
 decodeBase64Chunk(
     const std::string &value,
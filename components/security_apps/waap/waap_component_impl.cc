@@ -36,6 +36,7 @@
 #include "generic_rulebase/rulebase_config.h"
 #include "report_messaging.h"
 #include "first_request_object.h"
+#include "inspection_stage_metric.h"
 
 using namespace std;
 
@@ -77,6 +78,15 @@ WaapComponent::Impl::init()
         ReportIS::Audience::INTERNAL
     );
     assets_metric.registerListener();
+    inspection_budget_metric.init(
+        "WAAP Inspection Budget",
+        ReportIS::AudienceTeam::AGENT_CORE,
+        ReportIS::IssuingEngine::AGENT_CORE,
+        std::chrono::minutes(10),
+        true,
+        ReportIS::Audience::INTERNAL
+    );
+    inspection_budget_metric.registerListener();
     registerListener();
     waap_metric.registerListener();
 
@@ -200,6 +210,8 @@ WaapComponent::Impl::respond(const NewHttpTransactionEvent &event)
 EventVerdict
 WaapComponent::Impl::respond(const HttpRequestHeaderEvent &event)
 {
+    InspectionStageTimer timer("waap.requestHeader");
+
     auto &header_name = event.getKey();
     auto &header_value = event.getValue();
 
@@ -242,6 +254,10 @@ WaapComponent::Impl::respond(const HttpRequestHeaderEvent &event)
             verdict = waapDecisionAfterHeaders(waf2Transaction);
         }
 
+        if (verdict.getVerdict() == pending_response.getVerdict()) {
+            verdict = waapDecisionOnExhaustedBudget(waf2Transaction);
+        }
+
     }
 
     // Delete state before returning any verdict which is not pending
@@ -258,6 +274,8 @@ WaapComponent::Impl::respond(const HttpRequestHeaderEvent &event)
 EventVerdict
 WaapComponent::Impl::respond(const HttpRequestBodyEvent &event)
 {
+    InspectionStageTimer timer("waap.requestBody");
+
     dbgTrace(D_NGINX_EVENTS) << " * \e[32mNGEN_EVENT: HttpBodyRequest data buffer event\e[0m";
 
     if (!waapStateTable->hasState<Waf2Transaction>()) {
@@ -283,6 +301,9 @@ WaapComponent::Impl::respond(const HttpRequestBodyEvent &event)
     waf2Transaction.add_request_body_chunk(dataBuf, dataBufLen);
 
     ngx_http_cp_verdict_e verdict = waf2Transaction.getUserLimitVerdict();
+    if (verdict == ngx_http_cp_verdict_e::TRAFFIC_VERDICT_INSPECT) {
+        verdict = waapDecisionOnExhaustedBudget(waf2Transaction).getVerdict();
+    }
     if (verdict != ngx_http_cp_verdict_e::TRAFFIC_VERDICT_INSPECT) {
         finishTransaction(waf2Transaction);
     }
@@ -296,6 +317,8 @@ WaapComponent::Impl::respond(const HttpRequestBodyEvent &event)
 EventVerdict
 WaapComponent::Impl::respond(const EndRequestEvent &)
 {
+    InspectionStageTimer timer("waap.endRequest");
+
     dbgTrace(D_NGINX_EVENTS) << " * \e[32mNGEN_EVENT: endRequest event\e[0m";
 
     if (!waapStateTable->hasState<Waf2Transaction>()) {
@@ -383,6 +406,8 @@ WaapComponent::Impl::respond(const ResponseCodeEvent &event)
 EventVerdict
 WaapComponent::Impl::respond(const HttpResponseHeaderEvent &event)
 {
+    InspectionStageTimer timer("waap.responseHeader");
+
     auto &header_name = event.getKey();
     auto &header_value = event.getValue();
 
@@ -492,6 +517,8 @@ WaapComponent::Impl::respond(const HttpResponseHeaderEvent &event)
 EventVerdict
 WaapComponent::Impl::respond(const HttpResponseBodyEvent &event)
 {
+    InspectionStageTimer timer("waap.responseBody");
+
     dbgTrace(D_NGINX_EVENTS) << " * \e[32mNGEN_EVENT: HttpBodyResponse data buffer event\e[0m";
 
     if (!waapStateTable->hasState<Waf2Transaction>()) {
@@ -677,6 +704,24 @@ WaapComponent::Impl::waapDecision(IWaf2Transaction& waf2Transaction)
     return verdict;
 }
 
+// Once the inspection budget is exhausted the rest of the request is not parsed. The transaction is decided on what
+// was scanned until then, and the verdict of the budget only applies when that decision does not drop it.
+EventVerdict
+WaapComponent::Impl::waapDecisionOnExhaustedBudget(IWaf2Transaction& waf2Transaction)
+{
+    ngx_http_cp_verdict_e budget_verdict = waf2Transaction.getInspectionBudgetVerdict();
+    if (budget_verdict == ngx_http_cp_verdict_e::TRAFFIC_VERDICT_INSPECT) {
+        return pending_response;
+    }
+
+    dbgTrace(D_WAAP) << "Inspection budget exhausted, deciding on the scanned part of the request";
+    EventVerdict verdict = waapDecision(waf2Transaction);
+    if (verdict.getVerdict() == ngx_http_cp_verdict_e::TRAFFIC_VERDICT_DROP) {
+        return verdict;
+    }
+    return EventVerdict(budget_verdict);
+}
+
 void
 WaapComponent::Impl::finishTransaction(IWaf2Transaction& waf2Transaction)
 {
@@ -59,6 +59,7 @@ private:
     void init(const std::string &waapDataFileName);
     EventVerdict waapDecisionAfterHeaders(IWaf2Transaction& waf2Transaction);
     EventVerdict waapDecision(IWaf2Transaction& waf2Transaction);
+    EventVerdict waapDecisionOnExhaustedBudget(IWaf2Transaction& waf2Transaction);
     void finishTransaction(IWaf2Transaction& waf2Transaction);
 
     bool waf2_proc_start(const std::string& waapDataFileName);
@@ -75,6 +76,7 @@ private:
     EventVerdict drop_response;
     WaapMetricWrapper waap_metric;
     AssetsMetric assets_metric;
+    InspectionBudgetMetric inspection_budget_metric;
     I_Table* waapStateTable;
     // Count of transactions processed by this WaapComponent instance
     uint64_t transactionsCount;
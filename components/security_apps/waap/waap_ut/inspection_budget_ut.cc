@@ -0,0 +1,202 @@
+#include "InspectionBudget.h"
+#include "Waf2Engine.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include "cptest.h"
+#include "config.h"
+#include "config_component.h"
+#include "environment.h"
+#include "mock/mock_time_get.h"
+
+using namespace std;
+using namespace chrono;
+using namespace testing;
+using namespace Waap::InspectionBudget;
+
+class InspectionBudgetTest : public Test
+{
+public:
+    InspectionBudgetTest()
+    {
+        EXPECT_CALL(mock_time, getMonotonicTime()).WillRepeatedly(InvokeWithoutArgs([this] () { return now; }));
+        conf.preload();
+    }
+
+    void
+    loadSettings(const string &max_time_ms, const string &max_scanned_bytes, const string &verdict)
+    {
+        stringstream configuration;
+        configuration
+            << "{\"agentSettings\":["
+            << "{\"id\":\"1\",\"key\":\"agent.waap.inspectionBudget.maxTimeMs\",\"value\":\"" << max_time_ms << "\"},"
+            << "{\"id\":\"2\",\"key\":\"agent.waap.inspectionBudget.maxScannedBytes\",\"value\":\""
+            << max_scanned_bytes
+            << "\"},"
+            << "{\"id\":\"3\",\"key\":\"agent.waap.inspectionBudget.exhaustedVerdict\",\"value\":\"" << verdict << "\"}"
+            << "]}";
+        EXPECT_TRUE(Singleton::Consume<Config::I_Config>::from(conf)->loadConfiguration(configuration));
+    }
+
+    ExhaustedVerdict
+    verdictOf(const string &verdict)
+    {
+        loadSettings("0", "100", verdict);
+        State state;
+        state.reset();
+        return state.getExhaustedVerdict();
+    }
+
+    static bool
+    hasNote(const Waf2Transaction &transaction, const string &note)
+    {
+        vector<string> notes = transaction.getNotes();
+        return find(notes.begin(), notes.end(), note) != notes.end();
+    }
+
+    microseconds now = microseconds(0);
+    NiceMock<MockTimeGet> mock_time;
+    ::Environment env;
+    ConfigComponent conf;
+};
+
+TEST_F(InspectionBudgetTest, disabled_by_default)
+{
+    State state;
+    state.reset();
+    EXPECT_FALSE(state.isEnabled());
+    EXPECT_EQ(state.getExhaustedVerdict(), ExhaustedVerdict::INSPECT);
+
+    EXPECT_FALSE(state.consume(100000000, seconds(100)));
+    EXPECT_FALSE(state.isExhausted());
+    EXPECT_EQ(state.getExhaustedReason(), ExhaustedReason::NONE);
+    EXPECT_EQ(state.getScannedBytes(), 100000000u);
+}
+
+TEST_F(InspectionBudgetTest, exhausted_by_time)
+{
+    loadSettings("5", "0", "inspect");
+    State state;
+    state.reset();
+    EXPECT_TRUE(state.isEnabled());
+
+    EXPECT_FALSE(state.consume(10, milliseconds(3)));
+    EXPECT_FALSE(state.isExhausted());
+    EXPECT_TRUE(state.consume(10, milliseconds(2)));
+    EXPECT_TRUE(state.isExhausted());
+    EXPECT_EQ(state.getExhaustedReason(), ExhaustedReason::TIME);
+
+    // Only the step that exhausted the budget is reported, the following ones are still accounted for
+    EXPECT_FALSE(state.consume(10, milliseconds(1)));
+    EXPECT_EQ(state.getExhaustedReason(), ExhaustedReason::TIME);
+    EXPECT_EQ(state.getScannedBytes(), 30u);
+    EXPECT_EQ(state.getInspectionTime(), milliseconds(6));
+}
+
+TEST_F(InspectionBudgetTest, exhausted_by_bytes)
+{
+    loadSettings("0", "100", "inspect");
+    State state;
+    state.reset();
+
+    EXPECT_FALSE(state.consume(60, seconds(1)));
+    EXPECT_TRUE(state.consume(40, microseconds(1)));
+    EXPECT_EQ(state.getExhaustedReason(), ExhaustedReason::BYTES);
+    EXPECT_FALSE(state.consume(1, microseconds(1)));
+    EXPECT_STREQ(State::reasonToString(state.getExhaustedReason()), "bytes");
+}
+
+TEST_F(InspectionBudgetTest, time_is_checked_before_bytes)
+{
+    loadSettings("1", "100", "inspect");
+    State state;
+    state.reset();
+
+    EXPECT_TRUE(state.consume(200, milliseconds(2)));
+    EXPECT_EQ(state.getExhaustedReason(), ExhaustedReason::TIME);
+}
+
+TEST_F(InspectionBudgetTest, exhausted_verdict)
+{
+    EXPECT_EQ(verdictOf("inspect"), ExhaustedVerdict::INSPECT);
+    EXPECT_EQ(verdictOf("accept"), ExhaustedVerdict::ACCEPT);
+    EXPECT_EQ(verdictOf("drop"), ExhaustedVerdict::DROP);
+
+    // Unknown values fall back to inspecting, and the values are case sensitive
+    EXPECT_EQ(verdictOf("block"), ExhaustedVerdict::INSPECT);
+    EXPECT_EQ(verdictOf("DROP"), ExhaustedVerdict::INSPECT);
+}
+
+TEST_F(InspectionBudgetTest, reset_picks_up_the_settings)
+{
+    loadSettings("0", "100", "drop");
+    State state;
+    state.reset();
+    EXPECT_TRUE(state.consume(100, microseconds(1)));
+    state.skip(50);
+
+    // A new transaction starts from an empty budget with the current settings
+    loadSettings("0", "1000", "accept");
+    state.reset();
+    EXPECT_FALSE(state.isExhausted());
+    EXPECT_EQ(state.getScannedBytes(), 0u);
+    EXPECT_EQ(state.getSkippedBytes(), 0u);
+    EXPECT_EQ(state.getInspectionTime(), microseconds(0));
+    EXPECT_EQ(state.getExhaustedVerdict(), ExhaustedVerdict::ACCEPT);
+    EXPECT_FALSE(state.consume(100, microseconds(1)));
+    EXPECT_TRUE(state.consume(900, microseconds(1)));
+
+    loadSettings("0", "0", "accept");
+    state.reset();
+    EXPECT_FALSE(state.isEnabled());
+}
+
+TEST_F(InspectionBudgetTest, scope_charges_the_transaction)
+{
+    loadSettings("5", "0", "inspect");
+    Waf2Transaction transaction;
+    transaction.getInspectionBudget().reset();
+
+    {
+        Scope scope(transaction, 10);
+        now += milliseconds(3);
+    }
+    EXPECT_FALSE(transaction.getInspectionBudget().isExhausted());
+    EXPECT_EQ(transaction.getInspectionBudget().getInspectionTime(), milliseconds(3));
+
+    {
+        Scope scope(transaction, 20);
+        now += milliseconds(4);
+    }
+    EXPECT_TRUE(transaction.getInspectionBudget().isExhausted());
+    EXPECT_EQ(transaction.getInspectionBudget().getScannedBytes(), 30u);
+    EXPECT_TRUE(hasNote(transaction, "inspection_budget_exhausted:time"));
+
+    // The exhaustion is noted only once
+    {
+        Scope scope(transaction, 20);
+        now += milliseconds(4);
+    }
+    vector<string> notes = transaction.getNotes();
+    EXPECT_EQ(count(notes.begin(), notes.end(), "inspection_budget_exhausted:time"), 1);
+}
+
+TEST_F(InspectionBudgetTest, body_is_not_parsed_once_exhausted)
+{
+    loadSettings("0", "100", "inspect");
+    Waf2Transaction transaction;
+    transaction.getInspectionBudget().reset();
+    transaction.start_request_body();
+
+    string chunk(64, 'a');
+    transaction.add_request_body_chunk(chunk.data(), chunk.size());
+    EXPECT_EQ(transaction.getInspectionBudget().getSkippedBytes(), 0u);
+
+    EXPECT_TRUE(transaction.getInspectionBudget().consume(100, microseconds(1)));
+    transaction.add_request_body_chunk(chunk.data(), chunk.size());
+    transaction.add_request_body_chunk(chunk.data(), 10);
+    EXPECT_EQ(transaction.getInspectionBudget().getSkippedBytes(), 74u);
+    EXPECT_EQ(transaction.getInspectionBudget().getScannedBytes(), 100u);
+}
@@ -0,0 +1,266 @@
+#include "JsonStructuralScanner.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "cptest.h"
+#include "yajl/yajl_parse.h"
+
+using namespace std;
+using namespace testing;
+
+// Records the callbacks as text, e.g. "key:a", so the events of the scanner and of yajl can be compared.
+class JsonEvents
+{
+public:
+    static const yajl_callbacks callbacks;
+
+    vector<string> events;
+
+private:
+    static vector<string> & get(void *ctx) { return static_cast<JsonEvents *>(ctx)->events; }
+
+    static int onNull(void *ctx) { get(ctx).push_back("null"); return 1; }
+    static int onBoolean(void *ctx, int val) { get(ctx).push_back(val ? "true" : "false"); return 1; }
+    static int onNumber(void *ctx, const char *s, size_t len) { get(ctx).push_back("num:" + string(s, len)); return 1; }
+    static int onStartMap(void *ctx) { get(ctx).push_back("{"); return 1; }
+    static int onEndMap(void *ctx) { get(ctx).push_back("}"); return 1; }
+    static int onStartArray(void *ctx) { get(ctx).push_back("["); return 1; }
+    static int onEndArray(void *ctx) { get(ctx).push_back("]"); return 1; }
+
+    static int
+    onString(void *ctx, const unsigned char *s, size_t len)
+    {
+        get(ctx).push_back("str:" + string(reinterpret_cast<const char *>(s), len));
+        return 1;
+    }
+
+    static int
+    onMapKey(void *ctx, const unsigned char *s, size_t len)
+    {
+        get(ctx).push_back("key:" + string(reinterpret_cast<const char *>(s), len));
+        return 1;
+    }
+};
+
+const yajl_callbacks JsonEvents::callbacks = {
+    onNull,
+    onBoolean,
+    nullptr,
+    nullptr,
+    onNumber,
+    onString,
+    onStartMap,
+    onMapKey,
+    onEndMap,
+    onStartArray,
+    onEndArray
+};
+
+class JsonStructuralScannerTest : public Test
+{
+public:
+    // Feeds the input in chunks of the given size (the whole input at once when it is 0)
+    static JsonStructuralScanner::status
+    scan(const string &json, vector<string> &events, size_t chunk_size = 0)
+    {
+        JsonEvents recorder;
+        JsonStructuralScanner scanner(&JsonEvents::callbacks, &recorder);
+        if (chunk_size == 0) chunk_size = json.size();
+
+        JsonStructuralScanner::status status = JsonStructuralScanner::st_ok;
+        for (size_t pos = 0; pos < json.size() && status == JsonStructuralScanner::st_ok; pos += chunk_size) {
+            status = scanner.parse(json.data() + pos, min(chunk_size, json.size() - pos));
+        }
+        if (status == JsonStructuralScanner::st_ok) status = scanner.completeParse();
+        events = recorder.events;
+        return status;
+    }
+
+    // Splits the input in two at the given position
+    static JsonStructuralScanner::status
+    scanSplit(const string &json, size_t split, vector<string> &events)
+    {
+        JsonEvents recorder;
+        JsonStructuralScanner scanner(&JsonEvents::callbacks, &recorder);
+        JsonStructuralScanner::status status = scanner.parse(json.data(), split);
+        if (status == JsonStructuralScanner::st_ok) status = scanner.parse(json.data() + split, json.size() - split);
+        if (status == JsonStructuralScanner::st_ok) status = scanner.completeParse();
+        events = recorder.events;
+        return status;
+    }
+
+    // The events of yajl configured the way the WAAP JSON parser configures it
+    static vector<string>
+    yajlEvents(const string &json)
+    {
+        JsonEvents recorder;
+        yajl_handle handle = yajl_alloc(&JsonEvents::callbacks, nullptr, &recorder);
+        yajl_config(handle, yajl_allow_comments, 1);
+        yajl_config(handle, yajl_allow_multiple_values, 1);
+        yajl_config(handle, yajl_dont_validate_strings, 1);
+        yajl_status status = yajl_parse(handle, reinterpret_cast<const unsigned char *>(json.data()), json.size());
+        if (status == yajl_status_ok) status = yajl_complete_parse(handle);
+        yajl_free(handle);
+        EXPECT_EQ(status, yajl_status_ok) << "yajl rejected: " << json;
+        return recorder.events;
+    }
+
+    // The scanner gives the same events as yajl, whatever the input is split at
+    static void
+    expectSameAsYajl(const string &json)
+    {
+        vector<string> expected = yajlEvents(json);
+        vector<string> events;
+        EXPECT_EQ(scan(json, events), JsonStructuralScanner::st_ok) << json;
+        EXPECT_EQ(events, expected) << json;
+
+        for (size_t split = 1; split < json.size(); split++) {
+            EXPECT_EQ(scanSplit(json, split, events), JsonStructuralScanner::st_ok) << json << " split at " << split;
+            EXPECT_EQ(events, expected) << json << " split at " << split;
+        }
+    }
+
+    static void
+    expectError(const string &json)
+    {
+        vector<string> events;
+        EXPECT_EQ(scan(json, events), JsonStructuralScanner::st_error) << json;
+        for (size_t split = 1; split < json.size(); split++) {
+            EXPECT_EQ(scanSplit(json, split, events), JsonStructuralScanner::st_error) << json << " split at " << split;
+        }
+    }
+};
+
+TEST_F(JsonStructuralScannerTest, values_and_containers)
+{
+    expectSameAsYajl("{\"a\": 1, \"b\": [true, false, null], \"c\": {\"d\": \"text\"}, \"e\": {}, \"f\": []}");
+    expectSameAsYajl("[1] [2] \"three\" 4");
+    expectSameAsYajl(" \t\r\n{ \"key\" :\v\"value\"\f}\n");
+}
+
+TEST_F(JsonStructuralScannerTest, deep_nesting)
+{
+    const size_t depth = 10000;
+    string json = string(depth, '[') + "1" + string(depth, ']');
+
+    vector<string> events;
+    EXPECT_EQ(scan(json, events), JsonStructuralScanner::st_ok);
+    EXPECT_EQ(events, yajlEvents(json));
+    EXPECT_EQ(static_cast<size_t>(count(events.begin(), events.end(), "[")), depth);
+    EXPECT_EQ(static_cast<size_t>(count(events.begin(), events.end(), "]")), depth);
+
+    vector<string> chunked_events;
+    EXPECT_EQ(scan(json, chunked_events, 7), JsonStructuralScanner::st_ok);
+    EXPECT_EQ(chunked_events, events);
+
+    string maps;
+    for (size_t level = 0; level < depth; level++) maps += "{\"k\":";
+    maps += "null" + string(depth, '}');
+    EXPECT_EQ(scan(maps, events, 64), JsonStructuralScanner::st_ok);
+    EXPECT_EQ(events, yajlEvents(maps));
+
+    expectError(string(100, '[') + string(99, ']'));
+}
+
+TEST_F(JsonStructuralScannerTest, escapes)
+{
+    expectSameAsYajl("[\"quote \\\" backslash \\\\ slash \\/ controls \\b\\f\\n\\r\\t\"]");
+    expectSameAsYajl("{\"\\u0041\\u00e9\\u20ac\": \"\\ud83d\\ude00\"}");
+    expectSameAsYajl("[\"\\\\\", \"\\\\\\\"\", \"\\\\\\\\\"]");
+    // An unpaired surrogate is replaced the way yajl replaces it
+    expectSameAsYajl("[\"\\ud83d\", \"\\ud83dx\"]");
+
+    vector<string> events;
+    EXPECT_EQ(scan("[\"a\\nb\"]", events), JsonStructuralScanner::st_ok);
+    EXPECT_THAT(events, ElementsAre("[", "str:a\nb", "]"));
+
+    expectError("[\"bad escape \\x\"]");
+    expectError("[\"bad unicode \\u12g4\"]");
+}
+
+TEST_F(JsonStructuralScannerTest, escapes_across_blocks)
+{
+    // Runs of backslashes that cross the 64 bytes blocks of the structural index
+    for (size_t prefix = 55; prefix < 70; prefix++) {
+        expectSameAsYajl("[\"" + string(prefix, 'a') + "\\\\\\\"\\\\\", 1]");
+    }
+}
+
+TEST_F(JsonStructuralScannerTest, invalid_utf8_is_passed_as_is)
+{
+    string invalid_utf8 = "\xff\xfe\xc3\x28\xe2\x82";
+    string json = "{\"" + invalid_utf8 + "\": \"" + invalid_utf8 + "\"}";
+    expectSameAsYajl(json);
+
+    vector<string> events;
+    EXPECT_EQ(scan(json, events), JsonStructuralScanner::st_ok);
+    EXPECT_THAT(events, ElementsAre("{", "key:" + invalid_utf8, "str:" + invalid_utf8, "}"));
+
+    // Control characters are never allowed in strings
+    expectError("[\"line\nbreak\"]");
+}
+
+TEST_F(JsonStructuralScannerTest, truncated_input)
+{
+    expectError("[1, 2");
+    expectError("{\"a\": ");
+    expectError("{\"a\"");
+    expectError("{\"a\": \"text");
+    expectError("[\"escape \\u00");
+    expectError("[tru");
+    expectError("[nul");
+    expectError("[1.");
+    expectError("[1e");
+    expectError("[-");
+}
+
+TEST_F(JsonStructuralScannerTest, numbers_at_buffer_edges)
+{
+    expectSameAsYajl("[0, -0, 12345678901234567890, -1.5, 2.25e10, 3E-2, 4e+5, 0.000001]");
+    expectSameAsYajl("{\"n\":-123.456e-7}");
+    expectSameAsYajl("123");
+    // yajl lexes "0123" as two values, which are allowed at the top level
+    expectSameAsYajl("0123");
+    expectSameAsYajl("true1");
+
+    // Numbers that end exactly at the end of a 64 bytes block, and right after it
+    for (size_t padding = 50; padding < 66; padding++) {
+        expectSameAsYajl("[" + string(padding, ' ') + "98765.4321e+10, 1]");
+    }
+
+    vector<string> events;
+    EXPECT_EQ(scan("[1234567, 89]", events, 3), JsonStructuralScanner::st_ok);
+    EXPECT_THAT(events, ElementsAre("[", "num:1234567", "num:89", "]"));
+
+    expectError("[1.e5]");
+    expectError("[--1]");
+}
+
+TEST_F(JsonStructuralScannerTest, large_bodies)
+{
+    // Bodies larger than the index that is kept between calls, parsed once whole and once in large chunks
+    string json = "[";
+    for (int i = 0; i < 50000; i++) json += "\"value\\n" + to_string(i) + "\", " + to_string(i) + ", ";
+    json += "null]";
+
+    vector<string> expected = yajlEvents(json);
+    vector<string> events;
+    EXPECT_EQ(scan(json, events), JsonStructuralScanner::st_ok);
+    EXPECT_EQ(events, expected);
+    EXPECT_EQ(scan(json, events, 300000), JsonStructuralScanner::st_ok);
+    EXPECT_EQ(events, expected);
+}
+
+TEST_F(JsonStructuralScannerTest, comments_are_left_to_yajl)
+{
+    string json = "{\"a\": [1, /* comment */ 2]}";
+    JsonEvents recorder;
+    JsonStructuralScanner scanner(&JsonEvents::callbacks, &recorder);
+
+    EXPECT_EQ(scanner.parse(json.data(), json.size()), JsonStructuralScanner::st_unsupported);
+    EXPECT_EQ(scanner.bytesConsumed(), json.find('/'));
+    EXPECT_EQ(scanner.getYajlPrefix(), "{\"\":[null,");
+    EXPECT_THAT(recorder.events, ElementsAre("{", "key:a", "[", "num:1"));
+}
@@ -50,3 +50,19 @@ AssetMatcher::evalVariable() const
 
     return bc_asset_id_ctx.ok() && *bc_asset_id_ctx == asset_id;
 }
+
+Maybe<set<string>>
+AssetMatcher::lookupIndexValues()
+{
+    I_Environment *env = Singleton::Consume<I_Environment>::by<AssetMatcher>();
+    auto bc_asset_id_ctx = env->get<GenericConfigId>(AssetMatcher::ctx_key);
+    if (!bc_asset_id_ctx.ok()) return set<string>();
+    return set<string>{ bc_asset_id_ctx.unpack() };
+}
+
+Maybe<set<string>>
+AssetMatcher::getIndexValues(const string &index) const
+{
+    if (index != getIndexName()) return genError("Not indexed by " + index);
+    return set<string>{ asset_id };
+}
@@ -27,6 +27,22 @@ USE_DEBUG_FLAG(D_RULEBASE_CONFIG);
 using namespace std;
 using namespace EnvironmentHelper;
 
+static string
+toLower(string str)
+{
+    transform(str.begin(), str.end(), str.begin(), ::tolower);
+    return str;
+}
+
+// Adds the host, and the host without the port if it has one, as both are matched.
+static void
+addHostIndexValues(const string &host, set<string> &values)
+{
+    values.insert(host);
+    size_t pos = host.find_last_of(':');
+    if (pos != string::npos) values.insert(host.substr(0, pos));
+}
+
 EqualHost::EqualHost(const vector<string> &params)
 {
     if (params.size() != 1) reportWrongNumberOfParams("EqualHost", params.size(), 1, 1);
@@ -58,6 +74,28 @@ EqualHost::evalVariable() const
     return lower_host_ctx == lower_host;
 }
 
+Maybe<set<string>>
+EqualHost::lookupIndexValues()
+{
+    I_Environment *env = Singleton::Consume<I_Environment>::by<EqualHost>();
+    auto host_ctx = env->get<string>(HttpTransactionData::host_name_ctx);
+    if (!host_ctx.ok()) return set<string>();
+
+    set<string> values;
+    string lower_host_ctx = toLower(host_ctx.unpack());
+    addHostIndexValues(lower_host_ctx, values);
+    size_t pos = lower_host_ctx.find_first_of(".");
+    if (pos != string::npos) addHostIndexValues("*" + lower_host_ctx.substr(pos), values);
+    return values;
+}
+
+Maybe<set<string>>
+EqualHost::getIndexValues(const string &index) const
+{
+    if (index != getIndexName()) return genError("Not indexed by " + index);
+    return set<string>{ toLower(host) };
+}
+
 WildcardHost::WildcardHost(const vector<string> &params)
 {
     if (params.size() != 1) reportWrongNumberOfParams("WildcardHost", params.size(), 1, 1);
@@ -103,6 +141,13 @@ WildcardHost::evalVariable() const
     return lower_host_ctx == lower_host;
 }
 
+Maybe<set<string>>
+WildcardHost::getIndexValues(const string &index) const
+{
+    if (index != EqualHost::getIndexName()) return genError("Not indexed by " + index);
+    return set<string>{ toLower(host) };
+}
+
 EqualListeningIP::EqualListeningIP(const vector<string> &params)
 {
     if (params.size() != 1) reportWrongNumberOfParams("EqualListeningIP", params.size(), 1, 1);
@@ -141,6 +186,22 @@ EqualListeningPort::evalVariable() const
     return port_ctx.ok() && port_ctx.unpack() == listening_port;
 }
 
+Maybe<set<string>>
+EqualListeningPort::lookupIndexValues()
+{
+    I_Environment *env = Singleton::Consume<I_Environment>::by<EqualListeningPort>();
+    auto port_ctx = env->get<PortNumber>(HttpTransactionData::listening_port_ctx);
+    if (!port_ctx.ok()) return set<string>();
+    return set<string>{ to_string(port_ctx.unpack()) };
+}
+
+Maybe<set<string>>
+EqualListeningPort::getIndexValues(const string &index) const
+{
+    if (index != getIndexName()) return genError("Not indexed by " + index);
+    return set<string>{ to_string(listening_port) };
+}
+
 BeginWithUri::BeginWithUri(const vector<string> &params)
 {
     if (params.size() != 1) reportWrongNumberOfParams("BeginWithUri", params.size(), 1, 1);
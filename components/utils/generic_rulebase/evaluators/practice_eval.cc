@@ -48,3 +48,20 @@ PracticeMatcher::evalVariable() const
     auto rule = getConfiguration<BasicRuleConfig>("rulebase", "rulesConfig");
     return rule.ok() && rule.unpack().isPracticeActive(practice_id);
 }
+
+// Without the practices in the context the practices of the matching rule are used, and they are not indexed.
+Maybe<set<string>>
+PracticeMatcher::lookupIndexValues()
+{
+    I_Environment *env = Singleton::Consume<I_Environment>::by<PracticeMatcher>();
+    auto bc_practice_id_ctx = env->get<set<GenericConfigId>>(PracticeMatcher::ctx_key);
+    if (!bc_practice_id_ctx.ok()) return genError("No practices in the context");
+    return set<string>(bc_practice_id_ctx.unpack().begin(), bc_practice_id_ctx.unpack().end());
+}
+
+Maybe<set<string>>
+PracticeMatcher::getIndexValues(const string &index) const
+{
+    if (index != getIndexName()) return genError("Not indexed by " + index);
+    return set<string>{ practice_id };
+}
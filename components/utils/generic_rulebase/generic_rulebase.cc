@@ -84,6 +84,10 @@ GenericRulebase::Impl::preload()
     addMatcher<EqualListeningIP>();
     addMatcher<EqualListeningPort>();
     addMatcher<BeginWithUri>();
+    addContextIndex<EqualHost>();
+    addContextIndex<EqualListeningPort>();
+    addContextIndex<AssetMatcher>();
+    addContextIndex<PracticeMatcher>();
     BasicRuleConfig::preload();
     LogTriggerConf::preload();
     ParameterException::preload();
@@ -362,22 +362,26 @@ MatchQuery::matchAttributesString(const set<string> &values) const
     return false;
 }
 
+// Every IP match of every exception is given the same addresses of the current transaction, so the last parsed
+// address is kept instead of parsing it again on each lookup
+static Maybe<IPAddr>
+parseIpAddr(const string &ip_str)
+{
+    static thread_local string last_ip_str;
+    static thread_local Maybe<IPAddr> last_ip_addr = genError("No IP address was parsed");
+    if (ip_str != last_ip_str) {
+        last_ip_str = ip_str;
+        last_ip_addr = IPAddr::createIPAddr(ip_str);
+    }
+    return last_ip_addr;
+}
+
 bool
 MatchQuery::matchAttributesIp(const set<string> &values) const
 {
     for (const string &requested_value : values) {
-        int left = 0;
-        int right = ip_addr_value.size() - 1;
-        IpAddress ip_addr = IPUtilities::createIpFromString(requested_value);
-        while (left <= right) {
-            int mid = left + (right - left) / 2;
-            if (IPUtilities::isIpAddrInRange(ip_addr_value[mid], ip_addr)) return true;
-            if (ip_addr_value[mid].start < ip_addr) {
-                left = mid + 1;
-            } else {
-                right = mid - 1;
-            }
-        }
+        auto ip_addr = parseIpAddr(requested_value);
+        if (ip_addr.ok() && ip_addr_set.contains(ip_addr.unpack())) return true;
     }
     return false;
 }
@@ -407,4 +411,5 @@ MatchQuery::sortAndMergeIpRangesValues()
     }
 
     ip_addr_value.resize(mergedIndex + 1);
+    ip_addr_set = IPUtilities::IpRangeSet(ip_addr_value);
 }
@@ -13,7 +13,7 @@
 
 #include "ip_utilities.h"
 
-#include "connkey.h"
+#include <algorithm>
 
 using namespace std;
 
@@ -95,8 +95,8 @@ createRangeFromCidrV4(const pair<string, int> &cidr_values)
         address.erase(0, delimiter_pos + 1);
     }
 
-    unsigned int mask = 0xffffffff;
-    mask <<= (32 - mask_size);
+    // Shifting by the full width of the mask is undefined, so a zero size mask is set explicitly.
+    unsigned int mask = mask_size == 0 ? 0 : 0xffffffff << (32 - mask_size);
 
     unsigned int start, end;
     tie(start, end) = applyMaskOnAddress<unsigned int>(oct, mask);
@@ -155,7 +155,7 @@ createRangeFromCidrV6(const pair<string, int> &cidr_values)
         };
     } else {
         oct_offset = 3;
-        mask <<= (64 - mask_size);
+        mask = mask_size == 0 ? 0 : mask << (64 - mask_size);
         construct_address = [](uint64_t value, bool is_start)
         {
             stringstream address_stream;
@@ -360,4 +360,101 @@ IpAttrFromString::operator Maybe<Port>()
 
     return static_cast<Port>(value);
 }
+
+IpRangeSet::IpRangeSet(const vector<IPRange> &ranges)
+{
+    for (const IPRange &range : ranges) {
+        if (range.start.ip_type != range.end.ip_type) continue;
+        if (range.start.ip_type == IP_VERSION_4) {
+            v4_ranges.emplace_back(toValue(range.start.addr4_t), toValue(range.end.addr4_t));
+        } else if (range.start.ip_type == IP_VERSION_6) {
+            v6_ranges.emplace_back(toValue(range.start.addr6_t), toValue(range.end.addr6_t));
+        }
+    }
+    sortAndMerge(v4_ranges);
+    sortAndMerge(v6_ranges);
+}
+
+bool
+IpRangeSet::contains(const IPAddr &ip) const
+{
+    if (ip.getType() == IPType::V4) return isInRanges(v4_ranges, toValue(ip.getIPv4()));
+    if (ip.getType() == IPType::V6) return isInRanges(v6_ranges, toValue(ip.getIPv6()));
+    return false;
+}
+
+bool
+IpRangeSet::contains(const IpAddress &ip) const
+{
+    if (ip.ip_type == IP_VERSION_4) return isInRanges(v4_ranges, toValue(ip.addr4_t));
+    if (ip.ip_type == IP_VERSION_6) return isInRanges(v6_ranges, toValue(ip.addr6_t));
+    return false;
+}
+
+template <typename Value>
+void
+IpRangeSet::sortAndMerge(vector<pair<Value, Value>> &ranges)
+{
+    auto is_reversed = [] (const pair<Value, Value> &range) { return range.second < range.first; };
+    ranges.erase(remove_if(ranges.begin(), ranges.end(), is_reversed), ranges.end());
+    if (ranges.empty()) return;
+
+    sort(ranges.begin(), ranges.end());
+    size_t merged_index = 0;
+    for (size_t i = 1; i < ranges.size(); ++i) {
+        // Adjacent ranges are merged too, so the set holds as few ranges as possible
+        if (ranges[i].first <= ranges[merged_index].second || isNext(ranges[merged_index].second, ranges[i].first)) {
+            ranges[merged_index].second = max(ranges[merged_index].second, ranges[i].second);
+        } else {
+            ranges[++merged_index] = ranges[i];
+        }
+    }
+    ranges.resize(merged_index + 1);
+    ranges.shrink_to_fit();
+}
+
+template <typename Value>
+bool
+IpRangeSet::isInRanges(const vector<pair<Value, Value>> &ranges, const Value &value)
+{
+    // The ranges are disjoint and sorted, so only the last range that starts at or before the value can hold it.
+    auto next_range = upper_bound(
+        ranges.begin(),
+        ranges.end(),
+        value,
+        [] (const Value &value, const pair<Value, Value> &range) { return value < range.first; }
+    );
+    if (next_range == ranges.begin()) return false;
+    return value <= prev(next_range)->second;
+}
+
+bool
+IpRangeSet::isNext(uint32_t value, uint32_t next)
+{
+    return value != UINT32_MAX && next == value + 1;
+}
+
+bool
+IpRangeSet::isNext(const V6Value &value, const V6Value &next)
+{
+    if (value.second != UINT64_MAX) return next.first == value.first && next.second == value.second + 1;
+    return value.first != UINT64_MAX && next.first == value.first + 1 && next.second == 0;
+}
+
+uint32_t
+IpRangeSet::toValue(const struct in_addr &ip)
+{
+    return ntohl(ip.s_addr);
+}
+
+IpRangeSet::V6Value
+IpRangeSet::toValue(const struct in6_addr &ip)
+{
+    uint64_t high = 0, low = 0;
+    for (int i = 0; i < 8; i++) {
+        high = (high << 8) | ip.s6_addr[i];
+        low = (low << 8) | ip.s6_addr[i + 8];
+    }
+    return V6Value(high, low);
+}
 }
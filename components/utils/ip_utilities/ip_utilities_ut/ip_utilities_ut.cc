@@ -0,0 +1,120 @@
+#include "ip_utilities.h"
+
+#include <string>
+#include <vector>
+
+#include "cptest.h"
+
+using namespace std;
+using namespace testing;
+using namespace IPUtilities;
+
+static IPRange
+range(const string &range_str)
+{
+    auto res = createRangeFromString<IPRange, IpAddress>(range_str, "ip range");
+    EXPECT_TRUE(res.ok()) << res.getErr();
+    return res.unpack();
+}
+
+static IpAddress
+ip(const string &ip_str)
+{
+    return createIpFromString(ip_str);
+}
+
+TEST(IpRangeSetTest, empty_set)
+{
+    IpRangeSet empty_set;
+    EXPECT_TRUE(empty_set.empty());
+    EXPECT_EQ(empty_set.size(), 0u);
+    EXPECT_FALSE(empty_set.contains(ip("0.0.0.0")));
+    EXPECT_FALSE(empty_set.contains(ip("::")));
+
+    IpRangeSet built_from_nothing(vector<IPRange>{});
+    EXPECT_TRUE(built_from_nothing.empty());
+    EXPECT_FALSE(built_from_nothing.contains(ip("10.0.0.1")));
+    EXPECT_FALSE(built_from_nothing.contains(IPAddr::createIPAddr("10.0.0.1").unpack()));
+}
+
+TEST(IpRangeSetTest, overlapping_ranges_are_merged)
+{
+    IpRangeSet set({ range("10.0.0.50-10.0.0.200"), range("10.0.0.0/24"), range("10.0.0.100-10.0.1.10") });
+    EXPECT_EQ(set.size(), 1u);
+
+    EXPECT_FALSE(set.contains(ip("9.255.255.255")));
+    EXPECT_TRUE(set.contains(ip("10.0.0.0")));
+    EXPECT_TRUE(set.contains(ip("10.0.0.255")));
+    EXPECT_TRUE(set.contains(ip("10.0.1.10")));
+    EXPECT_FALSE(set.contains(ip("10.0.1.11")));
+}
+
+TEST(IpRangeSetTest, adjacent_ranges_are_merged)
+{
+    IpRangeSet set({ range("10.0.1.0/24"), range("10.0.0.0/24"), range("10.0.3.0/24") });
+    EXPECT_EQ(set.size(), 2u);
+
+    EXPECT_TRUE(set.contains(ip("10.0.0.255")));
+    EXPECT_TRUE(set.contains(ip("10.0.1.0")));
+    EXPECT_FALSE(set.contains(ip("10.0.2.0")));
+    EXPECT_TRUE(set.contains(ip("10.0.3.0")));
+
+    IpRangeSet v6_set({ range("2001:db8::-2001:db8::ffff:ffff:ffff:ffff"), range("2001:db8:0:1::/64") });
+    EXPECT_EQ(v6_set.size(), 1u);
+    EXPECT_TRUE(v6_set.contains(ip("2001:db8::ffff:ffff:ffff:ffff")));
+    EXPECT_TRUE(v6_set.contains(ip("2001:db8:0:1::")));
+    EXPECT_FALSE(v6_set.contains(ip("2001:db8:0:2::")));
+}
+
+TEST(IpRangeSetTest, whole_and_single_address_v4_ranges)
+{
+    IpRangeSet all_set({ range("0.0.0.0/0") });
+    EXPECT_EQ(all_set.size(), 1u);
+    EXPECT_TRUE(all_set.contains(ip("0.0.0.0")));
+    EXPECT_TRUE(all_set.contains(ip("128.0.0.1")));
+    EXPECT_TRUE(all_set.contains(ip("255.255.255.255")));
+    EXPECT_FALSE(all_set.contains(ip("::1")));
+
+    IpRangeSet single_set({ range("192.168.1.1/32"), range("255.255.255.255/32") });
+    EXPECT_EQ(single_set.size(), 2u);
+    EXPECT_TRUE(single_set.contains(ip("192.168.1.1")));
+    EXPECT_FALSE(single_set.contains(ip("192.168.1.0")));
+    EXPECT_FALSE(single_set.contains(ip("192.168.1.2")));
+    EXPECT_TRUE(single_set.contains(ip("255.255.255.255")));
+    EXPECT_FALSE(single_set.contains(ip("255.255.255.254")));
+}
+
+TEST(IpRangeSetTest, single_address_v6_ranges)
+{
+    IpRangeSet set({ range("2001:db8::1/128"), range("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff/128") });
+    EXPECT_EQ(set.size(), 2u);
+
+    EXPECT_TRUE(set.contains(ip("2001:db8::1")));
+    EXPECT_FALSE(set.contains(ip("2001:db8::")));
+    EXPECT_FALSE(set.contains(ip("2001:db8::2")));
+    EXPECT_TRUE(set.contains(ip("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff")));
+    EXPECT_FALSE(set.contains(ip("ffff:ffff:ffff:ffff:ffff:ffff:ffff:fffe")));
+
+    // The low half of the address carries into the high half
+    IpRangeSet carry_set({ range("2001:db8::ffff:ffff:ffff:ffff/128"), range("2001:db8:0:1::/128") });
+    EXPECT_EQ(carry_set.size(), 1u);
+}
+
+TEST(IpRangeSetTest, mixed_v4_and_v6_ranges)
+{
+    IPRange mixed_range;
+    mixed_range.start = ip("10.0.0.0");
+    mixed_range.end = ip("::ffff");
+
+    IpRangeSet set({ range("10.0.0.0/8"), range("::/96"), mixed_range });
+    EXPECT_EQ(set.size(), 2u);
+
+    EXPECT_TRUE(set.contains(ip("10.1.2.3")));
+    EXPECT_FALSE(set.contains(ip("11.0.0.0")));
+    EXPECT_TRUE(set.contains(ip("::ffff:ffff")));
+    EXPECT_FALSE(set.contains(ip("::1:0:0")));
+    // An IPv4 address is not looked up in the IPv6 ranges, even where their values overlap
+    EXPECT_FALSE(set.contains(ip("0.0.0.1")));
+    EXPECT_TRUE(set.contains(IPAddr::createIPAddr("10.1.2.3").unpack()));
+    EXPECT_TRUE(set.contains(IPAddr::createIPAddr("::1").unpack()));
+}
@@ -420,6 +420,26 @@ kiss_thin_nfa_exec_one_buf_parallel_ex(
 }
 
 
+// Run the Thin NFA over all segments of a buffer, continuing from the runtime's state.
+static void
+kiss_thin_nfa_exec_segments(struct kiss_bnfa_runtime_s *runtime, const Buffer &buf)
+{
+    KissThinNFA *nfa_h = runtime->nfa_h;
+    auto segments = buf.segRange();
+    for( auto iter = segments.begin(); iter != segments.end(); iter++ ) {
+        const u_char * data = iter->data();
+        u_int len = iter->size();
+        u_int flags = ((iter+1)==segments.end()) ? KISS_PM_EXEC_LAST_BUFF : 0;
+        if (nfa_h->flags & KISS_THIN_NFA_USE_CHAR_XLATION) {
+            kiss_thin_nfa_exec_one_buf_parallel_ex(runtime, data, len, flags, TRUE, nfa_h->xlation_tab);
+        } else {
+            kiss_thin_nfa_exec_one_buf_parallel_ex(runtime, data, len, flags, FALSE, nullptr);
+        }
+        runtime->scanned_so_far += len;
+    }
+}
+
+
 // Execute a thin NFA on a buffer.
 // Parameters:
 //   nfa_h             - the NFA handle
@@ -444,18 +464,45 @@ kiss_thin_nfa_exec(KissThinNFA *nfa_h, const Buffer& buf, std::vector<std::pair<
     bnfa_runtime.matches = &matches;
     bnfa_runtime.scanned_so_far = 0;
 
-    auto segments = buf.segRange();
-    for( auto iter = segments.begin(); iter != segments.end(); iter++ ) {
-        const u_char * data = iter->data();
-        u_int len = iter->size();
-        u_int flags = ((iter+1)==segments.end()) ? KISS_PM_EXEC_LAST_BUFF : 0;
-        if (nfa_h->flags & KISS_THIN_NFA_USE_CHAR_XLATION) {
-            kiss_thin_nfa_exec_one_buf_parallel_ex(&bnfa_runtime, data, len, flags, TRUE, nfa_h->xlation_tab);
-        } else {
-            kiss_thin_nfa_exec_one_buf_parallel_ex(&bnfa_runtime, data, len, flags, FALSE, nullptr);
-        }
-        bnfa_runtime.scanned_so_far += len;
-    }
+    kiss_thin_nfa_exec_segments(&bnfa_runtime, buf);
 
     return;
 }
+
+
+// Execute a thin NFA on the next buffer of a stream.
+// Parameters:
+//   nfa_h             - the NFA handle
+//   buf               - the next buffer of the stream.
+//   last_bnfa_offset  - input/output - the state reached at the end of the previous buffer.
+//   scanned_so_far    - input/output - the length of the previous buffers. 0 starts a new stream.
+//   matches           - output - will be filled with (pattern id, stream offset) for each match.
+void
+kiss_thin_nfa_exec_stream(
+    KissThinNFA *nfa_h,
+    const Buffer &buf,
+    kiss_bnfa_comp_offset_t &last_bnfa_offset,
+    u_int &scanned_so_far,
+    std::vector<std::pair<uint, uint>> &matches)
+{
+    struct kiss_bnfa_runtime_s bnfa_runtime;
+
+    dbgAssert(nfa_h != nullptr)
+        << AlertInfo(AlertTeam::CORE, "pattern matcher")
+        << "kiss_thin_nfa_exec_stream() was called with null handle";
+
+    if (buf.size() == 0) {
+        return;
+    }
+
+    bnfa_runtime.nfa_h = nfa_h;
+    bnfa_runtime.last_bnfa_offset =
+        scanned_so_far == 0 ? kiss_bnfa_offset_compress(nfa_h->min_bnfa_offset) : last_bnfa_offset;
+    bnfa_runtime.matches = &matches;
+    bnfa_runtime.scanned_so_far = scanned_so_far;
+
+    kiss_thin_nfa_exec_segments(&bnfa_runtime, buf);
+
+    last_bnfa_offset = bnfa_runtime.last_bnfa_offset;
+    scanned_so_far = bnfa_runtime.scanned_so_far;
+}
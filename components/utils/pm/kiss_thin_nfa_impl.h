@@ -165,6 +165,18 @@ BOOL kiss_thin_nfa_is_valid(const KissThinNFA *nfa_h);
 void
 kiss_thin_nfa_exec(KissThinNFA *nfa_h, const Buffer &buffer, std::vector<std::pair<uint, uint>> &matches);
 
+// Execute a Thin NFA on the next buffer of a stream.
+// last_bnfa_offset and scanned_so_far hold the state reached by the previous buffers, and are updated.
+// When scanned_so_far is 0, the scan starts at the initial state.
+void
+kiss_thin_nfa_exec_stream(
+    KissThinNFA *nfa_h,
+    const Buffer &buffer,
+    kiss_bnfa_comp_offset_t &last_bnfa_offset,
+    u_int &scanned_so_far,
+    std::vector<std::pair<uint, uint>> &matches
+);
+
 // Dump a PM
 kiss_ret_val kiss_thin_nfa_dump(const KissThinNFA *nfa_h, enum kiss_pm_dump_format_e format);
 
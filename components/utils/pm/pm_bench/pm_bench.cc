@@ -0,0 +1,133 @@
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "cptest/cptest_bench_inputs.h"
+#include "pm_hook.h"
+
+using namespace std;
+
+enum class InputType { BENIGN_JSON, ATTACKS, BINARY };
+
+static string
+generateInput(InputType type, size_t size)
+{
+    switch (type) {
+        case InputType::BENIGN_JSON:
+            return cptestBenignJson(size);
+        case InputType::ATTACKS: {
+            // Attack payloads hidden in an otherwise benign document, as they show up in real requests.
+            string input = cptestBenignJson(size);
+            const auto &sqli = cptestSqliPayloads();
+            const auto &xss = cptestXssPayloads();
+            for (size_t offset = 0, index = 0; offset < input.size(); offset += 512, index++) {
+                const string &payload = index % 2 == 0 ? sqli[index % sqli.size()] : xss[index % xss.size()];
+                input.replace(offset, min(payload.size(), input.size() - offset), payload);
+            }
+            return input;
+        }
+        case InputType::BINARY:
+            return cptestBinaryData(size);
+    }
+    return "";
+}
+
+static const PMHook &
+getKeywordsHook()
+{
+    static PMHook hook;
+    if (!hook.ok()) {
+        set<PMPattern> patterns;
+        uint index = 0;
+        for (const string &keyword : cptestAttackKeywords()) patterns.emplace(keyword, false, false, index++);
+        hook.prepare(patterns);
+    }
+    return hook;
+}
+
+static void
+BM_PMHookPrepare(benchmark::State &state)
+{
+    set<PMPattern> patterns;
+    uint index = 0;
+    for (const string &keyword : cptestAttackKeywords()) patterns.emplace(keyword, false, false, index++);
+
+    for (auto _ : state) {
+        PMHook hook;
+        benchmark::DoNotOptimize(hook.prepare(patterns));
+    }
+    state.SetItemsProcessed(state.iterations() * patterns.size());
+}
+BENCHMARK(BM_PMHookPrepare);
+
+static void
+BM_PMHookScanBuf(benchmark::State &state, InputType type)
+{
+    const PMHook &hook = getKeywordsHook();
+    Buffer input(generateInput(type, state.range(0)));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(hook.scanBuf(input));
+    }
+    state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK_CAPTURE(BM_PMHookScanBuf, benign_json, InputType::BENIGN_JSON)->Range(1 << 10, 1 << 20);
+BENCHMARK_CAPTURE(BM_PMHookScanBuf, attacks, InputType::ATTACKS)->Range(1 << 10, 1 << 20);
+BENCHMARK_CAPTURE(BM_PMHookScanBuf, binary, InputType::BINARY)->Range(1 << 10, 1 << 20);
+
+static void
+BM_PMHookScanBufWithOffset(benchmark::State &state, InputType type)
+{
+    const PMHook &hook = getKeywordsHook();
+    Buffer input(generateInput(type, state.range(0)));
+
+    for (auto _ : state) {
+        uint matches = 0;
+        hook.scanBufWithOffsetLambda(input, [&matches] (uint, const PMPattern &, bool) { matches++; });
+        benchmark::DoNotOptimize(matches);
+    }
+    state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK_CAPTURE(BM_PMHookScanBufWithOffset, benign_json, InputType::BENIGN_JSON)->Range(1 << 10, 1 << 20);
+BENCHMARK_CAPTURE(BM_PMHookScanBufWithOffset, attacks, InputType::ATTACKS)->Range(1 << 10, 1 << 20);
+
+// A body that arrived in many chunks is scanned as a buffer of many segments.
+static void
+BM_PMHookScanSegmentedBuf(benchmark::State &state)
+{
+    const PMHook &hook = getKeywordsHook();
+    string data = generateInput(InputType::ATTACKS, 1 << 20);
+    Buffer input;
+    for (size_t offset = 0; offset < data.size(); offset += state.range(0)) {
+        input += Buffer(data.substr(offset, state.range(0)));
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(hook.scanBuf(input));
+    }
+    state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_PMHookScanSegmentedBuf)->Range(1 << 10, 1 << 16);
+
+// The many short values of a parsed request (header values, parameters) are scanned one by one.
+static void
+BM_PMHookScanShortValues(benchmark::State &state)
+{
+    const PMHook &hook = getKeywordsHook();
+    vector<Buffer> values;
+    for (const string &payload : cptestSqliPayloads()) values.emplace_back(payload);
+    for (const string &payload : cptestXssPayloads()) values.emplace_back(payload);
+    for (uint index = 0; index < 100; index++) values.emplace_back("value-" + to_string(index));
+
+    size_t bytes = 0;
+    for (const Buffer &value : values) bytes += value.size();
+
+    for (auto _ : state) {
+        for (const Buffer &value : values) benchmark::DoNotOptimize(hook.scanBuf(value));
+    }
+    state.SetItemsProcessed(state.iterations() * values.size());
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_PMHookScanShortValues);
+
+BENCHMARK_MAIN();
@@ -170,6 +170,29 @@ PMHook::scanBufWithOffsetLambda(const Buffer &buf, I_PMScan::CBFunction cb) cons
     dbgTrace(D_PM) << totalCount << " filtered matches found";
 }
 
+vector<pair<PMPattern, uint>>
+PMHook::scanStream(StreamState &state, const Buffer &buf) const
+{
+    dbgAssert(handle != nullptr) << AlertInfo(AlertTeam::CORE, "pattern matcher") << "Unusable Pattern Matcher";
+
+    if (state.nfa.lock() != handle) {
+        dbgTrace(D_PM) << "Starting a new stream scan";
+        state = StreamState();
+        state.nfa = handle;
+    }
+
+    vector<pair<uint, uint>> pm_matches;
+    kiss_thin_nfa_exec_stream(handle.get(), buf, state.bnfa_offset, state.scanned_so_far, pm_matches);
+    dbgTrace(D_PM) << pm_matches.size() << " raw matches found, " << state.scanned_so_far << " bytes scanned so far";
+
+    vector<pair<PMPattern, uint>> res;
+    res.reserve(pm_matches.size());
+    for (auto &match : pm_matches) {
+        res.emplace_back(patterns.at(match.first), match.second);
+    }
+    return res;
+}
+
 bool
 PMPattern::operator<(const PMPattern &other) const
 {
@@ -528,3 +528,42 @@ TEST(pm_scan, pm_offsets_lambda_test_pat_limit_noregex)
 
     EXPECT_EQ(results, expected);
 }
+
+TEST(pm_scan, stream_scan_across_buffers)
+{
+    PMHook pm;
+    EXPECT_TRUE(pm.prepare(getPatternSet("ABCD", "XYZ", "^ST", "END$")).ok());
+
+    PMHook::StreamState state;
+    set<pair<PMPattern, uint>> results;
+    for (auto &chunk : { "STA", "BC", "DxxAB", "CD XY", "Z ST", "END" }) {
+        for (auto &match : pm.scanStream(state, Buffer(string(chunk)))) {
+            results.insert(match);
+        }
+    }
+    EXPECT_EQ(state.getScannedBytes(), 22u);
+
+    set<pair<PMPattern, uint>> expected{
+        { PMPattern("ST", true, false), 1 },
+        { PMPattern("ABCD", false, false), 5 },
+        { PMPattern("ABCD", false, false), 11 },
+        { PMPattern("XYZ", false, false), 15 },
+        { PMPattern("END", false, true), 21 }
+    };
+    EXPECT_EQ(results, expected);
+}
+
+TEST(pm_scan, stream_scan_restarts_after_prepare)
+{
+    PMHook pm;
+    EXPECT_TRUE(pm.prepare(getPatternSet("ABCD")).ok());
+
+    PMHook::StreamState state;
+    EXPECT_TRUE(pm.scanStream(state, Buffer(string("xxAB"))).empty());
+    EXPECT_TRUE(pm.prepare(getPatternSet("ABCD", "CD")).ok());
+
+    auto res = pm.scanStream(state, Buffer(string("CD")));
+    vector<pair<PMPattern, uint>> expected{ { PMPattern("CD", false, false), 1 } };
+    EXPECT_EQ(res, expected);
+    EXPECT_EQ(state.getScannedBytes(), 2u);
+}
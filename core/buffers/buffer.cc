@@ -14,6 +14,7 @@
 #include "buffer.h"
 
 #include <string.h>
+#include <algorithm>
 
 using namespace std;
 
@@ -104,8 +105,8 @@ Buffer::operator=(Buffer &&buf)
 bool
 Buffer::contains(char ch) const
 {
-    for (const auto &iter : *this) {
-        if (iter == ch) return true;
+    for (const auto &seg : segs) {
+        if (memchr(seg.data(), ch, seg.size()) != nullptr) return true;
     }
     return false;
 }
@@ -175,15 +176,47 @@ Buffer::getSubBuffer(uint start, uint end) const
     return res;
 }
 
+Maybe<uint>
+Buffer::findFirst(const SegmentScanner &scanner, uint start) const
+{
+    dbgAssert(start <= len) << alert << "Buffer::findFirst() returned: Cannot set a start point after buffer's end";
+
+    uint offset = 0;
+    for (const auto &seg : segs) {
+        uint seg_end = offset + seg.size();
+        if (start < seg_end) {
+            uint local_start = start > offset ? start - offset : 0;
+            const u_char *seg_data = seg.data();
+            const u_char *match = scanner(seg_data + local_start, seg.size() - local_start);
+            if (match != nullptr) return offset + (match - seg_data);
+        }
+        offset = seg_end;
+    }
+    return genError("Not located");
+}
+
 Maybe<uint>
 Buffer::findFirstOf(char ch, uint start) const
 {
     dbgAssert(start <= len) << alert << "Buffer::findFirstOf() returned: Cannot set a start point after buffer's end";
 
-    for (; start < len; ++start) {
-        if ((*this)[start] == ch) return start;
+    return findFirst(
+        [ch] (const u_char *data, uint size) { return static_cast<const u_char *>(memchr(data, ch, size)); },
+        start
+    );
+}
+
+// Compares the pattern to the buffer's data from `pos` in the segment `seg`, continuing into the next segments.
+static bool
+isEqualFrom(Buffer::SegIterator seg, Buffer::SegIterator end, uint pos, const u_char *pattern, uint pattern_len)
+{
+    for (; seg != end && pattern_len > 0; ++seg, pos = 0) {
+        uint compare_len = min(seg->size() - pos, pattern_len);
+        if (memcmp(seg->data() + pos, pattern, compare_len) != 0) return false;
+        pattern += compare_len;
+        pattern_len -= compare_len;
     }
-    return genError("Not located");
+    return pattern_len == 0;
 }
 
 Maybe<uint>
@@ -191,9 +224,45 @@ Buffer::findFirstOf(const Buffer &buf, uint start) const
 {
     dbgAssert(start <= len) << alert << "Buffer::findFirstOf() returned: Cannot set a start point after buffer's end";
 
-    for (; start + buf.size() <= len; ++start) {
-        auto sub_buffer = getSubBuffer(start, start + buf.size());
-        if (sub_buffer == buf) return start;
+    if (start + buf.size() > len) return genError("Not located");
+    if (buf.size() == 0) return start;
+
+    // The pattern is typically short, so a segmented one is copied once rather than compared segment by segment.
+    vector<u_char> pattern_copy;
+    const u_char *pattern = buf.segs.front().data();
+    if (buf.segmentsNumber() > 1) {
+        pattern_copy.reserve(buf.size());
+        for (const auto &seg : buf.segs) pattern_copy.insert(pattern_copy.end(), seg.data(), seg.data() + seg.size());
+        pattern = pattern_copy.data();
+    }
+    uint pattern_len = buf.size();
+    uint last_start = len - pattern_len;
+
+    uint offset = 0;
+    for (auto seg = segs.begin(); seg != segs.end() && offset <= last_start; ++seg) {
+        uint seg_size = seg->size();
+        uint seg_end = offset + seg_size;
+        if (seg_end <= start) {
+            offset = seg_end;
+            continue;
+        }
+
+        const u_char *seg_data = seg->data();
+        uint pos = start > offset ? start - offset : 0;
+        // Matches that are contained in the segment precede the ones that cross into the next segments.
+        if (pos + pattern_len <= seg_size) {
+            auto match = memmem(seg_data + pos, seg_size - pos, pattern, pattern_len);
+            if (match != nullptr) return offset + (static_cast<const u_char *>(match) - seg_data);
+            pos = seg_size - pattern_len + 1;
+        }
+        for (; pos < seg_size && offset + pos <= last_start; pos++) {
+            auto candidate = memchr(seg_data + pos, pattern[0], seg_size - pos);
+            if (candidate == nullptr) break;
+            pos = static_cast<const u_char *>(candidate) - seg_data;
+            if (offset + pos > last_start) break;
+            if (isEqualFrom(seg, segs.end(), pos, pattern, pattern_len)) return offset + pos;
+        }
+        offset = seg_end;
     }
     return genError("Not located");
 }
@@ -204,18 +273,35 @@ Buffer::findFirstNotOf(char ch, uint start) const
     dbgAssert(start <= len)
         << alert
         << "Buffer::findFirstNotOf() returned: Cannot set a start point after buffer's end";
-    for (; start < len; ++start) {
-        if ((*this)[start] != ch) return start;
-    }
-    return genError("Everything is the same ch");
+
+    auto match = findFirst(
+        [ch] (const u_char *data, uint size) -> const u_char *
+        {
+            for (const u_char *end = data + size; data < end; data++) {
+                if (*data != static_cast<u_char>(ch)) return data;
+            }
+            return nullptr;
+        },
+        start
+    );
+    if (!match.ok()) return genError("Everything is the same ch");
+    return match;
 }
 
 Maybe<uint>
 Buffer::findLastOf(char ch, uint start) const
 {
     dbgAssert(start <= len) << alert << "Buffer::findLastOf() returned: Cannot set a start point after buffer's end";
-    for (; 0 < start; --start) {
-        if ((*this)[start - 1] == ch) return start - 1;
+
+    uint offset = len;
+    for (auto seg = segs.rbegin(); seg != segs.rend(); ++seg) {
+        uint seg_start = offset - seg->size();
+        if (seg_start < start) {
+            const u_char *seg_data = seg->data();
+            auto match = memrchr(seg_data, ch, min(start, offset) - seg_start);
+            if (match != nullptr) return seg_start + (static_cast<const u_char *>(match) - seg_data);
+        }
+        offset = seg_start;
     }
     return genError("Not located");
 }
@@ -226,8 +312,17 @@ Buffer::findLastNotOf(char ch, uint start) const
     dbgAssert(start <= len)
         << alert
         << "Buffer::findLastNotOf() returned: Cannot set a start point after buffer's end";
-    for (; 0 < start; --start) {
-        if ((*this)[start - 1] != ch) return start - 1;
+
+    uint offset = len;
+    for (auto seg = segs.rbegin(); seg != segs.rend(); ++seg) {
+        uint seg_start = offset - seg->size();
+        if (seg_start < start) {
+            const u_char *seg_data = seg->data();
+            for (uint pos = min(start, offset) - seg_start; pos > 0; pos--) {
+                if (seg_data[pos - 1] != static_cast<u_char>(ch)) return seg_start + pos - 1;
+            }
+        }
+        offset = seg_start;
     }
     return genError("Everything is the same ch");
 }
@@ -0,0 +1,134 @@
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "cptest/cptest_bench_inputs.h"
+#include "buffer.h"
+
+using namespace std;
+
+// A buffer of `size` bytes made of segments of `segment_size` bytes, like a body that arrived in many chunks.
+static Buffer
+generateSegmentedBuffer(size_t size, size_t segment_size)
+{
+    string data = cptestBenignJson(size);
+    data.resize(size);
+    Buffer buf;
+    for (size_t offset = 0; offset < size; offset += segment_size) buf += Buffer(data.substr(offset, segment_size));
+    return buf;
+}
+
+static void
+BM_BufferAppend(benchmark::State &state)
+{
+    Buffer chunk(cptestBinaryData(state.range(0)));
+
+    for (auto _ : state) {
+        Buffer buf;
+        for (uint index = 0; index < 64; index++) buf += chunk;
+        benchmark::DoNotOptimize(buf.size());
+    }
+    state.SetItemsProcessed(state.iterations() * 64);
+    state.SetBytesProcessed(state.iterations() * 64 * chunk.size());
+}
+BENCHMARK(BM_BufferAppend)->Range(64, 1 << 16);
+
+static void
+BM_BufferCharIteration(benchmark::State &state)
+{
+    Buffer buf = generateSegmentedBuffer(1 << 20, state.range(0));
+
+    for (auto _ : state) {
+        uint sum = 0;
+        for (u_char ch : buf) sum += ch;
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations() * buf.size());
+}
+BENCHMARK(BM_BufferCharIteration)->Range(1 << 10, 1 << 20);
+
+static void
+BM_BufferSegmentIteration(benchmark::State &state)
+{
+    Buffer buf = generateSegmentedBuffer(1 << 20, state.range(0));
+
+    for (auto _ : state) {
+        uint sum = 0;
+        for (const auto &seg : buf.segRange()) {
+            const u_char *data = seg.data();
+            for (uint index = 0; index < seg.size(); index++) sum += data[index];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations() * buf.size());
+}
+BENCHMARK(BM_BufferSegmentIteration)->Range(1 << 10, 1 << 20);
+
+static void
+BM_BufferRandomAccess(benchmark::State &state)
+{
+    Buffer buf = generateSegmentedBuffer(1 << 20, state.range(0));
+
+    for (auto _ : state) {
+        uint sum = 0;
+        for (uint offset = 0; offset < buf.size(); offset += 97) sum += buf[offset];
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * (buf.size() / 97 + 1));
+}
+BENCHMARK(BM_BufferRandomAccess)->Range(1 << 10, 1 << 20);
+
+static void
+BM_BufferFindFirstOf(benchmark::State &state)
+{
+    Buffer buf = generateSegmentedBuffer(1 << 20, state.range(0));
+    Buffer needle(string("\"zip\":\"99999\""));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(buf.findFirstOf('\x01'));
+        benchmark::DoNotOptimize(buf.findFirstOf(needle));
+    }
+    state.SetBytesProcessed(state.iterations() * buf.size() * 2);
+}
+BENCHMARK(BM_BufferFindFirstOf)->Range(1 << 10, 1 << 20);
+
+static void
+BM_BufferSerialize(benchmark::State &state)
+{
+    Buffer segmented = generateSegmentedBuffer(1 << 20, state.range(0));
+
+    for (auto _ : state) {
+        Buffer buf = segmented;
+        benchmark::DoNotOptimize(buf.data());
+    }
+    state.SetBytesProcessed(state.iterations() * segmented.size());
+}
+BENCHMARK(BM_BufferSerialize)->Range(1 << 10, 1 << 20);
+
+static void
+BM_BufferSubBuffer(benchmark::State &state)
+{
+    Buffer buf = generateSegmentedBuffer(1 << 20, 4096);
+
+    for (auto _ : state) {
+        for (uint offset = 0; offset + state.range(0) <= buf.size(); offset += 4096 * 7) {
+            benchmark::DoNotOptimize(buf.getSubBuffer(offset, offset + state.range(0)));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * (buf.size() / (4096 * 7)));
+}
+BENCHMARK(BM_BufferSubBuffer)->Range(16, 1 << 16);
+
+static void
+BM_BufferCompare(benchmark::State &state)
+{
+    Buffer first = generateSegmentedBuffer(1 << 20, state.range(0));
+    Buffer second = generateSegmentedBuffer(1 << 20, 4096);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(first == second);
+    }
+    state.SetBytesProcessed(state.iterations() * first.size());
+}
+BENCHMARK(BM_BufferCompare)->Range(1 << 10, 1 << 20);
+
+BENCHMARK_MAIN();
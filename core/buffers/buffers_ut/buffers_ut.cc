@@ -296,6 +296,10 @@ TEST_F(BuffersTest, add_compound)
     // Testing adding a buffer to itself, which is an extreme case.
     buf += buf;
     EXPECT_EQ(buf, Buffer("123123"));
+
+    Buffer single_segment("12");
+    single_segment += single_segment;
+    EXPECT_EQ(single_segment, Buffer("1212"));
 }
 
 string
@@ -480,6 +484,53 @@ TEST_F(BuffersTest, volatile_data)
     EXPECT_EQ(Buffer("1"), b);
 }
 
+TEST_F(BuffersTest, move_volatile_data)
+{
+    string str("0");
+    auto ptr = reinterpret_cast<const u_char *>(str.data());
+    Buffer b;
+    {
+        Buffer c(str.data(), 1, Buffer::MemoryType::VOLATILE);
+        Buffer d(move(c));
+        // Moving the buffer keeps it the PRIMARY holder of the memory, so its copy still points to the memory.
+        b = d;
+        EXPECT_EQ(ptr, d.data());
+        EXPECT_EQ(ptr, b.data());
+    }
+    EXPECT_NE(ptr, b.data());
+    str[0] = '1';
+    EXPECT_EQ(Buffer("0"), b);
+}
+
+TEST_F(BuffersTest, single_to_multiple_segments)
+{
+    string str("12");
+    auto ptr = reinterpret_cast<const u_char *>(str.data());
+    Buffer b(str.data(), 2, Buffer::MemoryType::VOLATILE);
+    b += Buffer("345");
+    EXPECT_EQ(b.segmentsNumber(), 2u);
+    EXPECT_EQ(ptr, b.segRange().begin()->data());
+    EXPECT_EQ(b, Buffer("12345"));
+
+    b.truncateHead(2);
+    EXPECT_EQ(b.segmentsNumber(), 1u);
+    EXPECT_EQ(b, Buffer("345"));
+
+    Buffer c = b;
+    c += b;
+    c += c.getSubBuffer(1, 5);
+    EXPECT_EQ(c.segmentsNumber(), 4u);
+    EXPECT_EQ(c, Buffer("3453454534"));
+    EXPECT_EQ(b, Buffer("345"));
+
+    c.truncateTail(7);
+    EXPECT_EQ(c.segmentsNumber(), 1u);
+    EXPECT_EQ(c, Buffer("345"));
+    c.truncateTail(3);
+    EXPECT_TRUE(c.isEmpty());
+    EXPECT_EQ(c.segmentsNumber(), 0u);
+}
+
 TEST_F(BuffersTest, truncate_volatile_data)
 {
     string str("123");
@@ -601,6 +652,19 @@ TEST_F(BuffersTest, serialization)
         ar(buf);
     }
     EXPECT_EQ(buf, Buffer("aaabbc"));
+
+    string long_str(100, 'a');
+    stringstream single_segment_stream;
+    {
+        cereal::JSONOutputArchive ar(single_segment_stream);
+        ar(Buffer(long_str));
+    }
+    {
+        cereal::JSONInputArchive ar(single_segment_stream);
+        ar(buf);
+    }
+    EXPECT_EQ(buf, Buffer(long_str));
+    EXPECT_EQ(buf.segmentsNumber(), 1u);
 }
 
 TEST_F (BuffersTest, find_first_of_ch)
@@ -657,6 +721,75 @@ TEST_F (BuffersTest, find_last_not_of)
     EXPECT_TRUE(b2 == b1.getSubBuffer(0, index.unpack()));
 }
 
+TEST_F (BuffersTest, find_across_segments)
+{
+    Buffer b1 = genBuf("--bound", "ary--bo", "undary") + Buffer("--");
+    string str = "--boundary--boundary--";
+    vector<string> patterns = { "boundary", "-", "--", "y--b", "ary--bo", "--bound", "undary--", "x", "" };
+
+    for (uint start = 0; start <= str.size(); start++) {
+        for (auto &pattern : patterns) {
+            auto index = b1.findFirstOf(Buffer(pattern), start);
+            auto expected = str.find(pattern, start);
+            if (expected == string::npos || expected + pattern.size() > str.size()) {
+                EXPECT_FALSE(index.ok()) << "pattern: " << pattern << ", start: " << start;
+            } else {
+                EXPECT_THAT(index, IsValue(expected)) << "pattern: " << pattern << ", start: " << start;
+            }
+        }
+
+        auto first_of = b1.findFirstOf('y', start);
+        if (str.find('y', start) == string::npos) {
+            EXPECT_FALSE(first_of.ok());
+        } else {
+            EXPECT_THAT(first_of, IsValue(str.find('y', start)));
+        }
+
+        auto first_not_of = b1.findFirstNotOf('-', start);
+        if (str.find_first_not_of('-', start) == string::npos) {
+            EXPECT_FALSE(first_not_of.ok());
+        } else {
+            EXPECT_THAT(first_not_of, IsValue(str.find_first_not_of('-', start)));
+        }
+
+        auto last_of = b1.findLastOf('b', start);
+        if (start == 0 || str.find_last_of('b', start - 1) == string::npos) {
+            EXPECT_FALSE(last_of.ok());
+        } else {
+            EXPECT_THAT(last_of, IsValue(str.find_last_of('b', start - 1)));
+        }
+
+        auto last_not_of = b1.findLastNotOf('-', start);
+        if (start == 0 || str.find_last_not_of('-', start - 1) == string::npos) {
+            EXPECT_FALSE(last_not_of.ok());
+        } else {
+            EXPECT_THAT(last_not_of, IsValue(str.find_last_not_of('-', start - 1)));
+        }
+    }
+
+    EXPECT_THAT(b1.findFirstOf(genBuf("y-", "-", "b")), IsValue(9u));
+    EXPECT_TRUE(b1.contains('y'));
+    EXPECT_FALSE(b1.contains('x'));
+    EXPECT_EQ(b1.segmentsNumber(), 4u);
+}
+
+TEST_F (BuffersTest, find_first_with_scanner)
+{
+    Buffer b1 = genBuf("abc", "DEF", "ghi");
+    auto is_upper = [] (const u_char *data, uint size) -> const u_char *
+    {
+        for (uint i = 0; i < size; i++) {
+            if (isupper(data[i])) return data + i;
+        }
+        return nullptr;
+    };
+
+    EXPECT_THAT(b1.findFirst(is_upper), IsValue(3u));
+    EXPECT_THAT(b1.findFirst(is_upper, 4), IsValue(4u));
+    EXPECT_FALSE(b1.findFirst(is_upper, 6).ok());
+    EXPECT_EQ(b1.segmentsNumber(), 3u);
+}
+
 class SegmentsTest: public Test
 {
 public:
@@ -13,6 +13,8 @@
 
 #include "buffer.h"
 
+#include <algorithm>
+
 Buffer::DataContainer::DataContainer(std::vector<u_char> &&_vec)
         :
     vec(std::move(_vec)),
@@ -26,10 +28,21 @@ Buffer::DataContainer::DataContainer(const u_char *_ptr, uint _len, MemoryType _
     len(_len)
 {
     if (_type == MemoryType::OWNED) {
-        vec = std::vector<u_char>(_ptr, _ptr + len);
-        ptr = vec.data();
+        copyIn(_ptr);
     } else {
         ptr = _ptr;
         is_owned = false;
     }
 }
+
+void
+Buffer::DataContainer::copyIn(const u_char *_ptr)
+{
+    if (len <= inline_capacity) {
+        std::copy(_ptr, _ptr + len, inline_data);
+        ptr = inline_data;
+        return;
+    }
+    vec = std::vector<u_char>(_ptr, _ptr + len);
+    ptr = vec.data();
+}
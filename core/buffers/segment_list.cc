@@ -0,0 +1,207 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "buffer.h"
+
+using namespace std;
+
+Buffer::SegmentList::SegmentList(const SegmentList &other)
+        :
+    single(other.single),
+    has_single(other.has_single),
+    multiple(other.multiple)
+{
+}
+
+Buffer::SegmentList::SegmentList(SegmentList &&other)
+        :
+    has_single(other.has_single),
+    multiple(move(other.multiple))
+{
+    relocate(single, other.single);
+    other.has_single = false;
+    other.multiple.clear();
+}
+
+Buffer::SegmentList &
+Buffer::SegmentList::operator=(const SegmentList &other)
+{
+    if (this == &other) return *this;
+
+    if (other.has_single) {
+        single = other.single;
+    } else {
+        reset(single);
+    }
+    has_single = other.has_single;
+    multiple = other.multiple;
+
+    return *this;
+}
+
+Buffer::SegmentList &
+Buffer::SegmentList::operator=(SegmentList &&other)
+{
+    if (this == &other) return *this;
+
+    relocate(single, other.single);
+    has_single = other.has_single;
+    other.has_single = false;
+    multiple = move(other.multiple);
+    other.multiple.clear();
+
+    return *this;
+}
+
+void
+Buffer::SegmentList::push_back(const Segment &seg)
+{
+    if (empty()) {
+        single = seg;
+        has_single = true;
+        return;
+    }
+    spill(size() + 1);
+    multiple.push_back(seg);
+}
+
+void
+Buffer::SegmentList::push_back(Segment &&seg)
+{
+    if (empty()) {
+        relocate(single, seg);
+        has_single = true;
+        return;
+    }
+    spill(size() + 1);
+    multiple.push_back(move(seg));
+}
+
+void
+Buffer::SegmentList::emplace_back(const u_char *_ptr, uint _len, MemoryType _type)
+{
+    if (empty()) {
+        // Constructed and then relocated as is, so a VOLATILE segment stays PRIMARY (as if constructed in place).
+        Segment seg(_ptr, _len, _type);
+        relocate(single, seg);
+        has_single = true;
+        return;
+    }
+    spill(size() + 1);
+    multiple.emplace_back(_ptr, _len, _type);
+}
+
+void
+Buffer::SegmentList::insert(const_iterator pos, const_iterator first, const_iterator last)
+{
+    if (first == last) return;
+    if (begin() <= first && first < end()) {
+        // Inserting the list's own segments (a buffer added to itself) - they are copied before the list changes.
+        vector<Segment> own_segments(first, last);
+        insert(pos, own_segments.data(), own_segments.data() + own_segments.size());
+        return;
+    }
+    if (empty() && last - first == 1) {
+        single = *first;
+        has_single = true;
+        return;
+    }
+
+    auto index = pos - begin();
+    spill(size() + (last - first));
+    multiple.insert(multiple.begin() + index, first, last);
+}
+
+void
+Buffer::SegmentList::erase(const_iterator pos)
+{
+    if (multiple.empty()) {
+        reset(single);
+        has_single = false;
+        return;
+    }
+    multiple.erase(multiple.begin() + (pos - begin()));
+}
+
+void
+Buffer::SegmentList::pop_back()
+{
+    if (multiple.empty()) {
+        reset(single);
+        has_single = false;
+        return;
+    }
+    multiple.pop_back();
+}
+
+void
+Buffer::SegmentList::reserve(uint capacity)
+{
+    if (capacity < 2) return;
+    spill(capacity);
+}
+
+void
+Buffer::SegmentList::clear()
+{
+    reset(single);
+    has_single = false;
+    multiple.clear();
+}
+
+void
+Buffer::SegmentList::spill(uint capacity)
+{
+    // Reserving the capacity first keeps the vector from copying the segment when it grows, which would have made a
+    // PRIMARY segment give up the memory it points to.
+    multiple.reserve(capacity);
+    if (!has_single) return;
+    multiple.emplace_back();
+    relocate(multiple.back(), single);
+    has_single = false;
+}
+
+void
+Buffer::SegmentList::relocate(Segment &to, Segment &from)
+{
+    reset(to);
+
+    to.data_container = move(from.data_container);
+    to.offset = from.offset;
+    to.len = from.len;
+    to.type = from.type;
+    to.is_owned = from.is_owned;
+    to.ptr = from.ptr;
+
+    from.offset = 0;
+    from.len = 0;
+    from.type = Volatility::NONE;
+    from.is_owned = nullptr;
+    from.ptr = nullptr;
+}
+
+void
+Buffer::SegmentList::reset(Segment &seg)
+{
+    // Same as the destruction of the segment - a PRIMARY segment must leave the memory to its SECONDARY ones.
+    if (seg.type == Volatility::PRIMARY && seg.data_container != nullptr && !seg.data_container.unique()) {
+        seg.data_container->takeOwnership();
+    }
+
+    seg.data_container.reset();
+    seg.offset = 0;
+    seg.len = 0;
+    seg.type = Volatility::NONE;
+    seg.is_owned = nullptr;
+    seg.ptr = nullptr;
+}
@@ -19,10 +19,20 @@
 #include <array>
 #include <vector>
 #include <tuple>
+#include <mutex>
+#include <algorithm>
 #include <strings.h>
 #include <string.h>
 #include <zlib.h>
 
+#ifdef COMPRESSION_UTILS_BROTLI
+#include <brotli/decode.h>
+#endif // COMPRESSION_UTILS_BROTLI
+
+#ifdef COMPRESSION_UTILS_ZSTD
+#include <zstd.h>
+#endif // COMPRESSION_UTILS_ZSTD
+
 using namespace std;
 
 using DebugFunction = void(*)(const char *);
@@ -102,12 +112,69 @@ static const int zlib_finish_flush = Z_FINISH;
 static const int zlib_sync_flush = Z_SYNC_FLUSH;
 static const int zlib_no_flush = Z_NO_FLUSH;
 
+static const size_t output_chunk_size = 4096;
+static const size_t max_pooled_streams = 64;
+// Small outputs are never considered a decompression bomb, whatever their ratio is.
+static const uint64_t min_output_size_for_ratio_check = 1024 * 1024;
+static const uint32_t default_max_decompression_ratio = 1000;
+
+static uint32_t max_decompression_ratio = default_max_decompression_ratio;
+
+// The output of a single decompression call. The data is written straight into memory that is handed over to the
+// caller, so it is not copied again on its way out.
+class OutputBuffer
+{
+public:
+    OutputBuffer() = default;
+    OutputBuffer(const OutputBuffer &) = delete;
+    OutputBuffer & operator=(const OutputBuffer &) = delete;
+    ~OutputBuffer() { free(data); }
+
+    unsigned char *
+    reserve(size_t min_free_space)
+    {
+        if (capacity - length >= min_free_space) return data + length;
+
+        auto new_capacity = max(capacity * 2, length + min_free_space);
+        auto new_data = static_cast<unsigned char *>(realloc(data, new_capacity));
+        if (new_data == nullptr) throw bad_alloc();
+
+        data = new_data;
+        capacity = new_capacity;
+        return data + length;
+    }
+
+    size_t freeSpace() const { return capacity - length; }
+    void commit(size_t size) { length += size; }
+    size_t size() const { return length; }
+
+    unsigned char *
+    release()
+    {
+        auto res = data;
+        data = nullptr;
+        length = 0;
+        capacity = 0;
+        return res;
+    }
+
+private:
+    unsigned char *data = nullptr;
+    size_t length = 0;
+    size_t capacity = 0;
+};
+
 struct CompressionStream
 {
     CompressionStream() { bzero(&stream, sizeof(z_stream)); }
-    ~CompressionStream() { fini(); }
+    ~CompressionStream()
+    {
+        fini();
+        finiBrotli();
+        finiZstd();
+    }
 
-    tuple<basic_string<unsigned char>, bool>
+    tuple<unsigned char *, size_t, bool>
     decompress(const unsigned char *data, uint32_t size)
     {
         initInflate();
@@ -116,15 +183,14 @@ struct CompressionStream
         stream.avail_in = size;
         stream.next_in = data;
 
-        vector<unsigned char> work_space;
-        work_space.reserve(4096);
-        basic_string<unsigned char> res;
+        OutputBuffer res;
         int retries = 0;
 
         while (stream.avail_in != 0) {
-            stream.avail_out = work_space.capacity();
-            stream.next_out = work_space.data();
+            stream.next_out = res.reserve(output_chunk_size);
+            stream.avail_out = res.freeSpace();
 
+            auto old_total_in = stream.total_in;
             auto old_total_out = stream.total_out;
 
             auto inflate_res = inflate(&stream, zlib_no_flush);
@@ -135,7 +201,7 @@ struct CompressionStream
             }
 
             if (stream.total_out != old_total_out) {
-                res.append(work_space.data(), stream.total_out - old_total_out);
+                res.commit(stream.total_out - old_total_out);
             } else {
                 ++retries;
                 if (retries > 3) {
@@ -144,13 +210,121 @@ struct CompressionStream
                 }
             }
 
-            if (inflate_res == Z_STREAM_END) {
+            try {
+                countDecompressed(stream.total_in - old_total_in, stream.total_out - old_total_out);
+            } catch (...) {
                 fini();
-                return make_tuple(res, true);
+                throw;
+            }
+
+            if (inflate_res == Z_STREAM_END) {
+                resetInflate();
+                return finishDecompression(res, true);
+            }
+        }
+
+        return finishDecompression(res, false);
+    }
+
+    tuple<unsigned char *, size_t, bool>
+    decompressBrotli(const unsigned char *data, uint32_t size)
+    {
+#ifdef COMPRESSION_UTILS_BROTLI
+        if (brotli_state == nullptr) {
+            brotli_state = BrotliDecoderCreateInstance(nullptr, nullptr, nullptr);
+            if (brotli_state == nullptr) throw runtime_error("Failed to initialize brotli decompression stream");
+        }
+
+        size_t avail_in = size;
+        const uint8_t *next_in = data;
+        OutputBuffer res;
+
+        while (true) {
+            uint8_t *next_out = res.reserve(output_chunk_size);
+            size_t avail_out = res.freeSpace();
+            size_t old_avail_in = avail_in;
+            size_t old_avail_out = avail_out;
+
+            auto decode_res = BrotliDecoderDecompressStream(
+                brotli_state,
+                &avail_in,
+                &next_in,
+                &avail_out,
+                &next_out,
+                nullptr
+            );
+
+            if (decode_res == BROTLI_DECODER_RESULT_ERROR) {
+                string error = BrotliDecoderErrorString(BrotliDecoderGetErrorCode(brotli_state));
+                finiBrotli();
+                throw runtime_error("error in brotli decoder: " + error);
+            }
+
+            res.commit(old_avail_out - avail_out);
+            try {
+                countDecompressed(old_avail_in - avail_in, old_avail_out - avail_out);
+            } catch (...) {
+                finiBrotli();
+                throw;
             }
+
+            if (decode_res == BROTLI_DECODER_RESULT_SUCCESS) {
+                // The brotli decoder has no reset operation, so a finished stream is replaced on the next use.
+                finiBrotli();
+                return finishDecompression(res, true);
+            }
+            if (decode_res == BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT) return finishDecompression(res, false);
+        }
+#else
+        (void)data;
+        (void)size;
+        throw runtime_error("Brotli decompression is not supported in this build");
+#endif // COMPRESSION_UTILS_BROTLI
+    }
+
+    tuple<unsigned char *, size_t, bool>
+    decompressZstd(const unsigned char *data, uint32_t size)
+    {
+#ifdef COMPRESSION_UTILS_ZSTD
+        if (zstd_context == nullptr) {
+            zstd_context = ZSTD_createDCtx();
+            if (zstd_context == nullptr) throw runtime_error("Failed to initialize zstd decompression stream");
         }
 
-        return make_tuple(res, false);
+        ZSTD_inBuffer input = { data, size, 0 };
+        OutputBuffer res;
+
+        while (true) {
+            ZSTD_outBuffer output = { res.reserve(output_chunk_size), res.freeSpace(), 0 };
+            size_t old_input_pos = input.pos;
+
+            auto decode_res = ZSTD_decompressStream(zstd_context, &output, &input);
+
+            if (ZSTD_isError(decode_res)) {
+                string error = ZSTD_getErrorName(decode_res);
+                finiZstd();
+                throw runtime_error("error in zstd decoder: " + error);
+            }
+
+            res.commit(output.pos);
+            try {
+                countDecompressed(input.pos - old_input_pos, output.pos);
+            } catch (...) {
+                finiZstd();
+                throw;
+            }
+
+            if (decode_res == 0) {
+                ZSTD_DCtx_reset(zstd_context, ZSTD_reset_session_only);
+                return finishDecompression(res, true);
+            }
+            if (input.pos == input.size && output.pos < output.size) return finishDecompression(res, false);
+        }
+#else
+        (void)data;
+        (void)size;
+        throw runtime_error("Zstd decompression is not supported in this build");
+#endif // COMPRESSION_UTILS_ZSTD
     }
 
     basic_string<unsigned char>
@@ -197,10 +371,28 @@ struct CompressionStream
         return res;
     }
 
+    // Prepares the stream for another transaction, keeping whatever decoder contexts can be reused.
+    void
+    reset()
+    {
+        if (state == TYPE::DECOMPRESS) resetInflate();
+        if (state == TYPE::COMPRESS) fini();
+        finiBrotli();
+#ifdef COMPRESSION_UTILS_ZSTD
+        if (zstd_context != nullptr) ZSTD_DCtx_reset(zstd_context, ZSTD_reset_session_only);
+#endif // COMPRESSION_UTILS_ZSTD
+        compressed_size = 0;
+        decompressed_size = 0;
+    }
+
 private:
     void
     initInflate()
     {
+        if (state == TYPE::INFLATE_READY) {
+            state = TYPE::DECOMPRESS;
+            return;
+        }
         if (state != TYPE::UNINITIALIZAED) return;
 
         auto init_status = inflateInit2(&stream, default_num_window_bits + 32);
@@ -213,9 +405,23 @@ private:
         state = TYPE::DECOMPRESS;
     }
 
+    void
+    resetInflate()
+    {
+        auto reset_res = inflateReset(&stream);
+        if (reset_res != zlib_ok_return_value) {
+            zlibDbgError << "Failed to reset decompression stream: " << getZlibError(reset_res);
+            fini();
+            return;
+        }
+
+        state = TYPE::INFLATE_READY;
+    }
+
     void
     initDeflate(CompressionType type)
     {
+        if (state == TYPE::INFLATE_READY) fini();
         if (state != TYPE::UNINITIALIZAED) return;
 
         int num_history_window_bits;
@@ -228,6 +434,10 @@ private:
                 num_history_window_bits = default_num_window_bits;
                 break;
             }
+            case CompressionType::BROTLI:
+            case CompressionType::ZSTD: {
+                throw runtime_error("Compression type is supported only for decompression");
+            }
             default: {
                 zlibDbgAssertion
                     << "Invalid compression type value: "
@@ -258,7 +468,7 @@ private:
     {
         int end_stream_res = zlib_ok_return_value;
 
-        if (state == TYPE::DECOMPRESS) end_stream_res = inflateEnd(&stream);
+        if (state == TYPE::DECOMPRESS || state == TYPE::INFLATE_READY) end_stream_res = inflateEnd(&stream);
         if (state == TYPE::COMPRESS) end_stream_res = deflateEnd(&stream);
 
         if (end_stream_res != zlib_ok_return_value) {
@@ -266,6 +476,52 @@ private:
         }
 
         state = TYPE::UNINITIALIZAED;
+        compressed_size = 0;
+        decompressed_size = 0;
+    }
+
+    void
+    finiBrotli()
+    {
+#ifdef COMPRESSION_UTILS_BROTLI
+        if (brotli_state != nullptr) BrotliDecoderDestroyInstance(brotli_state);
+        brotli_state = nullptr;
+#endif // COMPRESSION_UTILS_BROTLI
+    }
+
+    void
+    finiZstd()
+    {
+#ifdef COMPRESSION_UTILS_ZSTD
+        if (zstd_context != nullptr) ZSTD_freeDCtx(zstd_context);
+        zstd_context = nullptr;
+#endif // COMPRESSION_UTILS_ZSTD
+    }
+
+    void
+    countDecompressed(uint64_t input_size, uint64_t output_size)
+    {
+        compressed_size += input_size;
+        decompressed_size += output_size;
+
+        if (max_decompression_ratio == 0 || decompressed_size < min_output_size_for_ratio_check) return;
+        if (decompressed_size / max_decompression_ratio <= compressed_size) return;
+
+        throw runtime_error(
+            "Decompression ratio exceeded the limit of " + to_string(max_decompression_ratio) +
+            " (" + to_string(compressed_size) + " bytes decompressed into " + to_string(decompressed_size) + ")"
+        );
+    }
+
+    tuple<unsigned char *, size_t, bool>
+    finishDecompression(OutputBuffer &output, bool is_last_chunk)
+    {
+        if (is_last_chunk) {
+            compressed_size = 0;
+            decompressed_size = 0;
+        }
+        auto size = output.size();
+        return make_tuple(output.release(), size, is_last_chunk);
     }
 
     string
@@ -288,9 +544,69 @@ private:
     }
 
     z_stream stream;
-    enum class TYPE { UNINITIALIZAED, COMPRESS, DECOMPRESS } state = TYPE::UNINITIALIZAED;
+    // INFLATE_READY holds an inflate context that was reset at the end of a previous stream, ready to be reused.
+    enum class TYPE { UNINITIALIZAED, COMPRESS, DECOMPRESS, INFLATE_READY } state = TYPE::UNINITIALIZAED;
+#ifdef COMPRESSION_UTILS_BROTLI
+    BrotliDecoderState *brotli_state = nullptr;
+#endif // COMPRESSION_UTILS_BROTLI
+#ifdef COMPRESSION_UTILS_ZSTD
+    ZSTD_DCtx *zstd_context = nullptr;
+#endif // COMPRESSION_UTILS_ZSTD
+    uint64_t compressed_size = 0;
+    uint64_t decompressed_size = 0;
+};
+
+// Streams released by their owners are kept for reuse, so a new transaction does not pay for allocating the decoder
+// state again.
+class CompressionStreamPool
+{
+public:
+    CompressionStream *
+    acquire()
+    {
+        {
+            lock_guard<mutex> guard(lock);
+            if (!streams.empty()) {
+                auto compression_stream = streams.back();
+                streams.pop_back();
+                return compression_stream;
+            }
+        }
+
+        return new CompressionStream();
+    }
+
+    void
+    release(CompressionStream *compression_stream)
+    {
+        if (compression_stream == nullptr) return;
+
+        compression_stream->reset();
+
+        {
+            lock_guard<mutex> guard(lock);
+            if (streams.size() < max_pooled_streams) {
+                streams.push_back(compression_stream);
+                return;
+            }
+        }
+
+        delete compression_stream;
+    }
+
+private:
+    mutex lock;
+    vector<CompressionStream *> streams;
 };
 
+// Never destroyed, so streams released by the static objects of other modules during exit still find the pool.
+static CompressionStreamPool &
+getCompressionStreamPool()
+{
+    static CompressionStreamPool *pool = new CompressionStreamPool();
+    return *pool;
+}
+
 void
 resetCompressionDebugFunctionsToStandardError()
 {
@@ -303,16 +619,22 @@ setCompressionDebugFunction(const CompressionUtilsDebugLevel debug_level, void (
     ZlibDebugStream::setDebugFunction(debug_level, debug_function);
 }
 
+void
+setMaxDecompressionRatio(const uint32_t max_ratio)
+{
+    max_decompression_ratio = max_ratio;
+}
+
 CompressionStream *
 initCompressionStream()
 {
-    return new CompressionStream();
+    return getCompressionStreamPool().acquire();
 }
 
 void
 finiCompressionStream(CompressionStream *compression_stream)
 {
-    delete compression_stream;
+    getCompressionStreamPool().release(compression_stream);
 }
 
 static unsigned char *
@@ -361,6 +683,17 @@ decompressData(
     const uint32_t compressed_data_size,
     const unsigned char *compressed_data
 )
+{
+    return decompressDataByType(compression_stream, CompressionType::GZIP, compressed_data_size, compressed_data);
+}
+
+DecompressionResult
+decompressDataByType(
+    CompressionStream *compression_stream,
+    const CompressionType compression_type,
+    const uint32_t compressed_data_size,
+    const unsigned char *compressed_data
+)
 {
     DecompressionResult result;
 
@@ -369,10 +702,28 @@ decompressData(
         if (compressed_data == nullptr) throw invalid_argument("Data pointer is NULL");
         if (compressed_data_size == 0) throw invalid_argument("Data size is 0");
 
-        auto decompress = compression_stream->decompress(compressed_data, compressed_data_size);
-        result.output = duplicateMemory(get<0>(decompress));
-        result.num_output_bytes = get<0>(decompress).size();
-        result.is_last_chunk = get<1>(decompress);
+        tuple<unsigned char *, size_t, bool> decompress;
+        switch (compression_type) {
+            case CompressionType::GZIP:
+            case CompressionType::ZLIB: {
+                decompress = compression_stream->decompress(compressed_data, compressed_data_size);
+                break;
+            }
+            case CompressionType::BROTLI: {
+                decompress = compression_stream->decompressBrotli(compressed_data, compressed_data_size);
+                break;
+            }
+            case CompressionType::ZSTD: {
+                decompress = compression_stream->decompressZstd(compressed_data, compressed_data_size);
+                break;
+            }
+            default: {
+                throw invalid_argument("Invalid decompression type: " + to_string(compression_type));
+            }
+        }
+        result.output = get<0>(decompress);
+        result.num_output_bytes = get<1>(decompress);
+        result.is_last_chunk = get<2>(decompress);
         result.ok = 1;
     } catch (const exception &e) {
         zlibDbgError << "Decompression failed " << e.what();
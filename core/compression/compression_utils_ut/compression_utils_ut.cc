@@ -136,7 +136,8 @@ public:
     decompressString(
         const string &compressed_string,
         int *is_last_chunk = nullptr,
-        CompressionStream *compression_stream = nullptr
+        CompressionStream *compression_stream = nullptr,
+        const CompressionType decompression_type = CompressionType::GZIP
     )
     {
         auto disposable_compression_stream = initCompressionStream();
@@ -157,8 +158,9 @@ public:
                 &disposable_is_last_chunk_indicator :
                 is_last_chunk;
 
-        DecompressionResult decompress_data_result = decompressData(
+        DecompressionResult decompress_data_result = decompressDataByType(
             compression_stream_to_use,
+            decompression_type,
             compressed_string.size(),
             compressed_data
         );
@@ -176,7 +178,10 @@ public:
     }
 
     Maybe<string>
-    chunkedDecompressString(const string &compressed_string)
+    chunkedDecompressString(
+        const string &compressed_string,
+        const CompressionType decompression_type = CompressionType::GZIP
+    )
     {
         auto compression_stream = initCompressionStream();
         int is_last_chunk = 0;
@@ -191,7 +196,8 @@ public:
             Maybe<string> decompress_string_result = decompressString(
                 input_string_chunks[curr_chunk_index],
                 &is_last_chunk,
-                compression_stream
+                compression_stream,
+                decompression_type
             );
             if (!decompress_string_result.ok()) {
                 finiCompressionStream(compression_stream);
@@ -271,6 +277,8 @@ public:
     const string multi_chunk_sized_string_file_name = "multiple_chunk_sized_string";
     const string multi_chunk_sized_gzip_file_name = "multiple_chunk_sized_compressed_file.gz";
     const string multi_chunk_sized_zlib_file_name = "multiple_chunk_sized_compressed_file.zz";
+    const string multi_chunk_sized_brotli_file_name = "multiple_chunk_sized_compressed_file.br";
+    const string multi_chunk_sized_zstd_file_name = "multiple_chunk_sized_compressed_file.zst";
     const vector<string> chunk_sized_compressed_files = { chunk_sized_gzip_file_name, chunk_sized_zlib_file_name };
     const vector<string> multi_chunk_sized_compressed_files = {
         multi_chunk_sized_gzip_file_name,
@@ -460,3 +468,93 @@ TEST_F(CompressionUtilsTest, DecompressPlainText)
         HasSubstr("error in 'inflate': Invalid or corrupted stream data")
     );
 }
+
+TEST_F(CompressionUtilsTest, ReuseReleasedCompressionStream)
+{
+    string test_string = readTestFileContents(chunk_sized_string_file_name);
+    string compressed_string = readTestFileContents(chunk_sized_gzip_file_name);
+
+    for (int i = 0; i < 3; i++) {
+        auto compression_stream = initCompressionStream();
+        int is_last_chunk = 0;
+
+        Maybe<string> decompressed_string = decompressString(compressed_string, &is_last_chunk, compression_stream);
+        EXPECT_TRUE(decompressed_string.ok());
+        EXPECT_EQ(decompressed_string.unpack(), test_string);
+        EXPECT_EQ(is_last_chunk, 1);
+
+        decompressed_string = decompressString(compressed_string, &is_last_chunk, compression_stream);
+        EXPECT_TRUE(decompressed_string.ok());
+        EXPECT_EQ(decompressed_string.unpack(), test_string);
+
+        Maybe<string> compressed = compressString(CompressionType::GZIP, simple_test_string, true, compression_stream);
+        EXPECT_TRUE(compressed.ok());
+        finiCompressionStream(compression_stream);
+
+        EXPECT_EQ(decompressString(compressed.unpack()).unpack(), simple_test_string);
+    }
+
+    auto compression_stream = initCompressionStream();
+    string partial_compressed_string = compressed_string.substr(0, compressed_string.size() / 2);
+    EXPECT_TRUE(decompressString(partial_compressed_string, nullptr, compression_stream).ok());
+    finiCompressionStream(compression_stream);
+
+    compression_stream = initCompressionStream();
+    Maybe<string> decompressed_string = decompressString(compressed_string, nullptr, compression_stream);
+    finiCompressionStream(compression_stream);
+    EXPECT_TRUE(decompressed_string.ok());
+    EXPECT_EQ(decompressed_string.unpack(), test_string);
+}
+
+TEST_F(CompressionUtilsTest, DecompressionRatioLimit)
+{
+    string test_string(4 * 1024 * 1024, 'a');
+    Maybe<string> compressed_string = compressString(CompressionType::GZIP, test_string);
+    EXPECT_TRUE(compressed_string.ok());
+
+    setMaxDecompressionRatio(100);
+    EXPECT_FALSE(chunkedDecompressString(compressed_string.unpack()).ok());
+    EXPECT_THAT(capture_debug.str(), HasSubstr("Decompression ratio exceeded the limit of 100"));
+
+    setMaxDecompressionRatio(0);
+    Maybe<string> decompressed_string = chunkedDecompressString(compressed_string.unpack());
+    setMaxDecompressionRatio(1000);
+
+    EXPECT_TRUE(decompressed_string.ok());
+    EXPECT_EQ(decompressed_string.unpack(), test_string);
+}
+
+TEST_F(CompressionUtilsTest, CompressionTypeSupportedOnlyForDecompression)
+{
+    EXPECT_FALSE(compressString(CompressionType::BROTLI, simple_test_string).ok());
+    EXPECT_FALSE(compressString(CompressionType::ZSTD, simple_test_string).ok());
+    EXPECT_THAT(capture_debug.str(), HasSubstr("Compression type is supported only for decompression"));
+}
+
+#ifdef COMPRESSION_UTILS_BROTLI
+TEST_F(CompressionUtilsTest, DecompressBrotliFile)
+{
+    string test_string = readTestFileContents(multi_chunk_sized_brotli_file_name);
+
+    Maybe<string> chunked_decompress_result = chunkedDecompressString(test_string, CompressionType::BROTLI);
+    EXPECT_TRUE(chunked_decompress_result.ok());
+    EXPECT_EQ(chunked_decompress_result.unpack(), readTestFileContents(multi_chunk_sized_string_file_name));
+
+    EXPECT_FALSE(decompressString(simple_test_string, nullptr, nullptr, CompressionType::BROTLI).ok());
+    EXPECT_THAT(capture_debug.str(), HasSubstr("error in brotli decoder"));
+}
+#endif // COMPRESSION_UTILS_BROTLI
+
+#ifdef COMPRESSION_UTILS_ZSTD
+TEST_F(CompressionUtilsTest, DecompressZstdFile)
+{
+    string test_string = readTestFileContents(multi_chunk_sized_zstd_file_name);
+
+    Maybe<string> chunked_decompress_result = chunkedDecompressString(test_string, CompressionType::ZSTD);
+    EXPECT_TRUE(chunked_decompress_result.ok());
+    EXPECT_EQ(chunked_decompress_result.unpack(), readTestFileContents(multi_chunk_sized_string_file_name));
+
+    EXPECT_FALSE(decompressString(simple_test_string, nullptr, nullptr, CompressionType::ZSTD).ok());
+    EXPECT_THAT(capture_debug.str(), HasSubstr("error in zstd decoder"));
+}
+#endif // COMPRESSION_UTILS_ZSTD
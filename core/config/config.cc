@@ -25,6 +25,7 @@
 #include "debug.h"
 #include "cereal/external/rapidjson/error/en.h"
 #include "include/profile_settings.h"
+#include "include/context_index.h"
 #include "enum_range.h"
 #include "rest.h"
 #include "tenant_profile_pair.h"
@@ -148,6 +149,7 @@ public:
 
 private:
     bool areTenantAndProfileActive(const TenantProfilePair &tenant_profile) const;
+    const TypeWrapper * findMatchingValue(const TenantProfilePair &tenant_profile, const vector<string> &paths) const;
     void periodicRegistrationRefresh();
 
     bool loadConfiguration(vector<shared_ptr<JSONInputArchive>> &file_archives, bool is_async);
@@ -278,11 +280,14 @@ private:
     }
 
     unordered_map<TenantProfilePair, map<vector<string>, PerContextValue>> configuration_nodes;
+    // Only the configurations with many values get an index, e.g. the rules of the assets.
+    unordered_map<TenantProfilePair, map<vector<string>, ContextIndex>> configuration_indexes;
     unordered_map<TenantProfilePair, map<vector<string>, TypeWrapper>> settings_nodes;
     unordered_map<string, string> config_flags;
 
     map<vector<string>, TypeWrapper> new_resource_nodes;
     unordered_map<TenantProfilePair, map<vector<string>, PerContextValue>> new_configuration_nodes;
+    unordered_map<TenantProfilePair, map<vector<string>, ContextIndex>> new_configuration_indexes;
     unordered_map<TenantProfilePair, map<vector<string>, TypeWrapper>> new_settings_nodes;
     unordered_map<string, string> new_config_flags;
 
@@ -356,29 +361,44 @@ checkContext(const shared_ptr<EnvironmentEvaluator<bool>> &ctx)
     return res.ok() && *res;
 }
 
-const TypeWrapper &
-ConfigComponent::Impl::getConfiguration(const vector<string> &paths) const
+const TypeWrapper *
+ConfigComponent::Impl::findMatchingValue(const TenantProfilePair &tenant_profile, const vector<string> &paths) const
 {
-    auto curr_configs = configuration_nodes.find(TenantProfilePair(getActiveTenant(), getActiveProfile()));
-
-    if (curr_configs != configuration_nodes.end()) {
-        auto requested_config = curr_configs->second.find(paths);
-        if (requested_config != curr_configs->second.end()) {
-            for (auto &value : requested_config->second) {
-                if (checkContext(value.first)) return value.second;
+    auto tenant_configs = configuration_nodes.find(tenant_profile);
+    if (tenant_configs == configuration_nodes.end()) return nullptr;
+    auto requested_config = tenant_configs->second.find(paths);
+    if (requested_config == tenant_configs->second.end()) return nullptr;
+    const PerContextValue &values = requested_config->second;
+
+    auto tenant_indexes = configuration_indexes.find(tenant_profile);
+    if (tenant_indexes != configuration_indexes.end()) {
+        auto index = tenant_indexes->second.find(paths);
+        if (index != tenant_indexes->second.end()) {
+            auto candidates = index->second.getCandidates();
+            if (candidates.ok()) {
+                for (uint pos : candidates.unpack()) {
+                    if (checkContext(values[pos].first)) return &values[pos].second;
+                }
+                return nullptr;
             }
+            dbgTrace(D_CONFIG) << "Checking all the contexts. Reason: " << candidates.getErr();
         }
     }
 
-    auto global_config = configuration_nodes.find(TenantProfilePair(default_tenant_id, default_profile_id));
-    if (global_config != configuration_nodes.end()) {
-        auto requested_config = global_config->second.find(paths);
-        if (requested_config != global_config->second.end()) {
-            for (auto &value : requested_config->second) {
-                if (checkContext(value.first)) return value.second;
-            }
-        }
+    for (auto &value : values) {
+        if (checkContext(value.first)) return &value.second;
     }
+    return nullptr;
+}
+
+const TypeWrapper &
+ConfigComponent::Impl::getConfiguration(const vector<string> &paths) const
+{
+    auto value = findMatchingValue(TenantProfilePair(getActiveTenant(), getActiveProfile()), paths);
+    if (value != nullptr) return *value;
+
+    value = findMatchingValue(TenantProfilePair(default_tenant_id, default_profile_id), paths);
+    if (value != nullptr) return *value;
 
     return empty;
 }
@@ -507,6 +527,9 @@ ConfigComponent::Impl::setConfiguration(TypeWrapper &&value, const vector<string
     for (auto &tenant : configuration_nodes) {
         tenant.second.erase(paths);
     }
+    for (auto &tenant : configuration_indexes) {
+        tenant.second.erase(paths);
+    }
 
     PerContextValue value_vec;
     TenantProfilePair default_tenant_profile(default_tenant_id, default_profile_id);
@@ -673,6 +696,12 @@ ConfigComponent::Impl::clearOldTenants()
         !areTenantAndProfileActive(iter->first) ? iter = configuration_nodes.erase(iter) : ++iter
     );
 
+    for (
+        auto iter = configuration_indexes.begin();
+        iter != configuration_indexes.end();
+        !areTenantAndProfileActive(iter->first) ? iter = configuration_indexes.erase(iter) : ++iter
+    );
+
     for (
         auto iter = settings_nodes.begin();
         iter != settings_nodes.end();
@@ -755,7 +784,12 @@ ConfigComponent::Impl::loadConfiguration(vector<shared_ptr<JSONInputArchive>> &f
             TenantProfilePair tenant_profile(curr_tenant, curr_profile);
             for (auto &config : expected_configs) {
                 auto loaded = config->loadConfiguration(*archive);
-                if (!loaded.empty()) new_configuration_nodes[tenant_profile][config->getPath()] = move(loaded);
+                if (!loaded.empty()) {
+                    auto index = ContextIndex::build(loaded);
+                    new_configuration_indexes[tenant_profile].erase(config->getPath());
+                    if (index.ok()) new_configuration_indexes[tenant_profile].emplace(config->getPath(), *index);
+                    new_configuration_nodes[tenant_profile][config->getPath()] = move(loaded);
+                }
                 if (is_async) mainloop->yield();
             }
             for (auto &setting : expected_settings) {
@@ -780,6 +814,7 @@ ConfigComponent::Impl::commitSuccess()
 {
     new_resource_nodes.clear();
     configuration_nodes = move(new_configuration_nodes);
+    configuration_indexes = move(new_configuration_indexes);
     settings_nodes = move(new_settings_nodes);
 
     reloadFileSystemPaths();
@@ -797,6 +832,7 @@ ConfigComponent::Impl::commitFailure(const string &error)
     error_to_report = error;
     new_resource_nodes.clear();
     new_configuration_nodes.clear();
+    new_configuration_indexes.clear();
     new_settings_nodes.clear();
     for (auto &cb : configuration_abort_cbs) {
         cb();
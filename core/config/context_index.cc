@@ -0,0 +1,102 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include/context_index.h"
+
+#include <algorithm>
+
+#include "debug.h"
+
+using namespace std;
+
+USE_DEBUG_FLAG(D_CONFIG);
+
+// Evaluating a few contexts is cheaper than looking up the index values in the environment.
+static const uint min_values_to_index = 8;
+
+ContextIndex::ContextIndex(const string &_index_name, const ContextIndexLookup &_lookup)
+        :
+    index_name(_index_name),
+    lookup(_lookup)
+{
+}
+
+Maybe<ContextIndex>
+ContextIndex::build(const PerContextValue &values)
+{
+    if (values.size() < min_values_to_index) return genError("Too few values to index");
+
+    Maybe<ContextIndex> best_index = genError("No context index splits the values");
+    for (auto &context_index : getContextIndexes()) {
+        ContextIndex index(context_index.first, context_index.second);
+        for (uint pos = 0; pos < values.size(); pos++) {
+            auto &context = values[pos].first;
+            auto index_values = context != nullptr ?
+                context->getIndexValues(index.index_name) :
+                Maybe<set<string>>(genError("No context"));
+            if (!index_values.ok()) {
+                index.unindexed_positions.push_back(pos);
+                continue;
+            }
+            for (auto &value : index_values.unpack()) index.positions_by_value[value].push_back(pos);
+        }
+
+        // An index that leaves most of the values to be checked anyway is not worth the lookup
+        if (index.getExpectedCandidates() * 2 > values.size()) continue;
+        if (best_index.ok() && best_index.unpack().getExpectedCandidates() <= index.getExpectedCandidates()) continue;
+        best_index = move(index);
+    }
+
+    if (best_index.ok()) {
+        dbgTrace(D_CONFIG)
+            << "Indexed "
+            << values.size()
+            << " values by "
+            << best_index.unpack().index_name
+            << ", expected candidates: "
+            << best_index.unpack().getExpectedCandidates();
+    }
+    return best_index;
+}
+
+Maybe<vector<uint>>
+ContextIndex::getCandidates() const
+{
+    auto lookup_values = lookup();
+    if (!lookup_values.ok()) return genError("Cannot look up " + index_name + ": " + lookup_values.getErr());
+
+    vector<uint> candidates = unindexed_positions;
+    uint num_of_lists = candidates.empty() ? 0 : 1;
+    for (auto &value : lookup_values.unpack()) {
+        auto positions = positions_by_value.find(value);
+        if (positions == positions_by_value.end()) continue;
+        candidates.insert(candidates.end(), positions->second.begin(), positions->second.end());
+        num_of_lists++;
+    }
+
+    // Every list is sorted, so there is only something to merge if more than one of them was found
+    if (num_of_lists > 1) {
+        sort(candidates.begin(), candidates.end());
+        candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+    }
+    return candidates;
+}
+
+uint
+ContextIndex::getExpectedCandidates() const
+{
+    uint indexed_positions = 0;
+    for (auto &positions : positions_by_value) indexed_positions += positions.second.size();
+    uint average_positions = positions_by_value.empty() ? 0 : indexed_positions / positions_by_value.size();
+    return unindexed_positions.size() + average_positions;
+}
@@ -0,0 +1,53 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __CONTEXT_INDEX_H__
+#define __CONTEXT_INDEX_H__
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "config.h"
+#include "environment_evaluator.h"
+#include "maybe_res.h"
+
+// The values of a configuration (e.g. one per asset) indexed by the context index that best splits their contexts,
+// so reading the configuration only evaluates the contexts that may match the current environment.
+class ContextIndex
+{
+public:
+    using PerContextValue = std::vector<std::pair<std::shared_ptr<EnvironmentEvaluator<bool>>, TypeWrapper>>;
+
+    // Fails if the values are too few to be worth indexing, or if no context index splits them well enough.
+    static Maybe<ContextIndex> build(const PerContextValue &values);
+
+    // The positions of the values whose context may match, in ascending order. Fails if the index cannot tell for
+    // the current environment, in which case every value has to be checked.
+    Maybe<std::vector<uint>> getCandidates() const;
+
+    const std::string & getIndexName() const { return index_name; }
+
+private:
+    ContextIndex(const std::string &_index_name, const ContextIndexLookup &_lookup);
+
+    uint getExpectedCandidates() const;
+
+    std::string index_name;
+    ContextIndexLookup lookup;
+    std::unordered_map<std::string, std::vector<uint>> positions_by_value;
+    std::vector<uint> unindexed_positions;
+};
+
+#endif // __CONTEXT_INDEX_H__
@@ -11,20 +11,16 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include "intelligence_is_v2/json_stream.h"
+#include "json_output_stream.h"
 
 #include "cptest.h"
 #include "cereal/archives/json.hpp"
 #include "boost/algorithm/string.hpp"
 #include "boost/format.hpp"
 
-#include <sstream>
-
 using namespace std;
 using namespace testing;
 
-USE_DEBUG_FLAG(D_INTELLIGENCE);
-
 string
 addSlashesToSpecialChars(const string &input)
 {
@@ -55,8 +51,7 @@ addSlashesToSpecialChars(const string &input)
 void
 testJsonStream(const string &key, const string &value, bool is_pretty)
 {
-    stringstream str_stream;
-    JsonStream json_stream(&str_stream, is_pretty);
+    JsonOutputStream json_stream(!is_pretty);
     {
         cereal::JSONOutputArchive out_ar(json_stream);
         out_ar.setNextName("regular_num");
@@ -77,56 +72,70 @@ testJsonStream(const string &key, const string &value, bool is_pretty)
     frmt = frmt % expected_value;
 
     string expected = frmt.str();
-    string actual = str_stream.str();
+    string actual = json_stream.take();
     EXPECT_EQ(actual, expected);
 }
 
-TEST(JsonStreamTest, prettyOneWord)
+TEST(JsonOutputStreamTest, prettyOneWord)
 {
     testJsonStream("regular_key", "regular_value", true);
 }
 
-TEST(JsonStreamTest, unprettyOneWord)
+TEST(JsonOutputStreamTest, unprettyOneWord)
 {
     testJsonStream("regular_key", "regular_value", false);
 }
 
-TEST(JsonStreamTest, prettyTwoWords)
+TEST(JsonOutputStreamTest, prettyTwoWords)
 {
     testJsonStream("spaced key", "spaced value", true);
 }
 
-TEST(JsonStreamTest, unprettyTwoWords)
+TEST(JsonOutputStreamTest, unprettyTwoWords)
 {
     testJsonStream("spaced key", "spaced value", false);
 }
 
-TEST(JsonStreamTest, prettyWithEnterTab)
+TEST(JsonOutputStreamTest, prettyWithEnterTab)
 {
     testJsonStream("entered\nkey", "tabbed\tvalue", true);
 }
 
-TEST(JsonStreamTest, unprettyWithEnterTab)
+TEST(JsonOutputStreamTest, unprettyWithEnterTab)
 {
     testJsonStream("entered\nkey", "tabbed\tvalue", false);
 }
 
-TEST(JsonStreamTest, prettyWithQout)
+TEST(JsonOutputStreamTest, prettyWithQout)
 {
     testJsonStream("qout \" key\"", "qout \" value\"", true);
 }
 
-TEST(JsonStreamTest, unprettyWithQout)
+TEST(JsonOutputStreamTest, unprettyWithQout)
 {
     testJsonStream("qout \" key\"", "qout \" value\"", false);
 }
 
-TEST(JsonStreamTest, prettyWithSlashQout)
+TEST(JsonOutputStreamTest, prettyWithSlashQout)
 {
     testJsonStream("qout \\\" key\\\"", "qout \\\" value\\\"", true);
 }
 
-TEST(JsonStreamTest, unprettyWithSlashQout)
+TEST(JsonOutputStreamTest, unprettyWithSlashQout)
 {
     testJsonStream("qout \\\" key\\\"", "qout \\\" value\\\"", false);
 }
+
+TEST(JsonOutputStreamTest, reuseStream)
+{
+    JsonOutputStream json_stream(true);
+    for (int i = 0; i < 3; i++) {
+        json_stream.reset();
+        {
+            cereal::JSONOutputArchive out_ar(json_stream);
+            out_ar(cereal::make_nvp("index", i));
+            out_ar(cereal::make_nvp("text", string(1000, 'a' + i)));
+        }
+        EXPECT_EQ(json_stream.str(), "{\"index\":" + to_string(i) + ",\"text\":\"" + string(1000, 'a' + i) + "\"}");
+    }
+}
@@ -0,0 +1,185 @@
+#include "cptest/cptest_bench_inputs.h"
+
+#include <random>
+#include <sstream>
+
+using namespace std;
+
+static const vector<string> first_names = {
+    "James", "Mary", "Robert", "Patricia", "John", "Jennifer", "Michael", "Linda", "David", "Elizabeth"
+};
+
+static const vector<string> cities = {
+    "Tel Aviv", "New York", "London", "Berlin", "Tokyo", "Paris", "Madrid", "Toronto", "Sydney", "Mumbai"
+};
+
+static const vector<string> products = {
+    "laptop", "phone case", "headphones", "monitor", "keyboard", "mouse pad", "usb-c cable", "webcam"
+};
+
+template <typename T>
+static const T &
+pick(const vector<T> &values, mt19937 &random)
+{
+    return values[random() % values.size()];
+}
+
+static string
+generateRecord(uint id, mt19937 &random)
+{
+    stringstream record;
+    record
+        << "{\"id\":" << id
+        << ",\"name\":\"" << pick(first_names, random) << "\""
+        << ",\"email\":\"user" << random() % 100000 << "@example.com\""
+        << ",\"active\":" << (random() % 2 == 0 ? "true" : "false")
+        << ",\"balance\":" << random() % 100000 << "." << random() % 100
+        << ",\"address\":{\"city\":\"" << pick(cities, random) << "\",\"zip\":\"" << 10000 + random() % 90000 << "\"}"
+        << ",\"orders\":[";
+    uint orders = random() % 4;
+    for (uint order = 0; order < orders; order++) {
+        if (order > 0) record << ",";
+        record
+            << "{\"product\":\"" << pick(products, random) << "\""
+            << ",\"quantity\":" << 1 + random() % 5
+            << ",\"note\":\"Please deliver after 5pm, thanks!\"}";
+    }
+    record << "]}";
+    return record.str();
+}
+
+string
+cptestBenignJson(size_t size, uint seed)
+{
+    mt19937 random(seed);
+    string json = "{\"page\":1,\"results\":[";
+    for (uint id = 0; json.size() < size; id++) {
+        if (id > 0) json += ",";
+        json += generateRecord(id, random);
+    }
+    json += "]}";
+    return json;
+}
+
+string
+cptestBenignXml(size_t size, uint seed)
+{
+    mt19937 random(seed);
+    stringstream xml;
+    xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?><response><page>1</page><results>";
+    for (uint id = 0; static_cast<size_t>(xml.tellp()) < size; id++) {
+        xml
+            << "<user id=\"" << id << "\">"
+            << "<name>" << pick(first_names, random) << "</name>"
+            << "<email>user" << random() % 100000 << "@example.com</email>"
+            << "<active>" << (random() % 2 == 0 ? "true" : "false") << "</active>"
+            << "<address><city>" << pick(cities, random) << "</city><zip>" << 10000 + random() % 90000 << "</zip>"
+            << "</address><note>Please deliver after 5pm &amp; call first</note></user>";
+    }
+    xml << "</results></response>";
+    return xml.str();
+}
+
+string
+cptestUrlEncodedForm(size_t size, uint seed)
+{
+    mt19937 random(seed);
+    string form;
+    for (uint field = 0; form.size() < size; field++) {
+        if (field > 0) form += "&";
+        form += "field" + to_string(field) + "=";
+        switch (random() % 3) {
+            case 0:
+                form += pick(first_names, random);
+                break;
+            case 1:
+                form += "Please%20deliver%20after%205pm%2C%20thanks%21";
+                break;
+            default:
+                form += to_string(random() % 100000);
+        }
+    }
+    return form;
+}
+
+string
+cptestMultipartBody(const string &boundary, size_t file_size, uint seed)
+{
+    mt19937 random(seed);
+    stringstream body;
+    body
+        << "--" << boundary << "\r\n"
+        << "Content-Disposition: form-data; name=\"title\"\r\n\r\n"
+        << "Quarterly report\r\n"
+        << "--" << boundary << "\r\n"
+        << "Content-Disposition: form-data; name=\"city\"\r\n\r\n"
+        << pick(cities, random) << "\r\n"
+        << "--" << boundary << "\r\n"
+        << "Content-Disposition: form-data; name=\"file\"; filename=\"report.zip\"\r\n"
+        << "Content-Type: application/zip\r\n\r\n"
+        << cptestBinaryData(file_size, seed) << "\r\n"
+        << "--" << boundary << "--\r\n";
+    return body.str();
+}
+
+string
+cptestBinaryData(size_t size, uint seed)
+{
+    mt19937 random(seed);
+    string data(size, '\0');
+    for (char &byte : data) byte = static_cast<char>(random() & 0xff);
+    return data;
+}
+
+const vector<string> &
+cptestSqliPayloads()
+{
+    static const vector<string> payloads = {
+        "' OR '1'='1",
+        "' OR 1=1 -- ",
+        "admin'--",
+        "1; DROP TABLE users",
+        "1' UNION SELECT username, password FROM users--",
+        "1 AND (SELECT COUNT(*) FROM information_schema.tables) > 0",
+        "1' AND SLEEP(5)#",
+        "1); WAITFOR DELAY '0:0:5'--",
+        "%27%20OR%20%271%27%3D%271",
+        "1'/**/UNION/**/SELECT/**/NULL,NULL,version()--",
+        "1' AND extractvalue(1,concat(0x7e,(SELECT user()),0x7e))--",
+        "MScgT1IgJzEnPScx"
+    };
+    return payloads;
+}
+
+const vector<string> &
+cptestXssPayloads()
+{
+    static const vector<string> payloads = {
+        "<script>alert(1)</script>",
+        "<img src=x onerror=alert(document.cookie)>",
+        "<svg/onload=alert('xss')>",
+        "javascript:alert(String.fromCharCode(88,83,83))",
+        "\"><iframe src=\"javascript:alert(1)\"></iframe>",
+        "<body onload=alert(1)>",
+        "%3Cscript%3Ealert%281%29%3C%2Fscript%3E",
+        "&lt;script&gt;alert(1)&lt;/script&gt;",
+        "\\u003cscript\\u003ealert(1)\\u003c/script\\u003e",
+        "<a href=\"jav&#x09;ascript:alert(1)\">click</a>",
+        "PHNjcmlwdD5hbGVydCgxKTwvc2NyaXB0Pg=="
+    };
+    return payloads;
+}
+
+const vector<string> &
+cptestAttackKeywords()
+{
+    static const vector<string> keywords = {
+        "select", "union", "insert", "update", "delete", "drop", "from", "where", "sleep", "benchmark",
+        "waitfor", "delay", "information_schema", "extractvalue", "updatexml", "concat", "char(", "0x",
+        "or 1=1", "' or '", "--", "/*", "*/", "#", ";",
+        "<script", "</script", "javascript:", "onerror", "onload", "onmouseover", "alert(", "document.cookie",
+        "<iframe", "<svg", "<img", "eval(", "fromcharcode", "expression(", "vbscript:",
+        "../", "..\\", "/etc/passwd", "cmd.exe", "/bin/sh", "${jndi:", "%00"
+    };
+    return keywords;
+}
@@ -38,6 +38,27 @@ public:
         return true;
     }
 
+    // All the indexed conditions must be true, so only the values that all of them allow are.
+    Maybe<set<string>>
+    getIndexValues(const string &index) const override
+    {
+        Maybe<set<string>> res = genError("None of the conditions is indexed");
+        for (auto &cond : conditions) {
+            auto values = cond->getIndexValues(index);
+            if (!values.ok()) continue;
+            if (!res.ok()) {
+                res = values;
+                continue;
+            }
+            set<string> common_values;
+            for (auto &value : values.unpack()) {
+                if (res.unpack().count(value) > 0) common_values.insert(value);
+            }
+            res = common_values;
+        }
+        return res;
+    }
+
     static std::string getName() { return "All"; }
 
 private:
@@ -65,6 +86,19 @@ public:
         return false;
     }
 
+    // Any of the conditions may be true, so the values are only known if all of them are indexed.
+    Maybe<set<string>>
+    getIndexValues(const string &index) const override
+    {
+        set<string> res;
+        for (auto &cond : conditions) {
+            auto values = cond->getIndexValues(index);
+            if (!values.ok()) return values;
+            res.insert(values.unpack().begin(), values.unpack().end());
+        }
+        return res;
+    }
+
     static std::string getName() { return "Any"; }
 
 private:
@@ -94,6 +128,25 @@ private:
     EvaluatorPtr<bool> cond;
 };
 
+static map<string, ContextIndexLookup> &
+getContextIndexesRepo()
+{
+    static map<string, ContextIndexLookup> context_indexes;
+    return context_indexes;
+}
+
+bool
+addContextIndex(const string &index, const ContextIndexLookup &lookup)
+{
+    return getContextIndexesRepo().emplace(index, lookup).second;
+}
+
+const map<string, ContextIndexLookup> &
+getContextIndexes()
+{
+    return getContextIndexesRepo();
+}
+
 void
 registerBaseEvaluators()
 {
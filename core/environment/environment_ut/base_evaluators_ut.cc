@@ -3,6 +3,7 @@
 #include "environment.h"
 #include "config.h"
 #include "config_component.h"
+#include "context.h"
 #include "mock/mock_mainloop.h"
 #include "mock/mock_time_get.h"
 
@@ -21,7 +22,7 @@ public:
         env.fini();
     }
 
-private:
+protected:
     NiceMock<MockMainLoop> mock_mainloop;
     NiceMock<MockTimeGet> mock_timer;
     ConfigComponent conf;
@@ -197,3 +198,106 @@ TEST_F(EvaluatorTest, malformed_evaluator_within_parameter)
     auto eval = genEvaluator<bool>("Any(All(), Any(BOB()))");
     EXPECT_THAT(eval, IsError("Evaluator 'BOB' doesn't exist for the required type"));
 }
+
+class TestIdMatcher : public EnvironmentEvaluator<bool>
+{
+public:
+    TestIdMatcher(const vector<string> &params)
+    {
+        if (params.size() != 1) reportWrongNumberOfParams(getName(), params.size(), 1, 1);
+        id = params[0];
+    }
+
+    static string getName() { return "testId"; }
+    static string getIndexName() { return "test id"; }
+
+    static Maybe<set<string>>
+    lookupIndexValues()
+    {
+        auto ctx = Singleton::Consume<I_Environment>::from<::Environment>()->get<string>("test id");
+        if (!ctx.ok()) return genError("No test id");
+        return set<string>{ ctx.unpack() };
+    }
+
+    Maybe<bool, Context::Error>
+    evalVariable() const override
+    {
+        evaluations++;
+        auto ctx = Singleton::Consume<I_Environment>::from<::Environment>()->get<string>("test id");
+        return ctx.ok() && ctx.unpack() == id;
+    }
+
+    Maybe<set<string>>
+    getIndexValues(const string &index) const override
+    {
+        if (index != getIndexName()) return genError("Not indexed");
+        return set<string>{ id };
+    }
+
+    static int evaluations;
+
+private:
+    string id;
+};
+
+int TestIdMatcher::evaluations = 0;
+
+static set<string>
+getTestIndexValues(const string &context)
+{
+    auto values = getMatcher<bool>(context)->getIndexValues("test id");
+    return values.ok() ? values.unpack() : set<string>{ "not indexed" };
+}
+
+TEST_F(EvaluatorTest, index_values)
+{
+    addMatcher<TestIdMatcher>();
+
+    EXPECT_EQ(getTestIndexValues("testId(a)"), set<string>({ "a" }));
+    EXPECT_FALSE(getMatcher<bool>("testId(a)")->getIndexValues("other").ok());
+    EXPECT_EQ(getTestIndexValues("Any(testId(a), All(testId(b), Not(testId(c))))"), set<string>({ "a", "b" }));
+    EXPECT_EQ(getTestIndexValues("All(Any(testId(a), testId(b)), testId(b))"), set<string>({ "b" }));
+    EXPECT_EQ(getTestIndexValues("Any()"), set<string>());
+    EXPECT_EQ(getTestIndexValues("Any(testId(a), All())"), set<string>({ "not indexed" }));
+    EXPECT_EQ(getTestIndexValues("Not(testId(a))"), set<string>({ "not indexed" }));
+}
+
+TEST_F(EvaluatorTest, indexed_configuration)
+{
+    addMatcher<TestIdMatcher>();
+    addContextIndex<TestIdMatcher>();
+    registerExpectedConfiguration<int>("Test", "indexed value");
+
+    string config_json = "{ \"Test\": { \"indexed value\": [ ";
+    for (int id = 0; id < 10; id++) {
+        config_json += "{ \"value\": " + to_string(id) + ", \"context\": \"testId(id" + to_string(id) + ")\" }, ";
+    }
+    config_json +=
+        "{ \"value\": 10, \"context\": \"Any(testId(other), testId(id7))\" }, "
+        "{ \"value\": 11, \"context\": \"All()\" } ] } }";
+    istringstream config_stream(config_json);
+    ASSERT_TRUE(Singleton::Consume<Config::I_Config>::from(conf)->loadConfiguration(config_stream));
+
+    Context ctx;
+    ctx.activate();
+    ctx.registerValue<string>("test id", "id7");
+    TestIdMatcher::evaluations = 0;
+    EXPECT_EQ(getConfigurationWithDefault<int>(-1, "Test", "indexed value"), 7);
+    EXPECT_EQ(TestIdMatcher::evaluations, 1);
+
+    ctx.registerValue<string>("test id", "other");
+    TestIdMatcher::evaluations = 0;
+    EXPECT_EQ(getConfigurationWithDefault<int>(-1, "Test", "indexed value"), 10);
+    EXPECT_EQ(TestIdMatcher::evaluations, 1);
+
+    ctx.registerValue<string>("test id", "unknown");
+    TestIdMatcher::evaluations = 0;
+    EXPECT_EQ(getConfigurationWithDefault<int>(-1, "Test", "indexed value"), 11);
+    EXPECT_EQ(TestIdMatcher::evaluations, 0);
+
+    // Without a test id the lookup fails, and all the contexts are checked in order.
+    ctx.deactivate();
+    TestIdMatcher::evaluations = 0;
+    EXPECT_EQ(getConfigurationWithDefault<int>(-1, "Test", "indexed value"), 11);
+    EXPECT_EQ(TestIdMatcher::evaluations, 12);
+}
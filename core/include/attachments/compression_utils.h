@@ -45,9 +45,15 @@ typedef enum CompressionType
 {
     NO_COMPRESSION,
     GZIP,
-    ZLIB
+    ZLIB,
+    BROTLI,
+    ZSTD
 } CompressionType;
 
+// Decompression of a stream fails once its output is larger than its input by more than the given ratio (1000 by
+// default, 0 disables the limit). Outputs under 1MB are never limited.
+void setMaxDecompressionRatio(const uint32_t max_ratio);
+
 typedef struct CompressionResult
 {
     int            ok;
@@ -79,6 +85,14 @@ decompressData(
     const unsigned char *compressed_data
 );
 
+DecompressionResult
+decompressDataByType(
+    CompressionStream *compression_stream,
+    const CompressionType compression_type,
+    const uint32_t compressed_data_size,
+    const unsigned char *compressed_data
+);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -17,6 +17,7 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <functional>
 
 #include "cereal/types/vector.hpp"
 #include "cereal/types/memory.hpp"
@@ -60,11 +61,100 @@ public:
     // The "Segment" class represent a countinuous part of the buffer. Unlike the "DataContainer" class, it is not
     // shared between diffrent buffers. It can be thought of as shared pointer to the "DataContainer" class - but it
     // also has additional capabilities of scoping, compairson, and handling copying-in of the memory.
-    class Segment;
+    // It is defined here, rather than with the rest of the internal classes, since the buffer holds a segment inline.
+    class Segment
+    {
+    public:
+        Segment() {}
+        Segment(std::vector<u_char> &&_vec);
+        Segment(const u_char *_ptr, uint _len, MemoryType _type);
+        ~Segment();
+        Segment(const Segment &);
+        Segment(Segment &&);
+        Segment & operator=(const Segment &);
+        Segment & operator=(Segment &&);
+
+        const u_char * data() const;
+        uint size() const { return len; }
+
+        template<class Archive> void save(Archive &ar, uint32_t) const;
+        template<class Archive> void load(Archive &ar, uint32_t);
+
+    private:
+        friend class Buffer;
+
+        // The "data_container" is the smart pointer to the actual memory.
+        std::shared_ptr<DataContainer> data_container;
+        // The "offset" and "len" members are used to indicate what part of the shared memory the segment refers to.
+        uint offset = 0, len = 0;
+
+        // The "type" member holds the volatility status of the memory.
+        Volatility type = Volatility::NONE;
+        // The "is_owned" member is used in case of SECONDARY volatility to check if ownership of the memory was
+        // taken. It a pointer to `data_container->is_owned` if the segement is SECONDARY, and nullptr if it isn't.
+        bool *is_owned = nullptr;
+        // The "ptr" member is used to gain access to the memory directly without going to through the shared memory
+        // pointer (fast path).
+        const u_char *ptr = nullptr;
+    };
+
+    // The "SegmentList" class holds the segments of the buffer. Most buffers are made of a single segment, so such a
+    // segment is kept inline and only buffers with more segments allocate a vector for them. Moving the list moves
+    // the inline segment as is, so a PRIMARY segment stays PRIMARY - just like when the vector is moved.
+    class SegmentList
+    {
+    public:
+        using iterator = Segment *;
+        using const_iterator = const Segment *;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        SegmentList() {}
+        SegmentList(const SegmentList &other);
+        SegmentList(SegmentList &&other);
+        SegmentList & operator=(const SegmentList &other);
+        SegmentList & operator=(SegmentList &&other);
+
+        uint size() const { return multiple.empty() ? (has_single ? 1 : 0) : multiple.size(); }
+        bool empty() const { return size() == 0; }
+
+        iterator begin() { return multiple.empty() ? &single : multiple.data(); }
+        iterator end() { return begin() + size(); }
+        const_iterator begin() const { return multiple.empty() ? &single : multiple.data(); }
+        const_iterator end() const { return begin() + size(); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+        Segment & front() { return *begin(); }
+        const Segment & front() const { return *begin(); }
+        Segment & back() { return *(end() - 1); }
+        const Segment & back() const { return *(end() - 1); }
+
+        void push_back(const Segment &seg);
+        void push_back(Segment &&seg);
+        void emplace_back(const u_char *_ptr, uint _len, MemoryType _type);
+        void insert(const_iterator pos, const_iterator first, const_iterator last);
+        void erase(const_iterator pos);
+        void pop_back();
+        void reserve(uint capacity);
+        void clear();
+
+        template<class Archive> void save(Archive &ar) const;
+        template<class Archive> void load(Archive &ar);
+
+    private:
+        void spill(uint capacity);
+        static void relocate(Segment &to, Segment &from);
+        static void reset(Segment &seg);
+
+        // The "single" segment is used while the buffer has at most one segment, and "multiple" once it has more.
+        Segment single;
+        bool has_single = false;
+        std::vector<Segment> multiple;
+    };
 
     // The "SegIterator" class allow iterating over the different segments of the buffer (for specifc part of the code
     // that require very high performance). The "SegRange" class is used for the `for ( : )` syntax.
-    using SegIterator = std::vector<Segment>::const_iterator;
+    using SegIterator = SegmentList::const_iterator;
     class SegRange final
     {
     public:
@@ -87,6 +177,9 @@ public:
     using value_type = u_char;
     using const_iterator = CharIterator;
 
+    // Searches a contiguous part of the buffer, returning a pointer to the match or nullptr (like `memchr`).
+    using SegmentScanner = std::function<const u_char *(const u_char *data, uint size)>;
+
     Buffer() {}
     Buffer(std::vector<u_char> &&vec);
     Buffer(const std::vector<u_char> &vec);
@@ -121,6 +214,9 @@ public:
     Maybe<uint> findLastOf(char ch, uint start) const;
     Maybe<uint> findLastNotOf(char ch) const { return findLastNotOf(ch, len); }
     Maybe<uint> findLastNotOf(char ch, uint start) const;
+    // Runs the scanner over each segment (from `start` onwards) without serializing the buffer, so it fits searches
+    // whose matches cannot cross segments, such as single characters.
+    Maybe<uint> findFirst(const SegmentScanner &scanner, uint start = 0) const;
     
     void truncateHead(uint size);
     void truncateTail(uint size);
@@ -155,7 +251,7 @@ public:
 
 private:
     void evalFastPath() const;
-    std::vector<Segment> segs;
+    SegmentList segs;
     uint len = 0;
     // The "fast_path_ptr" and "fast_path_len" are used to allow a direct fast access to the beginning of the buffer
     // (the first segment), which is the typical case.
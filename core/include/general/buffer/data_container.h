@@ -32,8 +32,7 @@ public:
     void
     takeOwnership()
     {
-        vec = std::vector<u_char>(ptr, ptr + len);
-        ptr = vec.data();
+        copyIn(ptr);
         is_owned = true;
     }
 
@@ -41,7 +40,7 @@ public:
     void
     save(Archive &ar, uint32_t) const
     {
-        if (is_owned) {
+        if (is_owned && ptr == vec.data()) {
             ar(vec);
         } else {
             std::vector<u_char> data(ptr, ptr + len);
@@ -60,8 +59,16 @@ public:
     }
 
 private:
-    // If the memory is OWNED (not STATIC or VOLATILE), the "vec" member is holding it - otherwise it is empty.
+    // Small payloads (such as header values and status codes) are kept in the container itself rather than in "vec",
+    // saving an allocation.
+    static const uint inline_capacity = 32;
+
+    void copyIn(const u_char *_ptr);
+
+    // If the memory is OWNED (not STATIC or VOLATILE), the "vec" or "inline_data" member is holding it - otherwise
+    // they are unused.
     std::vector<u_char> vec;
+    u_char inline_data[inline_capacity];
     // The "ptr" member points to the the beginning of the data, regardless of the type of memory.
     const u_char *ptr = nullptr;
     uint len = 0;
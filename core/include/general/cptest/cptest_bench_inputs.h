@@ -0,0 +1,50 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __CPTEST_BENCH_INPUTS_H__
+#define __CPTEST_BENCH_INPUTS_H__
+
+#include <string>
+#include <vector>
+
+//
+// Generators of realistic inputs for the micro-benchmarks.
+// The generators are deterministic - the same arguments always produce the same input, so that results of runs on
+// different versions can be compared.
+//
+
+// A JSON document of about `size` bytes, shaped like the responses of a typical REST API (arrays of records with
+// nested objects, numbers, booleans and short strings).
+std::string cptestBenignJson(size_t size, uint seed = 0);
+
+// An XML document of about `size` bytes, with the same records as `cptestBenignJson`.
+std::string cptestBenignXml(size_t size, uint seed = 0);
+
+// A "application/x-www-form-urlencoded" body of about `size` bytes, with some of the values percent-encoded.
+std::string cptestUrlEncodedForm(size_t size, uint seed = 0);
+
+// A "multipart/form-data" body with a few form fields and a binary file of `file_size` bytes.
+std::string cptestMultipartBody(const std::string &boundary, size_t file_size, uint seed = 0);
+
+// Random bytes, as in the upload of a compressed or encrypted file.
+std::string cptestBinaryData(size_t size, uint seed = 0);
+
+// Well known SQL injection and cross site scripting payloads, some of them encoded the way attackers evade
+// detection (percent-encoding, HTML entities, unicode escapes, base64).
+const std::vector<std::string> & cptestSqliPayloads();
+const std::vector<std::string> & cptestXssPayloads();
+
+// Keywords that signatures look for in SQL injection and cross site scripting attacks.
+const std::vector<std::string> & cptestAttackKeywords();
+
+#endif // __CPTEST_BENCH_INPUTS_H__
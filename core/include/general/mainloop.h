@@ -22,6 +22,7 @@
 #include "i_messaging.h"
 #include "i_agent_details.h"
 #include "i_signal_handler.h"
+#include "i_rest_api.h"
 #include "singleton.h"
 #include "component.h"
 
@@ -35,7 +36,8 @@ class MainloopComponent
     Singleton::Consume<I_TimeGet>,
     Singleton::Consume<I_Messaging>,
     Singleton::Consume<I_AgentDetails>,
-    Singleton::Consume<I_SignalHandler>
+    Singleton::Consume<I_SignalHandler>,
+    Singleton::Consume<I_RestApi>
 {
 public:
     MainloopComponent();
@@ -18,6 +18,7 @@
 
 #include "i_rest_api.h"
 #include "i_mainloop.h"
+#include "i_time_get.h"
 #include "singleton.h"
 #include "i_environment.h"
 #include "component.h"
@@ -27,6 +28,7 @@ class RestServer
     public Component,
     Singleton::Provide<I_RestApi>,
     Singleton::Consume<I_MainLoop>,
+    Singleton::Consume<I_TimeGet>,
     Singleton::Consume<I_Environment>
 {
 public:
@@ -15,6 +15,7 @@
 #define __MAINLOOP_METRIC_H__
 
 #include "generic_metric.h"
+#include "i_mainloop.h"
 
 class MainloopEvent : public Event<MainloopEvent>
 {
@@ -93,4 +94,60 @@ private:
     MetricCalculations::LastReportedValue<uint32_t> last_report_stress_value{this, "mainloopLastStressValueSample"};
 };
 
+// The runs of the routines since the previous report, aggregated by the mainloop once every report interval.
+class MainloopRoutinesEvent : public Event<MainloopRoutinesEvent>
+{
+public:
+    MainloopRoutinesEvent(const I_MainLoop::RoutinesStats &_stats) : stats(_stats) {}
+
+    const I_MainLoop::RoutinesStats & getStats() const { return stats; }
+
+private:
+    const I_MainLoop::RoutinesStats &stats;
+};
+
+class MainloopRoutinesMetric
+        :
+    public GenericMetric,
+    public Listener<MainloopRoutinesEvent>
+{
+public:
+    void
+    upon(const MainloopRoutinesEvent &event) override
+    {
+        for (const auto &routine : event.getStats()) {
+            cpu_time.report(routine.first, routine.second.cpu_time.count());
+            runs.report(routine.first, routine.second.runs);
+            yields.report(routine.first, routine.second.yields);
+            max_slice.report(routine.first, routine.second.max_slice.count());
+        }
+    }
+
+private:
+    MetricCalculations::MetricMap<std::string, MetricCalculations::Counter> cpu_time{
+        MetricCalculations::Counter{nullptr, ""},
+        this,
+        "routine",
+        "mainloopRoutineCpuTimeMicroSec"
+    };
+    MetricCalculations::MetricMap<std::string, MetricCalculations::Counter> runs{
+        MetricCalculations::Counter{nullptr, ""},
+        this,
+        "routine",
+        "mainloopRoutineRuns"
+    };
+    MetricCalculations::MetricMap<std::string, MetricCalculations::Counter> yields{
+        MetricCalculations::Counter{nullptr, ""},
+        this,
+        "routine",
+        "mainloopRoutineYields"
+    };
+    MetricCalculations::MetricMap<std::string, MetricCalculations::Max<uint64_t>> max_slice{
+        MetricCalculations::Max<uint64_t>{nullptr, ""},
+        this,
+        "routine",
+        "mainloopRoutineMaxSliceMicroSec"
+    };
+};
+
 #endif // __MAINLOOP_METRIC_H__
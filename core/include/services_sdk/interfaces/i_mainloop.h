@@ -15,6 +15,7 @@
 #define __I_MAINLOOP_H__
 
 #include <functional>
+#include <map>
 #include <string>
 #include <chrono>
 
@@ -27,6 +28,19 @@ public:
     using RoutineID = uint;
     enum class RoutineType { RealTime, Timer, System, Offline };
 
+    // Accounting of the runs of the routines with the same name, accumulated since the mainloop started.
+    struct RoutineStats
+    {
+        RoutineType priority = RoutineType::RealTime;
+        uint64_t runs = 0;     // Number of times the routine got the control
+        uint64_t yields = 0;   // Runs that ended with the routine yielding, rather than ending
+        uint64_t overruns = 0; // Runs that exceeded the time slice by more than the "Exceed Warning"
+        std::chrono::microseconds cpu_time = std::chrono::microseconds::zero();
+        std::chrono::microseconds run_time = std::chrono::microseconds::zero();
+        std::chrono::microseconds max_slice = std::chrono::microseconds::zero();
+    };
+    using RoutinesStats = std::map<std::string, RoutineStats>;
+
     // There are two types of routines:
     // 1. The primary routines that perform the main functionality of the product.
     // 2. The secondary routines that perform auxiliary functionality (upgrade, REST, etc.)
@@ -63,6 +77,8 @@ public:
 
     virtual void updateCurrentStress(bool is_busy) = 0;
 
+    virtual RoutinesStats getRoutinesStats() const = 0;
+
     virtual void run() = 0;
 
     // When a routine yields the scheduler may choose to let it continue to run (in the case the routine didn't use
@@ -73,6 +89,10 @@ public:
     virtual void yield(std::chrono::microseconds time) = 0;
     void yield(int) = delete; // This prevents the syntax `yield(0)` which is otherwise ambiguous
 
+    // A file routine that has nothing more to read can wait until its fd becomes readable, or until `timeout` passes
+    // (zero waits for the fd only). Routines whose fd is not watched by the mainloop are simply yielded.
+    virtual void yieldUntilFileEvent(std::chrono::microseconds timeout) = 0;
+
     virtual void stopAll() = 0;
     virtual void stop() = 0;
     virtual void stop(RoutineID id) = 0;
@@ -0,0 +1,39 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __I_SAMPLING_PROFILER_H__
+#define __I_SAMPLING_PROFILER_H__
+
+#include <chrono>
+#include <string>
+
+#include "maybe_res.h"
+
+class I_SamplingProfiler
+{
+public:
+    enum class ReportFormat { TOP, FOLDED };
+
+    // Samples the CPU time of the mainloop thread every `interval`. A non-zero `duration` stops the sampling after it.
+    virtual Maybe<void> start(std::chrono::milliseconds interval, std::chrono::seconds duration) = 0;
+    virtual void stop() = 0;
+    virtual bool isActive() const = 0;
+
+    // The samples taken since the last start: the `top` busiest routines and stages, or all of them as folded stacks.
+    virtual std::string getReport(ReportFormat format, uint top) const = 0;
+
+protected:
+    virtual ~I_SamplingProfiler() {}
+};
+
+#endif // __I_SAMPLING_PROFILER_H__
@@ -28,8 +28,11 @@ public:
 
     MOCK_METHOD1(updateCurrentStress,       void (bool));
 
+    MOCK_CONST_METHOD0(getRoutinesStats,    RoutinesStats ());
+
     MOCK_METHOD1(yield,                     void (bool));
     MOCK_METHOD1(yield,                     void (std::chrono::microseconds));
+    MOCK_METHOD1(yieldUntilFileEvent,       void (std::chrono::microseconds));
 
     MOCK_METHOD0(stopAll,                   void ());
     MOCK_METHOD0(stop,                      void ());
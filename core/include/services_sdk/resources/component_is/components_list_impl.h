@@ -37,6 +37,7 @@
 #include "signal_handler.h"
 #include "cpu.h"
 #include "memory_consumption.h"
+#include "sampling_profiler.h"
 #include "instance_awareness.h"
 #include "socket_is.h"
 #include "generic_rulebase/generic_rulebase.h"
@@ -232,6 +233,7 @@ class ComponentListCore
         CPUCalculator,
         CPUManager,
         MemoryCalculator,
+        SamplingProfiler,
         TenantManager,
         GenericRulebase,
         EnvDetails,
@@ -14,6 +14,11 @@
 #ifndef __ENVIRONMENT_EVALUATOR_H__
 #define __ENVIRONMENT_EVALUATOR_H__
 
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+
 #include "maybe_res.h"
 #include "context.h"
 
@@ -28,6 +33,14 @@ public:
     virtual ~EnvironmentEvaluator() {}
     virtual Maybe<Value, Context::Error> evalVariable() const = 0;
 
+    // The values of the context index `index` (see `addContextIndex`) for which the evaluator may be true, or an
+    // error if it may be true regardless of them.
+    virtual Maybe<std::set<std::string>>
+    getIndexValues(const std::string &) const
+    {
+        return genError("The evaluator is not indexed");
+    }
+
     using Type = Value;
 };
 
@@ -73,4 +86,21 @@ addMatcher()
     return ptr->template addMatcher<Matcher>();
 }
 
+// Context indexes let the configuration skip the contexts that cannot match, without evaluating them. The lookup of
+// an index returns the values of the current environment (e.g. the host of the transaction), and a context that can
+// only be true for other values is skipped. A lookup that cannot tell returns an error, and then no context is
+// skipped. An indexed matcher has `static std::string getIndexName()` and `static Maybe<std::set<std::string>>
+// lookupIndexValues()` functions, and implements `getIndexValues`.
+using ContextIndexLookup = std::function<Maybe<std::set<std::string>>()>;
+
+bool addContextIndex(const std::string &index, const ContextIndexLookup &lookup);
+const std::map<std::string, ContextIndexLookup> & getContextIndexes();
+
+template <typename Matcher>
+bool
+addContextIndex()
+{
+    return addContextIndex(Matcher::getIndexName(), Matcher::lookupIndexValues);
+}
+
 #endif // __ENVIRONMENT_EVALUATOR_H__
@@ -40,6 +40,7 @@ namespace MetricCalculations
     template <typename T> class Average;
     template <typename T> class LastReportedValue;
     template <typename T, uint N> class TopValues;
+    template <typename T> class Histogram;
     template <typename PrintableKey, typename Metric> class MetricMap;
 } // MetricCalculations
 
@@ -139,6 +140,7 @@ private:
 #include "metric/min.h"
 #include "metric/average.h"
 #include "metric/top_values.h"
+#include "metric/histogram.h"
 #include "metric/last_reported_value.h"
 #include "metric/metric_map.h"
 
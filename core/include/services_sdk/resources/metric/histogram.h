@@ -0,0 +1,217 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __HISTOGRAM_H__
+#define __HISTOGRAM_H__
+
+#ifndef __GENERIC_METRIC_H__
+#error metric/histogram.h should not be included directly
+#endif // __GENERIC_METRIC_H_
+
+#include <array>
+#include <vector>
+#include <algorithm>
+
+namespace MetricCalculations
+{
+
+// Distribution of the reported values, from which percentiles are calculated (e.g. the p99 of a latency).
+// Values are counted in log-linear buckets, in the manner of HdrHistogram: every power of 2 is split into
+// 16 buckets of equal width, so a percentile is accurate to within 1/16 of its value, and reporting a value
+// is a constant time increment. Negative values are counted as 0.
+// Histograms of the same type can be merged, e.g. to combine the histograms collected by several workers.
+template <typename T>
+class Histogram : public MetricCalc
+{
+    static const uint sub_bucket_bits = 4;
+    static const uint sub_bucket_count = 1 << sub_bucket_bits;
+    static const uint bucket_count = (64 - sub_bucket_bits + 1) * sub_bucket_count;
+
+public:
+    template <typename ... Args>
+    Histogram(GenericMetric *metric, const std::string &title, const Args & ... args)
+            :
+        MetricCalc(metric, title, args ...)
+    {
+        buckets.fill(0);
+    }
+
+    void
+    report(const T &new_value)
+    {
+        uint64_t value = new_value > 0 ? static_cast<uint64_t>(new_value) : 0;
+        buckets[getBucketIndex(value)]++;
+        if (count == 0 || value < min) min = value;
+        if (count == 0 || value > max) max = value;
+        sum += value;
+        count++;
+    }
+
+    void
+    merge(const Histogram<T> &other)
+    {
+        if (other.count == 0) return;
+        for (uint index = 0; index < bucket_count; index++) {
+            buckets[index] += other.buckets[index];
+        }
+        if (count == 0 || other.min < min) min = other.min;
+        if (count == 0 || other.max > max) max = other.max;
+        sum += other.sum;
+        count += other.count;
+    }
+
+    void
+    reset() override
+    {
+        buckets.fill(0);
+        count = 0;
+        sum = 0;
+        min = 0;
+        max = 0;
+    }
+
+    uint64_t getCount() const { return count; }
+    T getMin() const { return static_cast<T>(min); }
+    T getMax() const { return static_cast<T>(max); }
+    double getAverage() const { return count == 0 ? 0 : static_cast<double>(sum) / count; }
+
+    // The highest value the bucket of the given percentile (between 0 and 100) may hold, capped by the maximum.
+    T
+    getPercentile(double percentile) const
+    {
+        if (count == 0) return 0;
+
+        uint64_t rank = static_cast<uint64_t>(std::ceil(count * std::min(std::max(percentile, 0.0), 100.0) / 100));
+        if (rank == 0) rank = 1;
+
+        uint64_t seen = 0;
+        for (uint index = 0; index < bucket_count; index++) {
+            seen += buckets[index];
+            if (seen >= rank) return static_cast<T>(std::min(getBucketTop(index), max));
+        }
+        return static_cast<T>(max);
+    }
+
+    float
+    getValue() const override
+    {
+        return std::nanf("");
+    }
+
+    void
+    save(cereal::JSONOutputArchive &ar) const override
+    {
+        // The archive keeps the name by pointer until the node starts
+        const std::string name = getMetricName();
+        ar.setNextName(name.c_str());
+        ar.startNode();
+        ar(cereal::make_nvp("count", count));
+        ar(cereal::make_nvp("min", getMin()));
+        ar(cereal::make_nvp("max", getMax()));
+        for (const auto &percentile : getPercentiles()) {
+            ar(cereal::make_nvp(percentile.first, getPercentile(percentile.second)));
+        }
+        ar.finishNode();
+    }
+
+    LogField
+    getLogField() const override
+    {
+        LogField field(getMetricName());
+        field.addFields(LogField("count", count));
+        field.addFields(LogField("min", static_cast<uint64_t>(getMin())));
+        field.addFields(LogField("max", static_cast<uint64_t>(getMax())));
+        for (const auto &percentile : getPercentiles()) {
+            field.addFields(LogField(percentile.first, static_cast<uint64_t>(getPercentile(percentile.second))));
+        }
+        return field;
+    }
+
+    std::vector<PrometheusData>
+    getPrometheusMetrics() const override
+    {
+        std::vector<PrometheusData> res;
+        if (count == 0) return res;
+
+        for (const auto &percentile : getPercentiles()) {
+            PrometheusData data = getPrometheusData(static_cast<float>(getPercentile(percentile.second)));
+            data.label += (data.label.empty() ? "" : ",") + getQuantileLabel(percentile.second);
+            res.push_back(data);
+        }
+        return res;
+    }
+
+    std::vector<AiopsMetricData>
+    getAiopsMetrics() const override
+    {
+        std::vector<AiopsMetricData> res;
+        if (count == 0) return res;
+
+        for (const auto &percentile : getPercentiles()) {
+            AiopsMetricData data = getAiopsData(static_cast<float>(getPercentile(percentile.second)));
+            data.addMetricAttribute("quantile", percentile.first);
+            res.push_back(data);
+        }
+        return res;
+    }
+
+private:
+    static const std::vector<std::pair<std::string, double>> &
+    getPercentiles()
+    {
+        static const std::vector<std::pair<std::string, double>> percentiles = {
+            { "p50", 50 },
+            { "p90", 90 },
+            { "p99", 99 },
+            { "p999", 99.9 }
+        };
+        return percentiles;
+    }
+
+    static std::string
+    getQuantileLabel(double percentile)
+    {
+        std::stringstream label;
+        label << "quantile=\"" << percentile / 100 << "\"";
+        return label.str();
+    }
+
+    // Values below `sub_bucket_count` have a bucket each, from there on every power of 2 spans `sub_bucket_count`
+    // buckets, indexed by the bits that follow its most significant bit.
+    static uint
+    getBucketIndex(uint64_t value)
+    {
+        if (value < sub_bucket_count) return value;
+        uint shift = 63 - __builtin_clzll(value) - sub_bucket_bits;
+        return (shift + 1) * sub_bucket_count + ((value >> shift) - sub_bucket_count);
+    }
+
+    static uint64_t
+    getBucketTop(uint index)
+    {
+        if (index < sub_bucket_count) return index;
+        uint shift = index / sub_bucket_count - 1;
+        uint64_t mantissa = index % sub_bucket_count + sub_bucket_count;
+        return (mantissa << shift) + ((uint64_t(1) << shift) - 1);
+    }
+
+    std::array<uint64_t, bucket_count> buckets;
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t min = 0;
+    uint64_t max = 0;
+};
+
+} // namespace MetricCalculations
+
+#endif // __HISTOGRAM_H__
@@ -241,6 +241,8 @@ public:
 protected:
     void addMetric(GenericMetric *metric);
     std::map<std::string, std::string> getBasicLabels() const;
+    PrometheusData getPrometheusData(float value) const;
+    AiopsMetricData getAiopsData(float value) const;
 
     template <typename Metadata, typename ... OtherMetadata>
     void
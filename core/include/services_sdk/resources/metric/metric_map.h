@@ -44,6 +44,13 @@ class MetricMap : public MetricCalc
             return inner_map.emplace(key, std::move(metric));
         }
 
+        Metric *
+        find(const std::string &key)
+        {
+            auto metric = inner_map.find(key);
+            return metric != inner_map.end() ? &metric->second : nullptr;
+        }
+
         void clear() { inner_map.clear(); }
 
         MetricType
@@ -134,12 +141,14 @@ public:
     void
     report(const PrintableKey &key, const Values & ... new_values)
     {
-        std::stringstream string_key;
-        string_key << key;
-        auto new_metric = base_metric;
-        new_metric.setMetricName(string_key.str());
-        auto metric = metric_map.emplace(string_key.str(), std::move(new_metric)).first;
-        metric->second.report(new_values...);
+        getMetric(key).report(new_values...);
+    }
+
+    // Adds the values of a metric that was aggregated elsewhere (e.g. a histogram) to the metric of the key.
+    void
+    merge(const PrintableKey &key, const Metric &other)
+    {
+        getMetric(key).merge(other);
     }
 
     LogField
@@ -167,6 +176,21 @@ public:
     }
 
 private:
+    Metric &
+    getMetric(const PrintableKey &key)
+    {
+        std::stringstream string_key;
+        string_key << key;
+        // Avoid copying the base metric, which may be large (e.g. a histogram), if the key already has a metric
+        auto metric = metric_map.find(string_key.str());
+        if (metric == nullptr) {
+            auto new_metric = base_metric;
+            new_metric.setMetricName(string_key.str());
+            metric = &metric_map.emplace(string_key.str(), std::move(new_metric)).first->second;
+        }
+        return *metric;
+    }
+
     InnerMap metric_map;
     Metric base_metric;
     std::string label;
@@ -0,0 +1,47 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __SAMPLING_PROFILER_H__
+#define __SAMPLING_PROFILER_H__
+
+#include <memory>
+
+#include "i_sampling_profiler.h"
+#include "i_mainloop.h"
+#include "i_rest_api.h"
+#include "profiling_labels.h"
+#include "singleton.h"
+#include "component.h"
+
+// Attributes the CPU time of the mainloop thread to the running routine and to the instrumented stages in it (see
+// `ProfilingStage`). Controlled through the "set-sampling-profiler" and "show-sampling-profiler" REST calls.
+class SamplingProfiler
+        :
+    public Component,
+    Singleton::Provide<I_SamplingProfiler>,
+    Singleton::Consume<I_MainLoop>,
+    Singleton::Consume<I_RestApi>
+{
+public:
+    SamplingProfiler();
+    ~SamplingProfiler();
+
+    void init();
+    void fini();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pimpl;
+};
+
+#endif // __SAMPLING_PROFILER_H__
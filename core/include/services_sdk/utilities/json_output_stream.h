@@ -0,0 +1,137 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __JSON_OUTPUT_STREAM_H__
+#define __JSON_OUTPUT_STREAM_H__
+
+#include <algorithm>
+#include <cctype>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <utility>
+
+// An output stream to build JSON documents in memory, mostly used as the stream of `cereal::JSONOutputArchive`.
+// The text is written straight into a string owned by the stream, that can be moved out once the document is done
+// (saving the copy `std::stringstream::str()` makes), or reused with `reset()` for the next document.
+// A compact stream drops the whitespaces outside of JSON strings, leaving the pretty printing of the archive out.
+class JsonOutputStream : private std::streambuf, public std::ostream
+{
+public:
+    explicit JsonOutputStream(bool _is_compact = false) : std::ostream(this), is_compact(_is_compact) {}
+
+    JsonOutputStream(const JsonOutputStream &) = delete;
+    JsonOutputStream & operator=(const JsonOutputStream &) = delete;
+
+    // The document written so far. Valid until the next write to the stream.
+    const std::string &
+    str()
+    {
+        commit();
+        output.resize(output_size);
+        setp(nullptr, nullptr);
+        return output;
+    }
+
+    // Moves the document out of the stream, leaving it empty.
+    std::string
+    take()
+    {
+        str();
+        std::string res = std::move(output);
+        reset();
+        return res;
+    }
+
+    // Empties the stream, keeping the memory allocated by previous documents.
+    void
+    reset()
+    {
+        output.clear();
+        output_size = 0;
+        in_string = false;
+        is_prev_backslash = false;
+        setp(nullptr, nullptr);
+        std::ostream::clear();
+    }
+
+private:
+    static const size_t initial_size = 512;
+
+    int
+    overflow(int c) override
+    {
+        commit();
+        output.resize(std::max(output.size() * 2, output_size + initial_size));
+        setp(&output[output_size], &output[0] + output.size());
+        if (c == std::streambuf::traits_type::eof()) return std::streambuf::traits_type::not_eof(c);
+        *pptr() = std::streambuf::traits_type::to_char_type(c);
+        pbump(1);
+        return c;
+    }
+
+    std::streamsize
+    xsputn(const char *s, std::streamsize n) override
+    {
+        if (epptr() - pptr() < n) {
+            commit();
+            output.resize(std::max(output.size() * 2, output_size + n + initial_size));
+            setp(&output[output_size], &output[0] + output.size());
+        }
+        std::streambuf::traits_type::copy(pptr(), s, n);
+        pbump(n);
+        return n;
+    }
+
+    int
+    sync() override
+    {
+        commit();
+        return 0;
+    }
+
+    // Accounts for the characters in the put area, removing whitespaces from them in a compact stream.
+    void
+    commit()
+    {
+        if (pbase() == nullptr) return;
+
+        size_t end = pptr() - &output[0];
+        if (!is_compact) {
+            output_size = end;
+        } else {
+            for (size_t index = output_size; index < end; index++) {
+                char c = output[index];
+                if (is_prev_backslash) {
+                    is_prev_backslash = false;
+                } else if (c == '"') {
+                    in_string = !in_string;
+                } else if (c == '\\') {
+                    is_prev_backslash = true;
+                } else if (!in_string && isspace(static_cast<unsigned char>(c))) {
+                    continue;
+                }
+                output[output_size++] = c;
+            }
+        }
+        setp(&output[output_size], &output[0] + output.size());
+    }
+
+    std::string output;
+    size_t output_size = 0;
+    bool is_compact;
+    bool in_string = false;
+    bool is_prev_backslash = false;
+};
+
+#endif // __JSON_OUTPUT_STREAM_H__
@@ -0,0 +1,103 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __PROFILING_LABELS_H__
+#define __PROFILING_LABELS_H__
+
+#include <signal.h>
+
+// What the mainloop thread is doing right now: the running routine, and the stack of instrumented stages inside it.
+// The sampling profiler reads the labels from its signal handler, so they are kept in plain static memory and are
+// only written with single stores.
+class ProfilingLabels
+{
+public:
+    static const int max_stages = 8;
+
+    struct State
+    {
+        const char * volatile routine;
+        const char * volatile stages[max_stages];
+        volatile sig_atomic_t num_of_stages;
+    };
+
+    static State &
+    get()
+    {
+        static State state;
+        return state;
+    }
+
+    // The stages a routine was in when it yielded, to be restored when it resumes.
+    struct Stages
+    {
+        const char *stages[max_stages];
+        int num_of_stages = 0;
+    };
+
+    // The name must stay valid until the next call - the mainloop resets it after every run of a routine.
+    static void
+    setRoutine(const char *routine)
+    {
+        State &state = get();
+        state.num_of_stages = 0;
+        state.routine = routine;
+    }
+
+    static void
+    saveStages(Stages &saved)
+    {
+        const State &state = get();
+        saved.num_of_stages = state.num_of_stages;
+        for (int stage = 0; stage < saved.num_of_stages && stage < max_stages; stage++) {
+            saved.stages[stage] = state.stages[stage];
+        }
+    }
+
+    // The stages are written before their number, so a sample taken in the middle only sees complete stages.
+    static void
+    restoreStages(const Stages &saved)
+    {
+        State &state = get();
+        state.num_of_stages = 0;
+        for (int stage = 0; stage < saved.num_of_stages && stage < max_stages; stage++) {
+            state.stages[stage] = saved.stages[stage];
+        }
+        state.num_of_stages = saved.num_of_stages;
+    }
+};
+
+// Attributes the samples taken in its scope to the stage. The stage name is kept by pointer, so it should be a
+// string literal.
+class ProfilingStage
+{
+public:
+    explicit ProfilingStage(const char *stage) : depth(ProfilingLabels::get().num_of_stages)
+    {
+        ProfilingLabels::State &state = ProfilingLabels::get();
+        if (depth < ProfilingLabels::max_stages) state.stages[depth] = stage;
+        state.num_of_stages = depth + 1;
+    }
+
+    // Restores the depth rather than decrementing it, so a routine that yielded in the middle of a stage cannot
+    // leave the stack unbalanced.
+    ~ProfilingStage() { ProfilingLabels::get().num_of_stages = depth; }
+
+    ProfilingStage(const ProfilingStage &) = delete;
+    ProfilingStage & operator=(const ProfilingStage &) = delete;
+
+private:
+    sig_atomic_t depth;
+};
+
+#endif // __PROFILING_LABELS_H__
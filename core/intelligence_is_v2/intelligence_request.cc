@@ -14,7 +14,7 @@
 #include "intelligence_request.h"
 #include "debug.h"
 #include "intelligence_comp_v2.h"
-#include "intelligence_is_v2/json_stream.h"
+#include "json_output_stream.h"
 
 
 using namespace Intelligence;
@@ -85,8 +85,7 @@ IntelligenceRequest::isPagingAllowed() const
 Maybe<std::string>
 IntelligenceRequest::genJson() const
 {
-    std::stringstream str_stream;
-    JsonStream json_stream(&str_stream, is_pretty);
+    JsonOutputStream json_stream(!is_pretty);
     {
         cereal::JSONOutputArchive out_ar(json_stream);
 
@@ -117,5 +116,5 @@ IntelligenceRequest::genJson() const
         }
     }
 
-    return str_stream.str();
+    return json_stream.take();
 }
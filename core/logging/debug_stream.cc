@@ -13,9 +13,8 @@
 
 #include "log_streams.h"
 
-#include <sstream>
-
 #include "debug.h"
+#include "json_output_stream.h"
 
 using namespace std;
 using namespace cereal;
@@ -25,10 +24,10 @@ USE_DEBUG_FLAG(D_REPORT);
 void
 DebugStream::sendLog(const Report &log)
 {
-    stringstream ss;
+    JsonOutputStream json_stream;
     {
-        JSONOutputArchive ar(ss);
+        JSONOutputArchive ar(json_stream);
         log.serialize(ar);
     }
-    dbgInfo(D_REPORT) << ss.str();
+    dbgInfo(D_REPORT) << json_stream.str();
 }
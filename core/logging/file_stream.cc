@@ -12,11 +12,15 @@
 // limitations under the License.
 
 #include "log_streams.h"
+
+#include <algorithm>
+
 #include "debug.h"
 #include "config.h"
 #include "singleton.h"
 #include "logging_comp.h"
 #include "agent_core_utilities.h"
+#include "json_output_stream.h"
 
 using namespace std;
 using namespace cereal;
@@ -65,26 +69,23 @@ LogFileStream::sendLog(const Report &log)
     string logs_separator = getProfileAgentSettingWithDefault<string>("", "agent.config.logFileLineSeparator");
     logs_separator = getConfigurationWithDefault<string>(logs_separator, "Logging", "Log file line separator");
 
-    stringstream ss;
-    if (should_format_log) {
-        {
-            JSONOutputArchive ar(ss);
-            log.serialize(ar);
-        }
-        log_stream << ss.str() << logs_separator << endl;
-    } else {
-        {
-            JSONOutputArchive ar(ss, JSONOutputArchive::Options::NoIndent());
-            log.serialize(ar);
-        }
-        static const boost::regex reg("\\n");
-        log_stream << NGEN::Regex::regexReplace(__FILE__, __LINE__, ss.str(), reg, "") << logs_separator << endl;
+    JsonOutputStream json_stream;
+    {
+        JSONOutputArchive ar(
+            json_stream,
+            should_format_log ? JSONOutputArchive::Options::Default() : JSONOutputArchive::Options::NoIndent()
+        );
+        log.serialize(ar);
     }
+    string log_text = json_stream.take();
+    // Line breaks within strings are escaped, so the only ones in the text are the archive's formatting
+    if (!should_format_log) log_text.erase(remove(log_text.begin(), log_text.end(), '\n'), log_text.end());
+    log_stream << log_text << logs_separator << endl;
 
     if (!log_stream.good()) {
         dbgWarning(D_REPORT) << "Failed to write log to file, will retry. File path: " << log_file_name;
 
-        if (!retryWritingLog(ss.str())) {
+        if (!retryWritingLog(log_text)) {
             dbgWarning(D_REPORT) << "Failed to write log to file";
             return;
         }
@@ -13,6 +13,8 @@
 
 #include "log_generator.h"
 
+#include "json_output_stream.h"
+
 using namespace std;
 
 extern const string unnamed_service;
@@ -64,12 +66,12 @@ string
 LogGen::getLogInsteadOfSending()
 {
     send_log = false;
-    stringstream output;
+    JsonOutputStream output;
     {
         cereal::JSONOutputArchive ar(output);
         log.serialize(ar);
     }
-    return output.str();
+    return output.take();
 }
 
 void
@@ -18,6 +18,14 @@
 
 #include "i_mainloop.h"
 #include "maybe_res.h"
+#include "profiling_labels.h"
+
+// The runs of the routines that share a name, since the mainloop started and since the last metric report.
+struct RoutineAccounting
+{
+    I_MainLoop::RoutineStats total;
+    I_MainLoop::RoutineStats unreported;
+};
 
 class RoutineWrapper
 {
@@ -39,7 +47,11 @@ public:
     RoutineWrapper & operator=(RoutineWrapper &&) = default;
 
     bool isPrimary() { return is_primary; }
+    I_MainLoop::RoutineType getPriority() const { return pri; }
     const std::string & getRoutineName() const { return routine_name; }
+    RoutineAccounting * getAccounting() const { return accounting; }
+    void setAccounting(RoutineAccounting *_accounting) { accounting = _accounting; }
+    ProfilingLabels::Stages & getProfilingStages() { return profiling_stages; }
     bool isActive() const;
     bool shouldRun(const I_MainLoop::RoutineType &limit) const;
     void run();
@@ -58,6 +70,10 @@ private:
     bool is_primary;
     bool is_halt = false;
     std::string routine_name;
+    // Looked up by the routine name on the first accounted run, and kept for the following runs.
+    RoutineAccounting *accounting = nullptr;
+    // The stages the routine was in when it last yielded, so its samples keep being attributed to them.
+    ProfilingLabels::Stages profiling_stages;
 };
 
 #endif // __COROUTINE_H__
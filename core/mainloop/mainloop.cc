@@ -16,9 +16,15 @@
 #include <memory>
 #include <system_error>
 #include <map>
+#include <algorithm>
+#include <queue>
 #include <sstream>
 #include <poll.h>
 #include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <time.h>
 
 #include "config.h"
 #include "coroutine.h"
@@ -26,7 +32,9 @@
 #include "debug.h"
 #include "i_time_get.h"
 #include "report/log_rest.h"
+#include "rest.h"
 #include "mainloop/mainloop_metric.h"
+#include "profiling_labels.h"
 
 using namespace std;
 
@@ -38,6 +46,63 @@ static const AlertInfo alert(AlertTeam::CORE, "mainloop i/s");
 
 class MainloopStop {};
 
+string getRoutineTypeString(I_MainLoop::RoutineType priority);
+
+class RoutineStatsReport
+{
+public:
+    RoutineStatsReport() = default;
+    RoutineStatsReport(const string &_name, const I_MainLoop::RoutineStats &_stats) : name(_name), stats(_stats) {}
+
+    void
+    save(cereal::JSONOutputArchive &ar) const
+    {
+        ar(
+            cereal::make_nvp("name", name),
+            cereal::make_nvp("priority", getRoutineTypeString(stats.priority)),
+            cereal::make_nvp("runs", stats.runs),
+            cereal::make_nvp("yields", stats.yields),
+            cereal::make_nvp("overruns", stats.overruns),
+            cereal::make_nvp("cpuTimeMicroSec", static_cast<uint64_t>(stats.cpu_time.count())),
+            cereal::make_nvp("runTimeMicroSec", static_cast<uint64_t>(stats.run_time.count())),
+            cereal::make_nvp("maxSliceMicroSec", static_cast<uint64_t>(stats.max_slice.count()))
+        );
+    }
+
+    const I_MainLoop::RoutineStats & getStats() const { return stats; }
+
+private:
+    string name;
+    I_MainLoop::RoutineStats stats;
+};
+
+// The routines that used the most CPU time come first.
+class ShowMainloopRoutines : public ServerRest
+{
+public:
+    void
+    doCall() override
+    {
+        auto i_mainloop = Singleton::Consume<I_MainLoop>::from<MainloopComponent>();
+        vector<RoutineStatsReport> report;
+        for (auto &routine_stats : i_mainloop->getRoutinesStats()) {
+            report.emplace_back(routine_stats.first, routine_stats.second);
+        }
+        stable_sort(
+            report.begin(),
+            report.end(),
+            [] (const RoutineStatsReport &first, const RoutineStatsReport &second)
+            {
+                return first.getStats().cpu_time > second.getStats().cpu_time;
+            }
+        );
+        routines = report;
+    }
+
+private:
+    S2C_PARAM(vector<RoutineStatsReport>, routines);
+};
+
 class MainloopComponent::Impl : Singleton::Provide<I_MainLoop>::From<MainloopComponent>
 {
     using RoutineMap = map<RoutineID, RoutineWrapper>;
@@ -77,8 +142,11 @@ public:
 
     void updateCurrentStress(bool is_busy) override;
 
+    RoutinesStats getRoutinesStats() const override;
+
     void yield(bool force) override;
     void yield(chrono::microseconds time) override;
+    void yieldUntilFileEvent(chrono::microseconds timeout) override;
     void stopAll() override;
     void stop() override;
     void stop(RoutineID id) override;
@@ -116,6 +184,16 @@ public:
             false
         );
         mainloop_metric.registerListener();
+        is_initialized = true;
+        is_accounting_routines = getConfigurationWithDefault<bool>(false, "Mainloop", "Routines accounting");
+        if (is_accounting_routines) startRoutinesReport();
+
+        if (Singleton::exists<I_RestApi>()) {
+            Singleton::Consume<I_RestApi>::by<MainloopComponent>()->addRestCall<ShowMainloopRoutines>(
+                RestAction::SHOW,
+                "mainloop-routines"
+            );
+        }
     }
 
     void
@@ -123,12 +201,41 @@ public:
     {
         timer = nullptr;
         fini_signal_flag = false;
+        is_initialized = false;
+        closeEpoll();
     }
 
 private:
+    class FileRoutine
+    {
+    public:
+        FileRoutine(int _fd, RoutineType _priority) : fd(_fd), priority(_priority) {}
+
+        int fd;
+        RoutineType priority;
+        bool is_waiting = false;
+        // When set, the routine is also resumed once this time passes, even if its fd has nothing to read.
+        chrono::microseconds wake_time = chrono::microseconds::zero();
+    };
+
     void reportStartupEvent();
+    bool registerFileRoutine(RoutineID id, int fd, RoutineType priority);
+    void unregisterFileRoutine(RoutineID id);
+    bool isWaitingForFileEvent(RoutineID id);
+    uint64_t waitForFileEvents(chrono::microseconds timeout);
+    void closeEpoll();
+    void sleepUntil(chrono::microseconds wake_time);
+    void wakeExpiredTimers(chrono::microseconds current_time);
+    bool isSleeping(RoutineID id);
     void stop(const RoutineMap::iterator &iter);
     uint32_t getCurrentTimeSlice(uint32_t current_stress, int idle_time_slice, int busy_time_slice);
+    void loadRoutinesAccounting();
+    void startRoutinesReport();
+    void reportRoutinesStats();
+    void accountRoutineRun(chrono::microseconds cpu_time, chrono::microseconds slice, bool is_overrun);
+    static bool isExpectedToOverrun(const RoutineWrapper &routine);
+    RoutineType getRoundLimit(RoutineType round_type, chrono::microseconds current_time);
+    void deferPriority(RoutineType priority, chrono::microseconds current_time);
     RoutineID getNextID();
 
     I_TimeGet *
@@ -159,9 +266,39 @@ private:
     chrono::seconds metric_report_interval;
     MainloopEvent mainloop_event;
     MainloopMetric mainloop_metric;
+    MainloopRoutinesMetric routines_metric;
     bool reload_configuration = false;
+    bool is_initialized = false;
+
+    // Accounting a run takes two reads of the thread CPU clock, so it is only done when it is enabled. The runs are
+    // keyed by the routine name, so the runs of recurring routines and of routines that are re-added add up.
+    bool is_accounting_routines = false;
+    bool is_reporting_routines = false;
+    map<string, RoutineAccounting> routines_accounting;
+
+    // A lower priority routine that overran its time slice while the real time routines were busy starves them, so
+    // rounds that would let routines of its priority (or lower) run, only run the higher priority routines for a while.
+    RoutineType deferred_priority = RoutineType::Offline;
+    chrono::microseconds deferred_until = chrono::microseconds::zero();
+    uint32_t starvation_stress_threshold = 50;
+    // Deferring starving routines is opt-in, a zero backoff disables it
+    chrono::microseconds starvation_backoff = chrono::microseconds::zero();
+
+    // File routines whose fd is registered in the epoll set, and are only resumed once it is readable.
+    int epoll_fd = -1;
+    map<RoutineID, FileRoutine> file_routines;
+
+    // Routines sleeping in `yield(time)` are not resumed before their wake time, which is kept in a min-heap.
+    // Heap entries are not removed when a routine is stopped, so they are only valid if they match `sleeping_routines`.
+    using Timer = pair<chrono::microseconds, RoutineID>;
+    priority_queue<Timer, vector<Timer>, greater<Timer>> timers;
+    map<RoutineID, chrono::microseconds> sleeping_routines;
+    bool routines_added = false;
 };
 
+// Longest sleep when all the routines are waiting, so a jump of the clock cannot stall the mainloop
+static const chrono::microseconds max_idle_sleep = chrono::seconds(1);
+
 static I_MainLoop::RoutineType rounds[] = {
     I_MainLoop::RoutineType::RealTime,
     I_MainLoop::RoutineType::RealTime,
@@ -181,6 +318,16 @@ static I_MainLoop::RoutineType rounds[] = {
     I_MainLoop::RoutineType::Offline,
 };
 
+static chrono::microseconds
+getThreadCpuTime()
+{
+    struct timespec cpu_time;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_time) != 0) return chrono::microseconds::zero();
+    return chrono::seconds(cpu_time.tv_sec) + chrono::duration_cast<chrono::microseconds>(
+        chrono::nanoseconds(cpu_time.tv_nsec)
+    );
+}
+
 void
 MainloopComponent::Impl::reportStartupEvent()
 {
@@ -246,6 +393,9 @@ MainloopComponent::Impl::run()
     int idle_time_slice = getConfigurationWithDefault<int>(1500, "Mainloop", "Idle routine time slice");
     int busy_time_slice = getConfigurationWithDefault<int>(100, "Mainloop", "Busy routine time slice");
     int exceed_warning_slice = getConfigurationWithDefault(100, "Mainloop", "Exceed Warning");
+    starvation_stress_threshold = getConfigurationWithDefault<uint>(50, "Mainloop", "Starvation stress threshold");
+    starvation_backoff = chrono::milliseconds(getConfigurationWithDefault<uint>(0, "Mainloop", "Starvation backoff"));
+    loadRoutinesAccounting();
 
     while (has_primary_routines) {
         mainloop_event.setStressValue(current_stress);
@@ -253,6 +403,11 @@ MainloopComponent::Impl::run()
             idle_time_slice = getConfigurationWithDefault<int>(1500, "Mainloop", "Idle routine time slice");
             busy_time_slice = getConfigurationWithDefault<int>(100, "Mainloop", "Busy routine time slice");
             exceed_warning_slice = getConfigurationWithDefault(100, "Mainloop", "Exceed Warning");
+            starvation_stress_threshold =
+                getConfigurationWithDefault<uint>(50, "Mainloop", "Starvation stress threshold");
+            starvation_backoff =
+                chrono::milliseconds(getConfigurationWithDefault<uint>(0, "Mainloop", "Starvation backoff"));
+            loadRoutinesAccounting();
             reload_configuration = false;
         }
         int time_slice_to_use = getCurrentTimeSlice(current_stress, idle_time_slice, busy_time_slice);
@@ -261,6 +416,11 @@ MainloopComponent::Impl::run()
         chrono::milliseconds large_exceeding(exceed_warning_slice);
         auto start_time = getTimer()->getMonotonicTime();
         has_primary_routines = false;
+        // Set if any routine may need to run on the next round, otherwise the mainloop may sleep until a timer expires
+        bool has_runnable_routines = false;
+        routines_added = false;
+        wakeExpiredTimers(start_time);
+        RoutineType round_limit = getRoundLimit(rounds[round], start_time);
 
         curr_iter = routines.begin();
         while (curr_iter != routines.end()) {
@@ -268,19 +428,30 @@ MainloopComponent::Impl::run()
                 break;
             }
             if (!curr_iter->second.isActive()) {
+                unregisterFileRoutine(curr_iter->first);
+                sleeping_routines.erase(curr_iter->first);
                 curr_iter = routines.erase(curr_iter);
                 continue;
             }
 
             if (curr_iter->second.isPrimary()) has_primary_routines = true;
 
-            if (curr_iter->second.shouldRun(rounds[round])) {
+            if (isSleeping(curr_iter->first) || isWaitingForFileEvent(curr_iter->first)) {
+                curr_iter++;
+                continue;
+            }
+
+            if (curr_iter->second.shouldRun(round_limit)) {
                 // Set the time upon which `hasAdditionalTime` will yield.
-                stop_time = getTimer()->getMonotonicTime() + basic_time_slice;
+                auto slice_start = getTimer()->getMonotonicTime();
+                stop_time = slice_start + basic_time_slice;
                 dbgTrace(D_MAINLOOP) <<
                     "Starting execution of corutine. Routine named: " <<
                     curr_iter->second.getRoutineName();
 
+                ProfilingLabels::setRoutine(curr_iter->second.getRoutineName().c_str());
+                ProfilingLabels::restoreStages(curr_iter->second.getProfilingStages());
+                auto cpu_start = is_accounting_routines ? getThreadCpuTime() : chrono::microseconds::zero();
                 try {
                     curr_iter->second.run();
                 } catch (const exception &e) {
@@ -297,6 +468,8 @@ MainloopComponent::Impl::run()
                         + curr_iter->second.getRoutineName()
                         + "'";
                 }
+                ProfilingLabels::saveStages(curr_iter->second.getProfilingStages());
+                ProfilingLabels::setRoutine(nullptr);
 
                 if (error != "") {
                     cerr << error << endl;
@@ -310,14 +483,27 @@ MainloopComponent::Impl::run()
                 dbgTrace(D_MAINLOOP) <<
                     "Ending execution of corutine. Routine named: " <<
                     curr_iter->second.getRoutineName();
-                if (
-                    getTimer()->getMonotonicTime() > stop_time + large_exceeding &&
-                    curr_iter->second.getRoutineName() != "Orchestration runner"
-                ) {
+                auto slice_end = getTimer()->getMonotonicTime();
+                bool is_overrun = slice_end > stop_time + large_exceeding;
+                bool is_expected_overrun = isExpectedToOverrun(curr_iter->second);
+                if (is_overrun && !is_expected_overrun) {
                     dbgWarning(D_MAINLOOP)
                         << "Routine execution exceeded run time. Routine name: "
                         << curr_iter->second.getRoutineName();
                 }
+                if (is_accounting_routines) {
+                    accountRoutineRun(getThreadCpuTime() - cpu_start, slice_end - slice_start, is_overrun);
+                }
+                if (is_overrun && !is_expected_overrun && current_stress >= starvation_stress_threshold) {
+                    deferPriority(curr_iter->second.getPriority(), slice_end);
+                }
+
+                // A routine that has just ended is also counted, so it is cleaned up without delay
+                if (!isSleeping(curr_iter->first) && !isWaitingForFileEvent(curr_iter->first)) {
+                    has_runnable_routines = true;
+                }
+            } else {
+                has_runnable_routines = true;
             }
 
             curr_iter++;
@@ -326,11 +512,25 @@ MainloopComponent::Impl::run()
 
         uint64_t signed_sleep_time = 0;
         chrono::microseconds current_time = getTimer()->getMonotonicTime();
-        if (start_time + basic_time_slice > current_time) {
-            chrono::microseconds sleep_time = start_time + basic_time_slice - current_time;
-            signed_sleep_time = sleep_time.count();
+        chrono::microseconds sleep_time = chrono::microseconds::zero();
+        if (start_time + basic_time_slice > current_time) sleep_time = start_time + basic_time_slice - current_time;
+        if (has_primary_routines && !has_runnable_routines && !routines_added && !fini_signal_flag) {
+            // All the routines are sleeping or waiting for their file, nothing to do until the closest one wakes up
+            chrono::microseconds idle_time = max_idle_sleep;
+            if (!timers.empty()) idle_time = min(idle_time, timers.top().first - current_time);
+            sleep_time = max(sleep_time, idle_time);
+        }
+        if (sleep_time > chrono::microseconds::zero()) {
+            if (epoll_fd >= 0) {
+                // Sleep until the time slice ends, or until one of the file routines has something to read.
+                signed_sleep_time = waitForFileEvents(sleep_time);
+            } else {
+                signed_sleep_time = sleep_time.count();
+                usleep(signed_sleep_time);
+            }
             sleep_count += signed_sleep_time;
-            usleep(signed_sleep_time);
+        } else if (epoll_fd >= 0) {
+            waitForFileEvents(chrono::microseconds::zero());
         }
 
         mainloop_event.setSleepTime(signed_sleep_time);
@@ -352,6 +552,9 @@ MainloopComponent::Impl::run()
     dbgInfo(D_MAINLOOP) << "Mainloop ended - stopping all routines";
     stopAll();
     routines.clear();
+    closeEpoll();
+    sleeping_routines.clear();
+    timers = decltype(timers)();
 }
 
 string
@@ -389,6 +592,7 @@ MainloopComponent::Impl::addOneTimeRoutine(
     };
 
     routines.emplace(id, RoutineWrapper(priority, func_wrapper, is_primary, routine_name));
+    routines_added = true;
     dbgDebug(D_MAINLOOP)
         << "Added new routine. Name: "
         << routine_name
@@ -444,11 +648,149 @@ MainloopComponent::Impl::addFileRoutine(
             } else {
                 if (priority == I_MainLoop::RoutineType::RealTime) updateCurrentStress(false);
             }
-            yield(true);
+            yieldUntilFileEvent(chrono::microseconds::zero());
         }
     };
 
-    return addOneTimeRoutine(priority, func_wrapper, routine_name, is_primary);
+    auto id = addOneTimeRoutine(priority, func_wrapper, routine_name, is_primary);
+    if (getConfigurationWithDefault<bool>(false, "Mainloop", "Event driven file routines")) {
+        registerFileRoutine(id, fd, priority);
+    }
+    return id;
+}
+
+bool
+MainloopComponent::Impl::registerFileRoutine(RoutineID id, int fd, RoutineType priority)
+{
+    if (epoll_fd < 0) {
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd < 0) {
+            dbgWarning(D_MAINLOOP)
+                << "Failed to create epoll instance, polling file routines. Error: "
+                << strerror(errno);
+            return false;
+        }
+    }
+
+    // The events of an fd resume a single routine, so a second routine of the same fd keeps polling it
+    auto owner = find_if(
+        file_routines.begin(),
+        file_routines.end(),
+        [fd] (const pair<const RoutineID, FileRoutine> &file_routine) { return file_routine.second.fd == fd; }
+    );
+    if (owner != file_routines.end()) {
+        auto owner_routine = routines.find(owner->first);
+        if (owner_routine != routines.end() && owner_routine->second.isActive()) {
+            dbgWarning(D_MAINLOOP)
+                << "File routine "
+                << id
+                << " will poll fd "
+                << fd
+                << ", which is already waited on by file routine "
+                << owner->first;
+            return false;
+        }
+        // The owner was stopped, but was not cleaned up by the mainloop yet
+        unregisterFileRoutine(owner->first);
+    }
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = id;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        // Regular files, for example, cannot be waited on - such routines keep polling their fd every round
+        dbgDebug(D_MAINLOOP) << "File routine " << id << " will poll fd " << fd << ". Error: " << strerror(errno);
+        return false;
+    }
+
+    file_routines.emplace(id, FileRoutine(fd, priority));
+    return true;
+}
+
+void
+MainloopComponent::Impl::unregisterFileRoutine(RoutineID id)
+{
+    auto file_routine = file_routines.find(id);
+    if (file_routine == file_routines.end()) return;
+
+    // Fails harmlessly if the fd was already closed, which also removes it from the epoll set
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, file_routine->second.fd, nullptr);
+    file_routines.erase(file_routine);
+}
+
+bool
+MainloopComponent::Impl::isWaitingForFileEvent(RoutineID id)
+{
+    if (file_routines.empty()) return false;
+
+    auto file_routine = file_routines.find(id);
+    if (file_routine == file_routines.end() || !file_routine->second.is_waiting) return false;
+
+    // An idle real time file routine releases the stress, as it would have when polling its fd
+    if (file_routine->second.priority == RoutineType::RealTime) updateCurrentStress(false);
+    return true;
+}
+
+void
+MainloopComponent::Impl::yieldUntilFileEvent(chrono::microseconds timeout)
+{
+    dbgAssert(curr_iter != routines.end()) << alert << "Calling 'yieldUntilFileEvent' without a running routine";
+    RoutineID id = curr_iter->first;
+    auto file_routine = file_routines.find(id);
+    if (file_routine == file_routines.end()) {
+        yield(true);
+        return;
+    }
+
+    file_routine->second.is_waiting = true;
+    if (timeout > chrono::microseconds::zero()) {
+        file_routine->second.wake_time = getTimer()->getMonotonicTime() + timeout;
+        timers.emplace(file_routine->second.wake_time, id);
+    }
+    yield(true);
+
+    file_routine = file_routines.find(id);
+    if (file_routine != file_routines.end()) file_routine->second.wake_time = chrono::microseconds::zero();
+}
+
+uint64_t
+MainloopComponent::Impl::waitForFileEvents(chrono::microseconds timeout)
+{
+    auto start_time = getTimer()->getMonotonicTime();
+    if (timeout > chrono::microseconds::zero()) {
+        // epoll_wait only supports a timeout in milliseconds, so the sleep itself is done by polling the epoll fd
+        struct pollfd epoll_poll;
+        epoll_poll.fd = epoll_fd;
+        epoll_poll.events = POLLIN;
+        epoll_poll.revents = 0;
+        struct timespec sleep_time;
+        sleep_time.tv_sec = timeout.count() / 1000000;
+        sleep_time.tv_nsec = (timeout.count() % 1000000) * 1000;
+        if (ppoll(&epoll_poll, 1, &sleep_time, nullptr) <= 0) return timeout.count();
+    }
+
+    static const int max_events = 64;
+    struct epoll_event events[max_events];
+    int num_events;
+    do {
+        num_events = epoll_wait(epoll_fd, events, max_events, 0);
+        for (int i = 0; i < num_events; i++) {
+            auto file_routine = file_routines.find(events[i].data.u64);
+            if (file_routine != file_routines.end()) file_routine->second.is_waiting = false;
+        }
+    } while (num_events == max_events);
+
+    if (timeout == chrono::microseconds::zero()) return 0;
+    return (getTimer()->getMonotonicTime() - start_time).count();
+}
+
+void
+MainloopComponent::Impl::closeEpoll()
+{
+    file_routines.clear();
+    if (epoll_fd < 0) return;
+    close(epoll_fd);
+    epoll_fd = -1;
 }
 
 bool
@@ -486,10 +828,45 @@ MainloopComponent::Impl::yield(chrono::microseconds time)
     }
     chrono::microseconds restart_time = getTimer()->getMonotonicTime() + time;
     while (getTimer()->getMonotonicTime() < restart_time) {
-        yield(true);
+        sleepUntil(restart_time);
     }
 }
 
+void
+MainloopComponent::Impl::sleepUntil(chrono::microseconds wake_time)
+{
+    dbgAssert(curr_iter != routines.end()) << alert << "Calling 'yield' without a running current routine";
+    RoutineID id = curr_iter->first;
+    sleeping_routines[id] = wake_time;
+    timers.emplace(wake_time, id);
+    yield(true);
+    sleeping_routines.erase(id);
+}
+
+void
+MainloopComponent::Impl::wakeExpiredTimers(chrono::microseconds current_time)
+{
+    while (!timers.empty() && timers.top().first <= current_time) {
+        auto sleeping_routine = sleeping_routines.find(timers.top().second);
+        if (sleeping_routine != sleeping_routines.end() && sleeping_routine->second == timers.top().first) {
+            sleeping_routines.erase(sleeping_routine);
+        }
+        if (!file_routines.empty()) {
+            auto file_routine = file_routines.find(timers.top().second);
+            if (file_routine != file_routines.end() && file_routine->second.wake_time == timers.top().first) {
+                file_routine->second.is_waiting = false;
+            }
+        }
+        timers.pop();
+    }
+}
+
+bool
+MainloopComponent::Impl::isSleeping(RoutineID id)
+{
+    return !sleeping_routines.empty() && sleeping_routines.find(id) != sleeping_routines.end();
+}
+
 void
 MainloopComponent::Impl::stopAll()
 {
@@ -600,6 +977,124 @@ MainloopComponent::Impl::updateCurrentStress(bool is_busy)
     }
 }
 
+I_MainLoop::RoutinesStats
+MainloopComponent::Impl::getRoutinesStats() const
+{
+    RoutinesStats stats;
+    for (const auto &accounting : routines_accounting) {
+        stats.emplace(accounting.first, accounting.second.total);
+    }
+    return stats;
+}
+
+void
+MainloopComponent::Impl::loadRoutinesAccounting()
+{
+    is_accounting_routines = getConfigurationWithDefault<bool>(false, "Mainloop", "Routines accounting");
+    if (is_accounting_routines && is_initialized) startRoutinesReport();
+}
+
+void
+MainloopComponent::Impl::startRoutinesReport()
+{
+    if (is_reporting_routines) return;
+    is_reporting_routines = true;
+
+    routines_metric.init(
+        "Mainloop routines data",
+        ReportIS::AudienceTeam::AGENT_CORE,
+        ReportIS::IssuingEngine::AGENT_CORE,
+        metric_report_interval,
+        false
+    );
+    routines_metric.registerListener();
+    addRecurringRoutine(
+        RoutineType::System,
+        metric_report_interval,
+        [this] () { reportRoutinesStats(); },
+        "Mainloop routines accounting report",
+        false
+    );
+}
+
+void
+MainloopComponent::Impl::reportRoutinesStats()
+{
+    RoutinesStats unreported;
+    for (auto &accounting : routines_accounting) {
+        if (accounting.second.unreported.runs == 0) continue;
+        unreported.emplace(accounting.first, accounting.second.unreported);
+        accounting.second.unreported = RoutineStats();
+    }
+    if (!unreported.empty()) MainloopRoutinesEvent(unreported).notify();
+}
+
+static void
+addRoutineRun(
+    I_MainLoop::RoutineStats &stats,
+    I_MainLoop::RoutineType priority,
+    chrono::microseconds cpu_time,
+    chrono::microseconds slice,
+    bool has_yielded,
+    bool is_overrun)
+{
+    stats.priority = priority;
+    stats.runs++;
+    if (has_yielded) stats.yields++;
+    if (is_overrun) stats.overruns++;
+    stats.cpu_time += cpu_time;
+    stats.run_time += slice;
+    stats.max_slice = max(stats.max_slice, slice);
+}
+
+void
+MainloopComponent::Impl::accountRoutineRun(chrono::microseconds cpu_time, chrono::microseconds slice, bool is_overrun)
+{
+    RoutineAccounting *accounting = curr_iter->second.getAccounting();
+    if (accounting == nullptr) {
+        accounting = &routines_accounting[curr_iter->second.getRoutineName()];
+        curr_iter->second.setAccounting(accounting);
+    }
+
+    auto priority = curr_iter->second.getPriority();
+    bool has_yielded = curr_iter->second.isActive();
+    addRoutineRun(accounting->total, priority, cpu_time, slice, has_yielded, is_overrun);
+    addRoutineRun(accounting->unreported, priority, cpu_time, slice, has_yielded, is_overrun);
+}
+
+// Routines that are known to run for long, so their overruns are neither warned about nor deferred.
+bool
+MainloopComponent::Impl::isExpectedToOverrun(const RoutineWrapper &routine)
+{
+    return routine.getRoutineName() == "Orchestration runner";
+}
+
+I_MainLoop::RoutineType
+MainloopComponent::Impl::getRoundLimit(RoutineType round_type, chrono::microseconds current_time)
+{
+    if (current_time >= deferred_until || round_type < deferred_priority) return round_type;
+    return static_cast<RoutineType>(static_cast<int>(deferred_priority) - 1);
+}
+
+void
+MainloopComponent::Impl::deferPriority(RoutineType priority, chrono::microseconds current_time)
+{
+    if (priority == RoutineType::RealTime || starvation_backoff == chrono::microseconds::zero()) return;
+
+    if (current_time >= deferred_until || priority < deferred_priority) {
+        dbgInfo(D_MAINLOOP)
+            << "Routine "
+            << curr_iter->second.getRoutineName()
+            << " starves the real time routines, deferring the "
+            << getRoutineTypeString(priority)
+            << " routines for "
+            << chrono::duration_cast<chrono::milliseconds>(starvation_backoff).count()
+            << " msec";
+        deferred_priority = priority;
+    }
+    deferred_until = current_time + starvation_backoff;
+}
+
 uint32_t
 MainloopComponent::Impl::getCurrentTimeSlice(uint32_t current_stress, int idle_time_slice, int busy_time_slice)
 {
@@ -624,5 +1119,9 @@ MainloopComponent::preload()
     registerExpectedConfiguration<int>("Mainloop", "Busy routine time slice");
     registerExpectedConfiguration<uint>("Mainloop", "metric reporting interval");
     registerExpectedConfiguration<uint>("Mainloop", "Exceed Warning");
+    registerExpectedConfiguration<bool>("Mainloop", "Event driven file routines");
+    registerExpectedConfiguration<uint>("Mainloop", "Starvation stress threshold");
+    registerExpectedConfiguration<uint>("Mainloop", "Starvation backoff");
+    registerExpectedConfiguration<bool>("Mainloop", "Routines accounting");
     registerConfigLoadCb([&] () { pimpl->reloadConfigurationCb(); });
 }
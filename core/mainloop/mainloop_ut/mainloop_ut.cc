@@ -11,6 +11,7 @@
 #include "mock/mock_environment.h"
 #include "mock/mock_messaging.h"
 #include "mock/mock_agent_details.h"
+#include "mock/mock_rest_api.h"
 #include "scope_exit.h"
 #include "metric/all_metric_event.h"
 #include "debug.h"
@@ -376,6 +377,196 @@ TEST_F(MainloopTest, call_recurring_cb)
     EXPECT_EQ(3, num_called);
 }
 
+TEST_F(MainloopTest, sleeping_routine_wakes_on_time)
+{
+    microseconds time(0);
+    EXPECT_CALL(mock_time, getMonotonicTime()).WillRepeatedly(InvokeWithoutArgs([&time] () { return time; }));
+
+    int num_called = 0;
+    mainloop->addRecurringRoutine(
+        I_MainLoop::RoutineType::RealTime,
+        chrono::microseconds(1000),
+        [&num_called] () { num_called++; },
+        "sleeping_routine_wakes_on_time",
+        false
+    );
+
+    auto driver = [&num_called, &time, this] () {
+        for (int i = 0; i < 5; i++) mainloop->yield(true);
+        EXPECT_EQ(1, num_called);
+
+        time += microseconds(999);
+        for (int i = 0; i < 5; i++) mainloop->yield(true);
+        EXPECT_EQ(1, num_called);
+
+        time += microseconds(1);
+        mainloop->yield(true);
+        EXPECT_EQ(2, num_called);
+
+        time += microseconds(5000);
+        mainloop->yield(true);
+        EXPECT_EQ(3, num_called);
+    };
+    mainloop->addOneTimeRoutine(I_MainLoop::RoutineType::RealTime, driver, "sleeping_routine_wakes_on_time driver", true);
+
+    mainloop->run();
+    EXPECT_EQ(3, num_called);
+}
+
+TEST_F(MainloopTest, routine_stats_disabled_by_default)
+{
+    mainloop->addOneTimeRoutine(I_MainLoop::RoutineType::RealTime, [] () {}, "not accounted", true);
+    mainloop->run();
+
+    EXPECT_TRUE(mainloop->getRoutinesStats().empty());
+}
+
+TEST_F(MainloopTest, routine_stats)
+{
+    setConfiguration<bool>(true, string("Mainloop"), string("Routines accounting"));
+    microseconds time(0);
+    EXPECT_CALL(mock_time, getMonotonicTime()).WillRepeatedly(InvokeWithoutArgs([&time] () { return time; }));
+
+    auto cb = [&time, this] () {
+        for (int i = 1; i <= 3; i++) {
+            time += milliseconds(i);
+            mainloop->yield(true);
+        }
+    };
+    mainloop->addOneTimeRoutine(I_MainLoop::RoutineType::Timer, cb, "routine_stats test", true);
+    mainloop->run();
+
+    auto stats = mainloop->getRoutinesStats();
+    ASSERT_EQ(stats.size(), 1u);
+    auto &routine_stats = stats["routine_stats test"];
+    EXPECT_EQ(routine_stats.priority, I_MainLoop::RoutineType::Timer);
+    EXPECT_EQ(routine_stats.runs, 4u);
+    EXPECT_EQ(routine_stats.yields, 3u);
+    EXPECT_EQ(routine_stats.overruns, 0u);
+    EXPECT_EQ(routine_stats.run_time, milliseconds(6));
+    EXPECT_EQ(routine_stats.max_slice, milliseconds(3));
+}
+
+TEST_F(MainloopTest, routine_stats_reported_per_interval)
+{
+    setConfiguration<bool>(true, string("Mainloop"), string("Routines accounting"));
+    setConfiguration<uint>(1, string("Mainloop"), string("metric reporting interval"));
+    EXPECT_CALL(mock_msg, sendAsyncMessage(_, "/api/v1/agents/events", _, _, _, _)).Times(AnyNumber());
+    mainloop_comp.init();
+
+    microseconds time(0);
+    EXPECT_CALL(mock_time, getMonotonicTime()).WillRepeatedly(InvokeWithoutArgs([&time] () { return time; }));
+    auto cb = [&time, this] () {
+        for (int i = 0; i < 40; i++) {
+            time += milliseconds(100);
+            mainloop->yield(true);
+        }
+    };
+    mainloop->addOneTimeRoutine(I_MainLoop::RoutineType::RealTime, cb, "reported routine", true);
+    mainloop->run();
+
+    EXPECT_EQ(mainloop->getRoutinesStats()["reported routine"].runs, 41u);
+
+    // The runs are aggregated by the mainloop, and only handed to the metric once every reporting interval
+    AllMetricEvent all_mt_event;
+    all_mt_event.setReset(false);
+    EXPECT_THAT(
+        all_mt_event.performNamedQuery(),
+        Contains(
+            Pair(
+                "Mainloop routines data",
+                AllOf(HasSubstr("\"mainloopRoutineRuns\": {"), HasSubstr("\"reported routine\": 100000"))
+            )
+        )
+    );
+}
+
+TEST_F(MainloopTest, show_routines_rest)
+{
+    setConfiguration<bool>(true, string("Mainloop"), string("Routines accounting"));
+    StrictMock<MockRestApi> mock_rest;
+    unique_ptr<ServerRest> show_rest;
+    EXPECT_CALL(mock_rest, mockRestCall(RestAction::SHOW, "mainloop-routines", _)).WillOnce(
+        WithArg<2>(Invoke([&show_rest] (const unique_ptr<RestInit> &p) { show_rest = p->getRest(); return true; }))
+    );
+    mainloop_comp.init();
+
+    mainloop->addOneTimeRoutine(I_MainLoop::RoutineType::RealTime, [] () {}, "show_routines_rest test", true);
+    mainloop->run();
+
+    stringstream request("{}");
+    auto response = show_rest->performRestCall(request);
+    ASSERT_TRUE(response.ok());
+    EXPECT_THAT(response.unpack(), HasSubstr("\"name\": \"show_routines_rest test\""));
+    EXPECT_THAT(response.unpack(), HasSubstr("\"priority\": \"RealTime\""));
+    EXPECT_THAT(response.unpack(), HasSubstr("\"runs\": 1"));
+}
+
+class StarvationTest : public MainloopTest
+{
+public:
+    // Runs an offline routine that overruns every run, next to a real time routine that keeps the stress high.
+    // Returns the number of runs of the offline routine.
+    int
+    runStarvingRoutine(const string &name)
+    {
+        setConfiguration<bool>(true, string("Mainloop"), string("Routines accounting"));
+
+        microseconds time(0);
+        EXPECT_CALL(mock_time, getMonotonicTime()).WillRepeatedly(InvokeWithoutArgs([&time] () { return time; }));
+
+        int offline_runs = 0;
+        auto offline_cb = [&offline_runs, &time, this] () {
+            while (true) {
+                offline_runs++;
+                time += milliseconds(200);
+                mainloop->yield(true);
+            }
+        };
+        mainloop->addOneTimeRoutine(I_MainLoop::RoutineType::Offline, offline_cb, name, false);
+
+        auto real_time_cb = [&time, this] () {
+            for (int i = 0; i < 64; i++) {
+                for (int stress = 0; stress < 10; stress++) mainloop->updateCurrentStress(true);
+                time += milliseconds(1);
+                mainloop->yield(true);
+            }
+        };
+        mainloop->addOneTimeRoutine(I_MainLoop::RoutineType::RealTime, real_time_cb, "real time routine", true);
+
+        mainloop->run();
+
+        EXPECT_EQ(mainloop->getRoutinesStats()[name].overruns, static_cast<uint64_t>(offline_runs));
+        return offline_runs;
+    }
+};
+
+class StarvationBackoffTest : public StarvationTest, public WithParamInterface<uint>
+{
+};
+
+TEST_P(StarvationBackoffTest, defer_starving_offline_routine)
+{
+    setConfiguration<uint>(GetParam(), string("Mainloop"), string("Starvation backoff"));
+
+    // Without a backoff the offline routine runs on every offline round, once every 16 rounds.
+    EXPECT_EQ(runStarvingRoutine("starving routine"), GetParam() == 0 ? 4 : 1);
+}
+
+INSTANTIATE_TEST_CASE_P(backoff, StarvationBackoffTest, Values(0, 500));
+
+TEST_F(StarvationTest, no_deferral_by_default)
+{
+    EXPECT_EQ(runStarvingRoutine("starving routine"), 4);
+}
+
+TEST_F(StarvationTest, orchestration_runner_is_never_deferred)
+{
+    setConfiguration<uint>(500, string("Mainloop"), string("Starvation backoff"));
+
+    EXPECT_EQ(runStarvingRoutine("Orchestration runner"), 4);
+}
+
 TEST_F(MainloopTest, call_file_cb)
 {
     CPTestTempfile file({ "a", "b", "c" });
@@ -395,6 +586,136 @@ TEST_F(MainloopTest, call_file_cb)
     EXPECT_EQ(4, num_called);
 }
 
+TEST_F(MainloopTest, event_driven_file_cb)
+{
+    setConfiguration<bool>(true, string("Mainloop"), string("Event driven file routines"));
+
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    auto close_pipe = make_scope_exit([&fds] () { close(fds[0]); close(fds[1]); });
+
+    int num_called = 0;
+    auto read_cb = [&num_called, &fds, this] () {
+        char ch;
+        ASSERT_EQ(1, read(fds[0], &ch, 1));
+        if (ch == 'c') mainloop->stop();
+        num_called++;
+    };
+    mainloop->addFileRoutine(I_MainLoop::RoutineType::RealTime, fds[0], read_cb, "event_driven_file_cb test", true);
+
+    auto write_cb = [&num_called, &fds, this] () {
+        for (char ch : string("abc")) {
+            // Nothing was written yet, so the file routine should not have been called
+            for (int i = 0; i < 3; i++) mainloop->yield(true);
+            EXPECT_EQ(ch - 'a', num_called);
+            ASSERT_EQ(1, write(fds[1], &ch, 1));
+        }
+    };
+    mainloop->addOneTimeRoutine(I_MainLoop::RoutineType::Offline, write_cb, "event_driven_file_cb writer", false);
+
+    mainloop->run();
+    EXPECT_EQ(2, num_called);
+}
+
+TEST_F(MainloopTest, event_driven_file_shared_fd)
+{
+    setConfiguration<bool>(true, string("Mainloop"), string("Event driven file routines"));
+
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    auto close_pipe = make_scope_exit([&fds] () { close(fds[0]); close(fds[1]); });
+
+    // The data is never read, so both routines should keep being called, and neither may take the other's events
+    int first_called = 0;
+    int second_called = 0;
+    auto first_cb = [&first_called] () { first_called++; };
+    auto second_cb = [&second_called] () { second_called++; };
+    mainloop->addFileRoutine(I_MainLoop::RoutineType::RealTime, fds[0], first_cb, "shared fd first", false);
+    mainloop->addFileRoutine(I_MainLoop::RoutineType::RealTime, fds[0], second_cb, "shared fd second", false);
+
+    auto write_cb = [&fds, this] () {
+        ASSERT_EQ(1, write(fds[1], "a", 1));
+        for (int i = 0; i < 5; i++) mainloop->yield(true);
+        mainloop->stopAll();
+    };
+    mainloop->addOneTimeRoutine(I_MainLoop::RoutineType::RealTime, write_cb, "event_driven_file_shared_fd writer", true);
+
+    mainloop->run();
+    EXPECT_LT(0, first_called);
+    EXPECT_LT(0, second_called);
+}
+
+TEST_F(MainloopTest, event_driven_file_wait_times_out)
+{
+    setConfiguration<bool>(true, string("Mainloop"), string("Event driven file routines"));
+    microseconds time(0);
+    EXPECT_CALL(mock_time, getMonotonicTime()).WillRepeatedly(InvokeWithoutArgs([&time] () { return time; }));
+
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    auto close_pipe = make_scope_exit([&fds] () { close(fds[0]); close(fds[1]); });
+
+    bool is_waiting = false;
+    bool has_resumed = false;
+    auto read_cb = [&is_waiting, &has_resumed, &fds, this] () {
+        char ch;
+        ASSERT_EQ(1, read(fds[0], &ch, 1));
+        is_waiting = true;
+        mainloop->yieldUntilFileEvent(microseconds(1000));
+        has_resumed = true;
+    };
+    auto file_routine = mainloop->addFileRoutine(
+        I_MainLoop::RoutineType::RealTime,
+        fds[0],
+        read_cb,
+        "event_driven_file_wait_times_out test",
+        false
+    );
+
+    auto driver = [&is_waiting, &has_resumed, &time, &fds, file_routine, this] () {
+        ASSERT_EQ(1, write(fds[1], "a", 1));
+        while (!is_waiting) mainloop->yield(true);
+
+        // Nothing more was written, so the routine only resumes once its timeout passes
+        time += microseconds(999);
+        for (int i = 0; i < 5; i++) mainloop->yield(true);
+        EXPECT_FALSE(has_resumed);
+
+        time += microseconds(1);
+        for (int i = 0; i < 2; i++) mainloop->yield(true);
+        EXPECT_TRUE(has_resumed);
+
+        mainloop->stop(file_routine);
+    };
+    mainloop->addOneTimeRoutine(I_MainLoop::RoutineType::RealTime, driver, "event_driven_file_wait driver", true);
+
+    mainloop->run();
+    EXPECT_TRUE(has_resumed);
+}
+
+TEST_F(MainloopTest, event_driven_regular_file_cb)
+{
+    setConfiguration<bool>(true, string("Mainloop"), string("Event driven file routines"));
+
+    CPTestTempfile file({ "a", "b", "c" });
+    int fd = open(file.fname.c_str(), O_RDONLY);
+    ASSERT_LT(0, fd);
+    auto close_file = make_scope_exit([fd] () { close(fd); });
+
+    // Regular files cannot be added to an epoll set, so the routine keeps being polled on every round
+    int num_called = 0;
+    auto cb = [&num_called, fd, this] () {
+        char ch;
+        ASSERT_EQ(1, read(fd, &ch, 1));
+        if (ch == 'c') mainloop->stop();
+        num_called++;
+    };
+    mainloop->addFileRoutine(I_MainLoop::RoutineType::RealTime, fd, cb, "event_driven_regular_file_cb test", true);
+
+    mainloop->run();
+    EXPECT_EQ(4, num_called);
+}
+
 TEST_F(MainloopTest, stop_while_routines_are_running)
 {
     int num_called = 0;
@@ -18,6 +18,7 @@
 #include "report/log_rest.h"
 #include "config.h"
 #include "report_messaging.h"
+#include "json_output_stream.h"
 
 #include <fstream>
 #include <sstream>
@@ -44,12 +45,18 @@ MetricCalc::getAiopsMetrics() const
     float value = getValue();
     if (isnan(value)) return {};
 
+    return { getAiopsData(value) };
+}
+
+AiopsMetricData
+MetricCalc::getAiopsData(float value) const
+{
     string name = getMetricDotName() != "" ? getMetricDotName() : getMetricName();
     string units = getMetircUnits();
     string description = getMetircDescription();
     string type = getMetricType() == MetricType::GAUGE ? "Gauge" : "Counter";
 
-    return { AiopsMetricData(name, type, units, description, getBasicLabels(), value) };
+    return AiopsMetricData(name, type, units, description, getBasicLabels(), value);
 }
 
 string
@@ -82,6 +89,12 @@ MetricCalc::getPrometheusMetrics() const
     float value = getValue();
     if (isnan(value)) return {};
 
+    return { getPrometheusData(value) };
+}
+
+PrometheusData
+MetricCalc::getPrometheusData(float value) const
+{
     PrometheusData res;
 
     res.name = getMetricDotName() != "" ? getMetricDotName() : getMetricName();
@@ -102,7 +115,7 @@ MetricCalc::getPrometheusMetrics() const
     value_str << value;
     res.value = value_str.str();
 
-    return {res};
+    return res;
 }
 
 map<string, string>
@@ -213,16 +226,16 @@ GenericMetric::getReportInterval() const
 string
 GenericMetric::generateReport() const
 {
-    stringstream ss;
+    JsonOutputStream json_stream;
     {
-        cereal::JSONOutputArchive ar(ss);
+        cereal::JSONOutputArchive ar(json_stream);
         ar(cereal::make_nvp("Metric", metric_name));
         ar(cereal::make_nvp("Reporting interval", report_interval.count()));
         for(auto &calc : calcs) {
             calc->save(ar);
         }
     }
-    return ss.str();
+    return json_stream.take();
 }
 
 void
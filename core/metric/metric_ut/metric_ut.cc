@@ -32,6 +32,67 @@ TEST(BaseMetric, generic_metadata)
     EXPECT_EQ(test.getMetircDescription(), "CPU utilization percentage");
 }
 
+TEST(BaseMetric, histogram_percentiles)
+{
+    Histogram<uint64_t> first_half(nullptr, "latency");
+    Histogram<uint64_t> second_half(nullptr, "latency");
+    for (uint64_t value = 1; value <= 1000; value++) {
+        first_half.report(value);
+        second_half.report(value + 1000);
+    }
+
+    EXPECT_EQ(first_half.getCount(), 1000u);
+    EXPECT_EQ(first_half.getMin(), 1u);
+    EXPECT_EQ(first_half.getMax(), 1000u);
+    EXPECT_DOUBLE_EQ(first_half.getAverage(), 500.5);
+    EXPECT_EQ(first_half.getPercentile(0), 1u);
+    EXPECT_EQ(first_half.getPercentile(100), 1000u);
+    // Percentiles are rounded up to the top of their bucket, which is at most 1/16 above the bucket's bottom
+    EXPECT_GE(first_half.getPercentile(50), 500u);
+    EXPECT_LE(first_half.getPercentile(50), 500u + 500u / 16);
+    EXPECT_GE(first_half.getPercentile(99), 990u);
+    EXPECT_LE(first_half.getPercentile(99), 1000u);
+
+    first_half.merge(second_half);
+    EXPECT_EQ(first_half.getCount(), 2000u);
+    EXPECT_EQ(first_half.getMin(), 1u);
+    EXPECT_EQ(first_half.getMax(), 2000u);
+    EXPECT_GE(first_half.getPercentile(50), 1000u);
+    EXPECT_LE(first_half.getPercentile(50), 1000u + 1000u / 16);
+
+    first_half.reset();
+    EXPECT_EQ(first_half.getCount(), 0u);
+    EXPECT_EQ(first_half.getPercentile(99), 0u);
+
+    Histogram<int> small_values(nullptr, "small");
+    small_values.report(-5);
+    small_values.report(3);
+    EXPECT_EQ(small_values.getMin(), 0);
+    EXPECT_EQ(small_values.getPercentile(100), 3);
+}
+
+class LatencyEvent : public Event<LatencyEvent>
+{
+public:
+    LatencyEvent(uint64_t _latency) : latency(_latency) {}
+
+    uint64_t getLatency() const { return latency; }
+
+private:
+    uint64_t latency;
+};
+
+class LatencyMetric
+        :
+    public GenericMetric,
+    public Listener<LatencyEvent>
+{
+public:
+    void upon(const LatencyEvent &event) override { latency.report(event.getLatency()); }
+
+    Histogram<uint64_t> latency{this, "latency"};
+};
+
 class CPUEvent : public Event<CPUEvent>
 {
 public:
@@ -613,6 +674,59 @@ TEST_F(MetricTest, printPromeathus)
     EXPECT_EQ(message_body, res);
 }
 
+TEST_F(MetricTest, histogramReport)
+{
+    conf.preload();
+
+    stringstream configuration;
+    configuration << "{\"agentSettings\":[{\"key\":\"prometheus\",\"id\":\"id1\",\"value\":\"true\"}]}\n";
+    EXPECT_TRUE(Singleton::Consume<Config::I_Config>::from(conf)->loadConfiguration(configuration));
+
+    LatencyMetric latency_mt;
+    latency_mt.init(
+        "Latency",
+        ReportIS::AudienceTeam::AGENT_CORE,
+        ReportIS::IssuingEngine::AGENT_CORE,
+        seconds(5),
+        true
+    );
+    latency_mt.turnOffStream(GenericMetric::Stream::FOG);
+    latency_mt.turnOffStream(GenericMetric::Stream::DEBUG);
+    latency_mt.turnOnStream(GenericMetric::Stream::PROMETHEUS);
+    latency_mt.registerListener();
+
+    for (uint64_t latency = 1; latency <= 100; latency++) LatencyEvent(latency).notify();
+
+    string report =
+        "    \"latency\": {\n"
+        "        \"count\": 100,\n"
+        "        \"min\": 1,\n"
+        "        \"max\": 100,\n"
+        "        \"p50\": 51,\n"
+        "        \"p90\": 91,\n"
+        "        \"p99\": 99,\n"
+        "        \"p999\": 100\n"
+        "    }\n";
+    EXPECT_THAT(latency_mt.generateReport(), HasSubstr(report));
+
+    string message_body;
+    EXPECT_CALL(messaging_mock, sendSyncMessage(_, "/add-metrics", _, _, _))
+        .WillOnce(DoAll(SaveArg<2>(&message_body), Return(HTTPResponse())));
+    routine();
+
+    string p99 =
+        "        {\n"
+        "            \"metric_name\": \"latency\",\n"
+        "            \"metric_type\": \"gauge\",\n"
+        "            \"metric_description\": \"\",\n"
+        "            \"labels\": \"{agent=\\\"Unknown\\\",id=\\\"87\\\",quantile=\\\"0.99\\\"}\",\n"
+        "            \"value\": \"99\"\n"
+        "        }";
+    EXPECT_THAT(message_body, HasSubstr(p99));
+    EXPECT_THAT(message_body, HasSubstr("quantile=\\\"0.999\\\""));
+    EXPECT_EQ(latency_mt.latency.getCount(), 0u);
+}
+
 TEST_F(MetricTest, printPromeathusMultiMap)
 {
     conf.preload();
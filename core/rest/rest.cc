@@ -13,6 +13,8 @@
 
 #include "rest.h"
 
+#include "json_output_stream.h"
+
 using namespace std;
 
 ostream &
@@ -51,12 +53,12 @@ ServerRest::performRestCall(istream &in)
             throw JsonError(string("JSON parsing failed: ") + e.what());
         }
         doCall();
-        stringstream out;
+        JsonOutputStream out;
         {
             cereal::JSONOutputArchive out_ar(out);
             save(out_ar);
         }
-        return out.str();
+        return out.take();
     } catch (const JsonError &e) {
         return genError(e.getMsg());
     }
@@ -108,12 +110,12 @@ Maybe<string>
 ClientRest::genJson() const
 {
     try {
-        stringstream out;
+        JsonOutputStream out;
         {
             cereal::JSONOutputArchive out_ar(out);
             save(out_ar);
         }
-        return out.str();
+        return out.take();
     } catch (const JsonError &e) {
         return genError(e.getMsg());
     }
@@ -14,22 +14,38 @@
 #include "rest_conn.h"
 
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
 #include <sstream>
 #include <sys/socket.h>
 
+#include "rest_server.h"
+#include "config.h"
 #include "debug.h"
 
 using namespace std;
 
 USE_DEBUG_FLAG(D_API);
 
+static const size_t read_chunk_size = 16 * 1024;
+static const chrono::seconds read_timeout = chrono::seconds(10);
+static const size_t max_line_size = 64 * 1024;
+static const uint default_max_body_size = 64 * 1024 * 1024;
+
 RestConn::RestConn(int _fd, I_MainLoop *_mainloop, const I_RestInvoke *_invoke, bool is_external)
         :
         fd(_fd),
         mainloop(_mainloop),
         invoke(_invoke),
         is_external_ip(is_external)
-{}
+{
+    // Reads never block the mainloop - a connection that has no data yet yields until it arrives
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        dbgWarning(D_API) << "Failed to set socket " << fd << " as non-blocking: " << strerror(errno);
+    }
+}
 
 RestConn::~RestConn()
 {
@@ -47,69 +63,118 @@ compareStringCaseInsensitive(const string &s1, const string &s2)
     return true;
 }
 
-void
-RestConn::parseConn() const
+static string
+trimLine(const string &line, size_t start = 0, size_t end = string::npos)
 {
-    char ch;
+    static const char *whitespaces = " \t\r\n";
+    start = line.find_first_not_of(whitespaces, start);
+    if (start == string::npos || start >= end) return "";
+    end = line.find_last_not_of(whitespaces, end == string::npos ? end : end - 1);
+    return line.substr(start, end - start + 1);
+}
 
-    if (recv(fd, &ch, sizeof(char), MSG_PEEK) != sizeof(char)) {
+void
+RestConn::parseConn()
+{
+    if (buffer_offset == buffer.size() && !readMore()) {
         dbgDebug(D_API) << "Socket " << fd << " ended";
         stop();
     }
 
-    string line = readLine();
-    stringstream os;
-    os.str(line);
-    string method;
-    os >> method;
-
-    if (method!="POST" && method!="GET") {
-        dbgWarning(D_API) << "Unsupported REST method: " << method;
-        sendResponse("405 Method Not Allowed", "Method " + method + " is not supported");
-        return;
-    }
+    // The client may send its next requests without waiting for the responses, so every complete request that was
+    // already read is handled before going back to wait on the socket
+    do {
+        parseRequest();
+        while (buffer_offset < buffer.size() && (buffer[buffer_offset] == '\r' || buffer[buffer_offset] == '\n')) {
+            buffer_offset++;
+        }
+    } while (buffer_offset < buffer.size());
+}
 
-    string uri;
-    os >> uri;
-    string identifier = uri.substr(uri.find_first_of('/') + 1);
-    dbgDebug(D_API) << "Call identifier: " << identifier;
+void
+RestConn::parseRequest()
+{
+    buffer.erase(0, buffer_offset);
+    buffer_offset = 0;
 
-    uint len = 0;
+    string line;
+    // Empty lines between requests are ignored
+    do {
+        line = readLine();
+    } while (trimLine(line).empty());
+    size_t method_end = line.find(' ');
+    string method = trimLine(line, 0, method_end);
+    size_t uri_start = line.find_first_not_of(' ', method_end);
+    size_t uri_end = uri_start == string::npos ? string::npos : line.find(' ', uri_start);
+    string uri = uri_start == string::npos ? "" : trimLine(line, uri_start, uri_end);
+    string version = uri_end == string::npos ? "" : trimLine(line, uri_end);
+    keep_alive = version != "HTTP/1.0";
+
+    size_t len = 0;
+    bool is_chunked = false;
     while (true) {
         line = readLine();
         if (line.size() < 3) break;
 
-        os.str(line);
-        string head, data;
-        os >> head >> data;
-        if (compareStringCaseInsensitive(head, "Content-Length:")) {
+        size_t separator = line.find(':');
+        if (separator == string::npos) continue;
+        string head = trimLine(line, 0, separator);
+        string data = trimLine(line, separator + 1);
+        if (compareStringCaseInsensitive(head, "Content-Length")) {
             try {
-                len = stoi(data, nullptr);
+                len = stoul(data, nullptr);
             } catch (...) {
             }
+        } else if (compareStringCaseInsensitive(head, "Transfer-Encoding")) {
+            is_chunked = compareStringCaseInsensitive(data, "chunked");
+        } else if (compareStringCaseInsensitive(head, "Connection")) {
+            if (compareStringCaseInsensitive(data, "close")) keep_alive = false;
+            if (compareStringCaseInsensitive(data, "keep-alive")) keep_alive = true;
         }
     }
 
-    dbgDebug(D_API) << "Message length: " << len;
-
-    if (method=="POST" && len==0) {
-        dbgWarning(D_API) << "No length was found - could be chunked, but we still do not support that";
-        sendResponse("411 Length Required", "");
+    if (method!="POST" && method!="GET") {
+        dbgWarning(D_API) << "Unsupported REST method: " << method;
+        keep_alive = false;
+        sendResponse("405 Method Not Allowed", "Method " + method + " is not supported");
         stop();
     }
 
-    if (method=="GET" && invoke->isGetCall(identifier)) {
-        return sendResponse("200 OK", invoke->invokeGet(identifier), false);
+    string identifier = uri.substr(uri.find_first_of('/') + 1);
+    dbgDebug(D_API) << "Call identifier: " << identifier;
+    dbgDebug(D_API) << "Message length: " << (is_chunked ? "chunked" : to_string(len));
+
+    if (method=="POST" && len==0 && !is_chunked) {
+        dbgWarning(D_API) << "No length was found in a POST request";
+        keep_alive = false;
+        sendResponse("411 Length Required", "");
+        stop();
     }
 
-    if (is_external_ip) {
-        dbgWarning(D_API) << "External IP tried to POST";
+    // External peers may only make GET calls, so nothing they send is read before that is verified
+    bool is_get_call = method=="GET" && invoke->isGetCall(identifier);
+    if (is_external_ip && (!is_get_call || is_chunked || len > 0)) {
+        dbgWarning(D_API) << "External IP tried to " << (is_get_call ? "send a body in a GET request" : "POST");
+        keep_alive = false;
         sendResponse("500 Internal Server Error", "", false);
         stop();
     }
 
+    size_t max_body_size = getConfigurationWithDefault<uint>(
+        default_max_body_size,
+        "connection",
+        "Nano service API Max Body Size"
+    );
+    if (len > max_body_size) rejectLargeBody(len, max_body_size);
+
     stringstream body;
-    body.str(readSize(len));
+    body.str(is_chunked ? readChunkedBody(max_body_size) : readSize(len));
+
+    if (is_get_call) {
+        sendResponse("200 OK", invoke->invokeGet(identifier), false);
+        if (!keep_alive) stop();
+        return;
+    }
 
     dbgTrace(D_API) << "Message content: " << body.str();
 
@@ -120,6 +185,7 @@ RestConn::parseConn() const
     } else {
         sendResponse("500 Internal Server Error", res.getErr());
     }
+    if (!keep_alive) stop();
 }
 
 void
@@ -129,59 +195,151 @@ RestConn::stop() const
     mainloop->stop();
 }
 
+bool
+RestConn::readMore()
+{
+    I_TimeGet *timer = nullptr;
+    chrono::microseconds timeout;
+    size_t data_size = buffer.size();
+    while (true) {
+        buffer.resize(data_size + read_chunk_size);
+        ssize_t res = recv(fd, &buffer[data_size], read_chunk_size, 0);
+        buffer.resize(data_size + (res > 0 ? res : 0));
+        if (res > 0) return true;
+        if (res == 0) return false;
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            dbgDebug(D_API) << "Failed to read from socket " << fd << ": " << strerror(errno);
+            return false;
+        }
+
+        if (timer == nullptr) {
+            timer = Singleton::Consume<I_TimeGet>::by<RestServer>();
+            timeout = timer->getMonotonicTime() + read_timeout;
+        }
+        chrono::microseconds current_time = timer->getMonotonicTime();
+        if (current_time >= timeout) {
+            dbgWarning(D_API) << "Timed out waiting for data on socket " << fd;
+            keep_alive = false;
+            sendResponse("598 Network read timeout error", "");
+            stop();
+        }
+        mainloop->yieldUntilFileEvent(timeout - current_time);
+    }
+}
+
 string
-RestConn::readLine() const
+RestConn::readLine()
 {
-    string res;
-    char ch = 0;
-    while (ch != '\n') {
-        if (read(fd, &ch, sizeof(char)) != sizeof(char)) {
+    size_t searched = buffer_offset;
+    size_t line_end;
+    while ((line_end = buffer.find('\n', searched)) == string::npos) {
+        searched = buffer.size();
+        if (searched - buffer_offset > max_line_size) {
+            dbgWarning(D_API) << "Line exceeds the limit of " << max_line_size << " bytes on socket " << fd;
+            keep_alive = false;
+            sendResponse("431 Request Header Fields Too Large", "");
+            stop();
+        }
+        if (!readMore()) {
             dbgWarning(D_API) << "Failed to read from socket " << fd;
+            keep_alive = false;
             sendResponse("598 Network read timeout error", "");
             stop();
         }
-        res += ch;
     }
 
+    string res = buffer.substr(buffer_offset, line_end + 1 - buffer_offset);
+    buffer_offset = line_end + 1;
     return res;
 }
 
 string
-RestConn::readSize(int len) const
+RestConn::readSize(size_t len)
 {
-    string res;
-    for (int i = 0; i < len; i++) {
-        char ch;
-        if (read(fd, &ch, sizeof(char)) != sizeof(char)) {
+    while (buffer.size() - buffer_offset < len) {
+        if (!readMore()) {
             dbgWarning(D_API) << "Failed to read from socket " << fd;
+            keep_alive = false;
             sendResponse("598 Network read timeout error", "");
             stop();
         }
-        res += ch;
     }
+
+    string res = buffer.substr(buffer_offset, len);
+    buffer_offset += len;
     return res;
 }
 
 void
-RestConn::sendResponse(const string &status, const string &body, bool add_newline) const
+RestConn::rejectLargeBody(size_t size, size_t max_size)
 {
-    stringstream stream;
-    stream <<
-        "HTTP/1.1 " << status << "\r\n" <<
-        "Content-Type: application/json\r\n" <<
-        "Content-Length: " << (body.size() + (add_newline ? 2 : 0)) << "\r\n" <<
-        "\r\n" <<
-        body;
-    if (add_newline) stream << "\r\n";
-
+    dbgWarning(D_API) << "Request body of at least " << size << " bytes exceeds the limit of " << max_size << " bytes";
+    keep_alive = false;
+    sendResponse("413 Payload Too Large", "");
+    stop();
+}
 
-    string res = stream.str();
-    while (res.size() > 0 ) {
-        auto written = write(fd, res.c_str(), res.size());
-        if (written < 1) {
-            dbgWarning(D_API) << "Failed to write to socket " << fd;
+string
+RestConn::readChunkedBody(size_t max_size)
+{
+    string res;
+    while (true) {
+        string line = readLine();
+        size_t chunk_size = 0;
+        try {
+            chunk_size = stoul(line, nullptr, 16);
+        } catch (...) {
+            dbgWarning(D_API) << "Illegal chunk size line: " << trimLine(line);
+            keep_alive = false;
+            sendResponse("400 Bad Request", "");
             stop();
         }
-        res = res.substr(written);
+
+        if (chunk_size == 0) break;
+        if (chunk_size > max_size - res.size()) rejectLargeBody(res.size() + chunk_size, max_size);
+        res += readSize(chunk_size);
+        readLine();
+    }
+
+    // Skip the trailer headers, up to the empty line ending the message
+    while (readLine().size() >= 3) {}
+    return res;
+}
+
+void
+RestConn::sendResponse(const string &status, const string &body, bool add_newline) const
+{
+    string res =
+        "HTTP/1.1 " + status + "\r\n" +
+        "Content-Type: application/json\r\n" +
+        "Content-Length: " + to_string(body.size() + (add_newline ? 2 : 0)) + "\r\n" +
+        (keep_alive ? "" : "Connection: close\r\n") +
+        "\r\n" +
+        body;
+    if (add_newline) res += "\r\n";
+
+    I_TimeGet *timer = nullptr;
+    chrono::microseconds timeout;
+    size_t offset = 0;
+    while (offset < res.size()) {
+        auto written = write(fd, res.data() + offset, res.size() - offset);
+        if (written > 0) {
+            offset += written;
+            continue;
+        }
+        if (written < 0 && errno == EINTR) continue;
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (timer == nullptr) {
+                timer = Singleton::Consume<I_TimeGet>::by<RestServer>();
+                timeout = timer->getMonotonicTime() + read_timeout;
+            }
+            if (timer->getMonotonicTime() <= timeout) {
+                mainloop->yield(true);
+                continue;
+            }
+        }
+        dbgWarning(D_API) << "Failed to write to socket " << fd;
+        stop();
     }
 }
@@ -24,18 +24,26 @@ public:
     RestConn(int _fd, I_MainLoop *_mainloop, const I_RestInvoke *_invoke, bool is_external = false);
     ~RestConn();
 
-    void parseConn() const;
+    void parseConn();
 
 private:
+    void parseRequest();
     void stop() const;
-    std::string readLine() const;
-    std::string readSize(int len) const;
+    bool readMore();
+    std::string readLine();
+    std::string readSize(size_t len);
+    std::string readChunkedBody(size_t max_size);
+    void rejectLargeBody(size_t size, size_t max_size);
     void sendResponse(const std::string &status, const std::string &body, bool add_newline = true) const;
 
     int fd;
     I_MainLoop *mainloop;
     const I_RestInvoke *invoke;
     bool is_external_ip = false;
+    bool keep_alive = true;
+    // Data read from the socket, of which everything before `buffer_offset` was already parsed.
+    std::string buffer;
+    size_t buffer_offset = 0;
 };
 
 #endif // __REST_CONN_H__
@@ -263,7 +263,7 @@ RestServer::Impl::startNewConnection() const
     mainloop->addFileRoutine(
         I_MainLoop::RoutineType::Offline,
         new_socket,
-        [conn] () { conn.parseConn(); },
+        [conn] () mutable { conn.parseConn(); },
         "REST server connection handler"
     );
 }
@@ -364,4 +364,5 @@ RestServer::preload()
     registerExpectedConfiguration<uint>("connection", "Nano service API Port Range start");
     registerExpectedConfiguration<uint>("connection", "Nano service API Port Range end");
     registerExpectedConfiguration<bool>("connection", "Nano service API Allow Get From External IP");
+    registerExpectedConfiguration<uint>("connection", "Nano service API Max Body Size");
 }
@@ -57,6 +57,27 @@ static const string config_json =
         "    }\n"
         "}\n";
 
+static const string config_json_small_body =
+        "{\n"
+        "    \"connection\": {\n"
+        "        \"Nano service API Port Primary\": [\n"
+        "            {\n"
+        "                \"value\": 9777\n"
+        "            }\n"
+        "        ],\n"
+        "        \"Nano service API Port Alternative\": [\n"
+        "            {\n"
+        "                \"value\": 9778\n"
+        "            }\n"
+        "        ],\n"
+        "        \"Nano service API Max Body Size\": [\n"
+        "            {\n"
+        "                \"value\": 16\n"
+        "            }\n"
+        "        ]\n"
+        "    }\n"
+        "}\n";
+
 USE_DEBUG_FLAG(D_API);
 USE_DEBUG_FLAG(D_MAINLOOP);
 
@@ -235,6 +256,172 @@ TEST_F(RestConfigTest, basic_flow)
     );
 }
 
+TEST_F(RestConfigTest, keep_alive_chunked_flow)
+{
+    env.preload();
+    Singleton::Consume<I_Environment>::from(env)->registerValue<string>("Base Executable Name", "tmp_test_file");
+
+    config.preload();
+    config.init();
+
+    rest_server.init();
+    time_proxy.init();
+    mainloop_comp.init();
+
+    auto i_rest = Singleton::Consume<I_RestApi>::from(rest_server);
+    ASSERT_TRUE(i_rest->addRestCall<TestServer>(RestAction::ADD, "test"));
+    ASSERT_TRUE(i_rest->addGetCall("stuff", [] () { return string("blabla"); }));
+    TestServer::g_num = 0;
+
+    int file_descriptor = socket(AF_INET, SOCK_STREAM, 0);
+    EXPECT_NE(file_descriptor, -1);
+
+    struct sockaddr_in sa;
+    sa.sin_family = AF_INET;
+    sa.sin_addr.s_addr = inet_addr("127.0.0.1");
+
+    EXPECT_CALL(messaging, sendSyncMessage(_, _, _, _, _))
+        .WillRepeatedly(Return(HTTPResponse(HTTPStatusCode::HTTP_OK, "")));
+
+    auto mainloop = Singleton::Consume<I_MainLoop>::from(mainloop_comp);
+    string response;
+    I_MainLoop::Routine stop_routine = [&] () {
+        while (i_rest->getListeningPort() == 0) mainloop->yield(true);
+        sa.sin_port = htons(i_rest->getListeningPort());
+        EXPECT_EQ(connect(file_descriptor, (struct sockaddr*)&sa, sizeof(struct sockaddr)), 0)
+            << "file_descriptor Error: "
+            << strerror(errno);
+
+        // Both requests are sent on the same connection, the first one split between two writes
+        string msg1 =
+            "POST /add-test HTTP/1.1\r\n"
+            "Transfer-Encoding: chunked\r\n"
+            "\r\n"
+            "6\r\n{\"num\"\r\n";
+        string msg2 =
+            "4\r\n: 7}\r\n"
+            "0\r\n"
+            "\r\n"
+            "GET /stuff HTTP/1.1\r\n\r\n";
+        EXPECT_EQ(write(file_descriptor, msg1.data(), msg1.size()), static_cast<int>(msg1.size()));
+        for (int i = 0; i < 20; i++) mainloop->yield(true);
+        EXPECT_EQ(write(file_descriptor, msg2.data(), msg2.size()), static_cast<int>(msg2.size()));
+
+        struct pollfd s_poll;
+        s_poll.fd = file_descriptor;
+        s_poll.events = POLLIN;
+        s_poll.revents = 0;
+        while (response.find("blabla") == string::npos) {
+            if (poll(&s_poll, 1, 0) <= 0) {
+                mainloop->yield(true);
+                continue;
+            }
+            char buf[1000];
+            int len = read(file_descriptor, buf, sizeof(buf));
+            ASSERT_GT(len, 0);
+            response.append(buf, len);
+        }
+
+        mainloop->stopAll();
+    };
+    mainloop->addOneTimeRoutine(
+        I_MainLoop::RoutineType::RealTime,
+        stop_routine,
+        "RestConfigTest-keep_alive_chunked_flow stop routine",
+        true
+    );
+    mainloop->run();
+
+    EXPECT_EQ(TestServer::g_num, 7);
+    EXPECT_THAT(response, StartsWith("HTTP/1.1 200 OK\r\n"));
+    EXPECT_THAT(
+        response,
+        EndsWith("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: 6\r\n\r\nblabla")
+    );
+    close(file_descriptor);
+}
+
+TEST_F(RestConfigTest, body_size_limit)
+{
+    env.preload();
+    Singleton::Consume<I_Environment>::from(env)->registerValue<string>("Base Executable Name", "tmp_test_file");
+
+    istringstream ss(config_json_small_body);
+    Singleton::Consume<Config::I_Config>::from(config)->loadConfiguration(ss);
+
+    config.preload();
+    config.init();
+
+    rest_server.init();
+    time_proxy.init();
+    mainloop_comp.init();
+
+    auto i_rest = Singleton::Consume<I_RestApi>::from(rest_server);
+    ASSERT_TRUE(i_rest->addRestCall<TestServer>(RestAction::ADD, "test"));
+    TestServer::g_num = 0;
+
+    EXPECT_CALL(messaging, sendSyncMessage(_, _, _, _, _))
+        .WillRepeatedly(Return(HTTPResponse(HTTPStatusCode::HTTP_OK, "")));
+
+    auto mainloop = Singleton::Consume<I_MainLoop>::from(mainloop_comp);
+    vector<string> responses;
+    I_MainLoop::Routine stop_routine = [&] () {
+        while (i_rest->getListeningPort() == 0) mainloop->yield(true);
+
+        struct sockaddr_in sa;
+        sa.sin_family = AF_INET;
+        sa.sin_addr.s_addr = inet_addr("127.0.0.1");
+        sa.sin_port = htons(i_rest->getListeningPort());
+
+        // The chunk sizes only add up to more than the limit, while the content length exceeds it right away
+        vector<string> requests = {
+            "POST /add-test HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n8\r\n{\"num\": \r\nffffffff\r\n",
+            "POST /add-test HTTP/1.1\r\nContent-Length: 4294967296\r\n\r\n{\"num\": 5}"
+        };
+        for (const string &request : requests) {
+            int file_descriptor = socket(AF_INET, SOCK_STREAM, 0);
+            EXPECT_NE(file_descriptor, -1);
+            EXPECT_EQ(connect(file_descriptor, (struct sockaddr*)&sa, sizeof(struct sockaddr)), 0)
+                << "file_descriptor Error: "
+                << strerror(errno);
+            EXPECT_EQ(write(file_descriptor, request.data(), request.size()), static_cast<int>(request.size()));
+
+            // The server closes the connection after rejecting the request
+            struct pollfd s_poll;
+            s_poll.fd = file_descriptor;
+            s_poll.events = POLLIN;
+            s_poll.revents = 0;
+            string response;
+            while (true) {
+                if (poll(&s_poll, 1, 0) <= 0) {
+                    mainloop->yield(true);
+                    continue;
+                }
+                char buf[1000];
+                int len = read(file_descriptor, buf, sizeof(buf));
+                if (len <= 0) break;
+                response.append(buf, len);
+            }
+            responses.push_back(response);
+            close(file_descriptor);
+        }
+
+        mainloop->stopAll();
+    };
+    mainloop->addOneTimeRoutine(
+        I_MainLoop::RoutineType::RealTime,
+        stop_routine,
+        "RestConfigTest-body_size_limit stop routine",
+        true
+    );
+    mainloop->run();
+
+    EXPECT_EQ(TestServer::g_num, 0);
+    ASSERT_EQ(responses.size(), 2u);
+    EXPECT_THAT(responses[0], StartsWith("HTTP/1.1 413 Payload Too Large\r\n"));
+    EXPECT_THAT(responses[1], StartsWith("HTTP/1.1 413 Payload Too Large\r\n"));
+}
+
 string
 getLocalIPAddress() {
     char hostname[1024];
@@ -0,0 +1,383 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sampling_profiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <signal.h>
+#include <sstream>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "debug.h"
+#include "rest.h"
+
+using namespace std;
+
+USE_DEBUG_FLAG(D_MONITORING);
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+// Samples taken while no routine runs, i.e. in the scheduling of the mainloop itself.
+static const char *mainloop_label = "Mainloop";
+
+static const int max_routine_name_length = 64;
+static const uint num_of_slots = 1024;
+static const uint max_probes = 32;
+
+// The samples are counted per distinct routine and stack of stages, in a fixed table that the signal handler fills
+// without allocating. Samples that find no free slot are only counted as dropped.
+struct SampleSlot
+{
+    bool is_used;
+    uint64_t hash;
+    char routine[max_routine_name_length];
+    const char *stages[ProfilingLabels::max_stages];
+    int num_of_stages;
+    uint64_t count;
+};
+
+static SampleSlot sample_slots[num_of_slots];
+static uint64_t total_samples = 0;
+static uint64_t dropped_samples = 0;
+
+static bool
+isSameSample(const SampleSlot &slot, const char *routine, const ProfilingLabels::State &labels, int num_of_stages)
+{
+    if (slot.num_of_stages != num_of_stages) return false;
+    for (int stage = 0; stage < num_of_stages; stage++) {
+        if (slot.stages[stage] != labels.stages[stage]) return false;
+    }
+    for (int pos = 0; pos < max_routine_name_length - 1; pos++) {
+        if (slot.routine[pos] != routine[pos]) return false;
+        if (routine[pos] == '\0') return true;
+    }
+    return true;
+}
+
+// Runs in a signal handler - must only use async-signal-safe operations.
+static void
+takeSample(int)
+{
+    const ProfilingLabels::State &labels = ProfilingLabels::get();
+    const char *routine = labels.routine != nullptr ? labels.routine : mainloop_label;
+    int num_of_stages = labels.num_of_stages;
+    if (num_of_stages > ProfilingLabels::max_stages) num_of_stages = ProfilingLabels::max_stages;
+
+    uint64_t hash = 14695981039346656037ull;
+    for (int pos = 0; pos < max_routine_name_length - 1 && routine[pos] != '\0'; pos++) {
+        hash = (hash ^ static_cast<unsigned char>(routine[pos])) * 1099511628211ull;
+    }
+    for (int stage = 0; stage < num_of_stages; stage++) {
+        hash = (hash ^ reinterpret_cast<uintptr_t>(labels.stages[stage])) * 1099511628211ull;
+    }
+
+    total_samples++;
+    for (uint probe = 0; probe < max_probes; probe++) {
+        SampleSlot &slot = sample_slots[(hash + probe) % num_of_slots];
+        if (!slot.is_used) {
+            slot.hash = hash;
+            int pos = 0;
+            for (; pos < max_routine_name_length - 1 && routine[pos] != '\0'; pos++) slot.routine[pos] = routine[pos];
+            slot.routine[pos] = '\0';
+            for (int stage = 0; stage < num_of_stages; stage++) slot.stages[stage] = labels.stages[stage];
+            slot.num_of_stages = num_of_stages;
+            slot.count = 1;
+            slot.is_used = true;
+            return;
+        }
+        if (slot.hash == hash && isSameSample(slot, routine, labels, num_of_stages)) {
+            slot.count++;
+            return;
+        }
+    }
+    dropped_samples++;
+}
+
+// The signal is only delivered to the mainloop thread, so blocking it there keeps the handler from running while the
+// samples are read or reset.
+class BlockSampling
+{
+public:
+    BlockSampling()
+    {
+        sigset_t profiling_signal;
+        sigemptyset(&profiling_signal);
+        sigaddset(&profiling_signal, SIGPROF);
+        pthread_sigmask(SIG_BLOCK, &profiling_signal, &original_mask);
+    }
+
+    ~BlockSampling() { pthread_sigmask(SIG_SETMASK, &original_mask, nullptr); }
+
+private:
+    sigset_t original_mask;
+};
+
+class SetSamplingProfiler : public ServerRest
+{
+public:
+    void
+    doCall() override
+    {
+        auto i_profiler = Singleton::Consume<I_SamplingProfiler>::from<SamplingProfiler>();
+        if (enable.get()) {
+            auto res = i_profiler->start(
+                chrono::milliseconds(interval_msec.isActive() ? interval_msec.get() : 10),
+                chrono::seconds(duration_sec.isActive() ? duration_sec.get() : 0)
+            );
+            if (!res.ok()) error = res.getErr();
+        } else {
+            i_profiler->stop();
+        }
+        active = i_profiler->isActive();
+    }
+
+private:
+    C2S_PARAM(bool, enable);
+    C2S_OPTIONAL_PARAM(uint, interval_msec);
+    C2S_OPTIONAL_PARAM(uint, duration_sec);
+    S2C_PARAM(bool, active);
+    S2C_OPTIONAL_PARAM(string, error);
+};
+
+class ShowSamplingProfiler : public ServerRest
+{
+public:
+    void
+    doCall() override
+    {
+        auto i_profiler = Singleton::Consume<I_SamplingProfiler>::from<SamplingProfiler>();
+        bool is_folded = format.isActive() && format.get() == "folded";
+        report = i_profiler->getReport(
+            is_folded ? I_SamplingProfiler::ReportFormat::FOLDED : I_SamplingProfiler::ReportFormat::TOP,
+            top.isActive() ? top.get() : 20
+        );
+        active = i_profiler->isActive();
+    }
+
+private:
+    C2S_OPTIONAL_PARAM(string, format);
+    C2S_OPTIONAL_PARAM(uint, top);
+    S2C_PARAM(bool, active);
+    S2C_PARAM(string, report);
+};
+
+class SamplingProfiler::Impl : Singleton::Provide<I_SamplingProfiler>::From<SamplingProfiler>
+{
+public:
+    void
+    init()
+    {
+        auto rest = Singleton::Consume<I_RestApi>::by<SamplingProfiler>();
+        rest->addRestCall<SetSamplingProfiler>(RestAction::SET, "sampling-profiler");
+        rest->addRestCall<ShowSamplingProfiler>(RestAction::SHOW, "sampling-profiler");
+    }
+
+    void fini() { stop(); }
+
+    Maybe<void>
+    start(chrono::milliseconds _interval, chrono::seconds duration) override
+    {
+        if (_interval.count() <= 0) return genError("The sampling interval must be positive");
+        stop();
+        resetSamples();
+
+        // The timer counts the CPU time of the calling thread - the REST calls run on the mainloop thread.
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = takeSample;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGPROF, &action, &original_action) != 0) {
+            return genError(string("Failed to set the sampling signal handler: ") + strerror(errno));
+        }
+
+        struct sigevent event;
+        memset(&event, 0, sizeof(event));
+        event.sigev_notify = SIGEV_THREAD_ID;
+        event.sigev_signo = SIGPROF;
+        event.sigev_notify_thread_id = syscall(SYS_gettid);
+        if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &timer) != 0) {
+            string err = strerror(errno);
+            sigaction(SIGPROF, &original_action, nullptr);
+            return genError("Failed to create the sampling timer: " + err);
+        }
+
+        struct itimerspec timer_spec;
+        timer_spec.it_interval.tv_sec = _interval.count() / 1000;
+        timer_spec.it_interval.tv_nsec = (_interval.count() % 1000) * 1000000;
+        timer_spec.it_value = timer_spec.it_interval;
+        if (timer_settime(timer, 0, &timer_spec, nullptr) != 0) {
+            string err = strerror(errno);
+            timer_delete(timer);
+            sigaction(SIGPROF, &original_action, nullptr);
+            return genError("Failed to start the sampling timer: " + err);
+        }
+
+        interval = _interval;
+        is_active = true;
+        dbgInfo(D_MONITORING) << "Sampling profiler started. Interval: " << interval.count() << " msec";
+
+        if (duration.count() > 0) {
+            auto mainloop = Singleton::Consume<I_MainLoop>::by<SamplingProfiler>();
+            duration_routine = mainloop->addOneTimeRoutine(
+                I_MainLoop::RoutineType::Offline,
+                [this, mainloop, duration] ()
+                {
+                    mainloop->yield(duration);
+                    duration_routine = 0;
+                    stopSampling();
+                },
+                "Sampling profiler duration"
+            );
+        }
+
+        return Maybe<void>();
+    }
+
+    void
+    stop() override
+    {
+        if (duration_routine != 0) {
+            auto mainloop = Singleton::Consume<I_MainLoop>::by<SamplingProfiler>();
+            if (mainloop->doesRoutineExist(duration_routine)) mainloop->stop(duration_routine);
+            duration_routine = 0;
+        }
+        stopSampling();
+    }
+
+    bool isActive() const override { return is_active; }
+
+    string
+    getReport(ReportFormat format, uint top) const override
+    {
+        uint64_t samples, dropped;
+        map<string, uint64_t> stacks;
+        {
+            BlockSampling block_sampling;
+            samples = total_samples;
+            dropped = dropped_samples;
+            for (const SampleSlot &slot : sample_slots) {
+                if (slot.is_used) stacks[getFoldedStack(slot)] += slot.count;
+            }
+        }
+
+        vector<pair<string, uint64_t>> sorted_stacks(stacks.begin(), stacks.end());
+        sortByCount(sorted_stacks);
+
+        stringstream report;
+        if (format == ReportFormat::FOLDED) {
+            for (const auto &stack : sorted_stacks) report << stack.first << " " << stack.second << "\n";
+            return report.str();
+        }
+
+        map<string, uint64_t> routines;
+        for (const auto &stack : sorted_stacks) routines[stack.first.substr(0, stack.first.find(';'))] += stack.second;
+        vector<pair<string, uint64_t>> sorted_routines(routines.begin(), routines.end());
+        sortByCount(sorted_routines);
+
+        report
+            << "Samples: " << samples
+            << " (interval: " << interval.count() << " msec of mainloop CPU time, dropped: " << dropped << ")\n"
+            << "Routines:\n";
+        printTop(report, sorted_routines, samples, top);
+        report << "Routines and stages:\n";
+        printTop(report, sorted_stacks, samples, top);
+        return report.str();
+    }
+
+private:
+    void
+    stopSampling()
+    {
+        if (!is_active) return;
+        // A signal of the timer may still be pending once it is deleted, and the original action may be to terminate,
+        // so the signal is ignored (which also discards the pending one) until the timer is gone.
+        struct sigaction ignore_action;
+        memset(&ignore_action, 0, sizeof(ignore_action));
+        ignore_action.sa_handler = SIG_IGN;
+        sigemptyset(&ignore_action.sa_mask);
+        sigaction(SIGPROF, &ignore_action, nullptr);
+        timer_delete(timer);
+        sigaction(SIGPROF, &original_action, nullptr);
+        is_active = false;
+        dbgInfo(D_MONITORING) << "Sampling profiler stopped. Samples: " << total_samples;
+    }
+
+    static void
+    resetSamples()
+    {
+        BlockSampling block_sampling;
+        memset(sample_slots, 0, sizeof(sample_slots));
+        total_samples = 0;
+        dropped_samples = 0;
+    }
+
+    // "routine;stage;inner stage", the format of flame graph tools, which use ';' to separate the frames.
+    static string
+    getFoldedStack(const SampleSlot &slot)
+    {
+        string stack = slot.routine;
+        replace(stack.begin(), stack.end(), ';', ',');
+        for (int stage = 0; stage < slot.num_of_stages; stage++) {
+            stack += ";";
+            stack += slot.stages[stage];
+        }
+        return stack;
+    }
+
+    static void
+    sortByCount(vector<pair<string, uint64_t>> &entries)
+    {
+        sort(
+            entries.begin(),
+            entries.end(),
+            [] (const pair<string, uint64_t> &first, const pair<string, uint64_t> &second)
+            {
+                return first.second > second.second;
+            }
+        );
+    }
+
+    static void
+    printTop(ostream &report, const vector<pair<string, uint64_t>> &entries, uint64_t samples, uint top)
+    {
+        for (uint index = 0; index < entries.size() && index < top; index++) {
+            double percent = samples > 0 ? 100.0 * entries[index].second / samples : 0;
+            report
+                << "  " << fixed << setprecision(1) << setw(5) << percent << "%"
+                << "  " << setw(8) << entries[index].second
+                << "  " << entries[index].first << "\n";
+        }
+    }
+
+    bool is_active = false;
+    chrono::milliseconds interval{0};
+    timer_t timer;
+    struct sigaction original_action;
+    I_MainLoop::RoutineID duration_routine = 0;
+};
+
+SamplingProfiler::SamplingProfiler() : Component("SamplingProfiler"), pimpl(make_unique<Impl>()) {}
+
+SamplingProfiler::~SamplingProfiler() {}
+
+void SamplingProfiler::init() { pimpl->init(); }
+void SamplingProfiler::fini() { pimpl->fini(); }
@@ -0,0 +1,172 @@
+#include "sampling_profiler.h"
+
+#include <sstream>
+
+#include "cptest.h"
+#include "mock/mock_mainloop.h"
+#include "mock/mock_rest_api.h"
+
+using namespace std;
+using namespace testing;
+using namespace chrono;
+
+class SamplingProfilerTest : public Test
+{
+public:
+    SamplingProfilerTest()
+    {
+        EXPECT_CALL(mock_rest, mockRestCall(RestAction::SET, "sampling-profiler", _)).WillOnce(
+            WithArg<2>(Invoke([this] (const unique_ptr<RestInit> &p) { set_rest = p->getRest(); return true; }))
+        );
+        EXPECT_CALL(mock_rest, mockRestCall(RestAction::SHOW, "sampling-profiler", _)).WillOnce(
+            WithArg<2>(Invoke([this] (const unique_ptr<RestInit> &p) { show_rest = p->getRest(); return true; }))
+        );
+        profiler.init();
+        i_profiler = Singleton::Consume<I_SamplingProfiler>::from(profiler);
+    }
+
+    ~SamplingProfilerTest()
+    {
+        profiler.fini();
+        ProfilingLabels::setRoutine(nullptr);
+    }
+
+    // Keeps the CPU busy, so the thread CPU time timer expires.
+    void
+    burnCpu(milliseconds time)
+    {
+        auto end = steady_clock::now() + time;
+        volatile uint64_t counter = 0;
+        while (steady_clock::now() < end) counter++;
+    }
+
+    StrictMock<MockMainLoop> mock_mainloop;
+    StrictMock<MockRestApi> mock_rest;
+    SamplingProfiler profiler;
+    I_SamplingProfiler *i_profiler;
+    unique_ptr<ServerRest> set_rest;
+    unique_ptr<ServerRest> show_rest;
+};
+
+TEST_F(SamplingProfilerTest, inactiveByDefault)
+{
+    EXPECT_FALSE(i_profiler->isActive());
+    EXPECT_EQ(i_profiler->getReport(I_SamplingProfiler::ReportFormat::FOLDED, 10), "");
+}
+
+TEST_F(SamplingProfilerTest, attributesSamplesToRoutinesAndStages)
+{
+    EXPECT_TRUE(i_profiler->start(milliseconds(1), seconds(0)).ok());
+    EXPECT_TRUE(i_profiler->isActive());
+
+    ProfilingLabels::setRoutine("Inspection routine");
+    {
+        ProfilingStage outer("waap.requestBody");
+        {
+            ProfilingStage inner("waap.deepParser");
+            burnCpu(milliseconds(40));
+        }
+        burnCpu(milliseconds(20));
+    }
+    ProfilingLabels::setRoutine("Sync routine");
+    burnCpu(milliseconds(20));
+    ProfilingLabels::setRoutine(nullptr);
+
+    i_profiler->stop();
+    EXPECT_FALSE(i_profiler->isActive());
+
+    string folded = i_profiler->getReport(I_SamplingProfiler::ReportFormat::FOLDED, 10);
+    EXPECT_THAT(folded, HasSubstr("Inspection routine;waap.requestBody;waap.deepParser "));
+    EXPECT_THAT(folded, HasSubstr("Inspection routine;waap.requestBody "));
+    EXPECT_THAT(folded, HasSubstr("Sync routine "));
+
+    string top = i_profiler->getReport(I_SamplingProfiler::ReportFormat::TOP, 10);
+    EXPECT_THAT(top, HasSubstr("Routines:\n"));
+    EXPECT_THAT(top, HasSubstr("  Inspection routine\n"));
+    EXPECT_THAT(top, HasSubstr("  Inspection routine;waap.requestBody;waap.deepParser\n"));
+}
+
+TEST_F(SamplingProfilerTest, keepsTheStagesOfAYieldingRoutine)
+{
+    EXPECT_TRUE(i_profiler->start(milliseconds(1), seconds(0)).ok());
+
+    ProfilingLabels::Stages inspection_stages;
+    ProfilingLabels::setRoutine("Inspection routine");
+    ProfilingLabels::restoreStages(inspection_stages);
+    {
+        ProfilingStage stage("waap.requestBody");
+
+        // The routine yields in the middle of the stage, and another routine runs
+        ProfilingLabels::saveStages(inspection_stages);
+        ProfilingLabels::setRoutine("Sync routine");
+        burnCpu(milliseconds(20));
+
+        ProfilingLabels::setRoutine("Inspection routine");
+        ProfilingLabels::restoreStages(inspection_stages);
+        burnCpu(milliseconds(20));
+    }
+    ProfilingLabels::setRoutine(nullptr);
+    i_profiler->stop();
+
+    string folded = i_profiler->getReport(I_SamplingProfiler::ReportFormat::FOLDED, 10);
+    EXPECT_THAT(folded, HasSubstr("Inspection routine;waap.requestBody "));
+    EXPECT_THAT(folded, HasSubstr("Sync routine "));
+    EXPECT_THAT(folded, Not(HasSubstr("Sync routine;")));
+}
+
+TEST_F(SamplingProfilerTest, restartResetsSamples)
+{
+    EXPECT_TRUE(i_profiler->start(milliseconds(1), seconds(0)).ok());
+    ProfilingLabels::setRoutine("First routine");
+    burnCpu(milliseconds(20));
+
+    EXPECT_TRUE(i_profiler->start(milliseconds(1), seconds(0)).ok());
+    ProfilingLabels::setRoutine("Second routine");
+    burnCpu(milliseconds(20));
+    i_profiler->stop();
+
+    string folded = i_profiler->getReport(I_SamplingProfiler::ReportFormat::FOLDED, 10);
+    EXPECT_THAT(folded, Not(HasSubstr("First routine")));
+    EXPECT_THAT(folded, HasSubstr("Second routine"));
+}
+
+TEST_F(SamplingProfilerTest, rejectsZeroInterval)
+{
+    EXPECT_FALSE(i_profiler->start(milliseconds(0), seconds(0)).ok());
+    EXPECT_FALSE(i_profiler->isActive());
+}
+
+TEST_F(SamplingProfilerTest, stopsAfterDuration)
+{
+    I_MainLoop::Routine duration_routine;
+    EXPECT_CALL(mock_mainloop, addOneTimeRoutine(I_MainLoop::RoutineType::Offline, _, "Sampling profiler duration", _))
+        .WillOnce(DoAll(SaveArg<1>(&duration_routine), Return(1)));
+    EXPECT_CALL(mock_mainloop, yield(A<microseconds>())).WillOnce(Return());
+
+    EXPECT_TRUE(i_profiler->start(milliseconds(5), seconds(30)).ok());
+    EXPECT_TRUE(i_profiler->isActive());
+
+    duration_routine();
+    EXPECT_FALSE(i_profiler->isActive());
+}
+
+TEST_F(SamplingProfilerTest, restCalls)
+{
+    stringstream start_request("{ \"enable\": true, \"interval_msec\": 1 }");
+    auto start_response = set_rest->performRestCall(start_request);
+    ASSERT_TRUE(start_response.ok());
+    EXPECT_THAT(start_response.unpack(), HasSubstr("\"active\": true"));
+
+    ProfilingLabels::setRoutine("REST routine");
+    burnCpu(milliseconds(20));
+
+    stringstream stop_request("{ \"enable\": false }");
+    auto stop_response = set_rest->performRestCall(stop_request);
+    ASSERT_TRUE(stop_response.ok());
+    EXPECT_THAT(stop_response.unpack(), HasSubstr("\"active\": false"));
+
+    stringstream show_request("{ \"format\": \"folded\" }");
+    auto show_response = show_rest->performRestCall(show_request);
+    ASSERT_TRUE(show_response.ok());
+    EXPECT_THAT(show_response.unpack(), HasSubstr("REST routine "));
+}
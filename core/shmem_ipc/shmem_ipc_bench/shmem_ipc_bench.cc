@@ -0,0 +1,161 @@
+#include <atomic>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "benchmark/benchmark.h"
+#include "shmem_ipc.h"
+#include "nginx_attachment_common.h"
+
+extern "C" {
+#include "../shared_ipc_debug.h"
+}
+
+using namespace std;
+
+static const string shmem_name = "shmem_bench";
+
+static void
+ignoreDebug(int, const char *, const char *, int, const char *, ...)
+{
+}
+
+// The two sides of the IPC, as the service (the owner) and the attachment open them.
+class IpcPair
+{
+public:
+    IpcPair(uint16_t num_of_elements)
+    {
+        owner = initIpc(shmem_name.c_str(), getuid(), getgid(), 1, num_of_elements, ignoreDebug);
+        user = initIpc(shmem_name.c_str(), getuid(), getgid(), 0, num_of_elements, ignoreDebug);
+    }
+
+    ~IpcPair()
+    {
+        // Destroying a queue restores the default debug function, which prints to the standard output.
+        if (user != nullptr) destroyIpc(user, 0);
+        debug_int = ignoreDebug;
+        if (owner != nullptr) destroyIpc(owner, 1);
+        debug_int = ignoreDebug;
+    }
+
+    bool ok() const { return owner != nullptr && user != nullptr; }
+
+    SharedMemoryIPC *owner = nullptr;
+    SharedMemoryIPC *user = nullptr;
+};
+
+static int
+sendChunk(SharedMemoryIPC *ipc, uint32_t session_id, const string &data)
+{
+    ngx_http_cp_request_data_t request_data;
+    request_data.data_type = static_cast<uint16_t>(ngx_http_chunk_type_e::REQUEST_BODY);
+    request_data.session_id = session_id;
+
+    const char *fragments[] = { reinterpret_cast<const char *>(&request_data), data.data() };
+    const uint16_t fragments_sizes[] = { sizeof(request_data), static_cast<uint16_t>(data.size()) };
+    return sendChunkedData(ipc, fragments_sizes, fragments, 2);
+}
+
+static void
+sendVerdict(SharedMemoryIPC *ipc, uint32_t session_id)
+{
+    ngx_http_cp_reply_from_service_t verdict;
+    verdict.verdict = static_cast<uint16_t>(ngx_http_cp_verdict_e::TRAFFIC_VERDICT_INSPECT);
+    verdict.session_id = session_id;
+    verdict.modification_count = 0;
+    sendData(ipc, sizeof(verdict), reinterpret_cast<const char *>(&verdict));
+}
+
+static bool
+consume(SharedMemoryIPC *ipc)
+{
+    const char *data = nullptr;
+    uint16_t size = 0;
+    if (receiveData(ipc, &size, &data) < 0) return false;
+    benchmark::DoNotOptimize(data);
+    popData(ipc);
+    return true;
+}
+
+// A chunk pushed by the attachment and read by the service, without a reader waiting on the other side.
+static void
+BM_ShmemIpcChunk(benchmark::State &state)
+{
+    IpcPair ipc(NUM_OF_NGINX_IPC_ELEMENTS);
+    if (!ipc.ok()) return state.SkipWithError("Failed to open the shared memory queues");
+    string data(state.range(0), 'a');
+
+    for (auto _ : state) {
+        sendChunk(ipc.user, 1, data);
+        consume(ipc.owner);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_ShmemIpcChunk)->RangeMultiplier(4)->Range(64, 1 << 15);
+
+// The attachment pushes chunks until the queue is full, then the service reads all of them. The "chunks" counter
+// is the number of chunks of the given size that a queue with the given number of elements holds.
+static void
+BM_ShmemIpcFillAndDrain(benchmark::State &state)
+{
+    IpcPair ipc(state.range(0));
+    if (!ipc.ok()) return state.SkipWithError("Failed to open the shared memory queues");
+    string data(state.range(1), 'a');
+
+    uint64_t chunks = 0;
+    for (auto _ : state) {
+        chunks = 0;
+        while (sendChunk(ipc.user, 1, data) == 0) chunks++;
+        while (isDataAvailable(ipc.owner)) consume(ipc.owner);
+    }
+    state.counters["chunks"] = chunks;
+    state.SetItemsProcessed(state.iterations() * chunks);
+    state.SetBytesProcessed(state.iterations() * chunks * data.size());
+}
+BENCHMARK(BM_ShmemIpcFillAndDrain)
+    ->ArgsProduct({ { 50, 200, 500 }, { 128, 1024, 8192 } });
+
+// A chunk and its verdict, with the service polling the queue on another thread - the latency of the queues
+// themselves, without the socket signaling and the inspection.
+static void
+BM_ShmemIpcRoundTrip(benchmark::State &state)
+{
+    IpcPair ipc(NUM_OF_NGINX_IPC_ELEMENTS);
+    if (!ipc.ok()) return state.SkipWithError("Failed to open the shared memory queues");
+    string data(state.range(0), 'a');
+
+    atomic<bool> is_running(true);
+    thread service(
+        [&] ()
+        {
+            while (is_running) {
+                if (!isDataAvailable(ipc.owner)) {
+                    this_thread::yield();
+                    continue;
+                }
+                const char *request = nullptr;
+                uint16_t size = 0;
+                if (receiveData(ipc.owner, &size, &request) < 0) continue;
+                uint32_t session_id = reinterpret_cast<const ngx_http_cp_request_data_t *>(request)->session_id;
+                popData(ipc.owner);
+                sendVerdict(ipc.owner, session_id);
+            }
+        }
+    );
+
+    uint32_t session_id = 1;
+    for (auto _ : state) {
+        sendChunk(ipc.user, session_id++, data);
+        while (!isDataAvailable(ipc.user)) this_thread::yield();
+        consume(ipc.user);
+    }
+    is_running = false;
+    service.join();
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ShmemIpcRoundTrip)->Arg(128)->Arg(4096)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,589 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "http_traffic_replay.h"
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "cereal/archives/json.hpp"
+#include "cereal/types/vector.hpp"
+
+#include "common.h"
+#include "config.h"
+#include "debug.h"
+#include "generic_metric.h"
+#include "inspection_stage_metric.h"
+#include "nginx_attachment_opaque.h"
+
+using namespace std;
+
+USE_DEBUG_FLAG(D_HTTP_MANAGER);
+
+// The whole benchmark executable allocates through these, so the report can tell how many allocations the
+// inspection of a transaction takes.
+static atomic<uint64_t> allocations_count(0);
+static atomic<uint64_t> allocated_bytes(0);
+
+void *
+operator new(size_t size)
+{
+    allocations_count.fetch_add(1, memory_order_relaxed);
+    allocated_bytes.fetch_add(size, memory_order_relaxed);
+    void *ptr = malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) throw bad_alloc();
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+
+static const uint default_body_chunk_size = 8 * 1024;
+
+template <typename Archive, typename T>
+static void
+loadOptional(Archive &ar, const string &name, T &value)
+{
+    try {
+        ar(cereal::make_nvp(name, value));
+    } catch (const cereal::Exception &) {
+        ar.setNextName(nullptr);
+    }
+}
+
+class HarHeader
+{
+public:
+    template <typename Archive>
+    void
+    load(Archive &ar)
+    {
+        ar(cereal::make_nvp("name", name), cereal::make_nvp("value", value));
+    }
+
+    string name;
+    string value;
+};
+
+class HarContent
+{
+public:
+    template <typename Archive>
+    void
+    load(Archive &ar)
+    {
+        loadOptional(ar, "text", text);
+        loadOptional(ar, "encoding", encoding);
+    }
+
+    string text;
+    string encoding;
+};
+
+class HarRequest
+{
+public:
+    template <typename Archive>
+    void
+    load(Archive &ar)
+    {
+        ar(cereal::make_nvp("method", method), cereal::make_nvp("url", url));
+        loadOptional(ar, "httpVersion", http_version);
+        loadOptional(ar, "headers", headers);
+        loadOptional(ar, "postData", body);
+    }
+
+    string method;
+    string url;
+    string http_version = "HTTP/1.1";
+    vector<HarHeader> headers;
+    HarContent body;
+};
+
+class HarResponse
+{
+public:
+    template <typename Archive>
+    void
+    load(Archive &ar)
+    {
+        loadOptional(ar, "status", status);
+        loadOptional(ar, "headers", headers);
+        loadOptional(ar, "content", body);
+    }
+
+    uint16_t status = 0;
+    vector<HarHeader> headers;
+    HarContent body;
+};
+
+class HarEntry
+{
+public:
+    template <typename Archive>
+    void
+    load(Archive &ar)
+    {
+        ar(cereal::make_nvp("request", request));
+        loadOptional(ar, "response", response);
+        loadOptional(ar, "serverIPAddress", server_ip);
+    }
+
+    HarRequest request;
+    HarResponse response;
+    string server_ip;
+};
+
+class HarLog
+{
+public:
+    template <typename Archive>
+    void
+    load(Archive &ar)
+    {
+        ar(cereal::make_nvp("entries", entries));
+    }
+
+    vector<HarEntry> entries;
+};
+
+// A recorded transaction, prepared ahead of the replay so that parsing the corpus is not part of the measurements.
+class RecordedTransaction
+{
+public:
+    HttpTransactionData transaction_data;
+    vector<pair<string, string>> request_headers;
+    string request_body;
+    ResponseCode response_code = 0;
+    vector<pair<string, string>> response_headers;
+    string response_body;
+};
+
+class HttpTrafficReplay::Impl
+        :
+    Singleton::Provide<I_StaticResourcesHandler>::From<HttpTrafficReplay>,
+    public Listener<InspectionStageEvent>
+{
+public:
+    void
+    init()
+    {
+        registerListener();
+        Singleton::Consume<I_MainLoop>::by<HttpTrafficReplay>()->addOneTimeRoutine(
+            I_MainLoop::RoutineType::RealTime,
+            [this] () { replay(); },
+            "Replaying recorded HTTP traffic",
+            true
+        );
+    }
+
+    void
+    fini()
+    {
+        unregisterListener();
+    }
+
+    bool
+    registerStaticResource(const string &, const string &) override
+    {
+        return true;
+    }
+
+    void
+    upon(const InspectionStageEvent &event) override
+    {
+        auto stage = stages.find(event.getStage());
+        if (stage == stages.end()) {
+            stage = stages.emplace(
+                event.getStage(),
+                MetricCalculations::Histogram<uint64_t>(nullptr, event.getStage())
+            ).first;
+        }
+        stage->second.report(event.getTime().count());
+    }
+
+private:
+    void
+    replay()
+    {
+        string corpus_path = getConfigurationFlag("corpus");
+        uint iterations = getNumericFlag("iterations", 1);
+        body_chunk_size = getNumericFlag("body_chunk_size", default_body_chunk_size);
+        if (corpus_path.empty() || body_chunk_size == 0) {
+            cerr << "Usage: --corpus=<HAR file> [--iterations=<n>] [--body_chunk_size=<bytes>] [--report=<path>]"
+                << endl;
+            Singleton::Consume<I_MainLoop>::by<HttpTrafficReplay>()->stopAll();
+            return;
+        }
+
+        auto corpus = loadCorpus(corpus_path);
+        if (!corpus.ok()) {
+            cerr << "Failed to load the corpus: " << corpus.getErr() << endl;
+            Singleton::Consume<I_MainLoop>::by<HttpTrafficReplay>()->stopAll();
+            return;
+        }
+
+        // The latency of the stages is what the replay measures, regardless of the agent settings
+        InspectionStageTimer::setEnabled(true);
+        stages.clear();
+        auto timer = Singleton::Consume<I_TimeGet>::by<HttpTrafficReplay>();
+        uint64_t start_allocations = allocations_count.load();
+        uint64_t start_allocated_bytes = allocated_bytes.load();
+        chrono::microseconds start = timer->getMonotonicTime();
+
+        for (uint iteration = 0; iteration < iterations; iteration++) {
+            for (const RecordedTransaction &transaction : corpus.unpack()) {
+                chrono::microseconds transaction_start = timer->getMonotonicTime();
+                replayTransaction(transaction);
+                transaction_latency.report((timer->getMonotonicTime() - transaction_start).count());
+            }
+        }
+
+        duration = timer->getMonotonicTime() - start;
+        allocations = allocations_count.load() - start_allocations;
+        allocations_size = allocated_bytes.load() - start_allocated_bytes;
+
+        printSummary();
+        string report_path = getConfigurationFlag("report");
+        if (!report_path.empty()) saveReport(report_path);
+
+        Singleton::Consume<I_MainLoop>::by<HttpTrafficReplay>()->stopAll();
+    }
+
+    static uint
+    getNumericFlag(const string &flag, uint default_value)
+    {
+        string value = getConfigurationFlag(flag);
+        if (value.empty()) return default_value;
+        try {
+            return stoul(value);
+        } catch (const exception &) {
+            cerr << "Ignoring the illegal value '" << value << "' of the flag " << flag << endl;
+            return default_value;
+        }
+    }
+
+    Maybe<vector<RecordedTransaction>>
+    loadCorpus(const string &path)
+    {
+        ifstream corpus_file(path);
+        if (!corpus_file.is_open()) return genError("Could not open the file " + path);
+
+        HarLog har;
+        try {
+            cereal::JSONInputArchive ar(corpus_file);
+            ar(cereal::make_nvp("log", har));
+        } catch (const cereal::Exception &e) {
+            return genError(string("Illegal HAR file: ") + e.what());
+        }
+
+        vector<RecordedTransaction> transactions;
+        transactions.reserve(har.entries.size());
+        for (const HarEntry &entry : har.entries) {
+            auto transaction = parseEntry(entry);
+            if (!transaction.ok()) {
+                dbgWarning(D_HTTP_MANAGER) << "Skipping a HAR entry: " << transaction.getErr();
+                continue;
+            }
+            transactions.push_back(transaction.unpackMove());
+        }
+        if (transactions.empty()) return genError("The corpus does not contain any usable request");
+
+        return transactions;
+    }
+
+    Maybe<RecordedTransaction>
+    parseEntry(const HarEntry &entry)
+    {
+        const string &url = entry.request.url;
+        auto scheme_end = url.find("://");
+        if (scheme_end == string::npos) return genError("Not an absolute URL: " + url);
+
+        bool is_https = url.compare(0, scheme_end, "https") == 0;
+        auto authority_start = scheme_end + 3;
+        auto path_start = url.find('/', authority_start);
+        string authority = url.substr(authority_start, path_start - authority_start);
+        string uri = path_start == string::npos ? "/" : url.substr(path_start);
+        auto fragment = uri.find('#');
+        if (fragment != string::npos) uri.erase(fragment);
+
+        string host = authority;
+        uint16_t port = is_https ? 443 : 80;
+        auto port_start = authority.rfind(':');
+        if (port_start != string::npos && authority.find(']', port_start) == string::npos) {
+            host = authority.substr(0, port_start);
+            try {
+                port = stoul(authority.substr(port_start + 1));
+            } catch (const exception &) {
+                return genError("Illegal port in the URL: " + url);
+            }
+        }
+
+        RecordedTransaction transaction;
+        for (const HarHeader &header : entry.request.headers) {
+            // HTTP/2 captures hold the pseudo headers (e.g. ":authority"), which nginx does not pass on.
+            if (header.name.empty() || header.name[0] == ':') continue;
+            if (strcasecmp(header.name.c_str(), "host") == 0) host = header.value;
+            transaction.request_headers.emplace_back(header.name, header.value);
+        }
+
+        auto listening_ip = IPAddr::createIPAddr(entry.server_ip.empty() ? "127.0.0.1" : entry.server_ip);
+        if (!listening_ip.ok()) listening_ip = IPAddr::createIPAddr("127.0.0.1");
+        auto client_ip = IPAddr::createIPAddr("127.0.0.1");
+        next_client_port = next_client_port == UINT16_MAX ? 1024 : next_client_port + 1;
+
+        string parsed_host = host.substr(0, host.rfind(':') == string::npos ? string::npos : host.rfind(':'));
+        transaction.transaction_data = HttpTransactionData(
+            entry.request.http_version,
+            entry.request.method,
+            host,
+            parsed_host,
+            listening_ip.unpack(),
+            port,
+            uri,
+            uri.substr(0, uri.find('?')),
+            client_ip.unpack(),
+            next_client_port
+        );
+        transaction.request_body = decodeContent(entry.request.body);
+
+        transaction.response_code = entry.response.status;
+        for (const HarHeader &header : entry.response.headers) {
+            if (header.name.empty() || header.name[0] == ':') continue;
+            // The recorded body is already decoded, so it should not be marked as compressed.
+            if (strcasecmp(header.name.c_str(), "content-encoding") == 0) continue;
+            transaction.response_headers.emplace_back(header.name, header.value);
+        }
+        transaction.response_body = decodeContent(entry.response.body);
+
+        return transaction;
+    }
+
+    static string
+    decodeContent(const HarContent &content)
+    {
+        if (content.encoding != "base64") return content.text;
+        return Singleton::Consume<I_Encryptor>::by<HttpTrafficReplay>()->base64Decode(content.text);
+    }
+
+    // Feeds a transaction to the HTTP manager the way the nginx attachment would, stopping once a final verdict
+    // is given.
+    void
+    replayTransaction(const RecordedTransaction &transaction)
+    {
+        auto table = Singleton::Consume<I_TableSpecific<SessionID>>::by<HttpTrafficReplay>();
+        SessionID session_id = ++last_session_id;
+        if (!table->createEntry(session_id, chrono::minutes(1)) || !table->setActiveKey(session_id)) {
+            dbgWarning(D_HTTP_MANAGER) << "Failed to create a table entry for the session " << session_id;
+            verdicts["ERROR"]++;
+            return;
+        }
+
+        if (!table->createState<NginxAttachmentOpaque>(transaction.transaction_data)) {
+            dbgWarning(D_HTTP_MANAGER) << "Failed to create the state of the session " << session_id;
+            verdicts["ERROR"]++;
+            table->unsetActiveKey();
+            table->deleteEntry(session_id);
+            return;
+        }
+        NginxAttachmentOpaque &opaque = table->getState<NginxAttachmentOpaque>();
+        opaque.activateContext();
+
+        auto http_manager = Singleton::Consume<I_HttpManager>::by<HttpTrafficReplay>();
+        ngx_http_cp_verdict_e verdict = getVerdict(http_manager->inspect(transaction.transaction_data));
+        if (verdict == INSPECT) verdict = replayHeaders(transaction.request_headers, true);
+        if (verdict == INSPECT) verdict = replayBody(transaction.request_body, true);
+        if (verdict == INSPECT) verdict = getVerdict(http_manager->inspectEndRequest());
+        if (verdict == INSPECT && transaction.response_code != 0) {
+            verdict = getVerdict(http_manager->inspect(transaction.response_code));
+            if (verdict == INSPECT) verdict = replayHeaders(transaction.response_headers, false);
+            if (verdict == INSPECT) verdict = replayBody(transaction.response_body, false);
+        }
+        if (verdict == INSPECT) verdict = getVerdict(http_manager->inspectEndTransaction());
+
+        verdicts[verdictToString(verdict)]++;
+        request_bytes += transaction.request_body.size();
+        response_bytes += transaction.response_body.size();
+
+        opaque.deactivateContext();
+        table->unsetActiveKey();
+        table->deleteEntry(session_id);
+    }
+
+    ngx_http_cp_verdict_e
+    replayHeaders(const vector<pair<string, string>> &headers, bool is_request)
+    {
+        auto http_manager = Singleton::Consume<I_HttpManager>::by<HttpTrafficReplay>();
+        ngx_http_cp_verdict_e verdict = INSPECT;
+        for (uint index = 0; index < headers.size() && verdict == INSPECT; index++) {
+            HttpHeader header(
+                Buffer(headers[index].first),
+                Buffer(headers[index].second),
+                index,
+                index + 1 == headers.size()
+            );
+            verdict = getVerdict(http_manager->inspect(header, is_request));
+            if (verdict == INJECT) verdict = INSPECT;
+        }
+        return verdict;
+    }
+
+    ngx_http_cp_verdict_e
+    replayBody(const string &body, bool is_request)
+    {
+        if (body.empty()) return INSPECT;
+
+        auto http_manager = Singleton::Consume<I_HttpManager>::by<HttpTrafficReplay>();
+        ngx_http_cp_verdict_e verdict = INSPECT;
+        uint8_t chunk_index = 0;
+        for (size_t offset = 0; offset < body.size() && verdict == INSPECT; offset += body_chunk_size) {
+            size_t size = min<size_t>(body_chunk_size, body.size() - offset);
+            HttpBody chunk(
+                Buffer(body.data() + offset, size, Buffer::MemoryType::VOLATILE),
+                offset + size == body.size(),
+                chunk_index++
+            );
+            verdict = getVerdict(http_manager->inspect(chunk, is_request));
+            if (verdict == INJECT) verdict = INSPECT;
+        }
+        return verdict;
+    }
+
+    // Verdicts that are delayed (e.g. until a reputation query is answered) are polled, like nginx does.
+    ngx_http_cp_verdict_e
+    getVerdict(const FilterVerdict &filter_verdict)
+    {
+        ngx_http_cp_verdict_e verdict = filter_verdict.getVerdict();
+        while (verdict == WAIT) {
+            Singleton::Consume<I_MainLoop>::by<HttpTrafficReplay>()->yield(true);
+            verdict = Singleton::Consume<I_HttpManager>::by<HttpTrafficReplay>()->inspectDelayedVerdict().getVerdict();
+        }
+        return verdict;
+    }
+
+    static string
+    verdictToString(ngx_http_cp_verdict_e verdict)
+    {
+        switch (verdict) {
+            case INSPECT: return "INSPECT";
+            case ACCEPT: return "ACCEPT";
+            case DROP: return "DROP";
+            case INJECT: return "INJECT";
+            case IRRELEVANT: return "IRRELEVANT";
+            case RECONF: return "RECONF";
+            case WAIT: return "WAIT";
+        }
+        return "UNKNOWN";
+    }
+
+    void
+    printSummary() const
+    {
+        uint64_t transactions = transaction_latency.getCount();
+        double seconds = duration.count() / 1000000.0;
+
+        cout << fixed << setprecision(2);
+        cout << "Transactions: " << transactions << " in " << seconds << " seconds" << endl;
+        if (seconds > 0) {
+            cout << "Throughput: " << transactions / seconds << " transactions/sec, "
+                << (request_bytes + response_bytes) / seconds / (1024 * 1024) << " MB/sec of bodies" << endl;
+        }
+        if (transactions > 0) {
+            cout << "Allocations: " << static_cast<double>(allocations) / transactions << " per transaction, "
+                << static_cast<double>(allocations_size) / transactions << " bytes per transaction" << endl;
+        }
+        cout << "Verdicts:";
+        for (const auto &verdict : verdicts) cout << " " << verdict.first << "=" << verdict.second;
+        cout << endl;
+
+        cout << endl << left << setw(32) << "Stage (microseconds)" << right
+            << setw(10) << "count" << setw(12) << "total ms"
+            << setw(10) << "p50" << setw(10) << "p90" << setw(10) << "p99" << setw(10) << "p99.9" << setw(10) << "max"
+            << endl;
+        printHistogram("transaction", transaction_latency);
+        for (const auto &stage : stages) printHistogram(stage.first, stage.second);
+    }
+
+    static void
+    printHistogram(const string &name, const MetricCalculations::Histogram<uint64_t> &histogram)
+    {
+        cout << left << setw(32) << name << right
+            << setw(10) << histogram.getCount()
+            << setw(12) << histogram.getAverage() * histogram.getCount() / 1000
+            << setw(10) << histogram.getPercentile(50)
+            << setw(10) << histogram.getPercentile(90)
+            << setw(10) << histogram.getPercentile(99)
+            << setw(10) << histogram.getPercentile(99.9)
+            << setw(10) << histogram.getMax()
+            << endl;
+    }
+
+    void
+    saveReport(const string &path) const
+    {
+        ofstream report(path);
+        if (!report.is_open()) {
+            cerr << "Could not write the report to " << path << endl;
+            return;
+        }
+
+        cereal::JSONOutputArchive ar(report);
+        ar(
+            cereal::make_nvp("transactions", transaction_latency.getCount()),
+            cereal::make_nvp("durationMicroSec", static_cast<uint64_t>(duration.count())),
+            cereal::make_nvp("requestBodyBytes", request_bytes),
+            cereal::make_nvp("responseBodyBytes", response_bytes),
+            cereal::make_nvp("allocations", allocations),
+            cereal::make_nvp("allocatedBytes", allocations_size),
+            cereal::make_nvp("verdicts", verdicts)
+        );
+        transaction_latency.save(ar);
+        ar.setNextName("stagesLatencyMicroSec");
+        ar.startNode();
+        for (const auto &stage : stages) stage.second.save(ar);
+        ar.finishNode();
+    }
+
+    static constexpr auto INSPECT = ngx_http_cp_verdict_e::TRAFFIC_VERDICT_INSPECT;
+    static constexpr auto ACCEPT = ngx_http_cp_verdict_e::TRAFFIC_VERDICT_ACCEPT;
+    static constexpr auto DROP = ngx_http_cp_verdict_e::TRAFFIC_VERDICT_DROP;
+    static constexpr auto INJECT = ngx_http_cp_verdict_e::TRAFFIC_VERDICT_INJECT;
+    static constexpr auto IRRELEVANT = ngx_http_cp_verdict_e::TRAFFIC_VERDICT_IRRELEVANT;
+    static constexpr auto RECONF = ngx_http_cp_verdict_e::TRAFFIC_VERDICT_RECONF;
+    static constexpr auto WAIT = ngx_http_cp_verdict_e::TRAFFIC_VERDICT_WAIT;
+
+    uint body_chunk_size = default_body_chunk_size;
+    SessionID last_session_id = 0;
+    uint16_t next_client_port = 1024;
+    MetricCalculations::Histogram<uint64_t> transaction_latency{nullptr, "transactionLatencyMicroSec"};
+    map<string, MetricCalculations::Histogram<uint64_t>> stages;
+    map<string, uint64_t> verdicts;
+    uint64_t request_bytes = 0;
+    uint64_t response_bytes = 0;
+    uint64_t allocations = 0;
+    uint64_t allocations_size = 0;
+    chrono::microseconds duration{0};
+};
+
+HttpTrafficReplay::HttpTrafficReplay() : Component("HttpTrafficReplay"), pimpl(make_unique<Impl>()) {}
+HttpTrafficReplay::~HttpTrafficReplay() {}
+
+void HttpTrafficReplay::init() { pimpl->init(); }
+void HttpTrafficReplay::fini() { pimpl->fini(); }
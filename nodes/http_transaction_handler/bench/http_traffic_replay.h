@@ -0,0 +1,61 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __HTTP_TRAFFIC_REPLAY_H__
+#define __HTTP_TRAFFIC_REPLAY_H__
+
+#include <memory>
+
+#include "singleton.h"
+#include "i_mainloop.h"
+#include "i_table.h"
+#include "i_http_manager.h"
+#include "i_static_resources_handler.h"
+#include "i_environment.h"
+#include "i_encryptor.h"
+#include "i_time_get.h"
+#include "component.h"
+
+using SessionID = uint32_t;
+
+// Takes the place of the nginx attachment in the transaction handler benchmark: replays the requests recorded in a
+// HAR file through the HTTP manager, and reports the throughput, latency and allocations of the inspection.
+// Configured with the command line flags:
+//   --corpus=<path>           - the HAR file to replay
+//   --iterations=<number>     - how many times to replay the corpus (default 1)
+//   --body_chunk_size=<bytes> - the size of the body chunks passed to the HTTP manager (default 8192)
+//   --report=<path>           - where to write the report as JSON, in addition to the summary on the standard output
+class HttpTrafficReplay
+        :
+    public Component,
+    Singleton::Provide<I_StaticResourcesHandler>,
+    Singleton::Consume<I_MainLoop>,
+    Singleton::Consume<I_TableSpecific<SessionID>>,
+    Singleton::Consume<I_HttpManager>,
+    Singleton::Consume<I_Environment>,
+    Singleton::Consume<I_Encryptor>,
+    Singleton::Consume<I_TimeGet>
+{
+public:
+    HttpTrafficReplay();
+    ~HttpTrafficReplay();
+
+    void init() override;
+    void fini() override;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pimpl;
+};
+
+#endif // __HTTP_TRAFFIC_REPLAY_H__
@@ -0,0 +1,49 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "components_list.h"
+#include "http_traffic_replay.h"
+#include "gradual_deployment.h"
+#include "http_manager.h"
+#include "layer_7_access_control.h"
+#include "rate_limit.h"
+#include "waap.h"
+#include "ips_comp.h"
+#include "keyword_comp.h"
+#include "http_geo_filter.h"
+#include "geo_location.h"
+
+// The components of the HTTP Transaction Handler, with the nginx attachment replaced by the replay of a recorded
+// corpus. The policy is loaded as usual, e.g. from the directory given by --configDirectoryPath=<path>.
+int
+main(int argc, char **argv)
+{
+    NodeComponentsWithTable<
+        SessionID,
+        HttpTrafficReplay,
+        GradualDeployment,
+        HttpManager,
+        Layer7AccessControl,
+        RateLimit,
+        WaapComponent,
+        IPSComp,
+        KeywordComp,
+        GeoLocation,
+        HttpGeoFilter
+    > comps;
+
+    comps.registerGlobalValue<bool>("Is Rest primary routine", false);
+    comps.registerGlobalValue<uint>("Nano service API Port Range start", 12000);
+    comps.registerGlobalValue<uint>("Nano service API Port Range end", 13000);
+    return comps.run("HTTP Transaction Handler Benchmark", argc, argv);
+}